@@ -10,9 +10,33 @@
 
 #define NEAR_ZERO 1e-6
 #define NEON_ALIGNMENT 16
+#define SIMD_ALIGNMENT 64
 
 #include "crunum.h"
 
+enum CmpOp {
+	CMP_EQ,
+	CMP_NEQ,
+	CMP_GT,
+	CMP_GE,
+	CMP_LT,
+	CMP_LE,
+};
+
+/*
+ * What a fold kernel reduces with: the sum of the values, of their
+ * absolute values or of their squares, or their minimum, maximum or
+ * largest absolute value.
+ */
+enum Fold {
+	FOLD_SUM,
+	FOLD_ABS_SUM,
+	FOLD_SQUARE_SUM,
+	FOLD_MIN,
+	FOLD_MAX,
+	FOLD_ABS_MAX,
+};
+
 #if HAVE_NEON
 #include <arm_neon.h>
 
@@ -25,8 +49,35 @@ static inline float p_vaddvq_f32(float32x4_t v){
 #endif
 }
 
+static inline float p_vminvq_f32(float32x4_t v){
+#if defined(__aarch64__)
+	return vminvq_f32(v);
+#else
+	float32x2_t vtemp = vpmin_f32(vget_low_f32(v), vget_high_f32(v));
+	return vget_lane_f32(vpmin_f32(vtemp, vtemp), 0);
+#endif
+}
+
+static inline float p_vmaxvq_f32(float32x4_t v){
+#if defined(__aarch64__)
+	return vmaxvq_f32(v);
+#else
+	float32x2_t vtemp = vpmax_f32(vget_low_f32(v), vget_high_f32(v));
+	return vget_lane_f32(vpmax_f32(vtemp, vtemp), 0);
+#endif
+}
+
+static inline uint p_vmaxvq_u32(uint32x4_t v){
+#if defined(__aarch64__)
+	return vmaxvq_u32(v);
+#else
+	uint32x2_t vtemp = vpmax_u32(vget_low_u32(v), vget_high_u32(v));
+	return vget_lane_u32(vpmax_u32(vtemp, vtemp), 0);
+#endif
+}
+
 static inline uint is_lanes_eq(float32x4_t v1, float32x4_t v2){
-	return vmaxvq_u32(vceqq_f32(v1, v2));
+	return p_vmaxvq_u32(vceqq_f32(v1, v2));
 }
 
 static inline uint is_lanes_neq(float32x4_t v1, float32x4_t v2){
@@ -34,19 +85,19 @@ static inline uint is_lanes_neq(float32x4_t v1, float32x4_t v2){
 }
 
 static inline uint is_lanes_gt(float32x4_t v1, float32x4_t v2){
-	return vmaxvq_u32(vcgtq_f32(v1, v2));
+	return p_vmaxvq_u32(vcgtq_f32(v1, v2));
 }
 
 static inline uint is_lanes_ge(float32x4_t v1, float32x4_t v2){
-	return vmaxvq_u32(vcgeq_f32(v1, v2));
+	return p_vmaxvq_u32(vcgeq_f32(v1, v2));
 }
 
 static inline uint is_lanes_lt(float32x4_t v1, float32x4_t v2){
-	return vmaxvq_u32(vcltq_f32(v1, v2));
+	return p_vmaxvq_u32(vcltq_f32(v1, v2));
 }
 
 static inline uint is_lanes_le(float32x4_t v1, float32x4_t v2){
-	return vmaxvq_u32(vcleq_f32(v1, v2));
+	return p_vmaxvq_u32(vcleq_f32(v1, v2));
 }
 
 static inline uint any_lane_is(float32x4_t v, float scalar){
@@ -57,8 +108,433 @@ static inline uint any_lane_is_zero(float32x4_t v){
 	return any_lane_is(v, 0.0f);
 }
 
+#elif HAVE_SSE
+#include <immintrin.h>
+
+static inline float p_hadd_ps(__m128 v){
+	__m128 shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+	__m128 sums = _mm_add_ps(v, shuf);
+	shuf = _mm_movehl_ps(shuf, sums);
+	return _mm_cvtss_f32(_mm_add_ss(sums, shuf));
+}
+
+static inline float p_hmin_ps(__m128 v){
+	v = _mm_min_ps(v, _mm_movehl_ps(v, v));
+	return _mm_cvtss_f32(_mm_min_ss(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+}
+
+static inline float p_hmax_ps(__m128 v){
+	v = _mm_max_ps(v, _mm_movehl_ps(v, v));
+	return _mm_cvtss_f32(_mm_max_ss(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+}
+
+static inline uint is_lanes_eq(__m128 v1, __m128 v2){
+	return _mm_movemask_ps(_mm_cmpeq_ps(v1, v2)) != 0;
+}
+
+static inline uint is_lanes_neq(__m128 v1, __m128 v2){
+	return !is_lanes_eq(v1, v2);
+}
+
+static inline uint is_lanes_gt(__m128 v1, __m128 v2){
+	return _mm_movemask_ps(_mm_cmpgt_ps(v1, v2)) != 0;
+}
+
+static inline uint is_lanes_ge(__m128 v1, __m128 v2){
+	return _mm_movemask_ps(_mm_cmpge_ps(v1, v2)) != 0;
+}
+
+static inline uint is_lanes_lt(__m128 v1, __m128 v2){
+	return _mm_movemask_ps(_mm_cmplt_ps(v1, v2)) != 0;
+}
+
+static inline uint is_lanes_le(__m128 v1, __m128 v2){
+	return _mm_movemask_ps(_mm_cmple_ps(v1, v2)) != 0;
+}
+
+static inline uint any_lane_is(__m128 v, float scalar){
+	return is_lanes_eq(v, _mm_set1_ps(scalar));
+}
+
+static inline uint any_lane_is_zero(__m128 v){
+	return any_lane_is(v, 0.0f);
+}
+
 #endif
 
+static inline uint scalar_cmp(double value1, double value2, enum CmpOp op){
+	switch(op){
+		case CMP_EQ:
+			return value1 == value2;
+		case CMP_NEQ:
+			return value1 != value2;
+		case CMP_GT:
+			return value1 > value2;
+		case CMP_GE:
+			return value1 >= value2;
+		case CMP_LT:
+			return value1 < value2;
+		default:
+			return value1 <= value2;
+	}
+}
+
 void* malloc_aligned(uint alignment, uint size);
+void* malloc_aligned_wide(uint alignment, ulong size);
+void* pool_alloc(ulong size);
+void* pool_realloc(void* ptr, ulong size);
+void pool_free(void* ptr);
+ulong pool_size(void* ptr);
+void dtype_convert(void* dst, enum Dtype dst_dtype, const void* src,
+		enum Dtype src_dtype, ulong len);
+uint matrix_ld(uint cols, enum Dtype dtype);
+void matrix_clear(struct Matrix* matrix);
+void matrix_copy_values(struct Matrix* dst, const struct Matrix* src);
+const struct Matrix* matrix_cast(const struct Matrix* matrix, enum Dtype dtype,
+		struct Matrix** temp);
+void gemm(uint m, uint n, uint k, const float* a, uint lda,
+		const float* b, uint ldb, float* c, uint ldc);
+void gemm_trans(uint trans_a, uint trans_b, uint m, uint n, uint k,
+		const float* a, uint lda, const float* b, uint ldb, float* c, uint ldc);
+void gemm_f64(uint m, uint n, uint k, const double* a, uint lda,
+		const double* b, uint ldb, double* c, uint ldc);
+void gemm_trans_f64(uint trans_a, uint trans_b, uint m, uint n, uint k,
+		const double* a, uint lda, const double* b, uint ldb, double* c, uint ldc);
+void transpose_block(uint rows, uint cols, const float* src, ulong lds,
+		float* dst, ulong ldd);
+void parallel_for(ulong count, ulong grain,
+		void (*fn)(void* arg, ulong begin, ulong end), void* arg);
+
+/*
+ * Closed-form and fully unrolled routines for n x n matrices with
+ * 1 <= n <= SMALL_MAX, which the general entry points hand off to.
+ */
+#define SMALL_MAX 4
+
+void small_mul(struct Matrix* dst, const struct Matrix* matrix1, uint trans1,
+		const struct Matrix* matrix2, uint trans2);
+struct Matrix* small_inverse(struct Matrix* matrix, uint* invertible);
+double small_det(struct Matrix* matrix);
+struct Matrix* small_pow(struct Matrix* matrix, int exp, uint* invertible);
+
+/*
+ * Storage offset of the index-th element in row major order, and how many
+ * elements from there on are contiguous, capped at len. Elementwise code
+ * walks matrices in such runs, a dense matrix is a single run.
+ */
+static inline ulong matrix_offset(const struct Matrix* matrix, ulong index){
+	if(matrix->ld == matrix->cols)
+		return index;
+	return index / matrix->cols * matrix->ld + index % matrix->cols;
+}
+
+static inline ulong matrix_run(const struct Matrix* matrix, ulong index, ulong len){
+	if(matrix->ld == matrix->cols)
+		return len;
+	ulong rest = matrix->cols - index % matrix->cols;
+	return rest < len ? rest : len;
+}
+
+#define PARALLEL_THRESHOLD (1 << 16)
+#define PARALLEL_GRAIN (1 << 14)
+
+#define GEMM_MR 4
+#define GEMM_NR_MAX 32
+
+struct KernelTable {
+	const char* isa;
+	uint gemm_nr;
+	uint transpose_nr;
+	void (*add)(float* dst, const float* src1, const float* src2, ulong len);
+	void (*sub)(float* dst, const float* src1, const float* src2, ulong len);
+	void (*mul)(float* dst, const float* src1, const float* src2, ulong len);
+	void (*div)(float* dst, const float* src1, const float* src2, ulong len);
+	void (*add_scalar)(float* dst, const float* src, float scalar, ulong len);
+	void (*sub_scalar)(float* dst, const float* src, float scalar, ulong len);
+	void (*scalar_sub)(float* dst, float scalar, const float* src, ulong len);
+	void (*mul_scalar)(float* dst, const float* src, float scalar, ulong len);
+	void (*div_scalar)(float* dst, const float* src, float scalar, ulong len);
+	void (*scalar_div)(float* dst, float scalar, const float* src, ulong len);
+	uint (*cmp)(const float* src1, const float* src2, ulong len, enum CmpOp op);
+	uint (*cmp_scalar)(const float* src, float scalar, ulong len, enum CmpOp op);
+	void (*cmp_bits)(ulong* bits, const float* src1, const float* src2, ulong len, enum CmpOp op);
+	void (*cmp_scalar_bits)(ulong* bits, const float* src, float scalar, ulong len, enum CmpOp op);
+	uint (*allclose)(const float* src1, const float* src2, ulong len, float rtol, float atol);
+	float (*dot)(const float* src1, const float* src2, ulong len);
+	float (*fold)(const float* src, ulong len, enum Fold op);
+	void (*fold_into)(float* acc, const float* src, ulong len, enum Fold op);
+	ulong (*find)(const float* src, ulong len, float value);
+	void (*axpy)(float* dst, float alpha, const float* src, ulong len);
+	void (*gemm_micro)(uint kc, const float* a, const float* b, float* c, uint ldc);
+	void (*transpose4)(const float* src, ulong lds, float* dst, ulong ldd);
+	void (*transpose_tile)(const float* src, ulong lds, float* dst, ulong ldd);
+	void (*mul4)(const float* a, const float* b, float* c);
+	uint gemm_nr_f64;
+	void (*add_f64)(double* dst, const double* src1, const double* src2, ulong len);
+	void (*sub_f64)(double* dst, const double* src1, const double* src2, ulong len);
+	void (*mul_f64)(double* dst, const double* src1, const double* src2, ulong len);
+	void (*div_f64)(double* dst, const double* src1, const double* src2, ulong len);
+	void (*add_scalar_f64)(double* dst, const double* src, double scalar, ulong len);
+	void (*sub_scalar_f64)(double* dst, const double* src, double scalar, ulong len);
+	void (*scalar_sub_f64)(double* dst, double scalar, const double* src, ulong len);
+	void (*mul_scalar_f64)(double* dst, const double* src, double scalar, ulong len);
+	void (*div_scalar_f64)(double* dst, const double* src, double scalar, ulong len);
+	void (*scalar_div_f64)(double* dst, double scalar, const double* src, ulong len);
+	uint (*cmp_f64)(const double* src1, const double* src2, ulong len, enum CmpOp op);
+	uint (*cmp_scalar_f64)(const double* src, double scalar, ulong len, enum CmpOp op);
+	void (*cmp_bits_f64)(ulong* bits, const double* src1, const double* src2, ulong len,
+			enum CmpOp op);
+	void (*cmp_scalar_bits_f64)(ulong* bits, const double* src, double scalar, ulong len,
+			enum CmpOp op);
+	uint (*allclose_f64)(const double* src1, const double* src2, ulong len,
+			double rtol, double atol);
+	double (*dot_f64)(const double* src1, const double* src2, ulong len);
+	double (*fold_f64)(const double* src, ulong len, enum Fold op);
+	void (*fold_into_f64)(double* acc, const double* src, ulong len, enum Fold op);
+	ulong (*find_f64)(const double* src, ulong len, double value);
+	void (*axpy_f64)(double* dst, double alpha, const double* src, ulong len);
+	void (*gemm_micro_f64)(uint kc, const double* a, const double* b, double* c, uint ldc);
+	void (*widen_f16)(float* dst, const ushort* src, ulong len);
+	void (*narrow_f16)(ushort* dst, const float* src, ulong len);
+	void (*widen_bf16)(float* dst, const ushort* src, ulong len);
+	void (*narrow_bf16)(ushort* dst, const float* src, ulong len);
+	int (*dot_i8)(const schar* src1, const schar* src2, ulong len);
+	float (*gather_dot)(const float* values, const uint* indices,
+			const float* src, ulong len);
+	void (*batch_mul)(uint m, uint k, uint n,
+			const float* a, ulong lda, uint a_step, const float* b, ulong ldb, uint b_step,
+			float* c, ulong ldc, ulong lanes);
+	void (*batch_inverse)(uint n, const float* a, float* c, float* det,
+			ulong ld, ulong lanes);
+	void (*map)(float* dst, const float* src, ulong len, enum MapFn fn,
+			float param1, float param2);
+};
+
+extern const struct KernelTable kernel_table_scalar;
+#if HAVE_SSE
+extern const struct KernelTable kernel_table_sse;
+extern const struct KernelTable kernel_table_avx2;
+extern const struct KernelTable kernel_table_avx512;
+#endif
+#if HAVE_NEON
+extern const struct KernelTable kernel_table_neon;
+#endif
+
+extern const struct KernelTable* kernels;
+
+static inline void kernel_add(float* dst, const float* src1, const float* src2, ulong len){
+	kernels->add(dst, src1, src2, len);
+}
+
+static inline void kernel_sub(float* dst, const float* src1, const float* src2, ulong len){
+	kernels->sub(dst, src1, src2, len);
+}
+
+static inline void kernel_mul(float* dst, const float* src1, const float* src2, ulong len){
+	kernels->mul(dst, src1, src2, len);
+}
+
+static inline void kernel_div(float* dst, const float* src1, const float* src2, ulong len){
+	kernels->div(dst, src1, src2, len);
+}
+
+static inline void kernel_add_scalar(float* dst, const float* src, float scalar, ulong len){
+	kernels->add_scalar(dst, src, scalar, len);
+}
+
+static inline void kernel_sub_scalar(float* dst, const float* src, float scalar, ulong len){
+	kernels->sub_scalar(dst, src, scalar, len);
+}
+
+static inline void kernel_scalar_sub(float* dst, float scalar, const float* src, ulong len){
+	kernels->scalar_sub(dst, scalar, src, len);
+}
+
+static inline void kernel_mul_scalar(float* dst, const float* src, float scalar, ulong len){
+	kernels->mul_scalar(dst, src, scalar, len);
+}
+
+static inline void kernel_div_scalar(float* dst, const float* src, float scalar, ulong len){
+	kernels->div_scalar(dst, src, scalar, len);
+}
+
+static inline void kernel_scalar_div(float* dst, float scalar, const float* src, ulong len){
+	kernels->scalar_div(dst, scalar, src, len);
+}
+
+static inline uint kernel_cmp(const float* src1, const float* src2, ulong len, enum CmpOp op){
+	return kernels->cmp(src1, src2, len, op);
+}
+
+static inline uint kernel_cmp_scalar(const float* src, float scalar, ulong len, enum CmpOp op){
+	return kernels->cmp_scalar(src, scalar, len, op);
+}
+
+static inline void kernel_cmp_bits(ulong* bits, const float* src1, const float* src2,
+		ulong len, enum CmpOp op){
+	kernels->cmp_bits(bits, src1, src2, len, op);
+}
+
+static inline void kernel_cmp_scalar_bits(ulong* bits, const float* src, float scalar,
+		ulong len, enum CmpOp op){
+	kernels->cmp_scalar_bits(bits, src, scalar, len, op);
+}
+
+static inline uint kernel_allclose(const float* src1, const float* src2, ulong len,
+		float rtol, float atol){
+	return kernels->allclose(src1, src2, len, rtol, atol);
+}
+
+static inline float kernel_dot(const float* src1, const float* src2, ulong len){
+	return kernels->dot(src1, src2, len);
+}
+
+static inline float kernel_fold(const float* src, ulong len, enum Fold op){
+	return kernels->fold(src, len, op);
+}
+
+static inline void kernel_fold_into(float* acc, const float* src, ulong len, enum Fold op){
+	kernels->fold_into(acc, src, len, op);
+}
+
+static inline ulong kernel_find(const float* src, ulong len, float value){
+	return kernels->find(src, len, value);
+}
+
+static inline void kernel_axpy(float* dst, float alpha, const float* src, ulong len){
+	kernels->axpy(dst, alpha, src, len);
+}
+
+static inline void kernel_transpose4(const float* src, ulong lds, float* dst, ulong ldd){
+	kernels->transpose4(src, lds, dst, ldd);
+}
+
+static inline void kernel_mul4(const float* a, const float* b, float* c){
+	kernels->mul4(a, b, c);
+}
+
+static inline void kernel_add_f64(double* dst, const double* src1, const double* src2, ulong len){
+	kernels->add_f64(dst, src1, src2, len);
+}
+
+static inline void kernel_sub_f64(double* dst, const double* src1, const double* src2, ulong len){
+	kernels->sub_f64(dst, src1, src2, len);
+}
+
+static inline void kernel_mul_f64(double* dst, const double* src1, const double* src2, ulong len){
+	kernels->mul_f64(dst, src1, src2, len);
+}
+
+static inline void kernel_div_f64(double* dst, const double* src1, const double* src2, ulong len){
+	kernels->div_f64(dst, src1, src2, len);
+}
+
+static inline void kernel_add_scalar_f64(double* dst, const double* src, double scalar, ulong len){
+	kernels->add_scalar_f64(dst, src, scalar, len);
+}
+
+static inline void kernel_sub_scalar_f64(double* dst, const double* src, double scalar, ulong len){
+	kernels->sub_scalar_f64(dst, src, scalar, len);
+}
+
+static inline void kernel_scalar_sub_f64(double* dst, double scalar, const double* src, ulong len){
+	kernels->scalar_sub_f64(dst, scalar, src, len);
+}
+
+static inline void kernel_mul_scalar_f64(double* dst, const double* src, double scalar, ulong len){
+	kernels->mul_scalar_f64(dst, src, scalar, len);
+}
+
+static inline void kernel_div_scalar_f64(double* dst, const double* src, double scalar, ulong len){
+	kernels->div_scalar_f64(dst, src, scalar, len);
+}
+
+static inline void kernel_scalar_div_f64(double* dst, double scalar, const double* src, ulong len){
+	kernels->scalar_div_f64(dst, scalar, src, len);
+}
+
+static inline uint kernel_cmp_f64(const double* src1, const double* src2, ulong len, enum CmpOp op){
+	return kernels->cmp_f64(src1, src2, len, op);
+}
+
+static inline uint kernel_cmp_scalar_f64(const double* src, double scalar, ulong len, enum CmpOp op){
+	return kernels->cmp_scalar_f64(src, scalar, len, op);
+}
+
+static inline void kernel_cmp_bits_f64(ulong* bits, const double* src1, const double* src2,
+		ulong len, enum CmpOp op){
+	kernels->cmp_bits_f64(bits, src1, src2, len, op);
+}
+
+static inline void kernel_cmp_scalar_bits_f64(ulong* bits, const double* src, double scalar,
+		ulong len, enum CmpOp op){
+	kernels->cmp_scalar_bits_f64(bits, src, scalar, len, op);
+}
+
+static inline uint kernel_allclose_f64(const double* src1, const double* src2, ulong len,
+		double rtol, double atol){
+	return kernels->allclose_f64(src1, src2, len, rtol, atol);
+}
+
+static inline double kernel_dot_f64(const double* src1, const double* src2, ulong len){
+	return kernels->dot_f64(src1, src2, len);
+}
+
+static inline double kernel_fold_f64(const double* src, ulong len, enum Fold op){
+	return kernels->fold_f64(src, len, op);
+}
+
+static inline void kernel_fold_into_f64(double* acc, const double* src, ulong len, enum Fold op){
+	kernels->fold_into_f64(acc, src, len, op);
+}
+
+static inline ulong kernel_find_f64(const double* src, ulong len, double value){
+	return kernels->find_f64(src, len, value);
+}
+
+static inline void kernel_axpy_f64(double* dst, double alpha, const double* src, ulong len){
+	kernels->axpy_f64(dst, alpha, src, len);
+}
+
+static inline void kernel_widen_f16(float* dst, const ushort* src, ulong len){
+	kernels->widen_f16(dst, src, len);
+}
+
+static inline void kernel_narrow_f16(ushort* dst, const float* src, ulong len){
+	kernels->narrow_f16(dst, src, len);
+}
+
+static inline void kernel_widen_bf16(float* dst, const ushort* src, ulong len){
+	kernels->widen_bf16(dst, src, len);
+}
+
+static inline void kernel_narrow_bf16(ushort* dst, const float* src, ulong len){
+	kernels->narrow_bf16(dst, src, len);
+}
+
+static inline int kernel_dot_i8(const schar* src1, const schar* src2, ulong len){
+	return kernels->dot_i8(src1, src2, len);
+}
+
+static inline float kernel_gather_dot(const float* values, const uint* indices,
+		const float* src, ulong len){
+	return kernels->gather_dot(values, indices, src, len);
+}
+
+static inline void kernel_batch_mul(uint m, uint k, uint n,
+		const float* a, ulong lda, uint a_step, const float* b, ulong ldb, uint b_step,
+		float* c, ulong ldc, ulong lanes){
+	kernels->batch_mul(m, k, n, a, lda, a_step, b, ldb, b_step, c, ldc, lanes);
+}
+
+static inline void kernel_batch_inverse(uint n, const float* a, float* c, float* det,
+		ulong ld, ulong lanes){
+	kernels->batch_inverse(n, a, c, det, ld, lanes);
+}
+
+static inline void kernel_map(float* dst, const float* src, ulong len, enum MapFn fn,
+		float param1, float param2){
+	kernels->map(dst, src, len, fn, param1, param2);
+}
 
 #endif
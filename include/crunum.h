@@ -10,106 +10,672 @@
 
 typedef unsigned int uint;
 typedef unsigned long ulong;
+typedef unsigned short ushort;
+typedef signed char schar;
 
+/*
+ * Element types. DTYPE_F32 is the zero value, so storage set up without
+ * naming a dtype stays single precision. DTYPE_F16 (IEEE half) and
+ * DTYPE_BF16 (bfloat16) are storage only, they hold raw 16 bit patterns
+ * and are widened to float32 for arithmetic.
+ */
+enum Dtype {
+	DTYPE_F32,
+	DTYPE_F64,
+	DTYPE_F16,
+	DTYPE_BF16,
+};
+
+/*
+ * Row i starts at values[i * ld], ld >= cols. Rows wide enough to span
+ * a cache line are padded so each one starts SIMD_ALIGNMENT aligned, the
+ * padding holds no data. cols_cap is the row capacity, which is ld, and
+ * rows_cap the number of such rows the storage holds. values_f64 aliases
+ * values and is the one to use when dtype is DTYPE_F64, values_half when
+ * it is DTYPE_F16 or DTYPE_BF16.
+ */
 struct Matrix {
-	float* values;
+	union {
+		float* values;
+		double* values_f64;
+		ushort* values_half;
+	};
 	uint rows;
 	uint cols;
 	uint rows_cap;
 	uint cols_cap;
+	uint ld;
+	enum Dtype dtype;
 };
 
 struct Vector {
-	float* values;
+	union {
+		float* values;
+		double* values_f64;
+		ushort* values_half;
+	};
 	uint len;
 	uint cap;
+	enum Dtype dtype;
+};
+
+/*
+ * Non-owning window into matrix or vector storage, row i starts at
+ * values[i * ld] and holds cols contiguous elements. Matrix rows are
+ * 1 x cols views, columns rows x 1 views with ld = cols. A transposed
+ * view reads element (i, j) from values[j * ld + i] instead, so
+ * transposing is a flag flip rather than a copy. Views only exist over
+ * DTYPE_F32 storage.
+ */
+struct View {
+	float* values;
+	uint rows;
+	uint cols;
+	uint ld;
+	uint transposed;
+};
+
+enum ExprOp {
+	EXPR_MATRIX,
+	EXPR_SCALAR,
+	EXPR_ADD,
+	EXPR_SUB,
+	EXPR_MUL,
+	EXPR_DIV,
+};
+
+/*
+ * Node of a lazy elementwise expression. Nodes live in caller storage and
+ * only point at their children and leaf matrices, which must outlive the
+ * evaluation.
+ */
+struct Expr {
+	enum ExprOp op;
+	struct Matrix* matrix;
+	double scalar;
+	struct Expr* left;
+	struct Expr* right;
+	uint rows;
+	uint cols;
+	uint depth;
+};
+
+/*
+ * Packed P * A = L * U factorization, L is unit lower and shares values
+ * with U. Row i was swapped with pivots[i] at step i. The factors are
+ * kept in the compute dtype of the factored matrix, float32 for the 16
+ * bit types.
+ */
+struct LU {
+	union {
+		float* values;
+		double* values_f64;
+	};
+	uint* pivots;
+	uint size;
+	uint singular;
+	enum Dtype dtype;
+};
+
+/*
+ * int8 quantized matrix, element (i, j) stands for
+ * scales[g] * (values[i * ld + j] - zero_points[g]), g being i when
+ * per_row is set and 0 when one scale covers the whole matrix.
+ */
+struct QMatrix {
+	schar* values;
+	float* scales;
+	int* zero_points;
+	uint rows;
+	uint cols;
+	uint ld;
+	uint per_row;
+};
+
+/*
+ * Reductions of a whole matrix, of each row or of each column. ARGMIN and
+ * ARGMAX give the 0 based index of the first extreme value, row major
+ * over a whole matrix. The norms are entrywise, NORM2 of a whole matrix
+ * is the Frobenius norm.
+ */
+enum Reduce {
+	REDUCE_SUM,
+	REDUCE_MEAN,
+	REDUCE_MIN,
+	REDUCE_MAX,
+	REDUCE_ARGMIN,
+	REDUCE_ARGMAX,
+	REDUCE_NORM1,
+	REDUCE_NORM2,
+	REDUCE_NORM_INF,
+};
+
+/*
+ * Elementwise functions of matrix_map and vector_map. MAP_CLAMP bounds
+ * to [param1, param2] and MAP_POW raises to param1, the others take no
+ * parameter.
+ */
+enum MapFn {
+	MAP_EXP,
+	MAP_LOG,
+	MAP_TANH,
+	MAP_SIGMOID,
+	MAP_ERF,
+	MAP_SQRT,
+	MAP_RSQRT,
+	MAP_ABS,
+	MAP_CLAMP,
+	MAP_POW,
+};
+
+enum SparseFormat {
+	SPARSE_CSR,
+	SPARSE_CSC,
+};
+
+/*
+ * Compressed sparse float32 matrix. In CSR form the nonzeros of row i
+ * are values[offsets[i] .. offsets[i + 1]), in columns given by the same
+ * range of indices, sorted. CSC is the same with rows and columns
+ * swapped, offsets then has cols + 1 entries.
+ */
+struct Sparse {
+	float* values;
+	uint* indices;
+	uint* offsets;
+	uint rows;
+	uint cols;
+	uint nnz;
+	enum SparseFormat format;
 };
 
+/*
+ * count float32 matrices of one rows x cols shape, stored element major:
+ * element (i, j) of matrix b is values[(i * cols + j) * stride + b], so
+ * the same element of consecutive matrices is contiguous and batched
+ * kernels run one matrix per SIMD lane. stride is count rounded up to a
+ * whole SIMD_ALIGNMENT, the lanes past count are zero.
+ */
+struct Batch {
+	float* values;
+	uint count;
+	uint rows;
+	uint cols;
+	uint stride;
+};
+
+/*
+ * Result of an elementwise comparison of rows x cols elements, bit k % 64
+ * of bits[k / 64] holds element k = i * cols + j. Bits past rows * cols in
+ * the last word are zero.
+ */
+struct Mask {
+	ulong* bits;
+	uint rows;
+	uint cols;
+};
+
+/*
+ * Allocator counters, hits are allocations served from a thread cache.
+ */
+struct PoolStats {
+	ulong allocs;
+	ulong hits;
+	ulong misses;
+	ulong frees;
+	ulong arena_frees;
+	ulong cached_bytes;
+};
+
+const char* crunum_isa(void);
+uint crunum_set_isa(const char* isa);
+uint crunum_num_threads(void);
+void crunum_set_num_threads(uint threads);
+uint crunum_arena_begin(void);
+void crunum_arena_end(void);
+void crunum_arena_leave(void);
+uint crunum_arena_depth(void);
+void crunum_pool_trim(void);
+void crunum_pool_stats(struct PoolStats* stats);
+void crunum_pool_reset_stats(void);
+
+static inline uint dtype_size(enum Dtype dtype){
+	switch(dtype){
+		case DTYPE_F64:
+			return sizeof(double);
+		case DTYPE_F16:
+		case DTYPE_BF16:
+			return sizeof(ushort);
+		default:
+			return sizeof(float);
+	}
+}
+
+/*
+ * Result dtype of an op mixing the two. float64 wins over everything,
+ * two different 16 bit types meet in float32.
+ */
+static inline enum Dtype dtype_promote(enum Dtype dtype1, enum Dtype dtype2){
+	if(dtype1 == DTYPE_F64 || dtype2 == DTYPE_F64)
+		return DTYPE_F64;
+	return dtype1 == dtype2 ? dtype1 : DTYPE_F32;
+}
+
+/*
+ * Dtype arithmetic on storage of the given dtype is carried out in.
+ */
+static inline enum Dtype dtype_compute(enum Dtype dtype){
+	return dtype == DTYPE_F64 ? DTYPE_F64 : DTYPE_F32;
+}
+
+/*
+ * Scalar conversions between float32 and the 16 bit types, rounding to
+ * nearest even. Bulk conversion goes through the SIMD kernels, these
+ * serve single element access and the tails.
+ */
+union FloatBits {
+	float value;
+	uint bits;
+};
+
+static inline float half_to_float(ushort half){
+	union FloatBits magic = {.bits = 113u << 23};
+	union FloatBits result = {.bits = (uint)(half & 0x7fff) << 13};
+	uint exponent = result.bits & 0x0f800000u;
+	result.bits += (127 - 15) << 23;
+	if(exponent == 0x0f800000u)
+		result.bits += (128 - 16) << 23;
+	else if(exponent == 0){
+		result.bits += 1u << 23;
+		result.value -= magic.value;
+	}
+	result.bits |= (uint)(half & 0x8000) << 16;
+	return result.value;
+}
+
+static inline ushort float_to_half(float value){
+	union FloatBits bits = {.value = value};
+	union FloatBits denormal = {.bits = ((127 - 15) + (23 - 10) + 1) << 23};
+	uint sign = bits.bits & 0x80000000u;
+	bits.bits ^= sign;
+	ushort result;
+	if(bits.bits >= 0x47800000u)
+		result = bits.bits > 0x7f800000u ? 0x7e00 : 0x7c00;
+	else if(bits.bits < 0x38800000u){
+		bits.value += denormal.value;
+		result = (ushort)(bits.bits - denormal.bits);
+	}
+	else{
+		uint odd = (bits.bits >> 13) & 1;
+		bits.bits += ((uint)(15 - 127) << 23) + 0xfff + odd;
+		result = (ushort)(bits.bits >> 13);
+	}
+	return result | (ushort)(sign >> 16);
+}
+
+static inline float bfloat_to_float(ushort bfloat){
+	union FloatBits result = {.bits = (uint)bfloat << 16};
+	return result.value;
+}
+
+static inline ushort float_to_bfloat(float value){
+	union FloatBits bits = {.value = value};
+	if((bits.bits & 0x7fffffffu) > 0x7f800000u)
+		return (ushort)((bits.bits >> 16) | 0x40);
+	return (ushort)((bits.bits + 0x7fff + ((bits.bits >> 16) & 1)) >> 16);
+}
+
+/*
+ * Element i of storage in the given dtype, widened to double, and the
+ * matching store.
+ */
+static inline double dtype_load(const void* values, enum Dtype dtype, ulong i){
+	switch(dtype){
+		case DTYPE_F64:
+			return ((const double*)values)[i];
+		case DTYPE_F16:
+			return half_to_float(((const ushort*)values)[i]);
+		case DTYPE_BF16:
+			return bfloat_to_float(((const ushort*)values)[i]);
+		default:
+			return ((const float*)values)[i];
+	}
+}
+
+static inline void dtype_store(void* values, enum Dtype dtype, ulong i, double value){
+	switch(dtype){
+		case DTYPE_F64:
+			((double*)values)[i] = value;
+			break;
+		case DTYPE_F16:
+			((ushort*)values)[i] = float_to_half((float)value);
+			break;
+		case DTYPE_BF16:
+			((ushort*)values)[i] = float_to_bfloat((float)value);
+			break;
+		default:
+			((float*)values)[i] = (float)value;
+	}
+}
+
 struct Matrix* matrix_new(uint rows, uint cols, float value);
+struct Matrix* matrix_new_dtype(uint rows, uint cols, double value, enum Dtype dtype);
 struct Matrix* matrix_randinit(uint rows, uint cols);
+struct Matrix* matrix_randinit_dtype(uint rows, uint cols, enum Dtype dtype);
 struct Matrix* matrix_identity(uint size);
+struct Matrix* matrix_identity_dtype(uint size, enum Dtype dtype);
+struct Matrix* matrix_astype(struct Matrix* matrix, enum Dtype dtype);
 void matrix_free(struct Matrix* matrix);
+/*
+ * matrix_get points into DTYPE_F32 storage only, matrix_load and
+ * matrix_set work for every dtype.
+ */
 static inline float* matrix_get(struct Matrix* matrix, uint i, uint j){
-	return &matrix->values[i * matrix->cols + j];
+	return &matrix->values[(ulong)i * matrix->ld + j];
 }
 
-static inline void matrix_set(struct Matrix* matrix, uint i, uint j, float value){
-	matrix->values[i * matrix->cols + j] = value;
+static inline double matrix_load(const struct Matrix* matrix, uint i, uint j){
+	return dtype_load(matrix->values, matrix->dtype, (ulong)i * matrix->ld + j);
+}
+
+static inline void matrix_set(struct Matrix* matrix, uint i, uint j, double value){
+	dtype_store(matrix->values, matrix->dtype, (ulong)i * matrix->ld + j, value);
+}
+
+/*
+ * Start of a row's storage in bytes, whatever the dtype.
+ */
+static inline char* matrix_row_at(const struct Matrix* matrix, uint row){
+	return (char*)matrix->values + (ulong)row * matrix->ld * dtype_size(matrix->dtype);
 }
 
 struct Vector* matrix_row(struct Matrix* matrix, uint row);
 struct Vector* matrix_col(struct Matrix* matrix, uint col);
+struct Matrix* matrix_block(struct Matrix* matrix, uint row, uint col,
+		uint rows, uint cols);
+uint matrix_set_block(struct Matrix* matrix, uint row, uint col,
+		struct Matrix* block);
 void matrix_push_row(struct Matrix* matrix, struct Vector* vector);
 void matrix_push_col(struct Matrix* matrix, struct Vector* vector);
+uint matrix_reserve(struct Matrix* matrix, uint rows, uint cols);
 static inline struct Vector* matrix_pop_row(struct Matrix* matrix){
 	return matrix_row(matrix, --matrix->rows);
 }
 
 struct Vector* matrix_pop_col(struct Matrix* matrix);
 struct Matrix* matrix_add(struct Matrix* matrix1, struct Matrix* matrix2);
-struct Matrix* matrix_add_scalar(struct Matrix* matrix, float scalar);
+struct Matrix* matrix_add_scalar(struct Matrix* matrix, double scalar);
 struct Matrix* matrix_sub(struct Matrix* matrix1, struct Matrix* matrix2);
-struct Matrix* matrix_sub_scalar(struct Matrix* matrix, float scalar);
-struct Matrix* scalar_sub_matrix(float scalar, struct Matrix* matrix);
+struct Matrix* matrix_sub_scalar(struct Matrix* matrix, double scalar);
+struct Matrix* scalar_sub_matrix(double scalar, struct Matrix* matrix);
 struct Matrix* matrix_mul(struct Matrix* matrix1, struct Matrix* matrix2);
-struct Matrix* matrix_mul_scalar(struct Matrix* matrix, float scalar);
+struct Matrix* matrix_mul_trans(struct Matrix* matrix1, uint trans1,
+		struct Matrix* matrix2, uint trans2);
+struct Matrix* matrix_mul_scalar(struct Matrix* matrix, double scalar);
 struct Vector* matrix_mul_vector(struct Matrix* matrix, struct Vector* vector);
 struct Matrix* matrix_div(struct Matrix* matrix1, struct Matrix* matrix2);
-struct Matrix* matrix_div_scalar(struct Matrix* matrix, float scalar);
-struct Matrix* scalar_div_matrix(float scalar, struct Matrix* matrix);
+struct Matrix* matrix_div_scalar(struct Matrix* matrix, double scalar);
+struct Matrix* scalar_div_matrix(double scalar, struct Matrix* matrix);
 struct Matrix* matrix_pow(struct Matrix* matrix, int exp, uint* invertible);
 struct Matrix* matrix_transpose(struct Matrix* matrix);
-static inline void matrix_reshape(struct Matrix* matrix, 
-		uint new_rows, uint new_cols){
-	matrix->rows = new_rows;
-	matrix->cols = new_cols;
-}
+void matrix_reshape(struct Matrix* matrix, uint new_rows, uint new_cols);
 
 struct Matrix* matrix_inverse(struct Matrix* matrix, uint* invertible);
+uint matrix_det(struct Matrix* matrix, double* det);
+double matrix_reduce(struct Matrix* matrix, enum Reduce op);
+struct Vector* matrix_reduce_rows(struct Matrix* matrix, enum Reduce op);
+struct Vector* matrix_reduce_cols(struct Matrix* matrix, enum Reduce op);
+struct Matrix* matrix_map(struct Matrix* matrix, enum MapFn fn,
+		double param1, double param2);
+struct LU* matrix_lu(struct Matrix* matrix);
+void lu_free(struct LU* lu);
+struct Matrix* lu_solve(struct LU* lu, struct Matrix* matrix);
+struct Matrix* lu_solve_into(struct Matrix* dst, struct LU* lu,
+		struct Matrix* matrix);
+struct Matrix* matrix_solve(struct Matrix* matrix1, struct Matrix* matrix2);
+struct QMatrix* matrix_quantize(struct Matrix* matrix, uint per_row);
+struct Matrix* qmatrix_dequantize(struct QMatrix* qmatrix);
+void qmatrix_free(struct QMatrix* qmatrix);
+struct Vector* qmatrix_mul_vector(struct QMatrix* qmatrix, struct Vector* vector);
+struct Vector* qmatrix_mul_vector_into(struct Vector* dst,
+		struct QMatrix* qmatrix, struct Vector* vector);
+struct Matrix* qmatrix_mul(struct QMatrix* qmatrix, struct Matrix* matrix);
+struct Matrix* qmatrix_mul_into(struct Matrix* dst,
+		struct QMatrix* qmatrix, struct Matrix* matrix);
+struct Sparse* sparse_from_matrix(struct Matrix* matrix, enum SparseFormat format);
+struct Sparse* sparse_from_triplets(uint rows, uint cols, uint nnz,
+		const uint* row_index, const uint* col_index, const float* values,
+		enum SparseFormat format);
+struct Matrix* sparse_to_matrix(struct Sparse* sparse);
+struct Sparse* sparse_convert(struct Sparse* sparse, enum SparseFormat format);
+struct Sparse* sparse_transpose(struct Sparse* sparse);
+void sparse_free(struct Sparse* sparse);
+struct Vector* sparse_mul_vector(struct Sparse* sparse, struct Vector* vector);
+struct Vector* sparse_mul_vector_into(struct Vector* dst,
+		struct Sparse* sparse, struct Vector* vector);
+struct Matrix* sparse_mul(struct Sparse* sparse, struct Matrix* matrix);
+struct Matrix* sparse_mul_into(struct Matrix* dst,
+		struct Sparse* sparse, struct Matrix* matrix);
+struct Batch* batch_new(uint count, uint rows, uint cols, float value);
+struct Batch* batch_identity(uint count, uint size);
+void batch_free(struct Batch* batch);
+struct Matrix* batch_get(struct Batch* batch, uint index);
+struct Batch* batch_set(struct Batch* batch, uint index, struct Matrix* matrix);
+struct Batch* batch_mul(struct Batch* batch1, struct Batch* batch2);
+struct Batch* batch_mul_into(struct Batch* dst, struct Batch* batch1, struct Batch* batch2);
+struct Batch* batch_mul_vector(struct Batch* batch, struct Vector* vector);
+struct Batch* batch_mul_vector_into(struct Batch* dst,
+		struct Batch* batch, struct Vector* vector);
+struct Batch* batch_transpose(struct Batch* batch);
+struct Batch* batch_transpose_into(struct Batch* dst, struct Batch* batch);
+struct Batch* batch_inverse(struct Batch* batch, uint* singular);
+struct Batch* batch_inverse_into(struct Batch* dst, struct Batch* batch, uint* singular);
+
+static inline float* batch_at(struct Batch* batch, uint index, uint i, uint j){
+	return &batch->values[((ulong)i * batch->cols + j) * batch->stride + index];
+}
+void mask_free(struct Mask* mask);
+ulong mask_count_nonzero(struct Mask* mask);
+struct Matrix* mask_to_matrix(struct Mask* mask);
+
+static inline uint mask_get(struct Mask* mask, uint i, uint j){
+	ulong k = (ulong)i * mask->cols + j;
+	return (uint)(mask->bits[k / 64] >> (k % 64)) & 1;
+}
+struct Matrix* matrix_add_into(struct Matrix* dst,
+		struct Matrix* matrix1, struct Matrix* matrix2);
+struct Matrix* matrix_add_scalar_into(struct Matrix* dst,
+		struct Matrix* matrix, double scalar);
+struct Matrix* matrix_sub_into(struct Matrix* dst,
+		struct Matrix* matrix1, struct Matrix* matrix2);
+struct Matrix* matrix_sub_scalar_into(struct Matrix* dst,
+		struct Matrix* matrix, double scalar);
+struct Matrix* scalar_sub_matrix_into(struct Matrix* dst,
+		double scalar, struct Matrix* matrix);
+struct Matrix* matrix_mul_into(struct Matrix* dst,
+		struct Matrix* matrix1, struct Matrix* matrix2);
+struct Matrix* matrix_mul_trans_into(struct Matrix* dst,
+		struct Matrix* matrix1, uint trans1, struct Matrix* matrix2, uint trans2);
+struct Matrix* matrix_mul_scalar_into(struct Matrix* dst,
+		struct Matrix* matrix, double scalar);
+struct Vector* matrix_mul_vector_into(struct Vector* dst,
+		struct Matrix* matrix, struct Vector* vector);
+struct Matrix* matrix_div_into(struct Matrix* dst,
+		struct Matrix* matrix1, struct Matrix* matrix2);
+struct Matrix* matrix_div_scalar_into(struct Matrix* dst,
+		struct Matrix* matrix, double scalar);
+struct Matrix* scalar_div_matrix_into(struct Matrix* dst,
+		double scalar, struct Matrix* matrix);
+struct Matrix* matrix_transpose_into(struct Matrix* dst, struct Matrix* matrix);
+struct Vector* matrix_reduce_rows_into(struct Vector* dst,
+		struct Matrix* matrix, enum Reduce op);
+struct Vector* matrix_reduce_cols_into(struct Vector* dst,
+		struct Matrix* matrix, enum Reduce op);
+struct Matrix* matrix_map_into(struct Matrix* dst, struct Matrix* matrix,
+		enum MapFn fn, double param1, double param2);
 uint matrix_eq(struct Matrix* matrix1, struct Matrix* matrix2);
 uint matrix_neq(struct Matrix* matrix1, struct Matrix* matrix2);
 uint matrix_gt(struct Matrix* matrix1, struct Matrix* matrix2);
 uint matrix_ge(struct Matrix* matrix1, struct Matrix* matrix2);
 uint matrix_lt(struct Matrix* matrix1, struct Matrix* matrix2);
 uint matrix_le(struct Matrix* matrix1, struct Matrix* matrix2);
-uint matrix_eq_scalar(struct Matrix* matrix, float scalar);
-uint matrix_neq_scalar(struct Matrix* matrix, float scalar);
-uint matrix_gt_scalar(struct Matrix* matrix, float scalar);
-uint matrix_ge_scalar(struct Matrix* matrix, float scalar);
-uint matrix_lt_scalar(struct Matrix* matrix, float scalar);
-uint matrix_le_scalar(struct Matrix* matrix, float scalar);
+uint matrix_eq_scalar(struct Matrix* matrix, double scalar);
+uint matrix_neq_scalar(struct Matrix* matrix, double scalar);
+uint matrix_gt_scalar(struct Matrix* matrix, double scalar);
+uint matrix_ge_scalar(struct Matrix* matrix, double scalar);
+uint matrix_lt_scalar(struct Matrix* matrix, double scalar);
+uint matrix_le_scalar(struct Matrix* matrix, double scalar);
+struct Mask* matrix_eq_mask(struct Matrix* matrix1, struct Matrix* matrix2);
+struct Mask* matrix_neq_mask(struct Matrix* matrix1, struct Matrix* matrix2);
+struct Mask* matrix_gt_mask(struct Matrix* matrix1, struct Matrix* matrix2);
+struct Mask* matrix_ge_mask(struct Matrix* matrix1, struct Matrix* matrix2);
+struct Mask* matrix_lt_mask(struct Matrix* matrix1, struct Matrix* matrix2);
+struct Mask* matrix_le_mask(struct Matrix* matrix1, struct Matrix* matrix2);
+struct Mask* matrix_eq_scalar_mask(struct Matrix* matrix, double scalar);
+struct Mask* matrix_neq_scalar_mask(struct Matrix* matrix, double scalar);
+struct Mask* matrix_gt_scalar_mask(struct Matrix* matrix, double scalar);
+struct Mask* matrix_ge_scalar_mask(struct Matrix* matrix, double scalar);
+struct Mask* matrix_lt_scalar_mask(struct Matrix* matrix, double scalar);
+struct Mask* matrix_le_scalar_mask(struct Matrix* matrix, double scalar);
+uint matrix_allclose(struct Matrix* matrix1, struct Matrix* matrix2,
+		double rtol, double atol);
+
+void view_matrix(struct View* view, struct Matrix* matrix);
+void view_vector(struct View* view, struct Vector* vector);
+uint view_block(struct View* view, struct Matrix* matrix,
+		uint row, uint col, uint rows, uint cols);
+uint view_row(struct View* view, struct Matrix* matrix, uint row);
+uint view_col(struct View* view, struct Matrix* matrix, uint col);
+void view_transpose(struct View* dst, const struct View* view);
+static inline uint view_is_1d(const struct View* view){
+	return view->rows == 1 || view->cols == 1;
+}
+
+static inline float* view_get(const struct View* view, uint i, uint j){
+	if(view->transposed)
+		return &view->values[(ulong)j * view->ld + i];
+	return &view->values[(ulong)i * view->ld + j];
+}
+
+struct View* view_add_into(struct View* dst,
+		const struct View* view1, const struct View* view2);
+struct View* view_sub_into(struct View* dst,
+		const struct View* view1, const struct View* view2);
+struct View* view_mul_into(struct View* dst,
+		const struct View* view1, const struct View* view2);
+struct View* view_div_into(struct View* dst,
+		const struct View* view1, const struct View* view2);
+struct View* view_add_scalar_into(struct View* dst,
+		const struct View* view, float scalar);
+struct View* view_sub_scalar_into(struct View* dst,
+		const struct View* view, float scalar);
+struct View* view_mul_scalar_into(struct View* dst,
+		const struct View* view, float scalar);
+struct View* view_div_scalar_into(struct View* dst,
+		const struct View* view, float scalar);
+struct View* scalar_sub_view_into(struct View* dst,
+		float scalar, const struct View* view);
+struct View* scalar_div_view_into(struct View* dst,
+		float scalar, const struct View* view);
+struct View* view_copy_into(struct View* dst, const struct View* view);
+struct View* view_fill(struct View* dst, float value);
+float view_dot(const struct View* view1, const struct View* view2);
+uint view_eq(const struct View* view1, const struct View* view2);
+struct View* view_matmul_into(struct View* dst,
+		const struct View* view1, const struct View* view2);
+struct Matrix* view_matmul(const struct View* view1, const struct View* view2);
+struct Matrix* matrix_from_view(const struct View* view);
+struct Vector* vector_from_view(const struct View* view);
+
+void expr_matrix(struct Expr* expr, struct Matrix* matrix);
+void expr_scalar(struct Expr* expr, double scalar);
+uint expr_binary(struct Expr* expr, enum ExprOp op,
+		struct Expr* left, struct Expr* right);
+struct Matrix* expr_eval(const struct Expr* expr);
+struct Matrix* expr_eval_into(struct Matrix* dst, const struct Expr* expr);
 
 struct Vector* vector_new(uint len, float value);
+struct Vector* vector_new_dtype(uint len, double value, enum Dtype dtype);
 struct Vector* vector_randinit(uint len);
+struct Vector* vector_randinit_dtype(uint len, enum Dtype dtype);
+struct Vector* vector_astype(struct Vector* vector, enum Dtype dtype);
 struct Vector* vector_from_matrix(struct Matrix* matrix);
 void vector_free(struct Vector* vector);
-void vector_push(struct Vector* vector, float value);
-static inline float vector_pop(struct Vector* vector){
-	return vector->values[--vector->len];
+static inline double vector_load(const struct Vector* vector, uint index){
+	return dtype_load(vector->values, vector->dtype, index);
+}
+
+static inline void vector_set(struct Vector* vector, uint index, double value){
+	dtype_store(vector->values, vector->dtype, index, value);
+}
+
+void vector_push(struct Vector* vector, double value);
+static inline double vector_pop(struct Vector* vector){
+	return vector_load(vector, --vector->len);
 }
 
 struct Vector* vector_add(struct Vector* vector1, struct Vector* vector2);
-struct Vector* vector_add_scalar(struct Vector* vector, float scalar);
+struct Vector* vector_add_scalar(struct Vector* vector, double scalar);
 struct Vector* vector_sub(struct Vector* vector1, struct Vector* vector2);
-struct Vector* vector_sub_scalar(struct Vector* vector, float scalar);
-struct Vector* scalar_sub_vector(float scalar, struct Vector* vector);
+struct Vector* vector_sub_scalar(struct Vector* vector, double scalar);
+struct Vector* scalar_sub_vector(double scalar, struct Vector* vector);
 struct Vector* vector_mul(struct Vector* vector1, struct Vector* vector2);
-struct Vector* vector_mul_scalar(struct Vector* vector, float scalar);
+struct Vector* vector_mul_scalar(struct Vector* vector, double scalar);
 struct Vector* vector_mul_matrix(struct Vector* vector, struct Matrix* matrix);
 struct Vector* vector_div(struct Vector* vector1, struct Vector* vector2);
-struct Vector* vector_div_scalar(struct Vector* vector, float scalar);
-struct Vector* scalar_div_vector(float scalar, struct Vector* vector);
+struct Vector* vector_div_scalar(struct Vector* vector, double scalar);
+struct Vector* scalar_div_vector(double scalar, struct Vector* vector);
+struct Vector* vector_map(struct Vector* vector, enum MapFn fn,
+		double param1, double param2);
+struct Vector* vector_add_into(struct Vector* dst,
+		struct Vector* vector1, struct Vector* vector2);
+struct Vector* vector_add_scalar_into(struct Vector* dst,
+		struct Vector* vector, double scalar);
+struct Vector* vector_sub_into(struct Vector* dst,
+		struct Vector* vector1, struct Vector* vector2);
+struct Vector* vector_sub_scalar_into(struct Vector* dst,
+		struct Vector* vector, double scalar);
+struct Vector* scalar_sub_vector_into(struct Vector* dst,
+		double scalar, struct Vector* vector);
+struct Vector* vector_mul_into(struct Vector* dst,
+		struct Vector* vector1, struct Vector* vector2);
+struct Vector* vector_mul_scalar_into(struct Vector* dst,
+		struct Vector* vector, double scalar);
+struct Vector* vector_mul_matrix_into(struct Vector* dst,
+		struct Vector* vector, struct Matrix* matrix);
+struct Vector* vector_div_into(struct Vector* dst,
+		struct Vector* vector1, struct Vector* vector2);
+struct Vector* vector_div_scalar_into(struct Vector* dst,
+		struct Vector* vector, double scalar);
+struct Vector* scalar_div_vector_into(struct Vector* dst,
+		double scalar, struct Vector* vector);
+struct Vector* vector_map_into(struct Vector* dst, struct Vector* vector,
+		enum MapFn fn, double param1, double param2);
 uint vector_eq(struct Vector* vector1, struct Vector* vector2);
 uint vector_neq(struct Vector* vector1, struct Vector* vector2);
 uint vector_gt(struct Vector* vector1, struct Vector* vector2);
 uint vector_ge(struct Vector* vector1, struct Vector* vector2);
 uint vector_lt(struct Vector* vector1, struct Vector* vector2);
 uint vector_le(struct Vector* vector1, struct Vector* vector2);
-uint vector_eq_scalar(struct Vector* vector, float scalar);
-uint vector_neq_scalar(struct Vector* vector, float scalar);
-uint vector_gt_scalar(struct Vector* vector, float scalar);
-uint vector_ge_scalar(struct Vector* vector, float scalar);
-uint vector_lt_scalar(struct Vector* vector, float scalar);
-uint vector_le_scalar(struct Vector* vector, float scalar);
+uint vector_eq_scalar(struct Vector* vector, double scalar);
+uint vector_neq_scalar(struct Vector* vector, double scalar);
+uint vector_gt_scalar(struct Vector* vector, double scalar);
+uint vector_ge_scalar(struct Vector* vector, double scalar);
+uint vector_lt_scalar(struct Vector* vector, double scalar);
+uint vector_le_scalar(struct Vector* vector, double scalar);
+struct Mask* vector_eq_mask(struct Vector* vector1, struct Vector* vector2);
+struct Mask* vector_neq_mask(struct Vector* vector1, struct Vector* vector2);
+struct Mask* vector_gt_mask(struct Vector* vector1, struct Vector* vector2);
+struct Mask* vector_ge_mask(struct Vector* vector1, struct Vector* vector2);
+struct Mask* vector_lt_mask(struct Vector* vector1, struct Vector* vector2);
+struct Mask* vector_le_mask(struct Vector* vector1, struct Vector* vector2);
+struct Mask* vector_eq_scalar_mask(struct Vector* vector, double scalar);
+struct Mask* vector_neq_scalar_mask(struct Vector* vector, double scalar);
+struct Mask* vector_gt_scalar_mask(struct Vector* vector, double scalar);
+struct Mask* vector_ge_scalar_mask(struct Vector* vector, double scalar);
+struct Mask* vector_lt_scalar_mask(struct Vector* vector, double scalar);
+struct Mask* vector_le_scalar_mask(struct Vector* vector, double scalar);
+uint vector_allclose(struct Vector* vector1, struct Vector* vector2,
+		double rtol, double atol);
 
 #endif
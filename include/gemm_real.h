@@ -0,0 +1,209 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+/*
+ * Blocked GEMM driver, included by src/core/gemm.c once per element
+ * type. The includer defines REAL, REAL_NAME (suffixes a name for that
+ * type, which also picks the matching kernel table fields) and REAL_F32.
+ */
+
+static const REAL* REAL_NAME(op_block)(const REAL* x, uint ld, uint trans,
+		uint row, uint col){
+	return trans ? &x[(ulong)col * ld + row] : &x[(ulong)row * ld + col];
+}
+
+/*
+ * An untransposed full panel is a GEMM_MR x kc block stored row-major
+ * that has to come out kc x GEMM_MR, which is a transpose, so it goes
+ * through the 4x4 register transpose. The same holds for a transposed B.
+ * The register transposes only exist for float, double panels are
+ * gathered element by element.
+ */
+static void REAL_NAME(pack_a)(uint mc, uint kc, const REAL* a, uint lda, uint trans_a,
+		REAL* packed){
+	for(uint i = 0; i < mc; i += GEMM_MR){
+		uint mr = mc - i < GEMM_MR ? mc - i : GEMM_MR;
+		uint p = 0;
+#if REAL_F32
+		if(!trans_a && mr == GEMM_MR)
+			for(; p + GEMM_MR <= kc; p += GEMM_MR)
+				kernel_transpose4(&a[(ulong)i * lda + p], lda, &packed[p * GEMM_MR], GEMM_MR);
+#endif
+		packed += p * GEMM_MR;
+		for(; p < kc; p++){
+			uint r = 0;
+			if(trans_a && mr == GEMM_MR)
+				memcpy(packed, &a[(ulong)p * lda + i], sizeof(REAL) * GEMM_MR);
+			else{
+				for(; r < mr; r++)
+					packed[r] = OP_AT(a, lda, trans_a, i + r, p);
+				for(; r < GEMM_MR; r++)
+					packed[r] = 0;
+			}
+			packed += GEMM_MR;
+		}
+	}
+}
+
+static void REAL_NAME(pack_b)(uint kc, uint nc, uint nr_full, const REAL* b, uint ldb,
+		uint trans_b, REAL* packed){
+	for(uint j = 0; j < nc; j += nr_full){
+		uint nr = nc - j < nr_full ? nc - j : nr_full;
+#if REAL_F32
+		if(trans_b && nr == nr_full){
+			transpose_block(nr, kc, &b[(ulong)j * ldb], ldb, packed, nr_full);
+			packed += (ulong)kc * nr_full;
+			continue;
+		}
+#endif
+		for(uint p = 0; p < kc; p++){
+			if(!trans_b && nr == nr_full)
+				memcpy(packed, &b[(ulong)p * ldb + j], sizeof(REAL) * nr_full);
+			else{
+				uint c = 0;
+				for(; c < nr; c++)
+					packed[c] = OP_AT(b, ldb, trans_b, p, j + c);
+				for(; c < nr_full; c++)
+					packed[c] = 0;
+			}
+			packed += nr_full;
+		}
+	}
+}
+
+static void REAL_NAME(macro_kernel)(const struct KernelTable* table,
+		uint mc, uint nc, uint kc,
+		const REAL* packed_a, const REAL* packed_b, REAL* c, uint ldc){
+	const uint nr_full = table->REAL_NAME(gemm_nr);
+	REAL tile[GEMM_MR * GEMM_NR_MAX];
+	for(uint j = 0; j < nc; j += nr_full){
+		uint nr = nc - j < nr_full ? nc - j : nr_full;
+		const REAL* b = &packed_b[j * kc];
+		for(uint i = 0; i < mc; i += GEMM_MR){
+			uint mr = mc - i < GEMM_MR ? mc - i : GEMM_MR;
+			const REAL* a = &packed_a[i * kc];
+			REAL* ct = &c[(ulong)i * ldc + j];
+			if(mr == GEMM_MR && nr == nr_full){
+				table->REAL_NAME(gemm_micro)(kc, a, b, ct, ldc);
+				continue;
+			}
+			for(uint r = 0; r < GEMM_MR; r++)
+				for(uint s = 0; s < nr_full; s++)
+					tile[r * nr_full + s] = r < mr && s < nr ? ct[(ulong)r * ldc + s] : 0;
+			table->REAL_NAME(gemm_micro)(kc, a, b, tile, nr_full);
+			for(uint r = 0; r < mr; r++)
+				for(uint s = 0; s < nr; s++)
+					ct[(ulong)r * ldc + s] = tile[r * nr_full + s];
+		}
+	}
+}
+
+static void REAL_NAME(gemm_small)(uint trans_a, uint trans_b, uint m, uint n, uint k,
+		const REAL* a, uint lda, const REAL* b, uint ldb, REAL* c, uint ldc){
+	for(uint i = 0; i < m; i++)
+		for(uint p = 0; p < k; p++){
+			REAL value = OP_AT(a, lda, trans_a, i, p);
+			if(!trans_b){
+				for(uint j = 0; j < n; j++)
+					c[(ulong)i * ldc + j] += value * b[(ulong)p * ldb + j];
+				continue;
+			}
+			for(uint j = 0; j < n; j++)
+				c[(ulong)i * ldc + j] += value * b[(ulong)j * ldb + p];
+		}
+}
+
+struct REAL_NAME(GemmTask) {
+	const struct KernelTable* table;
+	uint trans_a;
+	uint trans_b;
+	uint nc;
+	uint kc;
+	uint m;
+	const REAL* a;
+	uint lda;
+	const REAL* b;
+	uint ldb;
+	const REAL* packed_b;
+	REAL* c;
+	uint ldc;
+};
+
+/*
+ * The work is split into GEMM_MC x GEMM_STRIP tiles of C, row block
+ * major. Every chunk packs its own A panel and shares the packed B panel,
+ * so workers never write the same C tile.
+ */
+static void REAL_NAME(gemm_tiles)(void* arg, ulong begin, ulong end){
+	struct REAL_NAME(GemmTask)* task = arg;
+	ulong strips = (task->nc + GEMM_STRIP - 1) / GEMM_STRIP;
+	REAL* packed_a = malloc_aligned(SIMD_ALIGNMENT,
+			sizeof(REAL) * GEMM_MC * GEMM_KC);
+	ulong packed_block = (ulong)-1;
+	for(ulong tile = begin; tile < end; tile++){
+		ulong block = tile / strips;
+		uint ic = block * GEMM_MC;
+		uint jt = (tile % strips) * GEMM_STRIP;
+		uint mc = task->m - ic < GEMM_MC ? task->m - ic : GEMM_MC;
+		uint nt = task->nc - jt < GEMM_STRIP ? task->nc - jt : GEMM_STRIP;
+		REAL* c = &task->c[(ulong)ic * task->ldc + jt];
+		const REAL* a = REAL_NAME(op_block)(task->a, task->lda, task->trans_a, ic, 0);
+		if(!packed_a){
+			REAL_NAME(gemm_small)(task->trans_a, task->trans_b, mc, nt, task->kc, a, task->lda,
+					REAL_NAME(op_block)(task->b, task->ldb, task->trans_b, 0, jt), task->ldb,
+					c, task->ldc);
+			continue;
+		}
+		if(packed_block != block){
+			REAL_NAME(pack_a)(mc, task->kc, a, task->lda, task->trans_a, packed_a);
+			packed_block = block;
+		}
+		REAL_NAME(macro_kernel)(task->table, mc, nt, task->kc, packed_a,
+				&task->packed_b[jt * task->kc], c, task->ldc);
+	}
+	free(packed_a);
+}
+
+void REAL_NAME(gemm_trans)(uint trans_a, uint trans_b, uint m, uint n, uint k,
+		const REAL* a, uint lda, const REAL* b, uint ldb, REAL* c, uint ldc){
+	if(!m || !n || !k)
+		return;
+	if((ulong)m * n * k <= GEMM_SMALL){
+		REAL_NAME(gemm_small)(trans_a, trans_b, m, n, k, a, lda, b, ldb, c, ldc);
+		return;
+	}
+	const struct KernelTable* table = kernels;
+	REAL* packed_b = malloc_aligned(SIMD_ALIGNMENT,
+			sizeof(REAL) * GEMM_KC * (GEMM_NC + GEMM_NR_MAX));
+	if(!packed_b){
+		REAL_NAME(gemm_small)(trans_a, trans_b, m, n, k, a, lda, b, ldb, c, ldc);
+		return;
+	}
+	for(uint jc = 0; jc < n; jc += GEMM_NC){
+		uint nc = n - jc < GEMM_NC ? n - jc : GEMM_NC;
+		for(uint pc = 0; pc < k; pc += GEMM_KC){
+			uint kc = k - pc < GEMM_KC ? k - pc : GEMM_KC;
+			const REAL* b_block = REAL_NAME(op_block)(b, ldb, trans_b, pc, jc);
+			REAL_NAME(pack_b)(kc, nc, table->REAL_NAME(gemm_nr), b_block, ldb, trans_b, packed_b);
+			struct REAL_NAME(GemmTask) task = {table, trans_a, trans_b, nc, kc, m,
+				REAL_NAME(op_block)(a, lda, trans_a, 0, pc), lda, b_block, ldb,
+				packed_b, &c[jc], ldc};
+			ulong tiles = (ulong)((m + GEMM_MC - 1) / GEMM_MC) *
+				((nc + GEMM_STRIP - 1) / GEMM_STRIP);
+			if((ulong)m * nc * kc < GEMM_PARALLEL)
+				REAL_NAME(gemm_tiles)(&task, 0, tiles);
+			else
+				parallel_for(tiles, 1, REAL_NAME(gemm_tiles), &task);
+		}
+	}
+	free(packed_b);
+}
+
+void REAL_NAME(gemm)(uint m, uint n, uint k, const REAL* a, uint lda,
+		const REAL* b, uint ldb, REAL* c, uint ldc){
+	REAL_NAME(gemm_trans)(0, 0, m, n, k, a, lda, b, ldb, c, ldc);
+}
@@ -0,0 +1,444 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+/*
+ * Type generic part of the kernel template, included by it once per
+ * element type. The includer defines REAL (the element type), REAL_NAME
+ * (suffixes a name for that type), REAL_VECTOR, REAL_NR and, when the ISA
+ * has vectors of that type, REAL_LANES.
+ */
+
+#define real_load REAL_NAME(simd_load)
+#define real_store REAL_NAME(simd_store)
+#define real_set1 REAL_NAME(simd_set1)
+#define real_add REAL_NAME(simd_add)
+#define real_sub REAL_NAME(simd_sub)
+#define real_mul REAL_NAME(simd_mul)
+#define real_div REAL_NAME(simd_div)
+#define real_fmadd REAL_NAME(simd_fmadd)
+#define real_hadd REAL_NAME(simd_hadd)
+#define real_min REAL_NAME(simd_min)
+#define real_max REAL_NAME(simd_max)
+#define real_abs REAL_NAME(simd_abs)
+#define real_hmin REAL_NAME(simd_hmin)
+#define real_hmax REAL_NAME(simd_hmax)
+#define real_cmp_mask REAL_NAME(simd_cmp_mask)
+
+#ifdef REAL_LANES
+#define KERNEL_BINARY(name, real_op, op) \
+	static void KERNEL(REAL_NAME(name))(REAL* dst, const REAL* src1, const REAL* src2, ulong len){ \
+		ulong i = 0; \
+		for(; i + 2 * REAL_LANES <= len; i += 2 * REAL_LANES){ \
+			REAL_VECTOR v1 = real_op(real_load(&src1[i]), real_load(&src2[i])); \
+			REAL_VECTOR v2 = real_op(real_load(&src1[i + REAL_LANES]), \
+					real_load(&src2[i + REAL_LANES])); \
+			real_store(&dst[i], v1); \
+			real_store(&dst[i + REAL_LANES], v2); \
+		} \
+		for(; i + REAL_LANES <= len; i += REAL_LANES) \
+			real_store(&dst[i], real_op(real_load(&src1[i]), real_load(&src2[i]))); \
+		for(; i < len; i++) \
+			dst[i] = src1[i] op src2[i]; \
+	}
+
+#define KERNEL_SCALAR(name, real_op, op) \
+	static void KERNEL(REAL_NAME(name))(REAL* dst, const REAL* src, REAL scalar, ulong len){ \
+		REAL_VECTOR vscalar = real_set1(scalar); \
+		ulong i = 0; \
+		for(; i + REAL_LANES <= len; i += REAL_LANES) \
+			real_store(&dst[i], real_op(real_load(&src[i]), vscalar)); \
+		for(; i < len; i++) \
+			dst[i] = src[i] op scalar; \
+	}
+
+#define KERNEL_SCALAR_LEFT(name, real_op, op) \
+	static void KERNEL(REAL_NAME(name))(REAL* dst, REAL scalar, const REAL* src, ulong len){ \
+		REAL_VECTOR vscalar = real_set1(scalar); \
+		ulong i = 0; \
+		for(; i + REAL_LANES <= len; i += REAL_LANES) \
+			real_store(&dst[i], real_op(vscalar, real_load(&src[i]))); \
+		for(; i < len; i++) \
+			dst[i] = scalar op src[i]; \
+	}
+#else
+#define KERNEL_BINARY(name, real_op, op) \
+	static void KERNEL(REAL_NAME(name))(REAL* dst, const REAL* src1, const REAL* src2, ulong len){ \
+		for(ulong i = 0; i < len; i++) \
+			dst[i] = src1[i] op src2[i]; \
+	}
+
+#define KERNEL_SCALAR(name, real_op, op) \
+	static void KERNEL(REAL_NAME(name))(REAL* dst, const REAL* src, REAL scalar, ulong len){ \
+		for(ulong i = 0; i < len; i++) \
+			dst[i] = src[i] op scalar; \
+	}
+
+#define KERNEL_SCALAR_LEFT(name, real_op, op) \
+	static void KERNEL(REAL_NAME(name))(REAL* dst, REAL scalar, const REAL* src, ulong len){ \
+		for(ulong i = 0; i < len; i++) \
+			dst[i] = scalar op src[i]; \
+	}
+#endif
+
+KERNEL_BINARY(add, real_add, +)
+KERNEL_BINARY(sub, real_sub, -)
+KERNEL_BINARY(mul, real_mul, *)
+KERNEL_BINARY(div, real_div, /)
+KERNEL_SCALAR(add_scalar, real_add, +)
+KERNEL_SCALAR(sub_scalar, real_sub, -)
+KERNEL_SCALAR(mul_scalar, real_mul, *)
+KERNEL_SCALAR(div_scalar, real_div, /)
+KERNEL_SCALAR_LEFT(scalar_sub, real_sub, -)
+KERNEL_SCALAR_LEFT(scalar_div, real_div, /)
+
+static uint KERNEL(REAL_NAME(cmp))(const REAL* src1, const REAL* src2, ulong len, enum CmpOp op){
+	if(op == CMP_NEQ)
+		return !KERNEL(REAL_NAME(cmp))(src1, src2, len, CMP_EQ);
+	ulong i = 0;
+#ifdef REAL_LANES
+	const uint full = (1u << REAL_LANES) - 1;
+	for(; i + REAL_LANES <= len; i += REAL_LANES)
+		if(real_cmp_mask(real_load(&src1[i]), real_load(&src2[i]), op) != full)
+			return 0;
+#endif
+	for(; i < len; i++)
+		if(!scalar_cmp(src1[i], src2[i], op))
+			return 0;
+	return 1;
+}
+
+static uint KERNEL(REAL_NAME(cmp_scalar))(const REAL* src, REAL scalar, ulong len, enum CmpOp op){
+	if(op == CMP_NEQ)
+		return !KERNEL(REAL_NAME(cmp_scalar))(src, scalar, len, CMP_EQ);
+	ulong i = 0;
+#ifdef REAL_LANES
+	const uint full = (1u << REAL_LANES) - 1;
+	REAL_VECTOR vscalar = real_set1(scalar);
+	for(; i + REAL_LANES <= len; i += REAL_LANES)
+		if(real_cmp_mask(real_load(&src[i]), vscalar, op) != full)
+			return 0;
+#endif
+	for(; i < len; i++)
+		if(!scalar_cmp(src[i], scalar, op))
+			return 0;
+	return 1;
+}
+
+/*
+ * Bit i % 64 of bits[i / 64] is set where src1[i] op src2[i] holds, the
+ * bits past len in the last word are cleared. A lane mask never straddles
+ * a word since REAL_LANES divides 64.
+ */
+static void KERNEL(REAL_NAME(cmp_bits))(ulong* bits, const REAL* src1, const REAL* src2,
+		ulong len, enum CmpOp op){
+	for(ulong w = 0; w * 64 < len; w++)
+		bits[w] = 0;
+	ulong i = 0;
+#ifdef REAL_LANES
+	for(; i + REAL_LANES <= len; i += REAL_LANES)
+		bits[i / 64] |= (ulong)real_cmp_mask(real_load(&src1[i]),
+				real_load(&src2[i]), op) << (i % 64);
+#endif
+	for(; i < len; i++)
+		bits[i / 64] |= (ulong)scalar_cmp(src1[i], src2[i], op) << (i % 64);
+}
+
+static void KERNEL(REAL_NAME(cmp_scalar_bits))(ulong* bits, const REAL* src, REAL scalar,
+		ulong len, enum CmpOp op){
+	for(ulong w = 0; w * 64 < len; w++)
+		bits[w] = 0;
+	ulong i = 0;
+#ifdef REAL_LANES
+	REAL_VECTOR vscalar = real_set1(scalar);
+	for(; i + REAL_LANES <= len; i += REAL_LANES)
+		bits[i / 64] |= (ulong)real_cmp_mask(real_load(&src[i]),
+				vscalar, op) << (i % 64);
+#endif
+	for(; i < len; i++)
+		bits[i / 64] |= (ulong)scalar_cmp(src[i], scalar, op) << (i % 64);
+}
+
+/*
+ * Whether every |src1[i] - src2[i]| <= atol + rtol * |src2[i]|, returning
+ * at the first vector holding a failure. Infinities are close only to
+ * themselves and NaNs to nothing.
+ */
+static uint KERNEL(REAL_NAME(allclose))(const REAL* src1, const REAL* src2, ulong len,
+		REAL rtol, REAL atol){
+	ulong i = 0;
+#ifdef REAL_LANES
+	const uint full = (1u << REAL_LANES) - 1;
+	REAL_VECTOR vrtol = real_set1(rtol);
+	REAL_VECTOR vatol = real_set1(atol);
+	REAL_VECTOR vinf = real_set1(INFINITY);
+	for(; i + REAL_LANES <= len; i += REAL_LANES){
+		REAL_VECTOR v1 = real_load(&src1[i]);
+		REAL_VECTOR v2 = real_load(&src2[i]);
+		REAL_VECTOR diff = real_abs(real_sub(v1, v2));
+		REAL_VECTOR bound = real_fmadd(vrtol, real_abs(v2), vatol);
+		if(((real_cmp_mask(diff, bound, CMP_LE) & real_cmp_mask(diff, vinf, CMP_LT)) |
+					real_cmp_mask(v1, v2, CMP_EQ)) != full)
+			return 0;
+	}
+#endif
+	for(; i < len; i++){
+		REAL diff = src1[i] < src2[i] ? src2[i] - src1[i] : src1[i] - src2[i];
+		REAL bound = atol + rtol * (src2[i] < 0 ? -src2[i] : src2[i]);
+		if(src1[i] != src2[i] && !(diff <= bound && diff < INFINITY))
+			return 0;
+	}
+	return 1;
+}
+
+static REAL KERNEL(REAL_NAME(dot))(const REAL* src1, const REAL* src2, ulong len){
+	ulong i = 0;
+	REAL result = 0;
+#ifdef REAL_LANES
+	REAL_VECTOR acc1 = real_set1(0), acc2 = real_set1(0);
+	REAL_VECTOR acc3 = real_set1(0), acc4 = real_set1(0);
+	for(; i + 4 * REAL_LANES <= len; i += 4 * REAL_LANES){
+		acc1 = real_fmadd(real_load(&src1[i]), real_load(&src2[i]), acc1);
+		acc2 = real_fmadd(real_load(&src1[i + REAL_LANES]),
+				real_load(&src2[i + REAL_LANES]), acc2);
+		acc3 = real_fmadd(real_load(&src1[i + 2 * REAL_LANES]),
+				real_load(&src2[i + 2 * REAL_LANES]), acc3);
+		acc4 = real_fmadd(real_load(&src1[i + 3 * REAL_LANES]),
+				real_load(&src2[i + 3 * REAL_LANES]), acc4);
+	}
+	for(; i + REAL_LANES <= len; i += REAL_LANES)
+		acc1 = real_fmadd(real_load(&src1[i]), real_load(&src2[i]), acc1);
+	result = real_hadd(real_add(real_add(acc1, acc2), real_add(acc3, acc4)));
+#endif
+	for(; i < len; i++)
+		result += src1[i] * src2[i];
+	return result;
+}
+
+/*
+ * Folds for enum Fold, each a map of the values (map_*, real_*) and a way
+ * to combine them (combine_*, real_*). Like dot they run four vector
+ * accumulators, which start at the identity init of the combination.
+ * Where NaNs end up depends on the ISA, so a fold over them is
+ * unspecified.
+ */
+#define map_id(x) (x)
+#define map_abs(x) ((x) < 0 ? -(x) : (x))
+#define map_square(x) ((x) * (x))
+#define combine_add(x, y) ((x) + (y))
+#define combine_min(x, y) ((y) < (x) ? (y) : (x))
+#define combine_max(x, y) ((y) > (x) ? (y) : (x))
+#define real_id(v) (v)
+#define real_square(v) real_mul(v, v)
+
+#ifdef REAL_LANES
+#define KERNEL_FOLD(name, map, combine, real_map, real_combine, real_hcombine) \
+	static REAL KERNEL(REAL_NAME(name))(const REAL* src, ulong len, REAL init){ \
+		ulong i = 0; \
+		REAL_VECTOR acc1 = real_set1(init), acc2 = acc1, acc3 = acc1, acc4 = acc1; \
+		for(; i + 4 * REAL_LANES <= len; i += 4 * REAL_LANES){ \
+			acc1 = real_combine(acc1, real_map(real_load(&src[i]))); \
+			acc2 = real_combine(acc2, real_map(real_load(&src[i + REAL_LANES]))); \
+			acc3 = real_combine(acc3, real_map(real_load(&src[i + 2 * REAL_LANES]))); \
+			acc4 = real_combine(acc4, real_map(real_load(&src[i + 3 * REAL_LANES]))); \
+		} \
+		for(; i + REAL_LANES <= len; i += REAL_LANES) \
+			acc1 = real_combine(acc1, real_map(real_load(&src[i]))); \
+		REAL result = real_hcombine(real_combine(real_combine(acc1, acc2), \
+					real_combine(acc3, acc4))); \
+		for(; i < len; i++) \
+			result = combine(result, map(src[i])); \
+		return result; \
+	}
+
+#define KERNEL_FOLD_INTO(name, map, combine, real_map, real_combine) \
+	static void KERNEL(REAL_NAME(name))(REAL* acc, const REAL* src, ulong len){ \
+		ulong i = 0; \
+		for(; i + REAL_LANES <= len; i += REAL_LANES) \
+			real_store(&acc[i], real_combine(real_load(&acc[i]), \
+						real_map(real_load(&src[i])))); \
+		for(; i < len; i++) \
+			acc[i] = combine(acc[i], map(src[i])); \
+	}
+#else
+#define KERNEL_FOLD(name, map, combine, real_map, real_combine, real_hcombine) \
+	static REAL KERNEL(REAL_NAME(name))(const REAL* src, ulong len, REAL init){ \
+		REAL result = init; \
+		for(ulong i = 0; i < len; i++) \
+			result = combine(result, map(src[i])); \
+		return result; \
+	}
+
+#define KERNEL_FOLD_INTO(name, map, combine, real_map, real_combine) \
+	static void KERNEL(REAL_NAME(name))(REAL* acc, const REAL* src, ulong len){ \
+		for(ulong i = 0; i < len; i++) \
+			acc[i] = combine(acc[i], map(src[i])); \
+	}
+#endif
+
+KERNEL_FOLD(fold_sum, map_id, combine_add, real_id, real_add, real_hadd)
+KERNEL_FOLD(fold_abs_sum, map_abs, combine_add, real_abs, real_add, real_hadd)
+KERNEL_FOLD(fold_square_sum, map_square, combine_add, real_square, real_add, real_hadd)
+KERNEL_FOLD(fold_min, map_id, combine_min, real_id, real_min, real_hmin)
+KERNEL_FOLD(fold_max, map_id, combine_max, real_id, real_max, real_hmax)
+KERNEL_FOLD(fold_abs_max, map_abs, combine_max, real_abs, real_max, real_hmax)
+KERNEL_FOLD_INTO(fold_into_sum, map_id, combine_add, real_id, real_add)
+KERNEL_FOLD_INTO(fold_into_abs_sum, map_abs, combine_add, real_abs, real_add)
+KERNEL_FOLD_INTO(fold_into_square_sum, map_square, combine_add, real_square, real_add)
+KERNEL_FOLD_INTO(fold_into_min, map_id, combine_min, real_id, real_min)
+KERNEL_FOLD_INTO(fold_into_max, map_id, combine_max, real_id, real_max)
+KERNEL_FOLD_INTO(fold_into_abs_max, map_abs, combine_max, real_abs, real_max)
+
+static REAL KERNEL(REAL_NAME(fold))(const REAL* src, ulong len, enum Fold op){
+	switch(op){
+		case FOLD_SUM:
+			return KERNEL(REAL_NAME(fold_sum))(src, len, 0);
+		case FOLD_ABS_SUM:
+			return KERNEL(REAL_NAME(fold_abs_sum))(src, len, 0);
+		case FOLD_SQUARE_SUM:
+			return KERNEL(REAL_NAME(fold_square_sum))(src, len, 0);
+		case FOLD_MIN:
+			return KERNEL(REAL_NAME(fold_min))(src, len, INFINITY);
+		case FOLD_MAX:
+			return KERNEL(REAL_NAME(fold_max))(src, len, -INFINITY);
+		default:
+			return KERNEL(REAL_NAME(fold_abs_max))(src, len, 0);
+	}
+}
+
+/*
+ * acc[i] combined with the mapped src[i], acc holds the running result
+ * of earlier calls.
+ */
+static void KERNEL(REAL_NAME(fold_into))(REAL* acc, const REAL* src, ulong len, enum Fold op){
+	switch(op){
+		case FOLD_SUM:
+			KERNEL(REAL_NAME(fold_into_sum))(acc, src, len);
+			break;
+		case FOLD_ABS_SUM:
+			KERNEL(REAL_NAME(fold_into_abs_sum))(acc, src, len);
+			break;
+		case FOLD_SQUARE_SUM:
+			KERNEL(REAL_NAME(fold_into_square_sum))(acc, src, len);
+			break;
+		case FOLD_MIN:
+			KERNEL(REAL_NAME(fold_into_min))(acc, src, len);
+			break;
+		case FOLD_MAX:
+			KERNEL(REAL_NAME(fold_into_max))(acc, src, len);
+			break;
+		default:
+			KERNEL(REAL_NAME(fold_into_abs_max))(acc, src, len);
+			break;
+	}
+}
+
+/*
+ * Index of the first value equal to value, len when there is none.
+ */
+static ulong KERNEL(REAL_NAME(find))(const REAL* src, ulong len, REAL value){
+	ulong i = 0;
+#ifdef REAL_LANES
+	REAL_VECTOR vvalue = real_set1(value);
+	for(; i + REAL_LANES <= len; i += REAL_LANES){
+		uint mask = real_cmp_mask(real_load(&src[i]), vvalue, CMP_EQ);
+		if(mask)
+			return i + __builtin_ctz(mask);
+	}
+#endif
+	for(; i < len; i++)
+		if(src[i] == value)
+			return i;
+	return len;
+}
+
+static void KERNEL(REAL_NAME(axpy))(REAL* dst, REAL alpha, const REAL* src, ulong len){
+	ulong i = 0;
+#ifdef REAL_LANES
+	REAL_VECTOR valpha = real_set1(alpha);
+	for(; i + REAL_LANES <= len; i += REAL_LANES)
+		real_store(&dst[i], real_fmadd(valpha, real_load(&src[i]),
+					real_load(&dst[i])));
+#endif
+	for(; i < len; i++)
+		dst[i] += alpha * src[i];
+}
+
+#ifdef REAL_LANES
+static void KERNEL(REAL_NAME(gemm_micro))(uint kc, const REAL* a, const REAL* b,
+		REAL* c, uint ldc){
+	REAL_VECTOR c00 = real_load(&c[0 * ldc]), c01 = real_load(&c[0 * ldc + REAL_LANES]);
+	REAL_VECTOR c10 = real_load(&c[1 * ldc]), c11 = real_load(&c[1 * ldc + REAL_LANES]);
+	REAL_VECTOR c20 = real_load(&c[2 * ldc]), c21 = real_load(&c[2 * ldc + REAL_LANES]);
+	REAL_VECTOR c30 = real_load(&c[3 * ldc]), c31 = real_load(&c[3 * ldc + REAL_LANES]);
+	for(uint p = 0; p < kc; p++){
+		REAL_VECTOR b0 = real_load(b);
+		REAL_VECTOR b1 = real_load(b + REAL_LANES);
+		REAL_VECTOR av = real_set1(a[0]);
+		c00 = real_fmadd(av, b0, c00);
+		c01 = real_fmadd(av, b1, c01);
+		av = real_set1(a[1]);
+		c10 = real_fmadd(av, b0, c10);
+		c11 = real_fmadd(av, b1, c11);
+		av = real_set1(a[2]);
+		c20 = real_fmadd(av, b0, c20);
+		c21 = real_fmadd(av, b1, c21);
+		av = real_set1(a[3]);
+		c30 = real_fmadd(av, b0, c30);
+		c31 = real_fmadd(av, b1, c31);
+		a += GEMM_MR;
+		b += REAL_NR;
+	}
+	real_store(&c[0 * ldc], c00); real_store(&c[0 * ldc + REAL_LANES], c01);
+	real_store(&c[1 * ldc], c10); real_store(&c[1 * ldc + REAL_LANES], c11);
+	real_store(&c[2 * ldc], c20); real_store(&c[2 * ldc + REAL_LANES], c21);
+	real_store(&c[3 * ldc], c30); real_store(&c[3 * ldc + REAL_LANES], c31);
+}
+#else
+static void KERNEL(REAL_NAME(gemm_micro))(uint kc, const REAL* a, const REAL* b,
+		REAL* c, uint ldc){
+	REAL acc[GEMM_MR][REAL_NR] = {{0}};
+	for(uint p = 0; p < kc; p++){
+		for(uint i = 0; i < GEMM_MR; i++)
+			for(uint j = 0; j < REAL_NR; j++)
+				acc[i][j] += a[i] * b[j];
+		a += GEMM_MR;
+		b += REAL_NR;
+	}
+	for(uint i = 0; i < GEMM_MR; i++)
+		for(uint j = 0; j < REAL_NR; j++)
+			c[i * ldc + j] += acc[i][j];
+}
+#endif
+
+#undef KERNEL_BINARY
+#undef KERNEL_SCALAR
+#undef KERNEL_SCALAR_LEFT
+#undef KERNEL_FOLD
+#undef KERNEL_FOLD_INTO
+#undef map_id
+#undef map_abs
+#undef map_square
+#undef combine_add
+#undef combine_min
+#undef combine_max
+#undef real_id
+#undef real_square
+#undef real_load
+#undef real_store
+#undef real_set1
+#undef real_add
+#undef real_sub
+#undef real_mul
+#undef real_div
+#undef real_fmadd
+#undef real_hadd
+#undef real_min
+#undef real_max
+#undef real_abs
+#undef real_hmin
+#undef real_hmax
+#undef real_cmp_mask
@@ -0,0 +1,1026 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+/*
+ * Kernel template, included once per ISA by src/core/kernel_*.c.
+ * The includer defines KERNEL_ISA (used as symbol suffix) and at most
+ * one SIMD_ISA_*; the result is a kernel_table_<KERNEL_ISA> instance.
+ * Everything that doesn't depend on the element type comes from
+ * kernel_real.h, once for float and once for double.
+ */
+
+#include <math.h>
+
+#include "simd.h"
+
+#define KERNEL_CONCAT(name, isa) name##_##isa
+#define KERNEL_EXPAND(name, isa) KERNEL_CONCAT(name, isa)
+#define KERNEL(name) KERNEL_EXPAND(name, KERNEL_ISA)
+#define KERNEL_STRING_EXPAND(isa) #isa
+#define KERNEL_STRING(isa) KERNEL_STRING_EXPAND(isa)
+
+#ifdef SIMD_LANES
+#define KERNEL_NR (2 * SIMD_LANES)
+#else
+#define KERNEL_NR 8
+#endif
+
+#ifdef SIMD_LANES_F64
+#define KERNEL_NR_F64 (2 * SIMD_LANES_F64)
+#else
+#define KERNEL_NR_F64 8
+#endif
+
+#if SIMD_ISA_AVX2 || SIMD_ISA_AVX512
+#define KERNEL_TILE 8
+#else
+#define KERNEL_TILE 4
+#endif
+
+#define REAL float
+#define REAL_NAME(name) name
+#define REAL_VECTOR simd_f32
+#define REAL_NR KERNEL_NR
+#ifdef SIMD_LANES
+#define REAL_LANES SIMD_LANES
+#endif
+#include "kernel_real.h"
+#undef REAL
+#undef REAL_NAME
+#undef REAL_VECTOR
+#undef REAL_NR
+#undef REAL_LANES
+
+#define REAL double
+#define REAL_NAME(name) name##_f64
+#define REAL_VECTOR simd_f64
+#define REAL_NR KERNEL_NR_F64
+#ifdef SIMD_LANES_F64
+#define REAL_LANES SIMD_LANES_F64
+#endif
+#include "kernel_real.h"
+#undef REAL
+#undef REAL_NAME
+#undef REAL_VECTOR
+#undef REAL_NR
+#undef REAL_LANES
+
+/*
+ * Tile transposes, dst[j * ldd + i] = src[i * lds + j]. Every row is
+ * loaded before anything is stored, so src == dst with lds == ldd
+ * transposes a diagonal tile in place.
+ */
+#if SIMD_ISA_NEON
+static void KERNEL(transpose4)(const float* src, ulong lds, float* dst, ulong ldd){
+	float32x4x2_t t01 = vtrnq_f32(vld1q_f32(&src[0]), vld1q_f32(&src[lds]));
+	float32x4x2_t t23 = vtrnq_f32(vld1q_f32(&src[2 * lds]), vld1q_f32(&src[3 * lds]));
+	vst1q_f32(&dst[0], vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0])));
+	vst1q_f32(&dst[ldd], vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1])));
+	vst1q_f32(&dst[2 * ldd], vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0])));
+	vst1q_f32(&dst[3 * ldd], vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1])));
+}
+#elif defined(SIMD_LANES)
+static void KERNEL(transpose4)(const float* src, ulong lds, float* dst, ulong ldd){
+	__m128 r0 = _mm_loadu_ps(&src[0]);
+	__m128 r1 = _mm_loadu_ps(&src[lds]);
+	__m128 r2 = _mm_loadu_ps(&src[2 * lds]);
+	__m128 r3 = _mm_loadu_ps(&src[3 * lds]);
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+	_mm_storeu_ps(&dst[0], r0);
+	_mm_storeu_ps(&dst[ldd], r1);
+	_mm_storeu_ps(&dst[2 * ldd], r2);
+	_mm_storeu_ps(&dst[3 * ldd], r3);
+}
+#else
+static void KERNEL(transpose4)(const float* src, ulong lds, float* dst, ulong ldd){
+	float tile[4][4];
+	for(uint i = 0; i < 4; i++)
+		for(uint j = 0; j < 4; j++)
+			tile[j][i] = src[i * lds + j];
+	for(uint j = 0; j < 4; j++)
+		for(uint i = 0; i < 4; i++)
+			dst[j * ldd + i] = tile[j][i];
+}
+#endif
+
+/*
+ * c = a * b for packed row major 4x4 matrices, each row of c a sum of
+ * the rows of b scaled by one row of a.
+ */
+#if SIMD_ISA_NEON
+static void KERNEL(mul4)(const float* a, const float* b, float* c){
+	float32x4_t b0 = vld1q_f32(&b[0]), b1 = vld1q_f32(&b[4]);
+	float32x4_t b2 = vld1q_f32(&b[8]), b3 = vld1q_f32(&b[12]);
+	for(uint i = 0; i < 4; i++){
+		float32x4_t row = vmulq_n_f32(b0, a[i * 4]);
+		row = vmlaq_n_f32(row, b1, a[i * 4 + 1]);
+		row = vmlaq_n_f32(row, b2, a[i * 4 + 2]);
+		row = vmlaq_n_f32(row, b3, a[i * 4 + 3]);
+		vst1q_f32(&c[i * 4], row);
+	}
+}
+#elif defined(SIMD_LANES)
+#if SIMD_ISA_AVX2 || SIMD_ISA_AVX512
+#define MUL4_FMADD(v1, v2, acc) _mm_fmadd_ps(v1, v2, acc)
+#else
+#define MUL4_FMADD(v1, v2, acc) _mm_add_ps(_mm_mul_ps(v1, v2), acc)
+#endif
+static void KERNEL(mul4)(const float* a, const float* b, float* c){
+	__m128 b0 = _mm_loadu_ps(&b[0]), b1 = _mm_loadu_ps(&b[4]);
+	__m128 b2 = _mm_loadu_ps(&b[8]), b3 = _mm_loadu_ps(&b[12]);
+	for(uint i = 0; i < 4; i++){
+		__m128 row = _mm_mul_ps(_mm_set1_ps(a[i * 4]), b0);
+		row = MUL4_FMADD(_mm_set1_ps(a[i * 4 + 1]), b1, row);
+		row = MUL4_FMADD(_mm_set1_ps(a[i * 4 + 2]), b2, row);
+		row = MUL4_FMADD(_mm_set1_ps(a[i * 4 + 3]), b3, row);
+		_mm_storeu_ps(&c[i * 4], row);
+	}
+}
+#undef MUL4_FMADD
+#else
+static void KERNEL(mul4)(const float* a, const float* b, float* c){
+	for(uint i = 0; i < 4; i++)
+		for(uint j = 0; j < 4; j++)
+			c[i * 4 + j] = a[i * 4] * b[j] + a[i * 4 + 1] * b[4 + j] +
+				a[i * 4 + 2] * b[8 + j] + a[i * 4 + 3] * b[12 + j];
+}
+#endif
+
+#if SIMD_ISA_AVX2 || SIMD_ISA_AVX512
+static void KERNEL(transpose_tile)(const float* src, ulong lds, float* dst, ulong ldd){
+	__m256 r[8], t[8];
+	for(uint i = 0; i < 8; i++)
+		r[i] = _mm256_loadu_ps(&src[i * lds]);
+	for(uint i = 0; i < 8; i += 2){
+		t[i] = _mm256_unpacklo_ps(r[i], r[i + 1]);
+		t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+	}
+	for(uint i = 0; i < 8; i += 4){
+		r[i] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+		r[i + 1] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+		r[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+		r[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+	}
+	for(uint i = 0; i < 4; i++){
+		_mm256_storeu_ps(&dst[i * ldd], _mm256_permute2f128_ps(r[i], r[i + 4], 0x20));
+		_mm256_storeu_ps(&dst[(i + 4) * ldd], _mm256_permute2f128_ps(r[i], r[i + 4], 0x31));
+	}
+}
+#else
+static void KERNEL(transpose_tile)(const float* src, ulong lds, float* dst, ulong ldd){
+	KERNEL(transpose4)(src, lds, dst, ldd);
+}
+#endif
+
+/*
+ * Conversions between float32 and the 16 bit storage types. Widening is
+ * exact, narrowing rounds to nearest even and keeps NaNs quiet, matching
+ * float_to_half() and float_to_bfloat(), which also handle the tails.
+ */
+#if SIMD_ISA_AVX2 || SIMD_ISA_AVX512
+#define KERNEL_HALF_LANES 8
+
+static void KERNEL(widen_f16)(float* dst, const ushort* src, ulong len){
+	ulong i = 0;
+	for(; i + KERNEL_HALF_LANES <= len; i += KERNEL_HALF_LANES)
+		_mm256_storeu_ps(&dst[i], _mm256_cvtph_ps(
+					_mm_loadu_si128((const __m128i*)&src[i])));
+	for(; i < len; i++)
+		dst[i] = half_to_float(src[i]);
+}
+
+static void KERNEL(narrow_f16)(ushort* dst, const float* src, ulong len){
+	ulong i = 0;
+	for(; i + KERNEL_HALF_LANES <= len; i += KERNEL_HALF_LANES)
+		_mm_storeu_si128((__m128i*)&dst[i], _mm256_cvtps_ph(_mm256_loadu_ps(&src[i]),
+					_MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+	for(; i < len; i++)
+		dst[i] = float_to_half(src[i]);
+}
+
+static void KERNEL(widen_bf16)(float* dst, const ushort* src, ulong len){
+	ulong i = 0;
+	for(; i + KERNEL_HALF_LANES <= len; i += KERNEL_HALF_LANES){
+		__m256i bits = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)&src[i]));
+		_mm256_storeu_ps(&dst[i], _mm256_castsi256_ps(_mm256_slli_epi32(bits, 16)));
+	}
+	for(; i < len; i++)
+		dst[i] = bfloat_to_float(src[i]);
+}
+
+static void KERNEL(narrow_bf16)(ushort* dst, const float* src, ulong len){
+	const __m256i bias = _mm256_set1_epi32(0x7fff);
+	const __m256i one = _mm256_set1_epi32(1);
+	const __m256i quiet = _mm256_set1_epi32(0x00400000);
+	ulong i = 0;
+	for(; i + KERNEL_HALF_LANES <= len; i += KERNEL_HALF_LANES){
+		__m256 v = _mm256_loadu_ps(&src[i]);
+		__m256i bits = _mm256_castps_si256(v);
+		__m256i odd = _mm256_and_si256(_mm256_srli_epi32(bits, 16), one);
+		__m256i rounded = _mm256_add_epi32(bits, _mm256_add_epi32(bias, odd));
+		__m256i nan = _mm256_castps_si256(_mm256_cmp_ps(v, v, _CMP_UNORD_Q));
+		bits = _mm256_srli_epi32(_mm256_blendv_epi8(rounded,
+					_mm256_or_si256(bits, quiet), nan), 16);
+		_mm_storeu_si128((__m128i*)&dst[i], _mm_packus_epi32(
+					_mm256_castsi256_si128(bits), _mm256_extracti128_si256(bits, 1)));
+	}
+	for(; i < len; i++)
+		dst[i] = float_to_bfloat(src[i]);
+}
+#elif SIMD_ISA_SSE
+/*
+ * SSE2 has no half conversion instructions, so float16 stays on the
+ * scalar helpers here and only bfloat16 is vectorized.
+ */
+static void KERNEL(widen_f16)(float* dst, const ushort* src, ulong len){
+	for(ulong i = 0; i < len; i++)
+		dst[i] = half_to_float(src[i]);
+}
+
+static void KERNEL(narrow_f16)(ushort* dst, const float* src, ulong len){
+	for(ulong i = 0; i < len; i++)
+		dst[i] = float_to_half(src[i]);
+}
+
+static void KERNEL(widen_bf16)(float* dst, const ushort* src, ulong len){
+	const __m128i zero = _mm_setzero_si128();
+	ulong i = 0;
+	for(; i + 8 <= len; i += 8){
+		__m128i bits = _mm_loadu_si128((const __m128i*)&src[i]);
+		_mm_storeu_ps(&dst[i], _mm_castsi128_ps(_mm_unpacklo_epi16(zero, bits)));
+		_mm_storeu_ps(&dst[i + 4], _mm_castsi128_ps(_mm_unpackhi_epi16(zero, bits)));
+	}
+	for(; i < len; i++)
+		dst[i] = bfloat_to_float(src[i]);
+}
+
+static __m128i KERNEL(round_bf16)(__m128 v){
+	__m128i bits = _mm_castps_si128(v);
+	__m128i odd = _mm_and_si128(_mm_srli_epi32(bits, 16), _mm_set1_epi32(1));
+	__m128i rounded = _mm_add_epi32(bits, _mm_add_epi32(_mm_set1_epi32(0x7fff), odd));
+	__m128i nan = _mm_castps_si128(_mm_cmpunord_ps(v, v));
+	__m128i quiet = _mm_or_si128(bits, _mm_set1_epi32(0x00400000));
+	bits = _mm_or_si128(_mm_and_si128(nan, quiet), _mm_andnot_si128(nan, rounded));
+	/* sign extend the upper halves so the signed pack keeps them intact */
+	return _mm_srai_epi32(bits, 16);
+}
+
+static void KERNEL(narrow_bf16)(ushort* dst, const float* src, ulong len){
+	ulong i = 0;
+	for(; i + 8 <= len; i += 8)
+		_mm_storeu_si128((__m128i*)&dst[i], _mm_packs_epi32(
+					KERNEL(round_bf16)(_mm_loadu_ps(&src[i])),
+					KERNEL(round_bf16)(_mm_loadu_ps(&src[i + 4]))));
+	for(; i < len; i++)
+		dst[i] = float_to_bfloat(src[i]);
+}
+#elif SIMD_ISA_NEON
+static void KERNEL(widen_f16)(float* dst, const ushort* src, ulong len){
+	ulong i = 0;
+#if defined(__aarch64__)
+	for(; i + 4 <= len; i += 4)
+		vst1q_f32(&dst[i], vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(&src[i]))));
+#endif
+	for(; i < len; i++)
+		dst[i] = half_to_float(src[i]);
+}
+
+static void KERNEL(narrow_f16)(ushort* dst, const float* src, ulong len){
+	ulong i = 0;
+#if defined(__aarch64__)
+	for(; i + 4 <= len; i += 4)
+		vst1_u16(&dst[i], vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(&src[i]))));
+#endif
+	for(; i < len; i++)
+		dst[i] = float_to_half(src[i]);
+}
+
+static void KERNEL(widen_bf16)(float* dst, const ushort* src, ulong len){
+	ulong i = 0;
+	for(; i + 4 <= len; i += 4)
+		vst1q_f32(&dst[i], vreinterpretq_f32_u32(vshll_n_u16(vld1_u16(&src[i]), 16)));
+	for(; i < len; i++)
+		dst[i] = bfloat_to_float(src[i]);
+}
+
+static void KERNEL(narrow_bf16)(ushort* dst, const float* src, ulong len){
+	const uint32x4_t bias = vdupq_n_u32(0x7fff);
+	const uint32x4_t one = vdupq_n_u32(1);
+	const uint32x4_t quiet = vdupq_n_u32(0x00400000);
+	ulong i = 0;
+	for(; i + 4 <= len; i += 4){
+		float32x4_t v = vld1q_f32(&src[i]);
+		uint32x4_t bits = vreinterpretq_u32_f32(v);
+		uint32x4_t odd = vandq_u32(vshrq_n_u32(bits, 16), one);
+		uint32x4_t rounded = vaddq_u32(bits, vaddq_u32(bias, odd));
+		bits = vbslq_u32(vceqq_f32(v, v), rounded, vorrq_u32(bits, quiet));
+		vst1_u16(&dst[i], vshrn_n_u32(bits, 16));
+	}
+	for(; i < len; i++)
+		dst[i] = float_to_bfloat(src[i]);
+}
+#else
+static void KERNEL(widen_f16)(float* dst, const ushort* src, ulong len){
+	for(ulong i = 0; i < len; i++)
+		dst[i] = half_to_float(src[i]);
+}
+
+static void KERNEL(narrow_f16)(ushort* dst, const float* src, ulong len){
+	for(ulong i = 0; i < len; i++)
+		dst[i] = float_to_half(src[i]);
+}
+
+static void KERNEL(widen_bf16)(float* dst, const ushort* src, ulong len){
+	for(ulong i = 0; i < len; i++)
+		dst[i] = bfloat_to_float(src[i]);
+}
+
+static void KERNEL(narrow_bf16)(ushort* dst, const float* src, ulong len){
+	for(ulong i = 0; i < len; i++)
+		dst[i] = float_to_bfloat(src[i]);
+}
+#endif
+
+/*
+ * Exact int8 dot product with int32 accumulation, the inner loop of the
+ * quantized GEMV and GEMM. Lane sums wrap like the hardware does, which
+ * callers avoid by keeping len well below 2^31 / 128^2.
+ */
+#if SIMD_ISA_AVX2 || SIMD_ISA_AVX512
+static int KERNEL(dot_i8_madd)(const schar* src1, const schar* src2, ulong len){
+	__m256i sum = _mm256_setzero_si256();
+	ulong i = 0;
+	for(; i + 16 <= len; i += 16){
+		__m256i a = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)&src1[i]));
+		__m256i b = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)&src2[i]));
+		sum = _mm256_add_epi32(sum, _mm256_madd_epi16(a, b));
+	}
+	__m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum),
+			_mm256_extracti128_si256(sum, 1));
+	half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+	half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+	int result = _mm_cvtsi128_si32(half);
+	for(; i < len; i++)
+		result += src1[i] * src2[i];
+	return result;
+}
+
+#if SIMD_ISA_AVX512
+/*
+ * vpdpbusd multiplies unsigned by signed bytes, so src1 is biased by 128
+ * and 128 * sum(src2), accumulated the same way against ones, is taken
+ * back off at the end.
+ */
+__attribute__((target("avx512vnni,avx512bw,avx512f")))
+static int KERNEL(dot_i8_vnni)(const schar* src1, const schar* src2, ulong len){
+	const __m512i flip = _mm512_set1_epi8((char)0x80);
+	const __m512i ones = _mm512_set1_epi8(1);
+	__m512i sum = _mm512_setzero_si512();
+	__m512i bias = _mm512_setzero_si512();
+	ulong i = 0;
+	for(; i + 64 <= len; i += 64){
+		__m512i a = _mm512_xor_si512(_mm512_loadu_si512(&src1[i]), flip);
+		__m512i b = _mm512_loadu_si512(&src2[i]);
+		sum = _mm512_dpbusd_epi32(sum, a, b);
+		bias = _mm512_dpbusd_epi32(bias, ones, b);
+	}
+	uint result = (uint)_mm512_reduce_add_epi32(sum) -
+		128u * (uint)_mm512_reduce_add_epi32(bias);
+	return (int)result + KERNEL(dot_i8_madd)(&src1[i], &src2[i], len - i);
+}
+#endif
+
+static int KERNEL(dot_i8)(const schar* src1, const schar* src2, ulong len){
+#if SIMD_ISA_AVX512
+	if(__builtin_cpu_supports("avx512vnni"))
+		return KERNEL(dot_i8_vnni)(src1, src2, len);
+#endif
+	return KERNEL(dot_i8_madd)(src1, src2, len);
+}
+#elif SIMD_ISA_SSE
+/*
+ * SSE2 has no byte sign extension, unpacking a byte with itself and
+ * shifting right arithmetically does the same.
+ */
+static int KERNEL(dot_i8)(const schar* src1, const schar* src2, ulong len){
+	__m128i sum = _mm_setzero_si128();
+	ulong i = 0;
+	for(; i + 16 <= len; i += 16){
+		__m128i a = _mm_loadu_si128((const __m128i*)&src1[i]);
+		__m128i b = _mm_loadu_si128((const __m128i*)&src2[i]);
+		__m128i a_low = _mm_srai_epi16(_mm_unpacklo_epi8(a, a), 8);
+		__m128i a_high = _mm_srai_epi16(_mm_unpackhi_epi8(a, a), 8);
+		__m128i b_low = _mm_srai_epi16(_mm_unpacklo_epi8(b, b), 8);
+		__m128i b_high = _mm_srai_epi16(_mm_unpackhi_epi8(b, b), 8);
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(a_low, b_low));
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(a_high, b_high));
+	}
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+	int result = _mm_cvtsi128_si32(sum);
+	for(; i < len; i++)
+		result += src1[i] * src2[i];
+	return result;
+}
+#elif SIMD_ISA_NEON
+/*
+ * sdot where the target has it, otherwise widening multiplies. The two
+ * halves are accumulated separately, -128 * -128 twice overflows int16.
+ */
+static int KERNEL(dot_i8)(const schar* src1, const schar* src2, ulong len){
+	int32x4_t sum = vdupq_n_s32(0);
+	ulong i = 0;
+	for(; i + 16 <= len; i += 16){
+		int8x16_t a = vld1q_s8(&src1[i]);
+		int8x16_t b = vld1q_s8(&src2[i]);
+#if defined(__ARM_FEATURE_DOTPROD)
+		sum = vdotq_s32(sum, a, b);
+#else
+		sum = vpadalq_s16(sum, vmull_s8(vget_low_s8(a), vget_low_s8(b)));
+		sum = vpadalq_s16(sum, vmull_s8(vget_high_s8(a), vget_high_s8(b)));
+#endif
+	}
+#if defined(__aarch64__)
+	int result = vaddvq_s32(sum);
+#else
+	int32x2_t pair = vadd_s32(vget_low_s32(sum), vget_high_s32(sum));
+	int result = vget_lane_s32(vpadd_s32(pair, pair), 0);
+#endif
+	for(; i < len; i++)
+		result += src1[i] * src2[i];
+	return result;
+}
+#else
+static int KERNEL(dot_i8)(const schar* src1, const schar* src2, ulong len){
+	int result = 0;
+	for(ulong i = 0; i < len; i++)
+		result += src1[i] * src2[i];
+	return result;
+}
+#endif
+
+/*
+ * sum(values[k] * src[indices[k]]), one compressed sparse row against a
+ * dense vector.
+ */
+static float KERNEL(gather_dot)(const float* values, const uint* indices,
+		const float* src, ulong len){
+	ulong i = 0;
+	float result = 0;
+#ifdef SIMD_LANES
+	simd_f32 acc1 = simd_set1(0), acc2 = simd_set1(0);
+	for(; i + 2 * SIMD_LANES <= len; i += 2 * SIMD_LANES){
+		acc1 = simd_fmadd(simd_load(&values[i]), simd_gather(src, &indices[i]), acc1);
+		acc2 = simd_fmadd(simd_load(&values[i + SIMD_LANES]),
+				simd_gather(src, &indices[i + SIMD_LANES]), acc2);
+	}
+	for(; i + SIMD_LANES <= len; i += SIMD_LANES)
+		acc1 = simd_fmadd(simd_load(&values[i]), simd_gather(src, &indices[i]), acc1);
+	result = simd_hadd(simd_add(acc1, acc2));
+#endif
+	for(; i < len; i++)
+		result += values[i] * src[indices[i]];
+	return result;
+}
+
+/*
+ * lane_* is simd_* where there is a SIMD ISA and its one lane scalar
+ * stand in otherwise, so the batched and elementwise math kernels below
+ * are written once. The scalar min, max and select follow SSE on NaN:
+ * a NaN in either operand yields the second one.
+ */
+#ifdef SIMD_LANES
+#define LANE_COUNT SIMD_LANES
+typedef simd_f32 lane_f32;
+
+static inline lane_f32 lane_neg(lane_f32 v){
+	return simd_sub(simd_set1(0), v);
+}
+
+static inline lane_f32 lane_recip(lane_f32 v){
+	return simd_div(simd_set1(1), v);
+}
+
+#define lane_add simd_add
+#define lane_sub simd_sub
+#define lane_mul simd_mul
+#define lane_div simd_div
+#define lane_load simd_load
+#define lane_store simd_store
+#define lane_set1 simd_set1
+#define lane_fmadd simd_fmadd
+#define lane_min simd_min
+#define lane_max simd_max
+#define lane_abs simd_abs
+#define lane_sqrt simd_sqrt
+#define lane_round simd_round
+#define lane_select_lt simd_select_lt
+#define lane_pow2i simd_pow2i
+#define lane_exponent simd_exponent
+#define lane_mantissa simd_mantissa
+#else
+#define LANE_COUNT 1
+typedef float lane_f32;
+
+static inline lane_f32 lane_neg(lane_f32 v){
+	return -v;
+}
+
+static inline lane_f32 lane_recip(lane_f32 v){
+	return 1 / v;
+}
+
+static inline lane_f32 lane_add(lane_f32 v1, lane_f32 v2){
+	return v1 + v2;
+}
+
+static inline lane_f32 lane_sub(lane_f32 v1, lane_f32 v2){
+	return v1 - v2;
+}
+
+static inline lane_f32 lane_mul(lane_f32 v1, lane_f32 v2){
+	return v1 * v2;
+}
+
+static inline lane_f32 lane_div(lane_f32 v1, lane_f32 v2){
+	return v1 / v2;
+}
+
+static inline lane_f32 lane_load(const float* p){
+	return *p;
+}
+
+static inline void lane_store(float* p, lane_f32 v){
+	*p = v;
+}
+
+static inline lane_f32 lane_set1(float scalar){
+	return scalar;
+}
+
+static inline lane_f32 lane_fmadd(lane_f32 v1, lane_f32 v2, lane_f32 acc){
+	return acc + v1 * v2;
+}
+
+static inline lane_f32 lane_min(lane_f32 v1, lane_f32 v2){
+	return v1 < v2 ? v1 : v2;
+}
+
+static inline lane_f32 lane_max(lane_f32 v1, lane_f32 v2){
+	return v1 > v2 ? v1 : v2;
+}
+
+static inline lane_f32 lane_abs(lane_f32 v){
+	return fabsf(v);
+}
+
+static inline lane_f32 lane_sqrt(lane_f32 v){
+	return sqrtf(v);
+}
+
+static inline lane_f32 lane_round(lane_f32 v){
+	return rintf(v);
+}
+
+static inline lane_f32 lane_select_lt(lane_f32 a, lane_f32 b, lane_f32 x, lane_f32 y){
+	return a < b ? x : y;
+}
+
+/*
+ * The SIMD versions work on the bits, NaN is passed through here since
+ * converting it to int is undefined.
+ */
+static inline lane_f32 lane_pow2i(lane_f32 v){
+	if(v != v)
+		return v;
+	union { float f; uint u; } bits = {.u = (uint)((int)v + 127) << 23};
+	return bits.f;
+}
+
+static inline lane_f32 lane_exponent(lane_f32 v){
+	union { float f; uint u; } bits = {.f = v};
+	return (float)((int)((bits.u >> 23) & 0xff) - 127);
+}
+
+static inline lane_f32 lane_mantissa(lane_f32 v){
+	union { float f; uint u; } bits = {.f = v};
+	bits.u = (bits.u & 0x007fffff) | 0x3f800000;
+	return bits.f;
+}
+#endif
+
+/*
+ * Batched small matrix kernels. A batch is element major (see struct
+ * Batch): plane p holds element p of every matrix, so one SIMD lane is
+ * one matrix and these are the plain scalar algorithms run on
+ * LANE_COUNT matrices at once. lanes is a multiple of LANE_COUNT.
+ */
+#define REAL lane_f32
+#define REAL_ADD lane_add
+#define REAL_SUB lane_sub
+#define REAL_MUL lane_mul
+#define REAL_NAME(name) KERNEL(batch_##name)
+#define REAL_NEG lane_neg
+#define REAL_RECIP lane_recip
+#include "small_real.h"
+#undef REAL
+#undef REAL_NAME
+#undef REAL_ADD
+#undef REAL_SUB
+#undef REAL_MUL
+#undef REAL_NEG
+#undef REAL_RECIP
+
+/*
+ * Square 2x2 to 4x4 products, fully unrolled.
+ */
+static void KERNEL(batch_mul_square)(uint n,
+		const float* a, ulong lda, uint a_step, const float* b, ulong ldb, uint b_step,
+		float* c, ulong ldc, ulong lanes){
+	const uint size = n * n;
+	for(ulong l = 0; l < lanes; l += LANE_COUNT){
+		const float* al = a + (a_step ? l : 0);
+		const float* bl = b + (b_step ? l : 0);
+		lane_f32 x[16], y[16], z[16];
+		for(uint p = 0; p < size; p++){
+			x[p] = lane_load(&al[p * lda]);
+			y[p] = lane_load(&bl[p * ldb]);
+		}
+		KERNEL(batch_small_mul_n)(x, y, z, n);
+		for(uint p = 0; p < size; p++)
+			lane_store(&c[p * ldc + l], z[p]);
+	}
+}
+
+/*
+ * c = a * b for m x k times k x n matrices, the planes of each operand
+ * lda, ldb and ldc floats apart. An operand whose step is 0 is one
+ * matrix broadcast over the batch, its planes then hold that matrix
+ * replicated over LANE_COUNT lanes.
+ */
+static void KERNEL(batch_mul)(uint m, uint k, uint n,
+		const float* a, ulong lda, uint a_step, const float* b, ulong ldb, uint b_step,
+		float* c, ulong ldc, ulong lanes){
+	if(m == k && k == n && n >= 2 && n <= 4){
+		KERNEL(batch_mul_square)(n, a, lda, a_step, b, ldb, b_step, c, ldc, lanes);
+		return;
+	}
+	for(ulong l = 0; l < lanes; l += LANE_COUNT){
+		const float* al = a + (a_step ? l : 0);
+		const float* bl = b + (b_step ? l : 0);
+		for(uint i = 0; i < m; i++)
+			for(uint j = 0; j < n; j++){
+				lane_f32 acc = lane_set1(0);
+				for(uint p = 0; p < k; p++)
+					acc = lane_fmadd(lane_load(&al[(ulong)(i * k + p) * lda]),
+							lane_load(&bl[(ulong)(p * n + j) * ldb]), acc);
+				lane_store(&c[(ulong)(i * n + j) * ldc + l], acc);
+			}
+	}
+}
+
+/*
+ * Closed-form inverse of n x n matrices, n <= 4, with their
+ * determinants stored to det[lane]. c may be a.
+ */
+static void KERNEL(batch_inverse)(uint n, const float* a, float* c, float* det,
+		ulong ld, ulong lanes){
+	const uint size = n * n;
+	for(ulong l = 0; l < lanes; l += LANE_COUNT){
+		lane_f32 x[16];
+		for(uint p = 0; p < size; p++)
+			x[p] = lane_load(&a[p * ld + l]);
+		lane_f32 d = KERNEL(batch_small_inverse_n)(x, x, n);
+		for(uint p = 0; p < size; p++)
+			lane_store(&c[p * ld + l], x[p]);
+		lane_store(&det[l], d);
+	}
+}
+
+/*
+ * Elementwise float32 math: Cephes style range reduction and minimax
+ * polynomials, evaluated the same way on every ISA so results only
+ * differ where fmadd is fused. Largest error found against double libm,
+ * in ulp, over every 61st float bit pattern:
+ *
+ *	exp 1.3, log 0.8, tanh 1.4, sigmoid 2.6, erf 2.5, sqrt 0.5,
+ *	rsqrt 1.5, abs and clamp exact, pow 1.5 + 0.65 * |param1|.
+ *
+ * Errors of results in the subnormal range count in ulp of the smallest
+ * normal.
+ */
+static inline lane_f32 KERNEL(lane_poly)(lane_f32 x, const float* coeffs, uint count){
+	lane_f32 acc = lane_set1(coeffs[0]);
+	for(uint i = 1; i < count; i++)
+		acc = lane_fmadd(acc, x, lane_set1(coeffs[i]));
+	return acc;
+}
+
+/*
+ * exp(x) = 2^n * exp(r), |r| <= ln(2) / 2, with ln(2) split in two so
+ * n * ln(2) is exact. exp(r) is scaled by 2^n in two halves, n ranges
+ * over [-150, 128] while one pow2i covers [-126, 127].
+ */
+#define LN2_HI 0.693359375f
+#define LN2_LO -2.12194440e-4f
+
+static inline lane_f32 KERNEL(lane_exp_reduced)(lane_f32 n, lane_f32 r){
+	static const float coeffs[] = {1.9875691500e-4f, 1.3981999507e-3f,
+		8.3334519073e-3f, 4.1665795894e-2f, 1.6666665459e-1f, 5.0000001201e-1f};
+	lane_f32 y = KERNEL(lane_poly)(r, coeffs, 6);
+	y = lane_fmadd(lane_mul(y, r), r, lane_add(r, lane_set1(1)));
+	lane_f32 half = lane_round(lane_mul(n, lane_set1(0.5f)));
+	y = lane_mul(y, lane_pow2i(half));
+	return lane_mul(y, lane_pow2i(lane_sub(n, half)));
+}
+
+static inline lane_f32 KERNEL(lane_exp)(lane_f32 x){
+	x = lane_max(lane_set1(-104.0f), lane_min(lane_set1(89.0f), x));
+	lane_f32 n = lane_round(lane_mul(x, lane_set1(1.44269504089f)));
+	lane_f32 r = lane_fmadd(n, lane_set1(-LN2_HI), x);
+	return KERNEL(lane_exp_reduced)(n, lane_fmadd(n, lane_set1(-LN2_LO), r));
+}
+
+/*
+ * log(x) = e * LN2_HI + b for positive finite x, b = e * LN2_LO +
+ * log(1 + f) with 1 + f in [sqrt(1/2), sqrt(2)). Subnormals are scaled
+ * into the normal range first.
+ */
+static inline void KERNEL(lane_log_reduced)(lane_f32 x, lane_f32* e, lane_f32* b){
+	static const float coeffs[] = {7.0376836292e-2f, -1.1514610310e-1f,
+		1.1676998740e-1f, -1.2420140846e-1f, 1.4249322787e-1f, -1.6668057665e-1f,
+		2.0000714765e-1f, -2.4999993993e-1f, 3.3333331174e-1f};
+	const lane_f32 one = lane_set1(1);
+	const lane_f32 sqrt2 = lane_set1(1.41421356f);
+	lane_f32 normal = lane_set1(0x1p-126f);
+	lane_f32 scaled = lane_select_lt(x, normal, lane_mul(x, lane_set1(0x1p23f)), x);
+	lane_f32 exponent = lane_exponent(scaled);
+	exponent = lane_select_lt(x, normal, lane_sub(exponent, lane_set1(23)), exponent);
+	lane_f32 m = lane_mantissa(scaled);
+	lane_f32 f = lane_select_lt(m, sqrt2, lane_sub(m, one),
+			lane_fmadd(m, lane_set1(0.5f), lane_set1(-1)));
+	*e = lane_select_lt(m, sqrt2, exponent, lane_add(exponent, one));
+	lane_f32 z = lane_mul(f, f);
+	lane_f32 y = lane_mul(lane_mul(KERNEL(lane_poly)(f, coeffs, 9), f), z);
+	y = lane_fmadd(*e, lane_set1(LN2_LO), y);
+	y = lane_fmadd(z, lane_set1(-0.5f), y);
+	*b = lane_add(f, y);
+}
+
+static inline lane_f32 KERNEL(lane_log)(lane_f32 x){
+	lane_f32 e, b;
+	KERNEL(lane_log_reduced)(x, &e, &b);
+	lane_f32 r = lane_fmadd(e, lane_set1(LN2_HI), b);
+	/*
+	 * x * 0 carries a NaN over, then +inf, zeros and negatives are
+	 * patched in.
+	 */
+	r = lane_fmadd(x, lane_set1(0), r);
+	r = lane_select_lt(lane_set1(0x1.fffffep127f), x, lane_set1(INFINITY), r);
+	r = lane_select_lt(x, lane_set1(0x1p-149f), lane_set1(-INFINITY), r);
+	return lane_select_lt(x, lane_set1(0), lane_set1(NAN), r);
+}
+
+/*
+ * Scalar parts of pow for the exponent p: p * LN2_HI split into hi,
+ * short enough that e * hi is exact for every exponent e, and lo.
+ */
+struct PowParams {
+	float p;
+	float hi;
+	float lo;
+	float zero;
+	float inf;
+	uint integer;
+	uint odd;
+};
+
+static inline struct PowParams KERNEL(pow_params)(float p){
+	double scaled = (double)p * LN2_HI;
+	union { float f; uint u; } hi = {.f = (float)scaled};
+	hi.u &= 0xffffff00;
+	struct PowParams params = {.p = p, .hi = hi.f, .lo = (float)(scaled - hi.f),
+		.zero = p > 0 ? 0 : INFINITY, .inf = p > 0 ? INFINITY : 0,
+		.integer = p == rintf(p)};
+	params.odd = params.integer && fmodf(p, 2) != 0;
+	return params;
+}
+
+/*
+ * exp(p * log|x|) with p * e * LN2_HI kept as the exact e * hi plus
+ * e * lo, so only the rounding of p * b is left to grow with p. Negative
+ * x give NaN unless p is an integer, odd ones keep the sign.
+ */
+static inline lane_f32 KERNEL(lane_pow)(lane_f32 x, const struct PowParams* params){
+	lane_f32 a = lane_abs(x);
+	lane_f32 e, b;
+	KERNEL(lane_log_reduced)(a, &e, &b);
+	lane_f32 h = lane_mul(e, lane_set1(params->hi));
+	lane_f32 l = lane_fmadd(e, lane_set1(params->lo), lane_mul(lane_set1(params->p), b));
+	lane_f32 t = lane_fmadd(a, lane_set1(0), lane_add(h, l));
+	lane_f32 clamped = lane_max(lane_set1(-104.0f), lane_min(lane_set1(89.0f), t));
+	lane_f32 n = lane_round(lane_mul(clamped, lane_set1(1.44269504089f)));
+	lane_f32 r = lane_add(lane_fmadd(n, lane_set1(-LN2_HI), h), l);
+	r = lane_fmadd(n, lane_set1(-LN2_LO), r);
+	r = KERNEL(lane_exp_reduced)(n, lane_max(lane_set1(-1), lane_min(lane_set1(1), r)));
+	r = lane_select_lt(lane_set1(89.0f), t, lane_set1(INFINITY), r);
+	r = lane_select_lt(t, lane_set1(-104.0f), lane_set1(0), r);
+	r = lane_select_lt(lane_set1(0x1.fffffep127f), a, lane_set1(params->inf), r);
+	r = lane_select_lt(a, lane_set1(0x1p-149f), lane_set1(params->zero), r);
+	if(!params->integer)
+		return lane_select_lt(x, lane_set1(0), lane_set1(NAN), r);
+	if(params->odd)
+		return lane_select_lt(x, lane_set1(0), lane_neg(r), r);
+	return r;
+}
+
+#undef LN2_HI
+#undef LN2_LO
+
+/*
+ * Odd polynomial below 0.625, 1 - 2 / (exp(2|x|) + 1) with the sign put
+ * back above.
+ */
+static inline lane_f32 KERNEL(lane_tanh)(lane_f32 x){
+	static const float coeffs[] = {-5.70498872745e-3f, 2.06390887954e-2f,
+		-5.37397155531e-2f, 1.33314422036e-1f, -3.33332819422e-1f};
+	const lane_f32 one = lane_set1(1);
+	lane_f32 a = lane_abs(x);
+	lane_f32 z = lane_mul(x, x);
+	lane_f32 small = lane_fmadd(lane_mul(KERNEL(lane_poly)(z, coeffs, 5), z), x, x);
+	lane_f32 big = lane_sub(one, lane_div(lane_set1(2),
+				lane_add(KERNEL(lane_exp)(lane_add(a, a)), one)));
+	big = lane_select_lt(x, lane_set1(0), lane_neg(big), big);
+	return lane_select_lt(a, lane_set1(0.625f), small, big);
+}
+
+/*
+ * 1 / (1 + exp(-x)) and exp(x) / (1 + exp(x)) below 0, both through
+ * exp(-|x|) which can't overflow.
+ */
+static inline lane_f32 KERNEL(lane_sigmoid)(lane_f32 x){
+	const lane_f32 one = lane_set1(1);
+	lane_f32 e = KERNEL(lane_exp)(lane_neg(lane_abs(x)));
+	return lane_div(lane_select_lt(x, lane_set1(0), e, one), lane_add(one, e));
+}
+
+/*
+ * x * P(x^2) below 1, 1 - exp(|x| * Q(|x|)) with the sign put back from
+ * there. |x| is capped at 3.92, past which erf rounds to 1.
+ */
+static inline lane_f32 KERNEL(lane_erf)(lane_f32 x){
+	static const float small_coeffs[] = {7.8541083673e-5f, -8.0102798542e-4f,
+		5.1883391884e-3f, -2.6853819187e-2f, 1.1283585363e-1f, -3.7612625849e-1f,
+		1.1283791657f};
+	static const float big_coeffs[] = {2.3930483104e-7f, -3.6696442102e-6f,
+		5.1121560294e-6f, 3.1566879517e-4f, -3.7912526807e-3f, 2.4256164035e-2f,
+		-1.0694294561e-1f, -6.3466339746e-1f, -1.1287814530f};
+	const lane_f32 one = lane_set1(1);
+	lane_f32 a = lane_min(lane_set1(3.92f), lane_abs(x));
+	lane_f32 small = lane_mul(x, KERNEL(lane_poly)(lane_mul(x, x), small_coeffs, 7));
+	lane_f32 big = lane_sub(one, KERNEL(lane_exp)(lane_mul(a,
+					KERNEL(lane_poly)(a, big_coeffs, 9))));
+	big = lane_select_lt(x, lane_set1(0), lane_neg(big), big);
+	return lane_select_lt(a, one, small, big);
+}
+
+/*
+ * Whole lanes straight from src, the remainder through a stack buffer.
+ * x names the loaded lanes in expr.
+ */
+#define MAP_RUN(expr) \
+	do{ \
+		ulong i = 0; \
+		for(; i + LANE_COUNT <= len; i += LANE_COUNT){ \
+			lane_f32 x = lane_load(&src[i]); \
+			lane_store(&dst[i], expr); \
+		} \
+		if(i < len){ \
+			float tail[LANE_COUNT] = {0}; \
+			for(ulong j = i; j < len; j++) \
+				tail[j - i] = src[j]; \
+			lane_f32 x = lane_load(tail); \
+			lane_store(tail, expr); \
+			for(ulong j = i; j < len; j++) \
+				dst[j] = tail[j - i]; \
+		} \
+	}while(0)
+
+/*
+ * dst[i] = fn(src[i]), dst may be src.
+ */
+static void KERNEL(map)(float* dst, const float* src, ulong len, enum MapFn fn,
+		float param1, float param2){
+	const lane_f32 p1 = lane_set1(param1);
+	const lane_f32 p2 = lane_set1(param2);
+	switch(fn){
+		case MAP_EXP:
+			MAP_RUN(KERNEL(lane_exp)(x));
+			break;
+		case MAP_LOG:
+			MAP_RUN(KERNEL(lane_log)(x));
+			break;
+		case MAP_TANH:
+			MAP_RUN(KERNEL(lane_tanh)(x));
+			break;
+		case MAP_SIGMOID:
+			MAP_RUN(KERNEL(lane_sigmoid)(x));
+			break;
+		case MAP_ERF:
+			MAP_RUN(KERNEL(lane_erf)(x));
+			break;
+		case MAP_SQRT:
+			MAP_RUN(lane_sqrt(x));
+			break;
+		case MAP_RSQRT:
+			MAP_RUN(lane_div(lane_set1(1), lane_sqrt(x)));
+			break;
+		case MAP_ABS:
+			MAP_RUN(lane_abs(x));
+			break;
+		case MAP_CLAMP:
+			MAP_RUN(lane_min(p2, lane_max(p1, x)));
+			break;
+		case MAP_POW:
+			if(param1 == 0)
+				MAP_RUN(((void)x, lane_set1(1)));
+			else if(param1 == 1)
+				MAP_RUN(x);
+			else if(param1 == -1)
+				MAP_RUN(lane_div(lane_set1(1), x));
+			else if(param1 == 2)
+				MAP_RUN(lane_mul(x, x));
+			else{
+				struct PowParams params = KERNEL(pow_params)(param1);
+				MAP_RUN(KERNEL(lane_pow)(x, &params));
+			}
+			break;
+	}
+}
+
+#undef MAP_RUN
+
+const struct KernelTable KERNEL(kernel_table) = {
+	.isa = KERNEL_STRING(KERNEL_ISA),
+	.gemm_nr = KERNEL_NR,
+	.transpose_nr = KERNEL_TILE,
+	.add = KERNEL(add),
+	.sub = KERNEL(sub),
+	.mul = KERNEL(mul),
+	.div = KERNEL(div),
+	.add_scalar = KERNEL(add_scalar),
+	.sub_scalar = KERNEL(sub_scalar),
+	.scalar_sub = KERNEL(scalar_sub),
+	.mul_scalar = KERNEL(mul_scalar),
+	.div_scalar = KERNEL(div_scalar),
+	.scalar_div = KERNEL(scalar_div),
+	.cmp = KERNEL(cmp),
+	.cmp_scalar = KERNEL(cmp_scalar),
+	.cmp_bits = KERNEL(cmp_bits),
+	.cmp_scalar_bits = KERNEL(cmp_scalar_bits),
+	.allclose = KERNEL(allclose),
+	.dot = KERNEL(dot),
+	.fold = KERNEL(fold),
+	.fold_into = KERNEL(fold_into),
+	.find = KERNEL(find),
+	.axpy = KERNEL(axpy),
+	.gemm_micro = KERNEL(gemm_micro),
+	.transpose4 = KERNEL(transpose4),
+	.transpose_tile = KERNEL(transpose_tile),
+	.mul4 = KERNEL(mul4),
+	.gemm_nr_f64 = KERNEL_NR_F64,
+	.add_f64 = KERNEL(add_f64),
+	.sub_f64 = KERNEL(sub_f64),
+	.mul_f64 = KERNEL(mul_f64),
+	.div_f64 = KERNEL(div_f64),
+	.add_scalar_f64 = KERNEL(add_scalar_f64),
+	.sub_scalar_f64 = KERNEL(sub_scalar_f64),
+	.scalar_sub_f64 = KERNEL(scalar_sub_f64),
+	.mul_scalar_f64 = KERNEL(mul_scalar_f64),
+	.div_scalar_f64 = KERNEL(div_scalar_f64),
+	.scalar_div_f64 = KERNEL(scalar_div_f64),
+	.cmp_f64 = KERNEL(cmp_f64),
+	.cmp_scalar_f64 = KERNEL(cmp_scalar_f64),
+	.cmp_bits_f64 = KERNEL(cmp_bits_f64),
+	.cmp_scalar_bits_f64 = KERNEL(cmp_scalar_bits_f64),
+	.allclose_f64 = KERNEL(allclose_f64),
+	.dot_f64 = KERNEL(dot_f64),
+	.fold_f64 = KERNEL(fold_f64),
+	.fold_into_f64 = KERNEL(fold_into_f64),
+	.find_f64 = KERNEL(find_f64),
+	.axpy_f64 = KERNEL(axpy_f64),
+	.gemm_micro_f64 = KERNEL(gemm_micro_f64),
+	.widen_f16 = KERNEL(widen_f16),
+	.narrow_f16 = KERNEL(narrow_f16),
+	.widen_bf16 = KERNEL(widen_bf16),
+	.narrow_bf16 = KERNEL(narrow_bf16),
+	.dot_i8 = KERNEL(dot_i8),
+	.gather_dot = KERNEL(gather_dot),
+	.batch_mul = KERNEL(batch_mul),
+	.batch_inverse = KERNEL(batch_inverse),
+	.map = KERNEL(map),
+};
@@ -0,0 +1,127 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+/*
+ * Blocked LU factorization and solve, included by src/core/lu.c once per
+ * element type. The includer defines REAL and REAL_NAME, which suffixes
+ * a name for that type and so also picks the matching kernels and gemm.
+ */
+
+static void REAL_NAME(swap_rows)(REAL* values, uint ld, uint row1, uint row2, uint len){
+	if(row1 == row2)
+		return;
+	REAL* src1 = &values[(ulong)row1 * ld];
+	REAL* src2 = &values[(ulong)row2 * ld];
+	for(uint j = 0; j < len; j++){
+		REAL temp = src1[j];
+		src1[j] = src2[j];
+		src2[j] = temp;
+	}
+}
+
+/*
+ * Copies -src (rows x cols, stride ld) into a packed buffer so gemm,
+ * which only accumulates, can subtract.
+ */
+static void REAL_NAME(negate_block)(REAL* dst, const REAL* src, uint ld,
+		uint rows, uint cols){
+	for(uint i = 0; i < rows; i++)
+		REAL_NAME(kernel_mul_scalar)(&dst[(ulong)i * cols], &src[(ulong)i * ld], -1, cols);
+}
+
+/*
+ * A pivot no larger than tolerance marks the matrix singular.
+ */
+static void REAL_NAME(factor_panel)(struct LU* lu, REAL* a, uint k, uint nb,
+		double tolerance){
+	const uint n = lu->size;
+	for(uint j = k; j < k + nb; j++){
+		uint pivot = j;
+		for(uint i = j + 1; i < n; i++)
+			if(fabs(a[(ulong)i * n + j]) > fabs(a[(ulong)pivot * n + j]))
+				pivot = i;
+		lu->pivots[j] = pivot;
+		REAL_NAME(swap_rows)(a, n, j, pivot, n);
+		REAL diagonal = a[(ulong)j * n + j];
+		if(!(fabs(diagonal) > tolerance)){
+			lu->singular = 1;
+			continue;
+		}
+		for(uint i = j + 1; i < n; i++){
+			REAL* row = &a[(ulong)i * n];
+			row[j] /= diagonal;
+			REAL_NAME(kernel_axpy)(&row[j + 1], -row[j], &a[(ulong)j * n + j + 1],
+					k + nb - j - 1);
+		}
+	}
+}
+
+/*
+ * Factors a, the packed n x n copy of the matrix, in place. work holds
+ * LU_BLOCK * n elements. Pivots are tested against NEAR_ZERO times the
+ * largest entry, so scaling a matrix doesn't change whether it is
+ * singular, as in the closed form small sizes take.
+ */
+static void REAL_NAME(lu_factor)(struct LU* lu, REAL* a, REAL* work){
+	const uint n = lu->size;
+	double scale = 0;
+	for(ulong k = 0; k < (ulong)n * n; k++)
+		scale = fmax(scale, fabs(a[k]));
+	const double tolerance = NEAR_ZERO * scale;
+	for(uint k = 0; k < n; k += LU_BLOCK){
+		uint nb = min_uint(LU_BLOCK, n - k);
+		uint rest = n - k - nb;
+		REAL_NAME(factor_panel)(lu, a, k, nb, tolerance);
+		if(!rest)
+			break;
+		for(uint i = k + 1; i < k + nb; i++)
+			for(uint p = k; p < i; p++)
+				REAL_NAME(kernel_axpy)(&a[(ulong)i * n + k + nb], -a[(ulong)i * n + p],
+						&a[(ulong)p * n + k + nb], rest);
+		REAL_NAME(negate_block)(work, &a[(ulong)(k + nb) * n + k], n, rest, nb);
+		REAL_NAME(gemm)(rest, rest, nb, work, nb, &a[(ulong)k * n + k + nb], n,
+				&a[(ulong)(k + nb) * n + k + nb], n);
+	}
+}
+
+/*
+ * Overwrites the n x m right-hand sides in x (stride ldx) with the
+ * solution. work holds LU_BLOCK * n elements.
+ */
+static void REAL_NAME(lu_substitute)(const struct LU* lu, const REAL* a,
+		REAL* x, uint ldx, uint m, REAL* work){
+	const uint n = lu->size;
+	for(uint i = 0; i < n; i++)
+		REAL_NAME(swap_rows)(x, ldx, i, lu->pivots[i], m);
+	for(uint k = 0; k < n; k += LU_BLOCK){
+		uint nb = min_uint(LU_BLOCK, n - k);
+		if(k){
+			REAL_NAME(negate_block)(work, &a[(ulong)k * n], n, nb, k);
+			REAL_NAME(gemm)(nb, m, k, work, k, x, ldx, &x[(ulong)k * ldx], ldx);
+		}
+		for(uint i = k + 1; i < k + nb; i++)
+			for(uint p = k; p < i; p++)
+				REAL_NAME(kernel_axpy)(&x[(ulong)i * ldx], -a[(ulong)i * n + p],
+						&x[(ulong)p * ldx], m);
+	}
+	for(uint end = n; end > 0;){
+		uint nb = (end - 1) % LU_BLOCK + 1;
+		uint k = end - nb;
+		if(end < n){
+			REAL_NAME(negate_block)(work, &a[(ulong)k * n + end], n, nb, n - end);
+			REAL_NAME(gemm)(nb, m, n - end, work, n - end, &x[(ulong)end * ldx], ldx,
+					&x[(ulong)k * ldx], ldx);
+		}
+		for(uint i = end; i-- > k;){
+			REAL* row = &x[(ulong)i * ldx];
+			for(uint p = i + 1; p < end; p++)
+				REAL_NAME(kernel_axpy)(row, -a[(ulong)i * n + p], &x[(ulong)p * ldx], m);
+			REAL_NAME(kernel_div_scalar)(row, row, a[(ulong)i * n + i], m);
+		}
+		end = k;
+	}
+}
@@ -13,5 +13,32 @@ extern const luaL_Reg matrix_methods[];
 extern const luaL_Reg matrix_functions[];
 extern const luaL_Reg vector_methods[];
 extern const luaL_Reg vector_functions[];
+extern const luaL_Reg expr_methods[];
+extern const luaL_Reg lu_methods[];
+extern const luaL_Reg view_methods[];
+extern const luaL_Reg qmatrix_methods[];
+extern const luaL_Reg sparse_methods[];
+extern const luaL_Reg batch_methods[];
+extern const luaL_Reg batch_functions[];
+extern const luaL_Reg mask_methods[];
+
+enum Dtype l_check_dtype(lua_State* lua, int index);
+void l_push_dtype(lua_State* lua, enum Dtype dtype);
+int l_check_map(lua_State* lua, int index, enum MapFn* fn, double* param1, double* param2);
+int l_push_mask(lua_State* lua, struct Mask* mask);
+int l_expr_lazy(lua_State* lua);
+int l_expr_arith(lua_State* lua, enum ExprOp op);
+int l_matrix_lu(lua_State* lua);
+int l_matrix_solve(lua_State* lua);
+int l_matrix_quantize(lua_State* lua);
+int l_matrix_sparse(lua_State* lua);
+int l_matrix_sparse_triplets(lua_State* lua);
+int l_view_push(lua_State* lua, int index, uint row, uint col,
+		uint rows, uint cols, uint vector);
+int l_view_arith(lua_State* lua, enum ExprOp op);
+int l_view_matmul(lua_State* lua);
+int l_view_transpose(lua_State* lua);
+int l_view_mul(lua_State* lua);
+int l_view_eq(lua_State* lua);
 
 #endif
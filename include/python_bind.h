@@ -5,19 +5,135 @@
 
 #include "crunum.h"
 
+/*
+ * source is set when the values are a view into another object's buffer,
+ * exports counts the buffers and views handed out by this object. Either
+ * one pins the values, so nothing may reallocate them.
+ */
 struct CrunumMatrix {
 	PyObject_HEAD
 	struct Matrix* matrix;
+	Py_buffer* source;
+	uint exports;
 };
 
 struct CrunumVector {
 	PyObject_HEAD
 	struct Vector* vector;
+	Py_buffer* source;
+	uint exports;
+};
+
+struct CrunumExpr {
+	PyObject_HEAD
+	struct Expr expr;
+	PyObject* left;
+	PyObject* right;
+};
+
+struct CrunumLU {
+	PyObject_HEAD
+	struct LU* lu;
+};
+
+struct CrunumQMatrix {
+	PyObject_HEAD
+	struct QMatrix* qmatrix;
+};
+
+struct CrunumSparse {
+	PyObject_HEAD
+	struct Sparse* sparse;
+};
+
+struct CrunumBatch {
+	PyObject_HEAD
+	struct Batch* batch;
+};
+
+struct CrunumMask {
+	PyObject_HEAD
+	struct Mask* mask;
+};
+
+/*
+ * vector is set on views of a single row or col, those read as vectors.
+ * Other views keep their 2D shape even when one side is 1.
+ */
+struct CrunumView {
+	PyObject_HEAD
+	struct View view;
+	struct CrunumMatrix* base;
+	uint vector;
 };
 
 extern PyTypeObject crn_matrix_type;
 extern PyModuleDef crn_matrix_def;
 extern PyTypeObject crn_vector_type;
 extern PyModuleDef crn_vector_def;
+extern PyTypeObject crn_expr_type;
+extern PyTypeObject crn_lu_type;
+extern PyTypeObject crn_view_type;
+extern PyTypeObject crn_qmatrix_type;
+extern PyTypeObject crn_sparse_type;
+extern PyTypeObject crn_batch_type;
+extern PyModuleDef crn_batch_def;
+extern PyTypeObject crn_mask_type;
+
+extern PyBufferProcs crn_matrix_as_buffer;
+extern PyBufferProcs crn_vector_as_buffer;
+
+PyObject* crn_expr_lazy(PyObject* self, PyObject* noargs);
+PyObject* crn_matrix_lu(PyObject* self, PyObject* args);
+PyObject* crn_matrix_solve(PyObject* self, PyObject* args);
+PyObject* crn_matrix_quantize(PyObject* self, PyObject* args, PyObject* kwargs);
+PyObject* crn_matrix_sparse(PyObject* self, PyObject* args, PyObject* kwargs);
+PyObject* crn_matrix_sparse_triplets(PyObject* self, PyObject* args, PyObject* kwargs);
+PyObject* crn_matrix_from_buffer(PyObject* self, PyObject* args, PyObject* kwargs);
+PyObject* crn_vector_from_buffer(PyObject* self, PyObject* args, PyObject* kwargs);
+void crn_buffer_free(Py_buffer* source);
+int crn_dtype_converter(PyObject* obj, void* dtype);
+PyObject* crn_dtype_name(enum Dtype dtype);
+PyObject* crn_mask_wrap(struct Mask* mask);
+int crn_map_parse(PyObject* args, PyObject* kwargs, enum MapFn* fn,
+		double* param1, double* param2, PyObject** out);
+PyObject* crn_view_new(struct CrunumMatrix* base, uint row, uint col,
+		uint rows, uint cols, uint vector);
+int crn_view_assign_to(struct View* view, PyObject* value);
+PyObject* crn_view_transpose(PyObject* obj);
+
+static inline struct CrunumMatrix* crn_matrix_alloc(void){
+	struct CrunumMatrix* crn_matrix = PyObject_New(struct CrunumMatrix, &crn_matrix_type);
+	if(crn_matrix){
+		crn_matrix->matrix = NULL;
+		crn_matrix->source = NULL;
+		crn_matrix->exports = 0;
+	}
+	return crn_matrix;
+}
+
+static inline struct CrunumVector* crn_vector_alloc(void){
+	struct CrunumVector* crn_vector = PyObject_New(struct CrunumVector, &crn_vector_type);
+	if(crn_vector){
+		crn_vector->vector = NULL;
+		crn_vector->source = NULL;
+		crn_vector->exports = 0;
+	}
+	return crn_vector;
+}
+
+static inline uint crn_matrix_pinned(struct CrunumMatrix* crn_matrix){
+	if(!crn_matrix->source && !crn_matrix->exports)
+		return 0;
+	PyErr_SetString(PyExc_BufferError, "Matrix memory is shared with a buffer or view");
+	return 1;
+}
+
+static inline uint crn_vector_pinned(struct CrunumVector* crn_vector){
+	if(!crn_vector->source && !crn_vector->exports)
+		return 0;
+	PyErr_SetString(PyExc_BufferError, "Vector memory is shared with a buffer");
+	return 1;
+}
 
 #endif
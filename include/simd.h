@@ -0,0 +1,900 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#ifndef CRUNUM_SIMD_H
+#define CRUNUM_SIMD_H
+
+/*
+ * simd_* layer used by the kernel template. The including translation
+ * unit picks one ISA with SIMD_ISA_* (and enables it with a target
+ * pragma), so every ISA can live in the same library and be chosen at
+ * runtime. Without any SIMD_ISA_* only the scalar path is compiled.
+ *
+ * The *_f64 set mirrors it for doubles with SIMD_LANES_F64 lanes. 32 bit
+ * NEON has no double vectors, so there only SIMD_LANES is defined and
+ * the double kernels take the scalar path.
+ */
+
+#include <math.h>
+
+#include "common.h"
+
+#if SIMD_ISA_NEON
+#define SIMD_LANES 4
+
+typedef float32x4_t simd_f32;
+
+static inline simd_f32 simd_load(const float* p){
+	return vld1q_f32(p);
+}
+
+static inline void simd_store(float* p, simd_f32 v){
+	vst1q_f32(p, v);
+}
+
+static inline simd_f32 simd_set1(float scalar){
+	return vdupq_n_f32(scalar);
+}
+
+static inline simd_f32 simd_add(simd_f32 v1, simd_f32 v2){
+	return vaddq_f32(v1, v2);
+}
+
+static inline simd_f32 simd_sub(simd_f32 v1, simd_f32 v2){
+	return vsubq_f32(v1, v2);
+}
+
+static inline simd_f32 simd_mul(simd_f32 v1, simd_f32 v2){
+	return vmulq_f32(v1, v2);
+}
+
+static inline simd_f32 simd_div(simd_f32 v1, simd_f32 v2){
+#if defined(__aarch64__)
+	return vdivq_f32(v1, v2);
+#else
+	float32x4_t recip = vrecpeq_f32(v2);
+	recip = vmulq_f32(vrecpsq_f32(v2, recip), recip);
+	recip = vmulq_f32(vrecpsq_f32(v2, recip), recip);
+	return vmulq_f32(v1, recip);
+#endif
+}
+
+static inline simd_f32 simd_fmadd(simd_f32 v1, simd_f32 v2, simd_f32 acc){
+#if defined(__aarch64__)
+	return vfmaq_f32(acc, v1, v2);
+#else
+	return vmlaq_f32(acc, v1, v2);
+#endif
+}
+
+static inline float simd_hadd(simd_f32 v){
+	return p_vaddvq_f32(v);
+}
+
+static inline simd_f32 simd_min(simd_f32 v1, simd_f32 v2){
+	return vminq_f32(v1, v2);
+}
+
+static inline simd_f32 simd_max(simd_f32 v1, simd_f32 v2){
+	return vmaxq_f32(v1, v2);
+}
+
+static inline simd_f32 simd_abs(simd_f32 v){
+	return vabsq_f32(v);
+}
+
+static inline float simd_hmin(simd_f32 v){
+	return p_vminvq_f32(v);
+}
+
+static inline float simd_hmax(simd_f32 v){
+	return p_vmaxvq_f32(v);
+}
+
+static inline simd_f32 simd_sqrt(simd_f32 v){
+#if defined(__aarch64__)
+	return vsqrtq_f32(v);
+#else
+	simd_f32 recip = vrsqrteq_f32(v);
+	recip = vmulq_f32(recip, vrsqrtsq_f32(vmulq_f32(v, recip), recip));
+	recip = vmulq_f32(recip, vrsqrtsq_f32(vmulq_f32(v, recip), recip));
+	uint32x4_t edge = vorrq_u32(vceqq_f32(v, vdupq_n_f32(0)),
+			vceqq_f32(v, vdupq_n_f32(INFINITY)));
+	return vbslq_f32(edge, v, vmulq_f32(v, recip));
+#endif
+}
+
+/*
+ * Nearest integer, ties to even. The 32 bit fallback is exact for
+ * |v| < 2^22, the only range the kernels round.
+ */
+static inline simd_f32 simd_round(simd_f32 v){
+#if defined(__aarch64__)
+	return vrndnq_f32(v);
+#else
+	simd_f32 magic = vdupq_n_f32(12582912.0f);
+	return vsubq_f32(vaddq_f32(v, magic), magic);
+#endif
+}
+
+/*
+ * a < b ? x : y per lane.
+ */
+static inline simd_f32 simd_select_lt(simd_f32 a, simd_f32 b, simd_f32 x, simd_f32 y){
+	return vbslq_f32(vcltq_f32(a, b), x, y);
+}
+
+/*
+ * 2^v for integral v in [-126, 127].
+ */
+static inline simd_f32 simd_pow2i(simd_f32 v){
+	int32x4_t bits = vaddq_s32(vcvtq_s32_f32(v), vdupq_n_s32(127));
+	return vreinterpretq_f32_s32(vshlq_n_s32(bits, 23));
+}
+
+/*
+ * Unbiased exponent and the mantissa scaled into [1, 2) of normal lanes,
+ * v = mantissa * 2^exponent for positive v.
+ */
+static inline simd_f32 simd_exponent(simd_f32 v){
+	uint32x4_t bits = vandq_u32(vshrq_n_u32(vreinterpretq_u32_f32(v), 23), vdupq_n_u32(0xff));
+	return vcvtq_f32_s32(vsubq_s32(vreinterpretq_s32_u32(bits), vdupq_n_s32(127)));
+}
+
+static inline simd_f32 simd_mantissa(simd_f32 v){
+	uint32x4_t bits = vandq_u32(vreinterpretq_u32_f32(v), vdupq_n_u32(0x007fffff));
+	return vreinterpretq_f32_u32(vorrq_u32(bits, vdupq_n_u32(0x3f800000)));
+}
+
+/*
+ * Lanes src[indices[0]], src[indices[1]], ...
+ */
+static inline simd_f32 simd_gather(const float* src, const uint* indices){
+	float lanes[4] = {src[indices[0]], src[indices[1]], src[indices[2]], src[indices[3]]};
+	return vld1q_f32(lanes);
+}
+
+static inline uint simd_cmp_mask(simd_f32 v1, simd_f32 v2, enum CmpOp op){
+	static const uint32_t bits[4] = {1, 2, 4, 8};
+	uint32x4_t mask;
+	switch(op){
+		case CMP_EQ:
+			mask = vceqq_f32(v1, v2);
+			break;
+		case CMP_NEQ:
+			mask = vmvnq_u32(vceqq_f32(v1, v2));
+			break;
+		case CMP_GT:
+			mask = vcgtq_f32(v1, v2);
+			break;
+		case CMP_GE:
+			mask = vcgeq_f32(v1, v2);
+			break;
+		case CMP_LT:
+			mask = vcltq_f32(v1, v2);
+			break;
+		default:
+			mask = vcleq_f32(v1, v2);
+			break;
+	}
+	uint32x4_t masked = vandq_u32(mask, vld1q_u32(bits));
+	uint32x2_t sum = vadd_u32(vget_low_u32(masked), vget_high_u32(masked));
+	return vget_lane_u32(vpadd_u32(sum, sum), 0);
+}
+
+#if defined(__aarch64__)
+#define SIMD_LANES_F64 2
+
+typedef float64x2_t simd_f64;
+
+static inline simd_f64 simd_load_f64(const double* p){
+	return vld1q_f64(p);
+}
+
+static inline void simd_store_f64(double* p, simd_f64 v){
+	vst1q_f64(p, v);
+}
+
+static inline simd_f64 simd_set1_f64(double scalar){
+	return vdupq_n_f64(scalar);
+}
+
+static inline simd_f64 simd_add_f64(simd_f64 v1, simd_f64 v2){
+	return vaddq_f64(v1, v2);
+}
+
+static inline simd_f64 simd_sub_f64(simd_f64 v1, simd_f64 v2){
+	return vsubq_f64(v1, v2);
+}
+
+static inline simd_f64 simd_mul_f64(simd_f64 v1, simd_f64 v2){
+	return vmulq_f64(v1, v2);
+}
+
+static inline simd_f64 simd_div_f64(simd_f64 v1, simd_f64 v2){
+	return vdivq_f64(v1, v2);
+}
+
+static inline simd_f64 simd_fmadd_f64(simd_f64 v1, simd_f64 v2, simd_f64 acc){
+	return vfmaq_f64(acc, v1, v2);
+}
+
+static inline double simd_hadd_f64(simd_f64 v){
+	return vaddvq_f64(v);
+}
+
+static inline simd_f64 simd_min_f64(simd_f64 v1, simd_f64 v2){
+	return vminq_f64(v1, v2);
+}
+
+static inline simd_f64 simd_max_f64(simd_f64 v1, simd_f64 v2){
+	return vmaxq_f64(v1, v2);
+}
+
+static inline simd_f64 simd_abs_f64(simd_f64 v){
+	return vabsq_f64(v);
+}
+
+static inline double simd_hmin_f64(simd_f64 v){
+	return vminvq_f64(v);
+}
+
+static inline double simd_hmax_f64(simd_f64 v){
+	return vmaxvq_f64(v);
+}
+
+static inline uint simd_cmp_mask_f64(simd_f64 v1, simd_f64 v2, enum CmpOp op){
+	static const uint64_t bits[2] = {1, 2};
+	uint64x2_t mask;
+	switch(op){
+		case CMP_EQ:
+			mask = vceqq_f64(v1, v2);
+			break;
+		case CMP_NEQ:
+			mask = veorq_u64(vceqq_f64(v1, v2), vdupq_n_u64(~(uint64_t)0));
+			break;
+		case CMP_GT:
+			mask = vcgtq_f64(v1, v2);
+			break;
+		case CMP_GE:
+			mask = vcgeq_f64(v1, v2);
+			break;
+		case CMP_LT:
+			mask = vcltq_f64(v1, v2);
+			break;
+		default:
+			mask = vcleq_f64(v1, v2);
+			break;
+	}
+	return (uint)vaddvq_u64(vandq_u64(mask, vld1q_u64(bits)));
+}
+#endif
+
+#elif SIMD_ISA_SSE || SIMD_ISA_AVX2 || SIMD_ISA_AVX512
+
+static inline double p_hadd_pd(__m128d v){
+	return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+static inline double p_hmin_pd(__m128d v){
+	return _mm_cvtsd_f64(_mm_min_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+static inline double p_hmax_pd(__m128d v){
+	return _mm_cvtsd_f64(_mm_max_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+#if SIMD_ISA_AVX2 || SIMD_ISA_AVX512
+static inline float p_hadd256_ps(__m256 v){
+	return p_hadd_ps(_mm_add_ps(_mm256_castps256_ps128(v),
+				_mm256_extractf128_ps(v, 1)));
+}
+
+static inline double p_hadd256_pd(__m256d v){
+	return p_hadd_pd(_mm_add_pd(_mm256_castpd256_pd128(v),
+				_mm256_extractf128_pd(v, 1)));
+}
+
+static inline float p_hmin256_ps(__m256 v){
+	return p_hmin_ps(_mm_min_ps(_mm256_castps256_ps128(v),
+				_mm256_extractf128_ps(v, 1)));
+}
+
+static inline float p_hmax256_ps(__m256 v){
+	return p_hmax_ps(_mm_max_ps(_mm256_castps256_ps128(v),
+				_mm256_extractf128_ps(v, 1)));
+}
+
+static inline double p_hmin256_pd(__m256d v){
+	return p_hmin_pd(_mm_min_pd(_mm256_castpd256_pd128(v),
+				_mm256_extractf128_pd(v, 1)));
+}
+
+static inline double p_hmax256_pd(__m256d v){
+	return p_hmax_pd(_mm_max_pd(_mm256_castpd256_pd128(v),
+				_mm256_extractf128_pd(v, 1)));
+}
+#endif
+
+#if SIMD_ISA_AVX512
+static inline float p_hadd512_ps(__m512 v){
+	return _mm512_reduce_add_ps(v);
+}
+#endif
+
+#if SIMD_ISA_AVX512
+#define SIMD_LANES 16
+
+typedef __m512 simd_f32;
+
+static inline simd_f32 simd_load(const float* p){
+	return _mm512_loadu_ps(p);
+}
+
+static inline void simd_store(float* p, simd_f32 v){
+	_mm512_storeu_ps(p, v);
+}
+
+static inline simd_f32 simd_set1(float scalar){
+	return _mm512_set1_ps(scalar);
+}
+
+static inline simd_f32 simd_add(simd_f32 v1, simd_f32 v2){
+	return _mm512_add_ps(v1, v2);
+}
+
+static inline simd_f32 simd_sub(simd_f32 v1, simd_f32 v2){
+	return _mm512_sub_ps(v1, v2);
+}
+
+static inline simd_f32 simd_mul(simd_f32 v1, simd_f32 v2){
+	return _mm512_mul_ps(v1, v2);
+}
+
+static inline simd_f32 simd_div(simd_f32 v1, simd_f32 v2){
+	return _mm512_div_ps(v1, v2);
+}
+
+static inline simd_f32 simd_fmadd(simd_f32 v1, simd_f32 v2, simd_f32 acc){
+	return _mm512_fmadd_ps(v1, v2, acc);
+}
+
+static inline float simd_hadd(simd_f32 v){
+	return p_hadd512_ps(v);
+}
+
+static inline simd_f32 simd_min(simd_f32 v1, simd_f32 v2){
+	return _mm512_min_ps(v1, v2);
+}
+
+static inline simd_f32 simd_max(simd_f32 v1, simd_f32 v2){
+	return _mm512_max_ps(v1, v2);
+}
+
+static inline simd_f32 simd_abs(simd_f32 v){
+	return _mm512_abs_ps(v);
+}
+
+static inline float simd_hmin(simd_f32 v){
+	return _mm512_reduce_min_ps(v);
+}
+
+static inline float simd_hmax(simd_f32 v){
+	return _mm512_reduce_max_ps(v);
+}
+
+static inline simd_f32 simd_sqrt(simd_f32 v){
+	return _mm512_sqrt_ps(v);
+}
+
+static inline simd_f32 simd_round(simd_f32 v){
+	return _mm512_roundscale_ps(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+}
+
+static inline simd_f32 simd_select_lt(simd_f32 a, simd_f32 b, simd_f32 x, simd_f32 y){
+	return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(a, b, _CMP_LT_OQ), y, x);
+}
+
+static inline simd_f32 simd_pow2i(simd_f32 v){
+	__m512i bits = _mm512_add_epi32(_mm512_cvttps_epi32(v), _mm512_set1_epi32(127));
+	return _mm512_castsi512_ps(_mm512_slli_epi32(bits, 23));
+}
+
+static inline simd_f32 simd_exponent(simd_f32 v){
+	__m512i bits = _mm512_srli_epi32(_mm512_castps_si512(v), 23);
+	bits = _mm512_and_si512(bits, _mm512_set1_epi32(0xff));
+	return _mm512_cvtepi32_ps(_mm512_sub_epi32(bits, _mm512_set1_epi32(127)));
+}
+
+static inline simd_f32 simd_mantissa(simd_f32 v){
+	__m512i bits = _mm512_and_si512(_mm512_castps_si512(v), _mm512_set1_epi32(0x007fffff));
+	return _mm512_castsi512_ps(_mm512_or_si512(bits, _mm512_set1_epi32(0x3f800000)));
+}
+
+static inline simd_f32 simd_gather(const float* src, const uint* indices){
+	return _mm512_i32gather_ps(_mm512_loadu_si512(indices), src, sizeof(float));
+}
+
+static inline uint simd_cmp_mask(simd_f32 v1, simd_f32 v2, enum CmpOp op){
+	switch(op){
+		case CMP_EQ:
+			return _mm512_cmp_ps_mask(v1, v2, _CMP_EQ_OQ);
+		case CMP_NEQ:
+			return _mm512_cmp_ps_mask(v1, v2, _CMP_NEQ_UQ);
+		case CMP_GT:
+			return _mm512_cmp_ps_mask(v1, v2, _CMP_GT_OQ);
+		case CMP_GE:
+			return _mm512_cmp_ps_mask(v1, v2, _CMP_GE_OQ);
+		case CMP_LT:
+			return _mm512_cmp_ps_mask(v1, v2, _CMP_LT_OQ);
+		default:
+			return _mm512_cmp_ps_mask(v1, v2, _CMP_LE_OQ);
+	}
+}
+
+#define SIMD_LANES_F64 8
+
+typedef __m512d simd_f64;
+
+static inline simd_f64 simd_load_f64(const double* p){
+	return _mm512_loadu_pd(p);
+}
+
+static inline void simd_store_f64(double* p, simd_f64 v){
+	_mm512_storeu_pd(p, v);
+}
+
+static inline simd_f64 simd_set1_f64(double scalar){
+	return _mm512_set1_pd(scalar);
+}
+
+static inline simd_f64 simd_add_f64(simd_f64 v1, simd_f64 v2){
+	return _mm512_add_pd(v1, v2);
+}
+
+static inline simd_f64 simd_sub_f64(simd_f64 v1, simd_f64 v2){
+	return _mm512_sub_pd(v1, v2);
+}
+
+static inline simd_f64 simd_mul_f64(simd_f64 v1, simd_f64 v2){
+	return _mm512_mul_pd(v1, v2);
+}
+
+static inline simd_f64 simd_div_f64(simd_f64 v1, simd_f64 v2){
+	return _mm512_div_pd(v1, v2);
+}
+
+static inline simd_f64 simd_fmadd_f64(simd_f64 v1, simd_f64 v2, simd_f64 acc){
+	return _mm512_fmadd_pd(v1, v2, acc);
+}
+
+static inline double simd_hadd_f64(simd_f64 v){
+	return _mm512_reduce_add_pd(v);
+}
+
+static inline simd_f64 simd_min_f64(simd_f64 v1, simd_f64 v2){
+	return _mm512_min_pd(v1, v2);
+}
+
+static inline simd_f64 simd_max_f64(simd_f64 v1, simd_f64 v2){
+	return _mm512_max_pd(v1, v2);
+}
+
+static inline simd_f64 simd_abs_f64(simd_f64 v){
+	return _mm512_abs_pd(v);
+}
+
+static inline double simd_hmin_f64(simd_f64 v){
+	return _mm512_reduce_min_pd(v);
+}
+
+static inline double simd_hmax_f64(simd_f64 v){
+	return _mm512_reduce_max_pd(v);
+}
+
+static inline uint simd_cmp_mask_f64(simd_f64 v1, simd_f64 v2, enum CmpOp op){
+	switch(op){
+		case CMP_EQ:
+			return _mm512_cmp_pd_mask(v1, v2, _CMP_EQ_OQ);
+		case CMP_NEQ:
+			return _mm512_cmp_pd_mask(v1, v2, _CMP_NEQ_UQ);
+		case CMP_GT:
+			return _mm512_cmp_pd_mask(v1, v2, _CMP_GT_OQ);
+		case CMP_GE:
+			return _mm512_cmp_pd_mask(v1, v2, _CMP_GE_OQ);
+		case CMP_LT:
+			return _mm512_cmp_pd_mask(v1, v2, _CMP_LT_OQ);
+		default:
+			return _mm512_cmp_pd_mask(v1, v2, _CMP_LE_OQ);
+	}
+}
+
+#elif SIMD_ISA_AVX2
+#define SIMD_LANES 8
+
+typedef __m256 simd_f32;
+
+static inline simd_f32 simd_load(const float* p){
+	return _mm256_loadu_ps(p);
+}
+
+static inline void simd_store(float* p, simd_f32 v){
+	_mm256_storeu_ps(p, v);
+}
+
+static inline simd_f32 simd_set1(float scalar){
+	return _mm256_set1_ps(scalar);
+}
+
+static inline simd_f32 simd_add(simd_f32 v1, simd_f32 v2){
+	return _mm256_add_ps(v1, v2);
+}
+
+static inline simd_f32 simd_sub(simd_f32 v1, simd_f32 v2){
+	return _mm256_sub_ps(v1, v2);
+}
+
+static inline simd_f32 simd_mul(simd_f32 v1, simd_f32 v2){
+	return _mm256_mul_ps(v1, v2);
+}
+
+static inline simd_f32 simd_div(simd_f32 v1, simd_f32 v2){
+	return _mm256_div_ps(v1, v2);
+}
+
+static inline simd_f32 simd_fmadd(simd_f32 v1, simd_f32 v2, simd_f32 acc){
+	return _mm256_fmadd_ps(v1, v2, acc);
+}
+
+static inline float simd_hadd(simd_f32 v){
+	return p_hadd256_ps(v);
+}
+
+static inline simd_f32 simd_min(simd_f32 v1, simd_f32 v2){
+	return _mm256_min_ps(v1, v2);
+}
+
+static inline simd_f32 simd_max(simd_f32 v1, simd_f32 v2){
+	return _mm256_max_ps(v1, v2);
+}
+
+static inline simd_f32 simd_abs(simd_f32 v){
+	return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v);
+}
+
+static inline float simd_hmin(simd_f32 v){
+	return p_hmin256_ps(v);
+}
+
+static inline float simd_hmax(simd_f32 v){
+	return p_hmax256_ps(v);
+}
+
+static inline simd_f32 simd_sqrt(simd_f32 v){
+	return _mm256_sqrt_ps(v);
+}
+
+static inline simd_f32 simd_round(simd_f32 v){
+	return _mm256_round_ps(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+}
+
+static inline simd_f32 simd_select_lt(simd_f32 a, simd_f32 b, simd_f32 x, simd_f32 y){
+	return _mm256_blendv_ps(y, x, _mm256_cmp_ps(a, b, _CMP_LT_OQ));
+}
+
+static inline simd_f32 simd_pow2i(simd_f32 v){
+	__m256i bits = _mm256_add_epi32(_mm256_cvttps_epi32(v), _mm256_set1_epi32(127));
+	return _mm256_castsi256_ps(_mm256_slli_epi32(bits, 23));
+}
+
+static inline simd_f32 simd_exponent(simd_f32 v){
+	__m256i bits = _mm256_srli_epi32(_mm256_castps_si256(v), 23);
+	bits = _mm256_and_si256(bits, _mm256_set1_epi32(0xff));
+	return _mm256_cvtepi32_ps(_mm256_sub_epi32(bits, _mm256_set1_epi32(127)));
+}
+
+static inline simd_f32 simd_mantissa(simd_f32 v){
+	__m256i bits = _mm256_and_si256(_mm256_castps_si256(v), _mm256_set1_epi32(0x007fffff));
+	return _mm256_castsi256_ps(_mm256_or_si256(bits, _mm256_set1_epi32(0x3f800000)));
+}
+
+static inline simd_f32 simd_gather(const float* src, const uint* indices){
+	return _mm256_i32gather_ps(src, _mm256_loadu_si256((const __m256i*)indices), sizeof(float));
+}
+
+static inline uint simd_cmp_mask(simd_f32 v1, simd_f32 v2, enum CmpOp op){
+	switch(op){
+		case CMP_EQ:
+			return _mm256_movemask_ps(_mm256_cmp_ps(v1, v2, _CMP_EQ_OQ));
+		case CMP_NEQ:
+			return _mm256_movemask_ps(_mm256_cmp_ps(v1, v2, _CMP_NEQ_UQ));
+		case CMP_GT:
+			return _mm256_movemask_ps(_mm256_cmp_ps(v1, v2, _CMP_GT_OQ));
+		case CMP_GE:
+			return _mm256_movemask_ps(_mm256_cmp_ps(v1, v2, _CMP_GE_OQ));
+		case CMP_LT:
+			return _mm256_movemask_ps(_mm256_cmp_ps(v1, v2, _CMP_LT_OQ));
+		default:
+			return _mm256_movemask_ps(_mm256_cmp_ps(v1, v2, _CMP_LE_OQ));
+	}
+}
+
+#define SIMD_LANES_F64 4
+
+typedef __m256d simd_f64;
+
+static inline simd_f64 simd_load_f64(const double* p){
+	return _mm256_loadu_pd(p);
+}
+
+static inline void simd_store_f64(double* p, simd_f64 v){
+	_mm256_storeu_pd(p, v);
+}
+
+static inline simd_f64 simd_set1_f64(double scalar){
+	return _mm256_set1_pd(scalar);
+}
+
+static inline simd_f64 simd_add_f64(simd_f64 v1, simd_f64 v2){
+	return _mm256_add_pd(v1, v2);
+}
+
+static inline simd_f64 simd_sub_f64(simd_f64 v1, simd_f64 v2){
+	return _mm256_sub_pd(v1, v2);
+}
+
+static inline simd_f64 simd_mul_f64(simd_f64 v1, simd_f64 v2){
+	return _mm256_mul_pd(v1, v2);
+}
+
+static inline simd_f64 simd_div_f64(simd_f64 v1, simd_f64 v2){
+	return _mm256_div_pd(v1, v2);
+}
+
+static inline simd_f64 simd_fmadd_f64(simd_f64 v1, simd_f64 v2, simd_f64 acc){
+	return _mm256_fmadd_pd(v1, v2, acc);
+}
+
+static inline double simd_hadd_f64(simd_f64 v){
+	return p_hadd256_pd(v);
+}
+
+static inline simd_f64 simd_min_f64(simd_f64 v1, simd_f64 v2){
+	return _mm256_min_pd(v1, v2);
+}
+
+static inline simd_f64 simd_max_f64(simd_f64 v1, simd_f64 v2){
+	return _mm256_max_pd(v1, v2);
+}
+
+static inline simd_f64 simd_abs_f64(simd_f64 v){
+	return _mm256_andnot_pd(_mm256_set1_pd(-0.0), v);
+}
+
+static inline double simd_hmin_f64(simd_f64 v){
+	return p_hmin256_pd(v);
+}
+
+static inline double simd_hmax_f64(simd_f64 v){
+	return p_hmax256_pd(v);
+}
+
+static inline uint simd_cmp_mask_f64(simd_f64 v1, simd_f64 v2, enum CmpOp op){
+	switch(op){
+		case CMP_EQ:
+			return _mm256_movemask_pd(_mm256_cmp_pd(v1, v2, _CMP_EQ_OQ));
+		case CMP_NEQ:
+			return _mm256_movemask_pd(_mm256_cmp_pd(v1, v2, _CMP_NEQ_UQ));
+		case CMP_GT:
+			return _mm256_movemask_pd(_mm256_cmp_pd(v1, v2, _CMP_GT_OQ));
+		case CMP_GE:
+			return _mm256_movemask_pd(_mm256_cmp_pd(v1, v2, _CMP_GE_OQ));
+		case CMP_LT:
+			return _mm256_movemask_pd(_mm256_cmp_pd(v1, v2, _CMP_LT_OQ));
+		default:
+			return _mm256_movemask_pd(_mm256_cmp_pd(v1, v2, _CMP_LE_OQ));
+	}
+}
+
+#elif SIMD_ISA_SSE
+#define SIMD_LANES 4
+
+typedef __m128 simd_f32;
+
+static inline simd_f32 simd_load(const float* p){
+	return _mm_loadu_ps(p);
+}
+
+static inline void simd_store(float* p, simd_f32 v){
+	_mm_storeu_ps(p, v);
+}
+
+static inline simd_f32 simd_set1(float scalar){
+	return _mm_set1_ps(scalar);
+}
+
+static inline simd_f32 simd_add(simd_f32 v1, simd_f32 v2){
+	return _mm_add_ps(v1, v2);
+}
+
+static inline simd_f32 simd_sub(simd_f32 v1, simd_f32 v2){
+	return _mm_sub_ps(v1, v2);
+}
+
+static inline simd_f32 simd_mul(simd_f32 v1, simd_f32 v2){
+	return _mm_mul_ps(v1, v2);
+}
+
+static inline simd_f32 simd_div(simd_f32 v1, simd_f32 v2){
+	return _mm_div_ps(v1, v2);
+}
+
+static inline simd_f32 simd_fmadd(simd_f32 v1, simd_f32 v2, simd_f32 acc){
+	return _mm_add_ps(_mm_mul_ps(v1, v2), acc);
+}
+
+static inline float simd_hadd(simd_f32 v){
+	return p_hadd_ps(v);
+}
+
+static inline simd_f32 simd_min(simd_f32 v1, simd_f32 v2){
+	return _mm_min_ps(v1, v2);
+}
+
+static inline simd_f32 simd_max(simd_f32 v1, simd_f32 v2){
+	return _mm_max_ps(v1, v2);
+}
+
+static inline simd_f32 simd_abs(simd_f32 v){
+	return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+static inline float simd_hmin(simd_f32 v){
+	return p_hmin_ps(v);
+}
+
+static inline float simd_hmax(simd_f32 v){
+	return p_hmax_ps(v);
+}
+
+static inline simd_f32 simd_sqrt(simd_f32 v){
+	return _mm_sqrt_ps(v);
+}
+
+/*
+ * SSE2 has no rounding instruction, adding and removing 1.5 * 2^23 is
+ * exact for |v| < 2^22, the only range the kernels round.
+ */
+static inline simd_f32 simd_round(simd_f32 v){
+	__m128 magic = _mm_set1_ps(12582912.0f);
+	return _mm_sub_ps(_mm_add_ps(v, magic), magic);
+}
+
+static inline simd_f32 simd_select_lt(simd_f32 a, simd_f32 b, simd_f32 x, simd_f32 y){
+	__m128 mask = _mm_cmplt_ps(a, b);
+	return _mm_or_ps(_mm_and_ps(mask, x), _mm_andnot_ps(mask, y));
+}
+
+static inline simd_f32 simd_pow2i(simd_f32 v){
+	__m128i bits = _mm_add_epi32(_mm_cvttps_epi32(v), _mm_set1_epi32(127));
+	return _mm_castsi128_ps(_mm_slli_epi32(bits, 23));
+}
+
+static inline simd_f32 simd_exponent(simd_f32 v){
+	__m128i bits = _mm_srli_epi32(_mm_castps_si128(v), 23);
+	bits = _mm_and_si128(bits, _mm_set1_epi32(0xff));
+	return _mm_cvtepi32_ps(_mm_sub_epi32(bits, _mm_set1_epi32(127)));
+}
+
+static inline simd_f32 simd_mantissa(simd_f32 v){
+	__m128i bits = _mm_and_si128(_mm_castps_si128(v), _mm_set1_epi32(0x007fffff));
+	return _mm_castsi128_ps(_mm_or_si128(bits, _mm_set1_epi32(0x3f800000)));
+}
+
+static inline simd_f32 simd_gather(const float* src, const uint* indices){
+	return _mm_set_ps(src[indices[3]], src[indices[2]], src[indices[1]], src[indices[0]]);
+}
+
+static inline uint simd_cmp_mask(simd_f32 v1, simd_f32 v2, enum CmpOp op){
+	switch(op){
+		case CMP_EQ:
+			return _mm_movemask_ps(_mm_cmpeq_ps(v1, v2));
+		case CMP_NEQ:
+			return _mm_movemask_ps(_mm_cmpneq_ps(v1, v2));
+		case CMP_GT:
+			return _mm_movemask_ps(_mm_cmpgt_ps(v1, v2));
+		case CMP_GE:
+			return _mm_movemask_ps(_mm_cmpge_ps(v1, v2));
+		case CMP_LT:
+			return _mm_movemask_ps(_mm_cmplt_ps(v1, v2));
+		default:
+			return _mm_movemask_ps(_mm_cmple_ps(v1, v2));
+	}
+}
+
+#define SIMD_LANES_F64 2
+
+typedef __m128d simd_f64;
+
+static inline simd_f64 simd_load_f64(const double* p){
+	return _mm_loadu_pd(p);
+}
+
+static inline void simd_store_f64(double* p, simd_f64 v){
+	_mm_storeu_pd(p, v);
+}
+
+static inline simd_f64 simd_set1_f64(double scalar){
+	return _mm_set1_pd(scalar);
+}
+
+static inline simd_f64 simd_add_f64(simd_f64 v1, simd_f64 v2){
+	return _mm_add_pd(v1, v2);
+}
+
+static inline simd_f64 simd_sub_f64(simd_f64 v1, simd_f64 v2){
+	return _mm_sub_pd(v1, v2);
+}
+
+static inline simd_f64 simd_mul_f64(simd_f64 v1, simd_f64 v2){
+	return _mm_mul_pd(v1, v2);
+}
+
+static inline simd_f64 simd_div_f64(simd_f64 v1, simd_f64 v2){
+	return _mm_div_pd(v1, v2);
+}
+
+static inline simd_f64 simd_fmadd_f64(simd_f64 v1, simd_f64 v2, simd_f64 acc){
+	return _mm_add_pd(_mm_mul_pd(v1, v2), acc);
+}
+
+static inline double simd_hadd_f64(simd_f64 v){
+	return p_hadd_pd(v);
+}
+
+static inline simd_f64 simd_min_f64(simd_f64 v1, simd_f64 v2){
+	return _mm_min_pd(v1, v2);
+}
+
+static inline simd_f64 simd_max_f64(simd_f64 v1, simd_f64 v2){
+	return _mm_max_pd(v1, v2);
+}
+
+static inline simd_f64 simd_abs_f64(simd_f64 v){
+	return _mm_andnot_pd(_mm_set1_pd(-0.0), v);
+}
+
+static inline double simd_hmin_f64(simd_f64 v){
+	return p_hmin_pd(v);
+}
+
+static inline double simd_hmax_f64(simd_f64 v){
+	return p_hmax_pd(v);
+}
+
+static inline uint simd_cmp_mask_f64(simd_f64 v1, simd_f64 v2, enum CmpOp op){
+	switch(op){
+		case CMP_EQ:
+			return _mm_movemask_pd(_mm_cmpeq_pd(v1, v2));
+		case CMP_NEQ:
+			return _mm_movemask_pd(_mm_cmpneq_pd(v1, v2));
+		case CMP_GT:
+			return _mm_movemask_pd(_mm_cmpgt_pd(v1, v2));
+		case CMP_GE:
+			return _mm_movemask_pd(_mm_cmpge_pd(v1, v2));
+		case CMP_LT:
+			return _mm_movemask_pd(_mm_cmplt_pd(v1, v2));
+		default:
+			return _mm_movemask_pd(_mm_cmple_pd(v1, v2));
+	}
+}
+
+#endif
+
+#endif
+
+#endif
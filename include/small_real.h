@@ -0,0 +1,196 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+/*
+ * Fully unrolled product, and closed-form determinant and inverse, of
+ * 1x1 to 4x4 matrices, row major in a[n * n]. The includer defines
+ * REAL, REAL_NAME and the REAL_ADD, REAL_SUB, REAL_MUL, REAL_NEG and
+ * REAL_RECIP operations, so REAL can be a scalar or a SIMD vector holding
+ * one matrix per lane. Each inverse writes the adjugate scaled by 1 / det
+ * into c, which may alias a, and returns det; a zero det leaves c
+ * non-finite and is for the caller to report.
+ */
+
+/*
+ * c = a * b, c apart from a and b. n is a constant at every call, so
+ * the loops unroll completely.
+ */
+static inline void REAL_NAME(small_mul)(const REAL* a, const REAL* b, REAL* c, const uint n){
+	for(uint i = 0; i < n; i++)
+		for(uint j = 0; j < n; j++){
+			REAL acc = REAL_MUL(a[i * n], b[j]);
+			for(uint p = 1; p < n; p++)
+				acc = REAL_ADD(acc, REAL_MUL(a[i * n + p], b[p * n + j]));
+			c[i * n + j] = acc;
+		}
+}
+
+static inline REAL REAL_NAME(small_det2)(const REAL* a){
+	return REAL_SUB(REAL_MUL(a[0], a[3]), REAL_MUL(a[1], a[2]));
+}
+
+static inline REAL REAL_NAME(small_det3)(const REAL* a){
+	REAL c0 = REAL_SUB(REAL_MUL(a[4], a[8]), REAL_MUL(a[5], a[7]));
+	REAL c1 = REAL_SUB(REAL_MUL(a[5], a[6]), REAL_MUL(a[3], a[8]));
+	REAL c2 = REAL_SUB(REAL_MUL(a[3], a[7]), REAL_MUL(a[4], a[6]));
+	return REAL_ADD(REAL_ADD(REAL_MUL(a[0], c0), REAL_MUL(a[1], c1)), REAL_MUL(a[2], c2));
+}
+
+/*
+ * 4x4 through the 2x2 minors of the top two rows (s) and the bottom two
+ * rows (t), shared between the determinant and the adjugate.
+ */
+#define SMALL_MINORS4(a) \
+	REAL s0 = REAL_SUB(REAL_MUL(a[0], a[5]), REAL_MUL(a[4], a[1])); \
+	REAL s1 = REAL_SUB(REAL_MUL(a[0], a[6]), REAL_MUL(a[4], a[2])); \
+	REAL s2 = REAL_SUB(REAL_MUL(a[0], a[7]), REAL_MUL(a[4], a[3])); \
+	REAL s3 = REAL_SUB(REAL_MUL(a[1], a[6]), REAL_MUL(a[5], a[2])); \
+	REAL s4 = REAL_SUB(REAL_MUL(a[1], a[7]), REAL_MUL(a[5], a[3])); \
+	REAL s5 = REAL_SUB(REAL_MUL(a[2], a[7]), REAL_MUL(a[6], a[3])); \
+	REAL t0 = REAL_SUB(REAL_MUL(a[8], a[13]), REAL_MUL(a[12], a[9])); \
+	REAL t1 = REAL_SUB(REAL_MUL(a[8], a[14]), REAL_MUL(a[12], a[10])); \
+	REAL t2 = REAL_SUB(REAL_MUL(a[8], a[15]), REAL_MUL(a[12], a[11])); \
+	REAL t3 = REAL_SUB(REAL_MUL(a[9], a[14]), REAL_MUL(a[13], a[10])); \
+	REAL t4 = REAL_SUB(REAL_MUL(a[9], a[15]), REAL_MUL(a[13], a[11])); \
+	REAL t5 = REAL_SUB(REAL_MUL(a[10], a[15]), REAL_MUL(a[14], a[11])); \
+	REAL det = REAL_ADD(REAL_ADD(REAL_SUB(REAL_MUL(s0, t5), REAL_MUL(s1, t4)), \
+				REAL_ADD(REAL_MUL(s2, t3), REAL_MUL(s3, t2))), \
+			REAL_SUB(REAL_MUL(s5, t0), REAL_MUL(s4, t1)))
+
+static inline REAL REAL_NAME(small_det4)(const REAL* a){
+	SMALL_MINORS4(a);
+	return det;
+}
+
+/*
+ * x1 * y1 - x2 * y2 + x3 * y3 and x1 * y1 - x2 * y2 - x3 * y3, the two
+ * sign patterns of a 4x4 adjugate entry.
+ */
+static inline REAL REAL_NAME(small_pmp)(REAL x1, REAL y1, REAL x2, REAL y2, REAL x3, REAL y3){
+	return REAL_ADD(REAL_SUB(REAL_MUL(x1, y1), REAL_MUL(x2, y2)), REAL_MUL(x3, y3));
+}
+
+static inline REAL REAL_NAME(small_pmm)(REAL x1, REAL y1, REAL x2, REAL y2, REAL x3, REAL y3){
+	return REAL_SUB(REAL_SUB(REAL_MUL(x1, y1), REAL_MUL(x2, y2)), REAL_MUL(x3, y3));
+}
+
+static inline REAL REAL_NAME(small_inverse1)(const REAL* a, REAL* c){
+	REAL det = a[0];
+	c[0] = REAL_RECIP(det);
+	return det;
+}
+
+static inline REAL REAL_NAME(small_inverse2)(const REAL* a, REAL* c){
+	REAL x[4] = {a[0], a[1], a[2], a[3]};
+	REAL det = REAL_NAME(small_det2)(x);
+	REAL r = REAL_RECIP(det);
+	c[0] = REAL_MUL(x[3], r);
+	c[1] = REAL_MUL(REAL_NEG(x[1]), r);
+	c[2] = REAL_MUL(REAL_NEG(x[2]), r);
+	c[3] = REAL_MUL(x[0], r);
+	return det;
+}
+
+static inline REAL REAL_NAME(small_inverse3)(const REAL* a, REAL* c){
+	REAL x[9];
+	for(uint k = 0; k < 9; k++)
+		x[k] = a[k];
+	REAL adj[9] = {
+		REAL_SUB(REAL_MUL(x[4], x[8]), REAL_MUL(x[5], x[7])),
+		REAL_SUB(REAL_MUL(x[2], x[7]), REAL_MUL(x[1], x[8])),
+		REAL_SUB(REAL_MUL(x[1], x[5]), REAL_MUL(x[2], x[4])),
+		REAL_SUB(REAL_MUL(x[5], x[6]), REAL_MUL(x[3], x[8])),
+		REAL_SUB(REAL_MUL(x[0], x[8]), REAL_MUL(x[2], x[6])),
+		REAL_SUB(REAL_MUL(x[2], x[3]), REAL_MUL(x[0], x[5])),
+		REAL_SUB(REAL_MUL(x[3], x[7]), REAL_MUL(x[4], x[6])),
+		REAL_SUB(REAL_MUL(x[1], x[6]), REAL_MUL(x[0], x[7])),
+		REAL_SUB(REAL_MUL(x[0], x[4]), REAL_MUL(x[1], x[3])),
+	};
+	REAL det = REAL_ADD(REAL_ADD(REAL_MUL(x[0], adj[0]), REAL_MUL(x[1], adj[3])),
+			REAL_MUL(x[2], adj[6]));
+	REAL r = REAL_RECIP(det);
+	for(uint k = 0; k < 9; k++)
+		c[k] = REAL_MUL(adj[k], r);
+	return det;
+}
+
+static inline REAL REAL_NAME(small_inverse4)(const REAL* a, REAL* c){
+	REAL x[16];
+	for(uint k = 0; k < 16; k++)
+		x[k] = a[k];
+	SMALL_MINORS4(x);
+	REAL adj[16] = {
+		REAL_NAME(small_pmp)(x[5], t5, x[6], t4, x[7], t3),
+		REAL_NAME(small_pmm)(x[2], t4, x[1], t5, x[3], t3),
+		REAL_NAME(small_pmp)(x[13], s5, x[14], s4, x[15], s3),
+		REAL_NAME(small_pmm)(x[10], s4, x[9], s5, x[11], s3),
+		REAL_NAME(small_pmm)(x[6], t2, x[4], t5, x[7], t1),
+		REAL_NAME(small_pmp)(x[0], t5, x[2], t2, x[3], t1),
+		REAL_NAME(small_pmm)(x[14], s2, x[12], s5, x[15], s1),
+		REAL_NAME(small_pmp)(x[8], s5, x[10], s2, x[11], s1),
+		REAL_NAME(small_pmp)(x[4], t4, x[5], t2, x[7], t0),
+		REAL_NAME(small_pmm)(x[1], t2, x[0], t4, x[3], t0),
+		REAL_NAME(small_pmp)(x[12], s4, x[13], s2, x[15], s0),
+		REAL_NAME(small_pmm)(x[9], s2, x[8], s4, x[11], s0),
+		REAL_NAME(small_pmm)(x[5], t1, x[4], t3, x[6], t0),
+		REAL_NAME(small_pmp)(x[0], t3, x[1], t1, x[2], t0),
+		REAL_NAME(small_pmm)(x[13], s1, x[12], s3, x[14], s0),
+		REAL_NAME(small_pmp)(x[8], s3, x[9], s1, x[10], s0),
+	};
+	REAL r = REAL_RECIP(det);
+	for(uint k = 0; k < 16; k++)
+		c[k] = REAL_MUL(adj[k], r);
+	return det;
+}
+
+/*
+ * The above for an n only known at run time.
+ */
+static inline void REAL_NAME(small_mul_n)(const REAL* a, const REAL* b, REAL* c, uint n){
+	switch(n){
+		case 1:
+			REAL_NAME(small_mul)(a, b, c, 1);
+			break;
+		case 2:
+			REAL_NAME(small_mul)(a, b, c, 2);
+			break;
+		case 3:
+			REAL_NAME(small_mul)(a, b, c, 3);
+			break;
+		default:
+			REAL_NAME(small_mul)(a, b, c, 4);
+			break;
+	}
+}
+
+static inline REAL REAL_NAME(small_det_n)(const REAL* a, uint n){
+	switch(n){
+		case 1:
+			return a[0];
+		case 2:
+			return REAL_NAME(small_det2)(a);
+		case 3:
+			return REAL_NAME(small_det3)(a);
+		default:
+			return REAL_NAME(small_det4)(a);
+	}
+}
+
+static inline REAL REAL_NAME(small_inverse_n)(const REAL* a, REAL* c, uint n){
+	switch(n){
+		case 1:
+			return REAL_NAME(small_inverse1)(a, c);
+		case 2:
+			return REAL_NAME(small_inverse2)(a, c);
+		case 3:
+			return REAL_NAME(small_inverse3)(a, c);
+		default:
+			return REAL_NAME(small_inverse4)(a, c);
+	}
+}
+
+#undef SMALL_MINORS4
@@ -0,0 +1,673 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#include "config.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "common.h"
+
+#define MATRIX_SIZE(matrix) ((ulong)(matrix)->rows * (matrix)->cols)
+
+/*
+ * Elementwise ops above PARALLEL_THRESHOLD elements are split into
+ * PARALLEL_GRAIN sized chunks and handed to the worker pool. Operands are
+ * walked in row major order, one contiguous run at a time, so padded rows
+ * become one kernel call each while dense storage stays a single call.
+ * Vectors go through the same path as one row matrices.
+ *
+ * Ops run in the compute dtype of their destination. A float64 dst gets
+ * operands of other dtypes converted into a temporary first. Otherwise
+ * the float32 kernels run, and when any operand or the dst holds another
+ * dtype each run is staged through ARITH_STAGE element stack buffers:
+ * the sources are widened piece by piece and the result narrowed straight
+ * back, so 16 bit storage never gets a full size float32 copy. The
+ * allocating flavours give the result the promoted dtype of the operands,
+ * so mixing float32 and float64 computes in float64.
+ */
+
+#define ARITH_STAGE 256
+
+struct BinaryTask {
+	void (*kernel)(float* dst, const float* src1, const float* src2, ulong len);
+	void (*kernel_f64)(double* dst, const double* src1, const double* src2, ulong len);
+	const struct Matrix* dst;
+	const struct Matrix* src1;
+	const struct Matrix* src2;
+	uint staged;
+};
+
+struct ScalarTask {
+	void (*kernel)(float* dst, const float* src, float scalar, ulong len);
+	void (*kernel_f64)(double* dst, const double* src, double scalar, ulong len);
+	const struct Matrix* dst;
+	const struct Matrix* src;
+	double scalar;
+	uint staged;
+};
+
+struct ScalarLeftTask {
+	void (*kernel)(float* dst, float scalar, const float* src, ulong len);
+	void (*kernel_f64)(double* dst, double scalar, const double* src, ulong len);
+	const struct Matrix* dst;
+	const struct Matrix* src;
+	double scalar;
+	uint staged;
+};
+
+static struct Matrix vector_layout(const struct Vector* vector){
+	struct Matrix layout = {.values = vector->values, .rows = 1, .cols = vector->len,
+		.rows_cap = 1, .cols_cap = vector->len, .ld = vector->len,
+		.dtype = vector->dtype};
+	return layout;
+}
+
+static ulong run_length(const struct Matrix* dst, const struct Matrix* src1,
+		const struct Matrix* src2, ulong index, ulong len){
+	len = matrix_run(dst, index, len);
+	len = matrix_run(src1, index, len);
+	return src2 ? matrix_run(src2, index, len) : len;
+}
+
+static void* at(const struct Matrix* matrix, ulong index){
+	return (char*)matrix->values +
+		matrix_offset(matrix, index) * dtype_size(matrix->dtype);
+}
+
+static uint is_staged(const struct Matrix* dst, const struct Matrix* src1,
+		const struct Matrix* src2){
+	return dst->dtype != DTYPE_F64 && (dst->dtype != DTYPE_F32 ||
+			src1->dtype != DTYPE_F32 || (src2 && src2->dtype != DTYPE_F32));
+}
+
+/*
+ * The float32 operand at index, widened into stage unless it already is
+ * float32, and where the result of that piece goes.
+ */
+static const float* stage_in(const struct Matrix* matrix, ulong index, ulong len,
+		float* stage){
+	if(matrix->dtype == DTYPE_F32)
+		return at(matrix, index);
+	dtype_convert(stage, DTYPE_F32, at(matrix, index), matrix->dtype, len);
+	return stage;
+}
+
+static float* stage_out(const struct Matrix* dst, ulong index, float* stage){
+	return dst->dtype == DTYPE_F32 ? at(dst, index) : stage;
+}
+
+static void stage_store(const struct Matrix* dst, ulong index, ulong len,
+		const float* stage){
+	if(dst->dtype != DTYPE_F32)
+		dtype_convert(at(dst, index), dst->dtype, stage, DTYPE_F32, len);
+}
+
+static void binary_staged(const struct BinaryTask* task, ulong index, ulong len){
+	float stage1[ARITH_STAGE];
+	float stage2[ARITH_STAGE];
+	float result[ARITH_STAGE];
+	for(ulong step; len; index += step, len -= step){
+		step = len < ARITH_STAGE ? len : ARITH_STAGE;
+		float* dst = stage_out(task->dst, index, result);
+		task->kernel(dst, stage_in(task->src1, index, step, stage1),
+				stage_in(task->src2, index, step, stage2), step);
+		stage_store(task->dst, index, step, dst);
+	}
+}
+
+static void scalar_staged(const struct ScalarTask* task, ulong index, ulong len){
+	float stage[ARITH_STAGE];
+	float result[ARITH_STAGE];
+	for(ulong step; len; index += step, len -= step){
+		step = len < ARITH_STAGE ? len : ARITH_STAGE;
+		float* dst = stage_out(task->dst, index, result);
+		task->kernel(dst, stage_in(task->src, index, step, stage),
+				(float)task->scalar, step);
+		stage_store(task->dst, index, step, dst);
+	}
+}
+
+static void scalar_left_staged(const struct ScalarLeftTask* task, ulong index, ulong len){
+	float stage[ARITH_STAGE];
+	float result[ARITH_STAGE];
+	for(ulong step; len; index += step, len -= step){
+		step = len < ARITH_STAGE ? len : ARITH_STAGE;
+		float* dst = stage_out(task->dst, index, result);
+		task->kernel(dst, (float)task->scalar,
+				stage_in(task->src, index, step, stage), step);
+		stage_store(task->dst, index, step, dst);
+	}
+}
+
+static void binary_chunk(void* arg, ulong begin, ulong end){
+	struct BinaryTask* task = arg;
+	for(ulong index = begin, len; index < end; index += len){
+		len = run_length(task->dst, task->src1, task->src2, index, end - index);
+		if(task->dst->dtype == DTYPE_F64)
+			task->kernel_f64(at(task->dst, index), at(task->src1, index),
+					at(task->src2, index), len);
+		else if(task->staged)
+			binary_staged(task, index, len);
+		else
+			task->kernel(at(task->dst, index), at(task->src1, index),
+					at(task->src2, index), len);
+	}
+}
+
+static void scalar_chunk(void* arg, ulong begin, ulong end){
+	struct ScalarTask* task = arg;
+	for(ulong index = begin, len; index < end; index += len){
+		len = run_length(task->dst, task->src, NULL, index, end - index);
+		if(task->dst->dtype == DTYPE_F64)
+			task->kernel_f64(at(task->dst, index), at(task->src, index),
+					task->scalar, len);
+		else if(task->staged)
+			scalar_staged(task, index, len);
+		else
+			task->kernel(at(task->dst, index), at(task->src, index),
+					(float)task->scalar, len);
+	}
+}
+
+static void scalar_left_chunk(void* arg, ulong begin, ulong end){
+	struct ScalarLeftTask* task = arg;
+	for(ulong index = begin, len; index < end; index += len){
+		len = run_length(task->dst, task->src, NULL, index, end - index);
+		if(task->dst->dtype == DTYPE_F64)
+			task->kernel_f64(at(task->dst, index), task->scalar,
+					at(task->src, index), len);
+		else if(task->staged)
+			scalar_left_staged(task, index, len);
+		else
+			task->kernel(at(task->dst, index), (float)task->scalar,
+					at(task->src, index), len);
+	}
+}
+
+/*
+ * Only a float64 dst needs its operands converted up front.
+ */
+static const struct Matrix* operand(const struct Matrix* matrix,
+		const struct Matrix* dst, struct Matrix** temp){
+	*temp = NULL;
+	if(dst->dtype != DTYPE_F64)
+		return matrix;
+	return matrix_cast(matrix, DTYPE_F64, temp);
+}
+
+static void run_chunks(void (*chunk)(void*, ulong, ulong), void* task, ulong len){
+	if(len < PARALLEL_THRESHOLD)
+		chunk(task, 0, len);
+	else
+		parallel_for(len, PARALLEL_GRAIN, chunk, task);
+}
+
+static uint run_binary(void (*kernel)(float*, const float*, const float*, ulong),
+		void (*kernel_f64)(double*, const double*, const double*, ulong),
+		const struct Matrix* dst, const struct Matrix* src1,
+		const struct Matrix* src2){
+	struct Matrix* temp1;
+	struct Matrix* temp2;
+	struct BinaryTask task = {kernel, kernel_f64, dst, operand(src1, dst, &temp1),
+		operand(src2, dst, &temp2), is_staged(dst, src1, src2)};
+	if(task.src1 && task.src2)
+		run_chunks(binary_chunk, &task, MATRIX_SIZE(dst));
+	matrix_free(temp1);
+	matrix_free(temp2);
+	return task.src1 && task.src2;
+}
+
+static uint run_scalar(void (*kernel)(float*, const float*, float, ulong),
+		void (*kernel_f64)(double*, const double*, double, ulong),
+		const struct Matrix* dst, const struct Matrix* src, double scalar){
+	struct Matrix* temp;
+	struct ScalarTask task = {kernel, kernel_f64, dst, operand(src, dst, &temp),
+		scalar, is_staged(dst, src, NULL)};
+	if(task.src)
+		run_chunks(scalar_chunk, &task, MATRIX_SIZE(dst));
+	matrix_free(temp);
+	return task.src != NULL;
+}
+
+static uint run_scalar_left(void (*kernel)(float*, float, const float*, ulong),
+		void (*kernel_f64)(double*, double, const double*, ulong),
+		const struct Matrix* dst, double scalar, const struct Matrix* src){
+	struct Matrix* temp;
+	struct ScalarLeftTask task = {kernel, kernel_f64, dst, operand(src, dst, &temp),
+		scalar, is_staged(dst, src, NULL)};
+	if(task.src)
+		run_chunks(scalar_left_chunk, &task, MATRIX_SIZE(dst));
+	matrix_free(temp);
+	return task.src != NULL;
+}
+
+static uint cmp_run(const struct Matrix* matrix1, const struct Matrix* matrix2,
+		ulong index, ulong len, enum CmpOp op){
+	if(matrix1->dtype == DTYPE_F64)
+		return kernel_cmp_f64(at(matrix1, index), at(matrix2, index), len, op);
+	return kernel_cmp(at(matrix1, index), at(matrix2, index), len, op);
+}
+
+/*
+ * Operands compare in the compute dtype of the promoted one.
+ */
+static uint cmp_matrix(const struct Matrix* matrix1, const struct Matrix* matrix2,
+		enum CmpOp op){
+	enum Dtype dtype = dtype_compute(dtype_promote(matrix1->dtype, matrix2->dtype));
+	struct Matrix* temp1;
+	struct Matrix* temp2;
+	const struct Matrix* src1 = matrix_cast(matrix1, dtype, &temp1);
+	const struct Matrix* src2 = matrix_cast(matrix2, dtype, &temp2);
+	uint result = src1 && src2;
+	ulong size = MATRIX_SIZE(matrix1);
+	for(ulong index = 0, len; result && index < size; index += len){
+		len = run_length(src1, src2, NULL, index, size - index);
+		result = cmp_run(src1, src2, index, len, op);
+	}
+	matrix_free(temp1);
+	matrix_free(temp2);
+	return result;
+}
+
+static uint cmp_matrix_scalar(const struct Matrix* matrix, double scalar,
+		enum CmpOp op){
+	ulong size = MATRIX_SIZE(matrix);
+	float stage[ARITH_STAGE];
+	for(ulong index = 0, len; index < size; index += len){
+		len = matrix_run(matrix, index, size - index);
+		if(matrix->dtype == DTYPE_F64){
+			if(!kernel_cmp_scalar_f64(at(matrix, index), scalar, len, op))
+				return 0;
+			continue;
+		}
+		if(matrix->dtype != DTYPE_F32 && len > ARITH_STAGE)
+			len = ARITH_STAGE;
+		if(!kernel_cmp_scalar(stage_in(matrix, index, len, stage), (float)scalar, len, op))
+			return 0;
+	}
+	return 1;
+}
+
+/*
+ * Every op comes in two flavours: name() allocates its result, name_into()
+ * writes into a caller owned dst of the same shape and returns it (NULL
+ * when the shape doesn't match). dst may be one of the sources, but must
+ * not partially overlap them.
+ */
+
+#define MATRIX_SAME_SHAPE(matrix1, matrix2) \
+	((matrix1)->rows == (matrix2)->rows && (matrix1)->cols == (matrix2)->cols)
+
+#define MATRIX_BINARY(name, kernel) \
+	struct Matrix* name##_into(struct Matrix* dst, \
+			struct Matrix* matrix1, struct Matrix* matrix2){ \
+		if(!MATRIX_SAME_SHAPE(dst, matrix1)) \
+			return NULL; \
+		if(!run_binary(kernel, kernel##_f64, dst, matrix1, matrix2)) \
+			return NULL; \
+		return dst; \
+	} \
+	struct Matrix* name(struct Matrix* matrix1, struct Matrix* matrix2){ \
+		struct Matrix* result = matrix_new_dtype(matrix1->rows, matrix1->cols, 0, \
+				dtype_promote(matrix1->dtype, matrix2->dtype)); \
+		if(!result) \
+			return NULL; \
+		if(!name##_into(result, matrix1, matrix2)){ \
+			matrix_free(result); \
+			return NULL; \
+		} \
+		return result; \
+	}
+
+#define MATRIX_SCALAR(name, kernel) \
+	struct Matrix* name##_into(struct Matrix* dst, \
+			struct Matrix* matrix, double scalar){ \
+		if(!MATRIX_SAME_SHAPE(dst, matrix)) \
+			return NULL; \
+		if(!run_scalar(kernel, kernel##_f64, dst, matrix, scalar)) \
+			return NULL; \
+		return dst; \
+	} \
+	struct Matrix* name(struct Matrix* matrix, double scalar){ \
+		struct Matrix* result = matrix_new_dtype(matrix->rows, matrix->cols, 0, \
+				matrix->dtype); \
+		if(!result) \
+			return NULL; \
+		if(!name##_into(result, matrix, scalar)){ \
+			matrix_free(result); \
+			return NULL; \
+		} \
+		return result; \
+	}
+
+#define SCALAR_MATRIX(name, kernel) \
+	struct Matrix* name##_into(struct Matrix* dst, \
+			double scalar, struct Matrix* matrix){ \
+		if(!MATRIX_SAME_SHAPE(dst, matrix)) \
+			return NULL; \
+		if(!run_scalar_left(kernel, kernel##_f64, dst, scalar, matrix)) \
+			return NULL; \
+		return dst; \
+	} \
+	struct Matrix* name(double scalar, struct Matrix* matrix){ \
+		struct Matrix* result = matrix_new_dtype(matrix->rows, matrix->cols, 0, \
+				matrix->dtype); \
+		if(!result) \
+			return NULL; \
+		if(!name##_into(result, scalar, matrix)){ \
+			matrix_free(result); \
+			return NULL; \
+		} \
+		return result; \
+	}
+
+#define VECTOR_BINARY(name, kernel) \
+	struct Vector* name##_into(struct Vector* dst, \
+			struct Vector* vector1, struct Vector* vector2){ \
+		if(dst->len != vector1->len) \
+			return NULL; \
+		struct Matrix layout = vector_layout(dst); \
+		struct Matrix layout1 = vector_layout(vector1); \
+		struct Matrix layout2 = vector_layout(vector2); \
+		if(!run_binary(kernel, kernel##_f64, &layout, &layout1, &layout2)) \
+			return NULL; \
+		return dst; \
+	} \
+	struct Vector* name(struct Vector* vector1, struct Vector* vector2){ \
+		struct Vector* result = vector_new_dtype(vector1->len, 0, \
+				dtype_promote(vector1->dtype, vector2->dtype)); \
+		if(!result) \
+			return NULL; \
+		if(!name##_into(result, vector1, vector2)){ \
+			vector_free(result); \
+			return NULL; \
+		} \
+		return result; \
+	}
+
+#define VECTOR_SCALAR(name, kernel) \
+	struct Vector* name##_into(struct Vector* dst, \
+			struct Vector* vector, double scalar){ \
+		if(dst->len != vector->len) \
+			return NULL; \
+		struct Matrix layout = vector_layout(dst); \
+		struct Matrix source = vector_layout(vector); \
+		if(!run_scalar(kernel, kernel##_f64, &layout, &source, scalar)) \
+			return NULL; \
+		return dst; \
+	} \
+	struct Vector* name(struct Vector* vector, double scalar){ \
+		struct Vector* result = vector_new_dtype(vector->len, 0, vector->dtype); \
+		if(!result) \
+			return NULL; \
+		if(!name##_into(result, vector, scalar)){ \
+			vector_free(result); \
+			return NULL; \
+		} \
+		return result; \
+	}
+
+#define SCALAR_VECTOR(name, kernel) \
+	struct Vector* name##_into(struct Vector* dst, \
+			double scalar, struct Vector* vector){ \
+		if(dst->len != vector->len) \
+			return NULL; \
+		struct Matrix layout = vector_layout(dst); \
+		struct Matrix source = vector_layout(vector); \
+		if(!run_scalar_left(kernel, kernel##_f64, &layout, scalar, &source)) \
+			return NULL; \
+		return dst; \
+	} \
+	struct Vector* name(double scalar, struct Vector* vector){ \
+		struct Vector* result = vector_new_dtype(vector->len, 0, vector->dtype); \
+		if(!result) \
+			return NULL; \
+		if(!name##_into(result, scalar, vector)){ \
+			vector_free(result); \
+			return NULL; \
+		} \
+		return result; \
+	}
+
+#define MATRIX_CMP(name, op) \
+	uint name(struct Matrix* matrix1, struct Matrix* matrix2){ \
+		return cmp_matrix(matrix1, matrix2, op); \
+	}
+
+#define MATRIX_CMP_SCALAR(name, op) \
+	uint name(struct Matrix* matrix, double scalar){ \
+		return cmp_matrix_scalar(matrix, scalar, op); \
+	}
+
+#define VECTOR_CMP(name, op) \
+	uint name(struct Vector* vector1, struct Vector* vector2){ \
+		struct Matrix layout1 = vector_layout(vector1); \
+		struct Matrix layout2 = vector_layout(vector2); \
+		return cmp_matrix(&layout1, &layout2, op); \
+	}
+
+#define VECTOR_CMP_SCALAR(name, op) \
+	uint name(struct Vector* vector, double scalar){ \
+		struct Matrix layout = vector_layout(vector); \
+		return cmp_matrix_scalar(&layout, scalar, op); \
+	}
+
+MATRIX_BINARY(matrix_add, kernel_add)
+MATRIX_BINARY(matrix_sub, kernel_sub)
+MATRIX_BINARY(matrix_div, kernel_div)
+MATRIX_SCALAR(matrix_add_scalar, kernel_add_scalar)
+MATRIX_SCALAR(matrix_sub_scalar, kernel_sub_scalar)
+MATRIX_SCALAR(matrix_mul_scalar, kernel_mul_scalar)
+MATRIX_SCALAR(matrix_div_scalar, kernel_div_scalar)
+SCALAR_MATRIX(scalar_sub_matrix, kernel_scalar_sub)
+SCALAR_MATRIX(scalar_div_matrix, kernel_scalar_div)
+
+VECTOR_BINARY(vector_add, kernel_add)
+VECTOR_BINARY(vector_sub, kernel_sub)
+VECTOR_BINARY(vector_mul, kernel_mul)
+VECTOR_BINARY(vector_div, kernel_div)
+VECTOR_SCALAR(vector_add_scalar, kernel_add_scalar)
+VECTOR_SCALAR(vector_sub_scalar, kernel_sub_scalar)
+VECTOR_SCALAR(vector_mul_scalar, kernel_mul_scalar)
+VECTOR_SCALAR(vector_div_scalar, kernel_div_scalar)
+SCALAR_VECTOR(scalar_sub_vector, kernel_scalar_sub)
+SCALAR_VECTOR(scalar_div_vector, kernel_scalar_div)
+
+MATRIX_CMP(matrix_eq, CMP_EQ)
+MATRIX_CMP(matrix_neq, CMP_NEQ)
+MATRIX_CMP(matrix_gt, CMP_GT)
+MATRIX_CMP(matrix_ge, CMP_GE)
+MATRIX_CMP(matrix_lt, CMP_LT)
+MATRIX_CMP(matrix_le, CMP_LE)
+MATRIX_CMP_SCALAR(matrix_eq_scalar, CMP_EQ)
+MATRIX_CMP_SCALAR(matrix_neq_scalar, CMP_NEQ)
+MATRIX_CMP_SCALAR(matrix_gt_scalar, CMP_GT)
+MATRIX_CMP_SCALAR(matrix_ge_scalar, CMP_GE)
+MATRIX_CMP_SCALAR(matrix_lt_scalar, CMP_LT)
+MATRIX_CMP_SCALAR(matrix_le_scalar, CMP_LE)
+
+VECTOR_CMP(vector_eq, CMP_EQ)
+VECTOR_CMP(vector_neq, CMP_NEQ)
+VECTOR_CMP(vector_gt, CMP_GT)
+VECTOR_CMP(vector_ge, CMP_GE)
+VECTOR_CMP(vector_lt, CMP_LT)
+VECTOR_CMP(vector_le, CMP_LE)
+VECTOR_CMP_SCALAR(vector_eq_scalar, CMP_EQ)
+VECTOR_CMP_SCALAR(vector_neq_scalar, CMP_NEQ)
+VECTOR_CMP_SCALAR(vector_gt_scalar, CMP_GT)
+VECTOR_CMP_SCALAR(vector_ge_scalar, CMP_GE)
+VECTOR_CMP_SCALAR(vector_lt_scalar, CMP_LT)
+VECTOR_CMP_SCALAR(vector_le_scalar, CMP_LE)
+
+/*
+ * Matrix-vector products run in the compute dtype of dst like the
+ * elementwise ops. A float64 product converts its operands first, a
+ * float32 one widens the rows of a matrix of another dtype ARITH_STAGE
+ * elements at a time and converts only the vectors. A 16 bit dst is
+ * computed in a float32 temporary and narrowed at the end.
+ */
+struct GemvTask {
+	const struct Matrix* matrix;
+	const struct Vector* src;
+	struct Vector* dst;
+};
+
+static float dot_staged(const struct Matrix* matrix, ulong index,
+		const float* src, ulong len){
+	float stage[ARITH_STAGE];
+	float sum = 0;
+	for(ulong i = 0, step; i < len; i += step){
+		step = len - i < ARITH_STAGE ? len - i : ARITH_STAGE;
+		sum += kernel_dot(stage_in(matrix, index + i, step, stage), &src[i], step);
+	}
+	return sum;
+}
+
+static void axpy_staged(float* dst, float alpha, const struct Matrix* matrix,
+		ulong index, ulong len){
+	float stage[ARITH_STAGE];
+	for(ulong i = 0, step; i < len; i += step){
+		step = len - i < ARITH_STAGE ? len - i : ARITH_STAGE;
+		kernel_axpy(&dst[i], alpha, stage_in(matrix, index + i, step, stage), step);
+	}
+}
+
+static void gemv_rows(void* arg, ulong begin, ulong end){
+	struct GemvTask* task = arg;
+	const struct Matrix* matrix = task->matrix;
+	if(matrix->dtype == DTYPE_F64){
+		for(ulong i = begin; i < end; i++)
+			task->dst->values_f64[i] = kernel_dot_f64(
+					&matrix->values_f64[i * matrix->ld],
+					task->src->values_f64, matrix->cols);
+		return;
+	}
+	if(matrix->dtype != DTYPE_F32){
+		for(ulong i = begin; i < end; i++)
+			task->dst->values[i] = dot_staged(matrix, i * matrix->cols,
+					task->src->values, matrix->cols);
+		return;
+	}
+	for(ulong i = begin; i < end; i++)
+		task->dst->values[i] = kernel_dot(&matrix->values[i * matrix->ld],
+				task->src->values, matrix->cols);
+}
+
+static void gevm_cols(void* arg, ulong begin, ulong end){
+	struct GemvTask* task = arg;
+	const struct Matrix* matrix = task->matrix;
+	if(matrix->dtype == DTYPE_F64){
+		for(ulong i = 0; i < matrix->rows; i++)
+			kernel_axpy_f64(&task->dst->values_f64[begin], task->src->values_f64[i],
+					&matrix->values_f64[i * matrix->ld + begin], end - begin);
+		return;
+	}
+	if(matrix->dtype != DTYPE_F32){
+		for(ulong i = 0; i < matrix->rows; i++)
+			axpy_staged(&task->dst->values[begin], task->src->values[i], matrix,
+					i * matrix->cols + begin, end - begin);
+		return;
+	}
+	for(ulong i = 0; i < matrix->rows; i++)
+		kernel_axpy(&task->dst->values[begin], task->src->values[i],
+				&matrix->values[i * matrix->ld + begin], end - begin);
+}
+
+static uint gemv_begin(struct GemvTask* task, struct Matrix** matrix_temp,
+		struct Vector** vector_temp, struct Vector** dst_temp, struct Vector* dst,
+		struct Matrix* matrix, struct Vector* vector){
+	enum Dtype dtype = dtype_compute(dst->dtype);
+	*matrix_temp = NULL;
+	*vector_temp = *dst_temp = NULL;
+	task->matrix = matrix;
+	if(dtype == DTYPE_F64)
+		task->matrix = matrix_cast(matrix, dtype, matrix_temp);
+	task->src = vector;
+	if(vector->dtype != dtype)
+		task->src = *vector_temp = vector_astype(vector, dtype);
+	task->dst = dst;
+	if(dst->dtype != dtype)
+		task->dst = *dst_temp = vector_new_dtype(dst->len, 0, dtype);
+	return task->matrix && task->src && task->dst;
+}
+
+static void gemv_end(struct Vector* result, struct Matrix* matrix_temp,
+		struct Vector* vector_temp, struct Vector* dst_temp){
+	if(result && dst_temp)
+		dtype_convert(result->values, result->dtype, dst_temp->values,
+				dst_temp->dtype, result->len);
+	matrix_free(matrix_temp);
+	vector_free(vector_temp);
+	vector_free(dst_temp);
+}
+
+struct Vector* matrix_mul_vector_into(struct Vector* dst,
+		struct Matrix* matrix, struct Vector* vector){
+	if(dst->len != matrix->rows || dst == vector)
+		return NULL;
+	struct GemvTask task;
+	struct Matrix* matrix_temp;
+	struct Vector* vector_temp;
+	struct Vector* dst_temp;
+	struct Vector* result = NULL;
+	if(gemv_begin(&task, &matrix_temp, &vector_temp, &dst_temp, dst, matrix, vector)){
+		if(MATRIX_SIZE(matrix) < PARALLEL_THRESHOLD)
+			gemv_rows(&task, 0, matrix->rows);
+		else
+			parallel_for(matrix->rows, PARALLEL_GRAIN / (matrix->cols + 1) + 1,
+					gemv_rows, &task);
+		result = dst;
+	}
+	gemv_end(result, matrix_temp, vector_temp, dst_temp);
+	return result;
+}
+
+struct Vector* matrix_mul_vector(struct Matrix* matrix, struct Vector* vector){
+	struct Vector* result = vector_new_dtype(matrix->rows, 0,
+			dtype_promote(matrix->dtype, vector->dtype));
+	if(!result)
+		return NULL;
+	if(!matrix_mul_vector_into(result, matrix, vector)){
+		vector_free(result);
+		return NULL;
+	}
+	return result;
+}
+
+struct Vector* vector_mul_matrix_into(struct Vector* dst,
+		struct Vector* vector, struct Matrix* matrix){
+	if(dst->len != matrix->cols || dst == vector)
+		return NULL;
+	struct GemvTask task;
+	struct Matrix* matrix_temp;
+	struct Vector* vector_temp;
+	struct Vector* dst_temp;
+	struct Vector* result = NULL;
+	if(gemv_begin(&task, &matrix_temp, &vector_temp, &dst_temp, dst, matrix, vector)){
+		memset(task.dst->values, 0, (ulong)dtype_size(task.dst->dtype) * dst->len);
+		if(MATRIX_SIZE(matrix) < PARALLEL_THRESHOLD)
+			gevm_cols(&task, 0, matrix->cols);
+		else
+			parallel_for(matrix->cols, GEMM_NR_MAX * 4, gevm_cols, &task);
+		result = dst;
+	}
+	gemv_end(result, matrix_temp, vector_temp, dst_temp);
+	return result;
+}
+
+struct Vector* vector_mul_matrix(struct Vector* vector, struct Matrix* matrix){
+	struct Vector* result = vector_new_dtype(matrix->cols, 0,
+			dtype_promote(matrix->dtype, vector->dtype));
+	if(!result)
+		return NULL;
+	if(!vector_mul_matrix_into(result, vector, matrix)){
+		vector_free(result);
+		return NULL;
+	}
+	return result;
+}
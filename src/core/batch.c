@@ -0,0 +1,360 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#include "config.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "common.h"
+
+/*
+ * Batches of small same-shape float32 matrices.
+ *
+ * The storage is element major, so a 4x4 batch is 16 planes of count
+ * floats and the kernels run the textbook loops with one matrix per SIMD
+ * lane: no shuffles, no per-matrix call and the same code for 2x2 as for
+ * 4x4. Planes are padded to BATCH_PAD lanes, which covers the widest
+ * vector, and the padding is kept at zero so kernels can run over it.
+ *
+ * A single matrix (count 1) or a vector is broadcast over the other
+ * operand's batch by replicating it across BATCH_PAD lanes and letting
+ * the kernel read it without advancing. Square inverses up to 4x4 are
+ * closed form, larger ones go through matrix_inverse one at a time.
+ */
+
+#define BATCH_PAD (SIMD_ALIGNMENT / sizeof(float))
+
+#define BATCH_SMALL 4
+
+struct BatchTask {
+	const float* a;
+	ulong lda;
+	uint a_step;
+	const float* b;
+	ulong ldb;
+	uint b_step;
+	float* c;
+	ulong ldc;
+	float* det;
+	uint m;
+	uint k;
+	uint n;
+};
+
+static struct Batch* batch_alloc(uint count, uint rows, uint cols){
+	struct Batch* batch = pool_alloc(sizeof(struct Batch));
+	if(!batch)
+		return NULL;
+	batch->count = count;
+	batch->rows = rows;
+	batch->cols = cols;
+	batch->stride = (uint)((count + BATCH_PAD - 1) / BATCH_PAD * BATCH_PAD);
+	batch->values = pool_alloc(sizeof(float) *
+			((ulong)rows * cols * batch->stride + 1));
+	if(!batch->values){
+		pool_free(batch);
+		return NULL;
+	}
+	return batch;
+}
+
+static ulong batch_planes(const struct Batch* batch){
+	return (ulong)batch->rows * batch->cols;
+}
+
+static void clear_padding(struct Batch* batch){
+	const ulong planes = batch_planes(batch);
+	for(ulong p = 0; p < planes; p++)
+		memset(&batch->values[p * batch->stride + batch->count], 0,
+				sizeof(float) * (batch->stride - batch->count));
+}
+
+struct Batch* batch_new(uint count, uint rows, uint cols, float value){
+	struct Batch* batch = batch_alloc(count, rows, cols);
+	if(!batch)
+		return NULL;
+	const ulong planes = batch_planes(batch);
+	for(ulong p = 0; p < planes; p++)
+		for(uint index = 0; index < count; index++)
+			batch->values[p * batch->stride + index] = value;
+	clear_padding(batch);
+	return batch;
+}
+
+struct Batch* batch_identity(uint count, uint size){
+	struct Batch* batch = batch_new(count, size, size, 0);
+	if(!batch)
+		return NULL;
+	for(uint i = 0; i < size; i++)
+		for(uint index = 0; index < count; index++)
+			*batch_at(batch, index, i, i) = 1;
+	return batch;
+}
+
+void batch_free(struct Batch* batch){
+	if(!batch)
+		return;
+	pool_free(batch->values);
+	pool_free(batch);
+}
+
+struct Matrix* batch_get(struct Batch* batch, uint index){
+	if(index >= batch->count)
+		return NULL;
+	struct Matrix* result = matrix_new(batch->rows, batch->cols, 0);
+	if(!result)
+		return NULL;
+	for(uint i = 0; i < batch->rows; i++)
+		for(uint j = 0; j < batch->cols; j++)
+			*matrix_get(result, i, j) = *batch_at(batch, index, i, j);
+	return result;
+}
+
+struct Batch* batch_set(struct Batch* batch, uint index, struct Matrix* matrix){
+	if(index >= batch->count || matrix->rows != batch->rows || matrix->cols != batch->cols)
+		return NULL;
+	for(uint i = 0; i < batch->rows; i++)
+		for(uint j = 0; j < batch->cols; j++)
+			*batch_at(batch, index, i, j) = (float)matrix_load(matrix, i, j);
+	return batch;
+}
+
+/*
+ * The planes of a count 1 batch, each replicated over BATCH_PAD lanes.
+ */
+static float* broadcast_batch(const struct Batch* batch){
+	const ulong planes = batch_planes(batch);
+	float* result = pool_alloc(sizeof(float) * (planes * BATCH_PAD + 1));
+	if(!result)
+		return NULL;
+	for(ulong p = 0; p < planes; p++)
+		for(uint lane = 0; lane < BATCH_PAD; lane++)
+			result[p * BATCH_PAD + lane] = batch->values[p * batch->stride];
+	return result;
+}
+
+static float* broadcast_vector(const struct Vector* vector){
+	float* result = pool_alloc(sizeof(float) * ((ulong)vector->len * BATCH_PAD + 1));
+	if(!result)
+		return NULL;
+	for(uint p = 0; p < vector->len; p++)
+		for(uint lane = 0; lane < BATCH_PAD; lane++)
+			result[(ulong)p * BATCH_PAD + lane] = (float)vector_load(vector, p);
+	return result;
+}
+
+/*
+ * begin and end count groups of BATCH_PAD lanes.
+ */
+static void mul_groups(void* arg, ulong begin, ulong end){
+	const struct BatchTask* task = arg;
+	const ulong lane = begin * BATCH_PAD;
+	kernel_batch_mul(task->m, task->k, task->n,
+			task->a + (task->a_step ? lane : 0), task->lda, task->a_step,
+			task->b + (task->b_step ? lane : 0), task->ldb, task->b_step,
+			task->c + lane, task->ldc, (end - begin) * BATCH_PAD);
+}
+
+static void inverse_groups(void* arg, ulong begin, ulong end){
+	const struct BatchTask* task = arg;
+	const ulong lane = begin * BATCH_PAD;
+	kernel_batch_inverse(task->n, task->a + lane, task->c + lane, task->det + lane,
+			task->lda, (end - begin) * BATCH_PAD);
+}
+
+/*
+ * Runs fn over the lane groups of dst, on the worker pool once the batch
+ * holds enough flops, work being the flops per matrix.
+ */
+static void run_groups(void (*fn)(void* arg, ulong begin, ulong end),
+		struct BatchTask* task, const struct Batch* dst, ulong work){
+	const ulong groups = dst->stride / BATCH_PAD;
+	work *= BATCH_PAD;
+	if(groups * work < PARALLEL_THRESHOLD)
+		fn(task, 0, groups);
+	else
+		parallel_for(groups, PARALLEL_GRAIN / work + 1, fn, task);
+}
+
+struct Batch* batch_mul_into(struct Batch* dst, struct Batch* batch1, struct Batch* batch2){
+	const uint count = batch1->count > batch2->count ? batch1->count : batch2->count;
+	if(batch1->cols != batch2->rows || dst->rows != batch1->rows ||
+			dst->cols != batch2->cols || dst->count != count ||
+			(batch1->count != count && batch1->count != 1) ||
+			(batch2->count != count && batch2->count != 1) ||
+			dst == batch1 || dst == batch2)
+		return NULL;
+	struct BatchTask task = {
+		.a = batch1->values, .lda = batch1->stride, .a_step = 1,
+		.b = batch2->values, .ldb = batch2->stride, .b_step = 1,
+		.c = dst->values, .ldc = dst->stride,
+		.m = batch1->rows, .k = batch1->cols, .n = batch2->cols,
+	};
+	float* broadcast = NULL;
+	if(batch1->count != count){
+		task.a = broadcast = broadcast_batch(batch1);
+		task.lda = BATCH_PAD;
+		task.a_step = 0;
+	}
+	else if(batch2->count != count){
+		task.b = broadcast = broadcast_batch(batch2);
+		task.ldb = BATCH_PAD;
+		task.b_step = 0;
+	}
+	if(!task.a || !task.b)
+		return NULL;
+	run_groups(mul_groups, &task, dst, (ulong)task.m * task.k * task.n);
+	pool_free(broadcast);
+	clear_padding(dst);
+	return dst;
+}
+
+struct Batch* batch_mul(struct Batch* batch1, struct Batch* batch2){
+	const uint count = batch1->count > batch2->count ? batch1->count : batch2->count;
+	struct Batch* result = batch_alloc(count, batch1->rows, batch2->cols);
+	if(!result)
+		return NULL;
+	if(!batch_mul_into(result, batch1, batch2)){
+		batch_free(result);
+		return NULL;
+	}
+	return result;
+}
+
+/*
+ * Every matrix times the same vector, the results are a batch of
+ * rows x 1 columns.
+ */
+struct Batch* batch_mul_vector_into(struct Batch* dst,
+		struct Batch* batch, struct Vector* vector){
+	if(batch->cols != vector->len || dst->rows != batch->rows || dst->cols != 1 ||
+			dst->count != batch->count || dst == batch)
+		return NULL;
+	float* broadcast = broadcast_vector(vector);
+	if(!broadcast)
+		return NULL;
+	struct BatchTask task = {
+		.a = batch->values, .lda = batch->stride, .a_step = 1,
+		.b = broadcast, .ldb = BATCH_PAD, .b_step = 0,
+		.c = dst->values, .ldc = dst->stride,
+		.m = batch->rows, .k = batch->cols, .n = 1,
+	};
+	run_groups(mul_groups, &task, dst, (ulong)task.m * task.k);
+	pool_free(broadcast);
+	clear_padding(dst);
+	return dst;
+}
+
+struct Batch* batch_mul_vector(struct Batch* batch, struct Vector* vector){
+	struct Batch* result = batch_alloc(batch->count, batch->rows, 1);
+	if(!result)
+		return NULL;
+	if(!batch_mul_vector_into(result, batch, vector)){
+		batch_free(result);
+		return NULL;
+	}
+	return result;
+}
+
+/*
+ * Element major storage makes this a permutation of whole planes.
+ */
+struct Batch* batch_transpose_into(struct Batch* dst, struct Batch* batch){
+	if(dst->rows != batch->cols || dst->cols != batch->rows ||
+			dst->count != batch->count || dst == batch)
+		return NULL;
+	for(uint i = 0; i < batch->rows; i++)
+		for(uint j = 0; j < batch->cols; j++)
+			memcpy(batch_at(dst, 0, j, i), batch_at(batch, 0, i, j),
+					sizeof(float) * batch->stride);
+	return dst;
+}
+
+struct Batch* batch_transpose(struct Batch* batch){
+	struct Batch* result = batch_alloc(batch->count, batch->cols, batch->rows);
+	if(!result)
+		return NULL;
+	return batch_transpose_into(result, batch);
+}
+
+static void fill_nan(struct Batch* batch, uint index){
+	for(uint i = 0; i < batch->rows; i++)
+		for(uint j = 0; j < batch->cols; j++)
+			*batch_at(batch, index, i, j) = NAN;
+}
+
+/*
+ * Past BATCH_SMALL each matrix is copied out and inverted on its own.
+ */
+static struct Batch* inverse_each(struct Batch* dst, struct Batch* batch, uint* singular){
+	struct Matrix* matrix = matrix_new(batch->rows, batch->cols, 0);
+	if(!matrix)
+		return NULL;
+	for(uint index = 0; index < batch->count; index++){
+		for(uint i = 0; i < batch->rows; i++)
+			for(uint j = 0; j < batch->cols; j++)
+				*matrix_get(matrix, i, j) = *batch_at(batch, index, i, j);
+		uint invertible;
+		struct Matrix* inverse = matrix_inverse(matrix, &invertible);
+		if(!inverse && invertible){
+			matrix_free(matrix);
+			return NULL;
+		}
+		if(inverse){
+			batch_set(dst, index, inverse);
+			matrix_free(inverse);
+		}
+		else{
+			fill_nan(dst, index);
+			(*singular)++;
+		}
+	}
+	matrix_free(matrix);
+	clear_padding(dst);
+	return dst;
+}
+
+/*
+ * Inverts every matrix, singular ones (those whose inverse would not be
+ * finite) come out as NaN and are counted in *singular. dst may be batch.
+ */
+struct Batch* batch_inverse_into(struct Batch* dst, struct Batch* batch, uint* singular){
+	*singular = 0;
+	if(batch->rows != batch->cols || dst->rows != batch->rows ||
+			dst->cols != batch->cols || dst->count != batch->count)
+		return NULL;
+	if(batch->rows > BATCH_SMALL)
+		return inverse_each(dst, batch, singular);
+	float* det = pool_alloc(sizeof(float) * ((ulong)batch->stride + 1));
+	if(!det)
+		return NULL;
+	struct BatchTask task = {
+		.a = batch->values, .lda = batch->stride,
+		.c = dst->values, .det = det, .n = batch->rows,
+	};
+	run_groups(inverse_groups, &task, dst, batch_planes(batch) * batch->rows);
+	for(uint index = 0; index < batch->count; index++)
+		if(!isfinite(1 / det[index])){
+			fill_nan(dst, index);
+			(*singular)++;
+		}
+	pool_free(det);
+	clear_padding(dst);
+	return dst;
+}
+
+struct Batch* batch_inverse(struct Batch* batch, uint* singular){
+	struct Batch* result = batch_alloc(batch->count, batch->rows, batch->cols);
+	if(!result)
+		return NULL;
+	if(!batch_inverse_into(result, batch, singular)){
+		batch_free(result);
+		return NULL;
+	}
+	return result;
+}
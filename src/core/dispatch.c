@@ -0,0 +1,86 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if HAVE_NEON && defined(__arm__) && defined(__linux__)
+#include <sys/auxv.h>
+#define HWCAP_ARM_NEON (1 << 12)
+#endif
+
+#include "common.h"
+
+const struct KernelTable* kernels = &kernel_table_scalar;
+
+static const struct KernelTable* const kernel_tables[] = {
+#if HAVE_SSE
+	&kernel_table_avx512,
+	&kernel_table_avx2,
+	&kernel_table_sse,
+#endif
+#if HAVE_NEON
+	&kernel_table_neon,
+#endif
+	&kernel_table_scalar,
+};
+
+#define KERNEL_TABLES (sizeof(kernel_tables) / sizeof(kernel_tables[0]))
+
+static uint isa_supported(const struct KernelTable* table){
+#if HAVE_SSE
+	__builtin_cpu_init();
+	if(table == &kernel_table_avx512)
+		return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2") &&
+			__builtin_cpu_supports("fma") && __builtin_cpu_supports("f16c");
+	if(table == &kernel_table_avx2)
+		return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+			__builtin_cpu_supports("f16c");
+	if(table == &kernel_table_sse)
+		return __builtin_cpu_supports("sse2");
+#endif
+#if HAVE_NEON
+	if(table == &kernel_table_neon){
+#if defined(__arm__) && defined(__linux__)
+		return (getauxval(AT_HWCAP) & HWCAP_ARM_NEON) != 0;
+#else
+		return 1;
+#endif
+	}
+#endif
+	return table == &kernel_table_scalar;
+}
+
+const char* crunum_isa(void){
+	return kernels->isa;
+}
+
+uint crunum_set_isa(const char* isa){
+	for(uint i = 0; i < KERNEL_TABLES; i++){
+		if(strcmp(kernel_tables[i]->isa, isa))
+			continue;
+		if(!isa_supported(kernel_tables[i]))
+			return 0;
+		kernels = kernel_tables[i];
+		return 1;
+	}
+	return 0;
+}
+
+__attribute__((constructor))
+static void dispatch_init(void){
+	for(uint i = 0; i < KERNEL_TABLES; i++)
+		if(isa_supported(kernel_tables[i])){
+			kernels = kernel_tables[i];
+			break;
+		}
+	const char* isa = getenv("CRUNUM_ISA");
+	if(isa && *isa)
+		crunum_set_isa(isa);
+}
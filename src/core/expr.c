@@ -0,0 +1,287 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+
+/*
+ * Fused evaluation of elementwise expression trees.
+ *
+ * The result is produced EXPR_BLOCK elements at a time: every leaf is
+ * read once, the destination written once, and intermediates only live
+ * in small scratch blocks that stay in L1. A binary node evaluates its
+ * left child into its own output block and its right child into the next
+ * scratch block, so the scratch needed is bounded by the tree depth.
+ * Blocks never cross a row end of a padded leaf or destination, leaves
+ * are read in row major order whatever their leading dimension.
+ *
+ * The tree computes in the compute dtype of the promotion of its leaves
+ * and destination. A leaf of another dtype, 16 bit ones included, is
+ * converted block by block into the output block of its parent, so
+ * mixing dtypes costs no full size temporary.
+ */
+
+#define EXPR_BLOCK 512
+
+static uint max_uint(uint value1, uint value2){
+	return value1 > value2 ? value1 : value2;
+}
+
+void expr_matrix(struct Expr* expr, struct Matrix* matrix){
+	memset(expr, 0, sizeof(*expr));
+	expr->op = EXPR_MATRIX;
+	expr->matrix = matrix;
+	expr->rows = matrix->rows;
+	expr->cols = matrix->cols;
+}
+
+void expr_scalar(struct Expr* expr, double scalar){
+	memset(expr, 0, sizeof(*expr));
+	expr->op = EXPR_SCALAR;
+	expr->scalar = scalar;
+}
+
+static double fold(enum ExprOp op, double value1, double value2){
+	switch(op){
+		case EXPR_ADD:
+			return value1 + value2;
+		case EXPR_SUB:
+			return value1 - value2;
+		case EXPR_MUL:
+			return value1 * value2;
+		default:
+			return value1 / value2;
+	}
+}
+
+uint expr_binary(struct Expr* expr, enum ExprOp op,
+		struct Expr* left, struct Expr* right){
+	if(left->op == EXPR_SCALAR && right->op == EXPR_SCALAR){
+		expr_scalar(expr, fold(op, left->scalar, right->scalar));
+		return 1;
+	}
+	if(left->op != EXPR_SCALAR && right->op != EXPR_SCALAR &&
+			(ulong)left->rows * left->cols != (ulong)right->rows * right->cols)
+		return 0;
+	struct Expr* shape = left->op == EXPR_SCALAR ? right : left;
+	memset(expr, 0, sizeof(*expr));
+	expr->op = op;
+	expr->left = left;
+	expr->right = right;
+	expr->rows = shape->rows;
+	expr->cols = shape->cols;
+	expr->depth = max_uint(left->depth, right->depth) + 1;
+	return 1;
+}
+
+static uint expr_uses(const struct Expr* expr, const struct Matrix* matrix){
+	if(expr->op == EXPR_MATRIX)
+		return expr->matrix->values == matrix->values;
+	if(expr->op == EXPR_SCALAR)
+		return 0;
+	return expr_uses(expr->left, matrix) || expr_uses(expr->right, matrix);
+}
+
+static uint expr_valid(const struct Expr* expr){
+	if(expr->op == EXPR_MATRIX)
+		return (ulong)expr->matrix->rows * expr->matrix->cols ==
+			(ulong)expr->rows * expr->cols;
+	if(expr->op == EXPR_SCALAR)
+		return 1;
+	return expr_valid(expr->left) && expr_valid(expr->right);
+}
+
+static enum Dtype expr_dtype(const struct Expr* expr){
+	if(expr->op == EXPR_MATRIX)
+		return expr->matrix->dtype;
+	if(expr->left->op == EXPR_SCALAR)
+		return expr_dtype(expr->right);
+	if(expr->right->op == EXPR_SCALAR)
+		return expr_dtype(expr->left);
+	return dtype_promote(expr_dtype(expr->left), expr_dtype(expr->right));
+}
+
+static void apply_binary(enum Dtype dtype, enum ExprOp op, void* out,
+		const void* src1, const void* src2, ulong len){
+	switch(op){
+		case EXPR_ADD:
+			if(dtype == DTYPE_F64)
+				kernel_add_f64(out, src1, src2, len);
+			else
+				kernel_add(out, src1, src2, len);
+			break;
+		case EXPR_SUB:
+			if(dtype == DTYPE_F64)
+				kernel_sub_f64(out, src1, src2, len);
+			else
+				kernel_sub(out, src1, src2, len);
+			break;
+		case EXPR_MUL:
+			if(dtype == DTYPE_F64)
+				kernel_mul_f64(out, src1, src2, len);
+			else
+				kernel_mul(out, src1, src2, len);
+			break;
+		default:
+			if(dtype == DTYPE_F64)
+				kernel_div_f64(out, src1, src2, len);
+			else
+				kernel_div(out, src1, src2, len);
+			break;
+	}
+}
+
+/*
+ * out = src op scalar, or scalar op src when left is set.
+ */
+static void apply_scalar(enum Dtype dtype, enum ExprOp op, void* out,
+		const void* src, double scalar, uint left, ulong len){
+	switch(op){
+		case EXPR_ADD:
+			if(dtype == DTYPE_F64)
+				kernel_add_scalar_f64(out, src, scalar, len);
+			else
+				kernel_add_scalar(out, src, (float)scalar, len);
+			break;
+		case EXPR_SUB:
+			if(dtype == DTYPE_F64 && left)
+				kernel_scalar_sub_f64(out, scalar, src, len);
+			else if(dtype == DTYPE_F64)
+				kernel_sub_scalar_f64(out, src, scalar, len);
+			else if(left)
+				kernel_scalar_sub(out, (float)scalar, src, len);
+			else
+				kernel_sub_scalar(out, src, (float)scalar, len);
+			break;
+		case EXPR_MUL:
+			if(dtype == DTYPE_F64)
+				kernel_mul_scalar_f64(out, src, scalar, len);
+			else
+				kernel_mul_scalar(out, src, (float)scalar, len);
+			break;
+		default:
+			if(dtype == DTYPE_F64 && left)
+				kernel_scalar_div_f64(out, scalar, src, len);
+			else if(dtype == DTYPE_F64)
+				kernel_div_scalar_f64(out, src, scalar, len);
+			else if(left)
+				kernel_scalar_div(out, (float)scalar, src, len);
+			else
+				kernel_div_scalar(out, src, (float)scalar, len);
+			break;
+	}
+}
+
+static const void* eval_block(const struct Expr* expr, enum Dtype dtype,
+		ulong offset, ulong len, char* out, char* scratch){
+	const ulong block = (ulong)EXPR_BLOCK * dtype_size(dtype);
+	if(expr->op == EXPR_MATRIX){
+		const struct Matrix* matrix = expr->matrix;
+		const char* src = (const char*)matrix->values +
+			matrix_offset(matrix, offset) * dtype_size(matrix->dtype);
+		if(matrix->dtype == dtype)
+			return src;
+		dtype_convert(out, dtype, src, matrix->dtype, len);
+		return out;
+	}
+	const struct Expr* left = expr->left;
+	const struct Expr* right = expr->right;
+	if(right->op == EXPR_SCALAR){
+		const void* src = eval_block(left, dtype, offset, len, out, scratch);
+		apply_scalar(dtype, expr->op, out, src, right->scalar, 0, len);
+		return out;
+	}
+	if(left->op == EXPR_SCALAR){
+		const void* src = eval_block(right, dtype, offset, len, out, scratch);
+		apply_scalar(dtype, expr->op, out, src, left->scalar, 1, len);
+		return out;
+	}
+	const void* src1 = eval_block(left, dtype, offset, len, out, scratch);
+	const void* src2 = eval_block(right, dtype, offset, len, scratch, scratch + block);
+	apply_binary(dtype, expr->op, out, src1, src2, len);
+	return out;
+}
+
+/*
+ * Clips len so the block starting at offset stays contiguous in every leaf.
+ */
+static ulong expr_run(const struct Expr* expr, ulong offset, ulong len){
+	if(expr->op == EXPR_MATRIX)
+		return matrix_run(expr->matrix, offset, len);
+	if(expr->op == EXPR_SCALAR)
+		return len;
+	return expr_run(expr->right, offset, expr_run(expr->left, offset, len));
+}
+
+/*
+ * aliased is set when dst is also a leaf, or doesn't hold the compute
+ * dtype, then blocks are computed in scratch and copied over.
+ */
+struct ExprTask {
+	const struct Expr* expr;
+	const struct Matrix* dst;
+	enum Dtype dtype;
+	uint aliased;
+	uint failed;
+};
+
+static void eval_range(void* arg, ulong begin, ulong end){
+	struct ExprTask* task = arg;
+	const ulong block = (ulong)EXPR_BLOCK * dtype_size(task->dtype);
+	const uint size = dtype_size(task->dst->dtype);
+	char* scratch = malloc_aligned(SIMD_ALIGNMENT,
+			block * (task->expr->depth + 1));
+	if(!scratch){
+		__atomic_store_n(&task->failed, 1, __ATOMIC_RELAXED);
+		return;
+	}
+	for(ulong offset = begin, len; offset < end; offset += len){
+		len = end - offset < EXPR_BLOCK ? end - offset : EXPR_BLOCK;
+		len = expr_run(task->expr, offset, matrix_run(task->dst, offset, len));
+		char* dst = (char*)task->dst->values +
+			matrix_offset(task->dst, offset) * size;
+		char* out = task->aliased ? scratch : dst;
+		const void* result = eval_block(task->expr, task->dtype, offset, len,
+				out, scratch + block);
+		if(result != dst)
+			dtype_convert(dst, task->dst->dtype, result, task->dtype, len);
+	}
+	free(scratch);
+}
+
+struct Matrix* expr_eval_into(struct Matrix* dst, const struct Expr* expr){
+	if(expr->op == EXPR_SCALAR || !expr_valid(expr) ||
+			(ulong)dst->rows * dst->cols != (ulong)expr->rows * expr->cols)
+		return NULL;
+	enum Dtype dtype = dtype_compute(dtype_promote(expr_dtype(expr), dst->dtype));
+	struct ExprTask task = {expr, dst, dtype,
+		expr_uses(expr, dst) || dtype != dst->dtype, 0};
+	ulong len = (ulong)expr->rows * expr->cols;
+	if(len < PARALLEL_THRESHOLD)
+		eval_range(&task, 0, len);
+	else
+		parallel_for(len, PARALLEL_GRAIN, eval_range, &task);
+	return task.failed ? NULL : dst;
+}
+
+struct Matrix* expr_eval(const struct Expr* expr){
+	if(expr->op == EXPR_SCALAR || !expr_valid(expr))
+		return NULL;
+	struct Matrix* result = matrix_new_dtype(expr->rows, expr->cols, 0,
+			expr_dtype(expr));
+	if(!result)
+		return NULL;
+	if(!expr_eval_into(result, expr)){
+		matrix_free(result);
+		return NULL;
+	}
+	return result;
+}
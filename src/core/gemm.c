@@ -0,0 +1,292 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+
+/*
+ * Blocked GEMM, C += op(A) * op(B), all row-major, where op() is either
+ * the identity or the transpose as selected by trans_a/trans_b.
+ *
+ * The loop order follows the usual Goto/BLIS layering:
+ *   jc (NC cols of B, L3) -> pc (KC depth, L2/L1 panel of B)
+ *   -> ic (MC rows of A, L2) -> jr/ir (NR x MR register tile)
+ * A and B panels are packed so the micro kernel reads both
+ * operands with unit stride. The register tile is GEMM_MR x nr, where
+ * nr comes from the dispatched kernel table. The ic loop is spread over
+ * the worker pool once the block is large enough to pay for it.
+ *
+ * Transposition is absorbed by the packing routines, which read the
+ * panels in whichever order the operand is stored, so the NT, TN and TT
+ * cases run the same micro kernel as NN and never materialize a copy.
+ *
+ * The driver itself is in gemm_real.h and is built for float and double.
+ * Matrix products run in the compute dtype of their destination, the
+ * allocating ones promote, so a float32 operand times a float64 one is a
+ * float64 product. Float32 products with an operand of another dtype,
+ * 16 bit storage in particular, run gemm_widen(), which converts while
+ * packing, so only the packed panels ever hold float32 copies.
+ */
+
+#define GEMM_MC 128
+#define GEMM_KC 256
+#define GEMM_NC 4096
+#define GEMM_STRIP 256
+
+#define GEMM_SMALL (32 * 32 * 32)
+#define GEMM_PARALLEL (128 * 128 * 128)
+
+/*
+ * Element (row, col) of op(X) and the start of the op(X) block at (row, col).
+ */
+#define OP_AT(x, ld, trans, row, col) \
+	((trans) ? (x)[(ulong)(col) * (ld) + (row)] : (x)[(ulong)(row) * (ld) + (col)])
+
+#define REAL float
+#define REAL_NAME(name) name
+#define REAL_F32 1
+#include "gemm_real.h"
+#undef REAL
+#undef REAL_NAME
+#undef REAL_F32
+
+#define REAL double
+#define REAL_NAME(name) name##_f64
+#define REAL_F32 0
+#include "gemm_real.h"
+#undef REAL
+#undef REAL_NAME
+#undef REAL_F32
+
+/*
+ * Start of element (row, col) of matrix's storage, and the packing
+ * routines of gemm_widen(). They lay panels out like pack_a() and
+ * pack_b(), converting each contiguous stretch of the operand with
+ * dtype_convert() on the way.
+ */
+static const char* element_at(const struct Matrix* matrix, uint row, uint col){
+	return matrix_row_at(matrix, row) + (ulong)col * dtype_size(matrix->dtype);
+}
+
+static void pack_a_widen(uint mc, uint kc, const struct Matrix* a, uint trans_a,
+		uint ic, uint pc, float* packed){
+	float stage[GEMM_KC];
+	for(uint i = 0; i < mc; i += GEMM_MR){
+		uint mr = mc - i < GEMM_MR ? mc - i : GEMM_MR;
+		for(uint p = 0; p < kc; p++)
+			for(uint r = mr; r < GEMM_MR; r++)
+				packed[p * GEMM_MR + r] = 0;
+		if(trans_a)
+			for(uint p = 0; p < kc; p++)
+				dtype_convert(&packed[p * GEMM_MR], DTYPE_F32,
+						element_at(a, pc + p, ic + i), a->dtype, mr);
+		else
+			for(uint r = 0; r < mr; r++){
+				dtype_convert(stage, DTYPE_F32, element_at(a, ic + i + r, pc), a->dtype, kc);
+				for(uint p = 0; p < kc; p++)
+					packed[p * GEMM_MR + r] = stage[p];
+			}
+		packed += (ulong)kc * GEMM_MR;
+	}
+}
+
+static void pack_b_widen(uint kc, uint nc, uint nr_full, const struct Matrix* b,
+		uint trans_b, uint pc, uint jc, float* packed){
+	float stage[GEMM_KC];
+	for(uint j = 0; j < nc; j += nr_full){
+		uint nr = nc - j < nr_full ? nc - j : nr_full;
+		for(uint p = 0; p < kc; p++)
+			for(uint c = nr; c < nr_full; c++)
+				packed[p * nr_full + c] = 0;
+		if(trans_b)
+			for(uint c = 0; c < nr; c++){
+				dtype_convert(stage, DTYPE_F32, element_at(b, jc + j + c, pc), b->dtype, kc);
+				for(uint p = 0; p < kc; p++)
+					packed[p * nr_full + c] = stage[p];
+			}
+		else
+			for(uint p = 0; p < kc; p++)
+				dtype_convert(&packed[p * nr_full], DTYPE_F32,
+						element_at(b, pc + p, jc + j), b->dtype, nr);
+		packed += (ulong)kc * nr_full;
+	}
+}
+
+struct WidenTask {
+	const struct KernelTable* table;
+	const struct Matrix* a;
+	uint trans_a;
+	uint pc;
+	uint kc;
+	uint nc;
+	uint m;
+	const float* packed_b;
+	float* c;
+	uint ldc;
+	uint failed;
+};
+
+static void widen_tiles(void* arg, ulong begin, ulong end){
+	struct WidenTask* task = arg;
+	ulong strips = (task->nc + GEMM_STRIP - 1) / GEMM_STRIP;
+	float* packed_a = malloc_aligned(SIMD_ALIGNMENT, sizeof(float) * GEMM_MC * GEMM_KC);
+	if(!packed_a){
+		__atomic_store_n(&task->failed, 1, __ATOMIC_RELAXED);
+		return;
+	}
+	ulong packed_block = (ulong)-1;
+	for(ulong tile = begin; tile < end; tile++){
+		ulong block = tile / strips;
+		uint ic = block * GEMM_MC;
+		uint jt = (tile % strips) * GEMM_STRIP;
+		uint mc = task->m - ic < GEMM_MC ? task->m - ic : GEMM_MC;
+		uint nt = task->nc - jt < GEMM_STRIP ? task->nc - jt : GEMM_STRIP;
+		if(packed_block != block){
+			pack_a_widen(mc, task->kc, task->a, task->trans_a, ic, task->pc, packed_a);
+			packed_block = block;
+		}
+		macro_kernel(task->table, mc, nt, task->kc, packed_a,
+				&task->packed_b[jt * task->kc], &task->c[(ulong)ic * task->ldc + jt], task->ldc);
+	}
+	free(packed_a);
+}
+
+/*
+ * C += op(A) * op(B) in float32 for operands of any dtype. 0 when the
+ * panels can't be allocated.
+ */
+static uint gemm_widen(uint trans_a, uint trans_b, uint m, uint n, uint k,
+		const struct Matrix* a, const struct Matrix* b, float* c, uint ldc){
+	if(!m || !n || !k)
+		return 1;
+	const struct KernelTable* table = kernels;
+	float* packed_b = malloc_aligned(SIMD_ALIGNMENT,
+			sizeof(float) * GEMM_KC * (GEMM_NC + GEMM_NR_MAX));
+	if(!packed_b)
+		return 0;
+	uint failed = 0;
+	for(uint jc = 0; !failed && jc < n; jc += GEMM_NC){
+		uint nc = n - jc < GEMM_NC ? n - jc : GEMM_NC;
+		for(uint pc = 0; !failed && pc < k; pc += GEMM_KC){
+			uint kc = k - pc < GEMM_KC ? k - pc : GEMM_KC;
+			pack_b_widen(kc, nc, table->gemm_nr, b, trans_b, pc, jc, packed_b);
+			struct WidenTask task = {table, a, trans_a, pc, kc, nc, m,
+				packed_b, &c[jc], ldc, 0};
+			ulong tiles = (ulong)((m + GEMM_MC - 1) / GEMM_MC) *
+				((nc + GEMM_STRIP - 1) / GEMM_STRIP);
+			if((ulong)m * nc * kc < GEMM_PARALLEL)
+				widen_tiles(&task, 0, tiles);
+			else
+				parallel_for(tiles, 1, widen_tiles, &task);
+			failed = task.failed;
+		}
+	}
+	free(packed_b);
+	return !failed;
+}
+
+/*
+ * Accumulates op(matrix1) * op(matrix2) into dst. A float64 dst gets its
+ * operands converted first, a 16 bit one accumulates into a float32
+ * temporary that is narrowed once at the end. Square products up to
+ * SMALL_MAX skip gemm for the unrolled code. 0 when an allocation fails.
+ */
+static uint mul_values(struct Matrix* dst, const struct Matrix* matrix1, uint trans1,
+		const struct Matrix* matrix2, uint trans2, uint m, uint n, uint k){
+	if(m == n && n == k && n && n <= SMALL_MAX){
+		small_mul(dst, matrix1, trans1, matrix2, trans2);
+		return 1;
+	}
+	if(dst->dtype != DTYPE_F64 && (dst->dtype != DTYPE_F32 ||
+				matrix1->dtype != DTYPE_F32 || matrix2->dtype != DTYPE_F32)){
+		struct Matrix* temp = NULL;
+		struct Matrix* c = dst;
+		if(dst->dtype != DTYPE_F32 && !(c = temp = matrix_new(m, n, 0)))
+			return 0;
+		uint result = gemm_widen(trans1, trans2, m, n, k, matrix1, matrix2,
+				c->values, c->ld);
+		if(result && temp)
+			matrix_copy_values(dst, temp);
+		matrix_free(temp);
+		return result;
+	}
+	struct Matrix* temp1;
+	struct Matrix* temp2;
+	const struct Matrix* src1 = matrix_cast(matrix1, dst->dtype, &temp1);
+	const struct Matrix* src2 = matrix_cast(matrix2, dst->dtype, &temp2);
+	uint result = src1 && src2;
+	if(result && dst->dtype == DTYPE_F64)
+		gemm_trans_f64(trans1, trans2, m, n, k, src1->values_f64, src1->ld,
+				src2->values_f64, src2->ld, dst->values_f64, dst->ld);
+	else if(result)
+		gemm_trans(trans1, trans2, m, n, k, src1->values, src1->ld,
+				src2->values, src2->ld, dst->values, dst->ld);
+	matrix_free(temp1);
+	matrix_free(temp2);
+	return result;
+}
+
+struct Matrix* matrix_mul_into(struct Matrix* dst,
+		struct Matrix* matrix1, struct Matrix* matrix2){
+	if(dst->rows != matrix1->rows || dst->cols != matrix2->cols ||
+			dst == matrix1 || dst == matrix2)
+		return NULL;
+	matrix_clear(dst);
+	if(!mul_values(dst, matrix1, 0, matrix2, 0,
+				matrix1->rows, matrix2->cols, matrix1->cols))
+		return NULL;
+	return dst;
+}
+
+struct Matrix* matrix_mul(struct Matrix* matrix1, struct Matrix* matrix2){
+	struct Matrix* result = matrix_new_dtype(matrix1->rows, matrix2->cols, 0,
+			dtype_promote(matrix1->dtype, matrix2->dtype));
+	if(!result)
+		return NULL;
+	if(!mul_values(result, matrix1, 0, matrix2, 0,
+				matrix1->rows, matrix2->cols, matrix1->cols)){
+		matrix_free(result);
+		return NULL;
+	}
+	return result;
+}
+
+/*
+ * op(matrix1) * op(matrix2) with op() the transpose when trans1/trans2
+ * are set, read straight from the untransposed storage.
+ */
+struct Matrix* matrix_mul_trans_into(struct Matrix* dst,
+		struct Matrix* matrix1, uint trans1, struct Matrix* matrix2, uint trans2){
+	uint m = trans1 ? matrix1->cols : matrix1->rows;
+	uint k = trans1 ? matrix1->rows : matrix1->cols;
+	uint n = trans2 ? matrix2->rows : matrix2->cols;
+	if((trans2 ? matrix2->cols : matrix2->rows) != k ||
+			dst->rows != m || dst->cols != n || dst == matrix1 || dst == matrix2)
+		return NULL;
+	matrix_clear(dst);
+	if(!mul_values(dst, matrix1, trans1, matrix2, trans2, m, n, k))
+		return NULL;
+	return dst;
+}
+
+struct Matrix* matrix_mul_trans(struct Matrix* matrix1, uint trans1,
+		struct Matrix* matrix2, uint trans2){
+	struct Matrix* result = matrix_new_dtype(trans1 ? matrix1->cols : matrix1->rows,
+			trans2 ? matrix2->rows : matrix2->cols, 0,
+			dtype_promote(matrix1->dtype, matrix2->dtype));
+	if(!result)
+		return NULL;
+	if(!matrix_mul_trans_into(result, matrix1, trans1, matrix2, trans2)){
+		matrix_free(result);
+		return NULL;
+	}
+	return result;
+}
@@ -0,0 +1,15 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#include "config.h"
+
+#if HAVE_SSE
+#pragma GCC target("avx2,fma,f16c")
+#define SIMD_ISA_AVX2 1
+#define KERNEL_ISA avx2
+#include "kernel_template.h"
+#endif
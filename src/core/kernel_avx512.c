@@ -0,0 +1,15 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#include "config.h"
+
+#if HAVE_SSE
+#pragma GCC target("avx512f,avx2,fma,f16c")
+#define SIMD_ISA_AVX512 1
+#define KERNEL_ISA avx512
+#include "kernel_template.h"
+#endif
@@ -0,0 +1,14 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#include "config.h"
+
+#if HAVE_SSE
+#define SIMD_ISA_SSE 1
+#define KERNEL_ISA sse
+#include "kernel_template.h"
+#endif
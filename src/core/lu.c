@@ -0,0 +1,198 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#include "config.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+
+/*
+ * Blocked right-looking LU with partial pivoting, P * A = L * U.
+ *
+ * Each LU_BLOCK wide column panel is factored with row operations, the
+ * block row of U to its right is solved against the unit lower triangle,
+ * and the trailing matrix gets the rank-LU_BLOCK update through gemm,
+ * which is where almost all of the flops go. Solves use the same
+ * blocking, so many right-hand sides also run mostly inside gemm.
+ * Both live in lu_real.h, built for float and double.
+ */
+
+#define LU_BLOCK 64
+
+static uint min_uint(uint value1, uint value2){
+	return value1 < value2 ? value1 : value2;
+}
+
+#define REAL float
+#define REAL_NAME(name) name
+#include "lu_real.h"
+#undef REAL
+#undef REAL_NAME
+
+#define REAL double
+#define REAL_NAME(name) name##_f64
+#include "lu_real.h"
+#undef REAL
+#undef REAL_NAME
+
+/*
+ * The factors are in the compute dtype of matrix.
+ */
+struct LU* matrix_lu(struct Matrix* matrix){
+	if(matrix->rows != matrix->cols)
+		return NULL;
+	const uint n = matrix->rows;
+	const uint size = dtype_size(dtype_compute(matrix->dtype));
+	struct LU* lu = malloc(sizeof(struct LU));
+	if(!lu)
+		return NULL;
+	lu->size = n;
+	lu->singular = 0;
+	lu->dtype = dtype_compute(matrix->dtype);
+	lu->values = malloc_aligned_wide(SIMD_ALIGNMENT, (ulong)size * n * n);
+	lu->pivots = malloc(sizeof(uint) * (n ? n : 1));
+	void* work = malloc_aligned_wide(SIMD_ALIGNMENT, (ulong)size * LU_BLOCK * n);
+	if(!lu->values || !lu->pivots || !work){
+		free(work);
+		lu_free(lu);
+		return NULL;
+	}
+	struct Matrix packed = {.values = lu->values, .rows = n, .cols = n,
+		.rows_cap = n, .cols_cap = n, .ld = n, .dtype = lu->dtype};
+	matrix_copy_values(&packed, matrix);
+	if(lu->dtype == DTYPE_F64)
+		lu_factor_f64(lu, lu->values_f64, work);
+	else
+		lu_factor(lu, lu->values, work);
+	free(work);
+	return lu;
+}
+
+void lu_free(struct LU* lu){
+	if(!lu)
+		return;
+	free(lu->values);
+	free(lu->pivots);
+	free(lu);
+}
+
+/*
+ * Solves in the dtype of the factors. A dst of another dtype receives
+ * the converted solution.
+ */
+struct Matrix* lu_solve_into(struct Matrix* dst, struct LU* lu,
+		struct Matrix* matrix){
+	const uint n = lu->size;
+	const uint m = matrix->cols;
+	if(lu->singular || matrix->rows != n || dst->rows != n || dst->cols != m)
+		return NULL;
+	struct Matrix* temp = NULL;
+	struct Matrix* x = dst;
+	if(dst->dtype != lu->dtype){
+		x = temp = matrix_new_dtype(n, m, 0, lu->dtype);
+		if(!temp)
+			return NULL;
+	}
+	void* work = malloc_aligned_wide(SIMD_ALIGNMENT,
+			(ulong)dtype_size(lu->dtype) * LU_BLOCK * n);
+	if(!work){
+		matrix_free(temp);
+		return NULL;
+	}
+	matrix_copy_values(x, matrix);
+	if(lu->dtype == DTYPE_F64)
+		lu_substitute_f64(lu, lu->values_f64, x->values_f64, x->ld, m, work);
+	else
+		lu_substitute(lu, lu->values, x->values, x->ld, m, work);
+	free(work);
+	if(temp){
+		matrix_copy_values(dst, temp);
+		matrix_free(temp);
+	}
+	return dst;
+}
+
+struct Matrix* lu_solve(struct LU* lu, struct Matrix* matrix){
+	struct Matrix* result = matrix_new_dtype(lu->size, matrix->cols, 0,
+			dtype_promote(lu->dtype, matrix->dtype));
+	if(!result)
+		return NULL;
+	if(!lu_solve_into(result, lu, matrix)){
+		matrix_free(result);
+		return NULL;
+	}
+	return result;
+}
+
+/*
+ * Mixed dtypes factor in the promoted one.
+ */
+struct Matrix* matrix_solve(struct Matrix* matrix1, struct Matrix* matrix2){
+	struct Matrix* temp;
+	const struct Matrix* matrix = matrix_cast(matrix1,
+			dtype_promote(matrix1->dtype, matrix2->dtype), &temp);
+	struct LU* lu = matrix ? matrix_lu((struct Matrix*)matrix) : NULL;
+	matrix_free(temp);
+	if(!lu)
+		return NULL;
+	struct Matrix* result = lu_solve(lu, matrix2);
+	lu_free(lu);
+	return result;
+}
+
+/*
+ * Up to SMALL_MAX in closed form, larger through LU.
+ */
+struct Matrix* matrix_inverse(struct Matrix* matrix, uint* invertible){
+	*invertible = 0;
+	if(matrix->rows == matrix->cols && matrix->rows && matrix->rows <= SMALL_MAX)
+		return small_inverse(matrix, invertible);
+	struct LU* lu = matrix_lu(matrix);
+	if(!lu)
+		return NULL;
+	struct Matrix* result = NULL;
+	if(!lu->singular){
+		result = matrix_identity_dtype(lu->size, matrix->dtype);
+		if(result && !lu_solve_into(result, lu, result)){
+			matrix_free(result);
+			result = NULL;
+		}
+		*invertible = result != NULL;
+	}
+	lu_free(lu);
+	return result;
+}
+
+/*
+ * Up to SMALL_MAX in closed form, larger as the signed product of the LU
+ * pivots. 0 when matrix isn't square or the factors can't be allocated.
+ */
+uint matrix_det(struct Matrix* matrix, double* det){
+	if(matrix->rows != matrix->cols)
+		return 0;
+	if(matrix->rows <= SMALL_MAX){
+		*det = small_det(matrix);
+		return 1;
+	}
+	struct LU* lu = matrix_lu(matrix);
+	if(!lu)
+		return 0;
+	const uint n = lu->size;
+	double result = !lu->singular;
+	for(uint i = 0; i < n && result; i++){
+		result *= lu->dtype == DTYPE_F64 ? lu->values_f64[(ulong)i * n + i] :
+			lu->values[(ulong)i * n + i];
+		if(lu->pivots[i] != i)
+			result = -result;
+	}
+	lu_free(lu);
+	*det = result;
+	return 1;
+}
@@ -0,0 +1,174 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#include "config.h"
+
+#include <math.h>
+#include <stddef.h>
+
+#include "common.h"
+
+/*
+ * Elementwise math functions.
+ *
+ * Like the arith ops these run in the compute dtype of dst, walking dst
+ * and src one contiguous run at a time in PARALLEL_GRAIN element chunks
+ * across threads when large. float32 goes through the map kernel (its
+ * error bounds are listed in the kernel template), with 16 bit operands
+ * or dst staged through MAP_STAGE element buffers. float64 uses libm
+ * element by element, src converted up front when it is another dtype.
+ */
+
+#define MAP_STAGE 256
+#define MATRIX_SIZE(matrix) ((ulong)(matrix)->rows * (matrix)->cols)
+
+struct MapTask {
+	const struct Matrix* dst;
+	const struct Matrix* src;
+	enum MapFn fn;
+	double param1;
+	double param2;
+};
+
+static struct Matrix vector_layout(const struct Vector* vector){
+	struct Matrix layout = {.values = vector->values, .rows = 1, .cols = vector->len,
+		.rows_cap = 1, .cols_cap = vector->len, .ld = vector->len,
+		.dtype = vector->dtype};
+	return layout;
+}
+
+static void* at(const struct Matrix* matrix, ulong index){
+	return (char*)matrix->values +
+		matrix_offset(matrix, index) * dtype_size(matrix->dtype);
+}
+
+static double map_f64(double value, enum MapFn fn, double param1, double param2){
+	switch(fn){
+		case MAP_EXP:
+			return exp(value);
+		case MAP_LOG:
+			return log(value);
+		case MAP_TANH:
+			return tanh(value);
+		case MAP_SIGMOID:
+			return value < 0 ? exp(value) / (1 + exp(value)) : 1 / (1 + exp(-value));
+		case MAP_ERF:
+			return erf(value);
+		case MAP_SQRT:
+			return sqrt(value);
+		case MAP_RSQRT:
+			return 1 / sqrt(value);
+		case MAP_ABS:
+			return fabs(value);
+		case MAP_CLAMP:
+			return value < param1 ? param1 : value > param2 ? param2 : value;
+		default:
+			return pow(value, param1);
+	}
+}
+
+static void map_run_f64(double* dst, const double* src, ulong len, const struct MapTask* task){
+	for(ulong i = 0; i < len; i++)
+		dst[i] = map_f64(src[i], task->fn, task->param1, task->param2);
+}
+
+static void map_staged(const struct MapTask* task, ulong index, ulong len){
+	float stage[MAP_STAGE];
+	for(ulong step; len; index += step, len -= step){
+		step = len < MAP_STAGE ? len : MAP_STAGE;
+		const float* src = stage;
+		if(task->src->dtype == DTYPE_F32)
+			src = at(task->src, index);
+		else
+			dtype_convert(stage, DTYPE_F32, at(task->src, index), task->src->dtype, step);
+		float* dst = task->dst->dtype == DTYPE_F32 ? at(task->dst, index) : stage;
+		kernel_map(dst, src, step, task->fn, (float)task->param1, (float)task->param2);
+		if(task->dst->dtype != DTYPE_F32)
+			dtype_convert(at(task->dst, index), task->dst->dtype, stage, DTYPE_F32, step);
+	}
+}
+
+static void map_chunk(void* arg, ulong begin, ulong end){
+	struct MapTask* task = arg;
+	uint staged = task->dst->dtype != DTYPE_F32 || task->src->dtype != DTYPE_F32;
+	for(ulong index = begin, len; index < end; index += len){
+		len = matrix_run(task->dst, index, end - index);
+		len = matrix_run(task->src, index, len);
+		if(task->dst->dtype == DTYPE_F64)
+			map_run_f64(at(task->dst, index), at(task->src, index), len, task);
+		else if(staged)
+			map_staged(task, index, len);
+		else
+			kernel_map(at(task->dst, index), at(task->src, index), len, task->fn,
+					(float)task->param1, (float)task->param2);
+	}
+}
+
+static uint run_map(const struct Matrix* dst, const struct Matrix* src, enum MapFn fn,
+		double param1, double param2){
+	struct Matrix* temp = NULL;
+	if(dst->dtype == DTYPE_F64)
+		src = matrix_cast(src, DTYPE_F64, &temp);
+	if(!src)
+		return 0;
+	struct MapTask task = {dst, src, fn, param1, param2};
+	ulong size = MATRIX_SIZE(dst);
+	if(size < PARALLEL_THRESHOLD)
+		map_chunk(&task, 0, size);
+	else
+		parallel_for(size, PARALLEL_GRAIN, map_chunk, &task);
+	matrix_free(temp);
+	return 1;
+}
+
+/*
+ * dst may be matrix itself for an in place map, but must not partially
+ * overlap it.
+ */
+struct Matrix* matrix_map_into(struct Matrix* dst, struct Matrix* matrix,
+		enum MapFn fn, double param1, double param2){
+	if(dst->rows != matrix->rows || dst->cols != matrix->cols)
+		return NULL;
+	if(!run_map(dst, matrix, fn, param1, param2))
+		return NULL;
+	return dst;
+}
+
+struct Matrix* matrix_map(struct Matrix* matrix, enum MapFn fn,
+		double param1, double param2){
+	struct Matrix* result = matrix_new_dtype(matrix->rows, matrix->cols, 0, matrix->dtype);
+	if(!result)
+		return NULL;
+	if(!matrix_map_into(result, matrix, fn, param1, param2)){
+		matrix_free(result);
+		return NULL;
+	}
+	return result;
+}
+
+struct Vector* vector_map_into(struct Vector* dst, struct Vector* vector,
+		enum MapFn fn, double param1, double param2){
+	if(dst->len != vector->len)
+		return NULL;
+	struct Matrix layout = vector_layout(dst);
+	struct Matrix source = vector_layout(vector);
+	if(!run_map(&layout, &source, fn, param1, param2))
+		return NULL;
+	return dst;
+}
+
+struct Vector* vector_map(struct Vector* vector, enum MapFn fn,
+		double param1, double param2){
+	struct Vector* result = vector_new_dtype(vector->len, 0, vector->dtype);
+	if(!result)
+		return NULL;
+	if(!vector_map_into(result, vector, fn, param1, param2)){
+		vector_free(result);
+		return NULL;
+	}
+	return result;
+}
@@ -0,0 +1,316 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#include "config.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "common.h"
+
+/*
+ * Elementwise comparisons into packed masks, and allclose.
+ *
+ * Operands compare in the compute dtype of the promoted one like the
+ * uint returning comparisons of arith.c, float64 operands converted up
+ * front and 16 bit ones staged MASK_STAGE elements at a time. The kernels
+ * write each piece of up to MASK_STAGE elements as whole words, which are
+ * then shifted into place in the mask since a piece needn't start on a
+ * word. Large matrices are split across threads in PARALLEL_GRAIN element
+ * chunks, a multiple of 64, so no two threads write the same word.
+ *
+ * allclose shares a flag between the chunks, each of which stops at its
+ * first failing vector and makes the others skip their remaining runs.
+ */
+
+#define MASK_STAGE 256
+#define MATRIX_SIZE(matrix) ((ulong)(matrix)->rows * (matrix)->cols)
+
+struct MaskTask {
+	struct Mask* mask;
+	const struct Matrix* src1;
+	const struct Matrix* src2;
+	double scalar;
+	enum CmpOp op;
+};
+
+struct CloseTask {
+	const struct Matrix* src1;
+	const struct Matrix* src2;
+	double rtol;
+	double atol;
+	uint close;
+};
+
+static struct Matrix vector_layout(const struct Vector* vector){
+	struct Matrix layout = {.values = vector->values, .rows = 1, .cols = vector->len,
+		.rows_cap = 1, .cols_cap = vector->len, .ld = vector->len,
+		.dtype = vector->dtype};
+	return layout;
+}
+
+static void* at(const struct Matrix* matrix, ulong index){
+	return (char*)matrix->values +
+		matrix_offset(matrix, index) * dtype_size(matrix->dtype);
+}
+
+static ulong run_length(const struct Matrix* src1, const struct Matrix* src2,
+		ulong index, ulong len){
+	len = matrix_run(src1, index, len);
+	return src2 ? matrix_run(src2, index, len) : len;
+}
+
+static const float* stage_in(const struct Matrix* matrix, ulong index, ulong len,
+		float* stage){
+	if(matrix->dtype == DTYPE_F32)
+		return at(matrix, index);
+	dtype_convert(stage, DTYPE_F32, at(matrix, index), matrix->dtype, len);
+	return stage;
+}
+
+static ulong mask_words(uint rows, uint cols){
+	return (ulong)rows * cols / 64 + 1;
+}
+
+static struct Mask* mask_alloc(uint rows, uint cols){
+	struct Mask* mask = pool_alloc(sizeof(struct Mask));
+	if(!mask)
+		return NULL;
+	mask->bits = pool_alloc(mask_words(rows, cols) * sizeof(ulong));
+	if(!mask->bits){
+		pool_free(mask);
+		return NULL;
+	}
+	memset(mask->bits, 0, mask_words(rows, cols) * sizeof(ulong));
+	mask->rows = rows;
+	mask->cols = cols;
+	return mask;
+}
+
+/*
+ * ORs the len bits of words, which start at bit 0, into bits from bit
+ * index on. Only words holding one of those bits are touched.
+ */
+static void mask_splice(ulong* bits, ulong index, const ulong* words, ulong len){
+	const uint shift = index % 64;
+	bits += index / 64;
+	for(ulong w = 0; w * 64 < len; w++){
+		bits[w] |= words[w] << shift;
+		if(shift && w * 64 + 64 - shift < len)
+			bits[w + 1] |= words[w] >> (64 - shift);
+	}
+}
+
+static void mask_chunk(void* arg, ulong begin, ulong end){
+	struct MaskTask* task = arg;
+	const struct Matrix* src1 = task->src1;
+	const struct Matrix* src2 = task->src2;
+	float stage1[MASK_STAGE];
+	float stage2[MASK_STAGE];
+	ulong words[MASK_STAGE / 64];
+	for(ulong index = begin, len; index < end; index += len){
+		len = run_length(src1, src2, index, end - index);
+		if(len > MASK_STAGE)
+			len = MASK_STAGE;
+		if(src1->dtype == DTYPE_F64 && src2)
+			kernel_cmp_bits_f64(words, at(src1, index), at(src2, index), len, task->op);
+		else if(src1->dtype == DTYPE_F64)
+			kernel_cmp_scalar_bits_f64(words, at(src1, index), task->scalar, len, task->op);
+		else if(src2)
+			kernel_cmp_bits(words, stage_in(src1, index, len, stage1),
+					stage_in(src2, index, len, stage2), len, task->op);
+		else
+			kernel_cmp_scalar_bits(words, stage_in(src1, index, len, stage1),
+					(float)task->scalar, len, task->op);
+		mask_splice(task->mask->bits, index, words, len);
+	}
+}
+
+/*
+ * matrix2 NULL compares matrix1 with scalar.
+ */
+static struct Mask* run_mask(const struct Matrix* matrix1, const struct Matrix* matrix2,
+		double scalar, enum CmpOp op){
+	enum Dtype dtype = dtype_compute(matrix2 ?
+			dtype_promote(matrix1->dtype, matrix2->dtype) : matrix1->dtype);
+	struct Matrix* temp1 = NULL;
+	struct Matrix* temp2 = NULL;
+	const struct Matrix* src1 = matrix1;
+	const struct Matrix* src2 = matrix2;
+	if(dtype == DTYPE_F64){
+		src1 = matrix_cast(matrix1, dtype, &temp1);
+		if(matrix2)
+			src2 = matrix_cast(matrix2, dtype, &temp2);
+	}
+	struct Mask* mask = NULL;
+	if(src1 && (src2 || !matrix2))
+		mask = mask_alloc(matrix1->rows, matrix1->cols);
+	if(mask){
+		struct MaskTask task = {mask, src1, src2, scalar, op};
+		ulong size = MATRIX_SIZE(matrix1);
+		if(size < PARALLEL_THRESHOLD)
+			mask_chunk(&task, 0, size);
+		else
+			parallel_for(size, PARALLEL_GRAIN, mask_chunk, &task);
+	}
+	matrix_free(temp1);
+	matrix_free(temp2);
+	return mask;
+}
+
+static void close_chunk(void* arg, ulong begin, ulong end){
+	struct CloseTask* task = arg;
+	const struct Matrix* src1 = task->src1;
+	const struct Matrix* src2 = task->src2;
+	uint staged = src1->dtype != DTYPE_F32 || src2->dtype != DTYPE_F32;
+	float stage1[MASK_STAGE];
+	float stage2[MASK_STAGE];
+	for(ulong index = begin, len; index < end; index += len){
+		if(!__atomic_load_n(&task->close, __ATOMIC_RELAXED))
+			return;
+		len = run_length(src1, src2, index, end - index);
+		uint close;
+		if(src1->dtype == DTYPE_F64)
+			close = kernel_allclose_f64(at(src1, index), at(src2, index), len,
+					task->rtol, task->atol);
+		else if(staged){
+			len = len < MASK_STAGE ? len : MASK_STAGE;
+			close = kernel_allclose(stage_in(src1, index, len, stage1),
+					stage_in(src2, index, len, stage2), len,
+					(float)task->rtol, (float)task->atol);
+		}
+		else
+			close = kernel_allclose(at(src1, index), at(src2, index), len,
+					(float)task->rtol, (float)task->atol);
+		if(!close)
+			__atomic_store_n(&task->close, 0, __ATOMIC_RELAXED);
+	}
+}
+
+static uint run_allclose(const struct Matrix* matrix1, const struct Matrix* matrix2,
+		double rtol, double atol){
+	if(matrix1->rows != matrix2->rows || matrix1->cols != matrix2->cols)
+		return 0;
+	enum Dtype dtype = dtype_compute(dtype_promote(matrix1->dtype, matrix2->dtype));
+	struct Matrix* temp1 = NULL;
+	struct Matrix* temp2 = NULL;
+	const struct Matrix* src1 = matrix1;
+	const struct Matrix* src2 = matrix2;
+	if(dtype == DTYPE_F64){
+		src1 = matrix_cast(matrix1, dtype, &temp1);
+		src2 = matrix_cast(matrix2, dtype, &temp2);
+	}
+	struct CloseTask task = {src1, src2, rtol, atol, src1 && src2};
+	ulong size = MATRIX_SIZE(matrix1);
+	if(task.close && size < PARALLEL_THRESHOLD)
+		close_chunk(&task, 0, size);
+	else if(task.close)
+		parallel_for(size, PARALLEL_GRAIN, close_chunk, &task);
+	matrix_free(temp1);
+	matrix_free(temp2);
+	return task.close;
+}
+
+void mask_free(struct Mask* mask){
+	if(!mask)
+		return;
+	pool_free(mask->bits);
+	pool_free(mask);
+}
+
+ulong mask_count_nonzero(struct Mask* mask){
+	ulong count = 0;
+	const ulong words = mask_words(mask->rows, mask->cols);
+	for(ulong w = 0; w < words; w++)
+		count += __builtin_popcountl(mask->bits[w]);
+	return count;
+}
+
+/*
+ * float32 matrix of 1 where the mask is set and 0 elsewhere.
+ */
+struct Matrix* mask_to_matrix(struct Mask* mask){
+	struct Matrix* result = matrix_new(mask->rows, mask->cols, 0);
+	if(!result)
+		return NULL;
+	for(uint i = 0; i < mask->rows; i++)
+		for(uint j = 0; j < mask->cols; j++)
+			*matrix_get(result, i, j) = (float)mask_get(mask, i, j);
+	return result;
+}
+
+/*
+ * NULL when the shapes don't match.
+ */
+#define MATRIX_CMP_MASK(name, op) \
+	struct Mask* name(struct Matrix* matrix1, struct Matrix* matrix2){ \
+		if(matrix1->rows != matrix2->rows || matrix1->cols != matrix2->cols) \
+			return NULL; \
+		return run_mask(matrix1, matrix2, 0, op); \
+	}
+
+#define MATRIX_CMP_SCALAR_MASK(name, op) \
+	struct Mask* name(struct Matrix* matrix, double scalar){ \
+		return run_mask(matrix, NULL, scalar, op); \
+	}
+
+#define VECTOR_CMP_MASK(name, op) \
+	struct Mask* name(struct Vector* vector1, struct Vector* vector2){ \
+		if(vector1->len != vector2->len) \
+			return NULL; \
+		struct Matrix layout1 = vector_layout(vector1); \
+		struct Matrix layout2 = vector_layout(vector2); \
+		return run_mask(&layout1, &layout2, 0, op); \
+	}
+
+#define VECTOR_CMP_SCALAR_MASK(name, op) \
+	struct Mask* name(struct Vector* vector, double scalar){ \
+		struct Matrix layout = vector_layout(vector); \
+		return run_mask(&layout, NULL, scalar, op); \
+	}
+
+MATRIX_CMP_MASK(matrix_eq_mask, CMP_EQ)
+MATRIX_CMP_MASK(matrix_neq_mask, CMP_NEQ)
+MATRIX_CMP_MASK(matrix_gt_mask, CMP_GT)
+MATRIX_CMP_MASK(matrix_ge_mask, CMP_GE)
+MATRIX_CMP_MASK(matrix_lt_mask, CMP_LT)
+MATRIX_CMP_MASK(matrix_le_mask, CMP_LE)
+MATRIX_CMP_SCALAR_MASK(matrix_eq_scalar_mask, CMP_EQ)
+MATRIX_CMP_SCALAR_MASK(matrix_neq_scalar_mask, CMP_NEQ)
+MATRIX_CMP_SCALAR_MASK(matrix_gt_scalar_mask, CMP_GT)
+MATRIX_CMP_SCALAR_MASK(matrix_ge_scalar_mask, CMP_GE)
+MATRIX_CMP_SCALAR_MASK(matrix_lt_scalar_mask, CMP_LT)
+MATRIX_CMP_SCALAR_MASK(matrix_le_scalar_mask, CMP_LE)
+
+VECTOR_CMP_MASK(vector_eq_mask, CMP_EQ)
+VECTOR_CMP_MASK(vector_neq_mask, CMP_NEQ)
+VECTOR_CMP_MASK(vector_gt_mask, CMP_GT)
+VECTOR_CMP_MASK(vector_ge_mask, CMP_GE)
+VECTOR_CMP_MASK(vector_lt_mask, CMP_LT)
+VECTOR_CMP_MASK(vector_le_mask, CMP_LE)
+VECTOR_CMP_SCALAR_MASK(vector_eq_scalar_mask, CMP_EQ)
+VECTOR_CMP_SCALAR_MASK(vector_neq_scalar_mask, CMP_NEQ)
+VECTOR_CMP_SCALAR_MASK(vector_gt_scalar_mask, CMP_GT)
+VECTOR_CMP_SCALAR_MASK(vector_ge_scalar_mask, CMP_GE)
+VECTOR_CMP_SCALAR_MASK(vector_lt_scalar_mask, CMP_LT)
+VECTOR_CMP_SCALAR_MASK(vector_le_scalar_mask, CMP_LE)
+
+/*
+ * Whether every |matrix1 - matrix2| <= atol + rtol * |matrix2| elementwise,
+ * 0 when the shapes don't match.
+ */
+uint matrix_allclose(struct Matrix* matrix1, struct Matrix* matrix2,
+		double rtol, double atol){
+	return run_allclose(matrix1, matrix2, rtol, atol);
+}
+
+uint vector_allclose(struct Vector* vector1, struct Vector* vector2,
+		double rtol, double atol){
+	struct Matrix layout1 = vector_layout(vector1);
+	struct Matrix layout2 = vector_layout(vector2);
+	return run_allclose(&layout1, &layout2, rtol, atol);
+}
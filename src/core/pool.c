@@ -0,0 +1,371 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+#include "common.h"
+
+/*
+ * Pooled allocator for matrix and vector storage.
+ *
+ * Requests are rounded up to power of two size classes from 64 bytes to
+ * POOL_MAX_BYTES, anything larger goes straight to the system. Every
+ * block carries a SIMD_ALIGNMENT sized header in front of the returned
+ * pointer, so user memory stays SIMD aligned and the class is known on
+ * free. Freed blocks go to a per thread free list of their class, up to
+ * POOL_CACHE_BYTES per class, so same shape temporaries are recycled
+ * without touching malloc or any lock.
+ *
+ * An arena scope links every block allocated inside it into a list.
+ * crunum_arena_end frees whatever is still live in one sweep,
+ * crunum_arena_leave keeps the survivors and hands them to the enclosing
+ * scope. Arenas belong to the thread that opened them and only that
+ * thread touches their lists: a block of an arena freed on another thread
+ * is just marked BLOCK_FREED and released by the owner when the arena
+ * ends or is left, so its memory lingers until then. A block must not be
+ * freed while its arena is ending.
+ *
+ * A thread's cache is trimmed when the thread exits.
+ */
+
+#define POOL_MIN_SHIFT 6
+#define POOL_CLASSES 18
+#define POOL_MAX_BYTES ((ulong)1 << (POOL_MIN_SHIFT + POOL_CLASSES - 1))
+#define POOL_CACHE_BYTES ((ulong)16 << 20)
+#define POOL_CACHE_MIN 4
+#define POOL_LARGE POOL_CLASSES
+
+/*
+ * States of a block allocated inside an arena, changed atomically since
+ * a thread other than the owner may free the block.
+ */
+enum BlockState {
+	BLOCK_LIVE,
+	BLOCK_FREED,
+	BLOCK_UNTRACKED,
+};
+
+struct PoolArena;
+struct PoolCache;
+
+struct PoolBlock {
+	struct PoolBlock* next;
+	struct PoolBlock* prev;
+	struct PoolArena* arena;
+	struct PoolCache* owner;
+	ulong size;
+	uint size_class;
+	uint state;
+};
+
+struct PoolArena {
+	struct PoolBlock* blocks;
+	struct PoolArena* parent;
+};
+
+struct PoolCache {
+	struct PoolBlock* free[POOL_CLASSES];
+	uint count[POOL_CLASSES];
+	struct PoolArena* arena;
+	uint registered;
+};
+
+static __thread struct PoolCache cache;
+static struct PoolStats stats;
+
+#if HAVE_PTHREAD_H
+static pthread_key_t cache_key;
+static pthread_once_t cache_key_once = PTHREAD_ONCE_INIT;
+
+static void cache_exit(void* unused){
+	(void)unused;
+	crunum_pool_trim();
+}
+
+static void cache_key_create(void){
+	pthread_key_create(&cache_key, cache_exit);
+}
+
+/*
+ * Arms cache_exit for the calling thread once it caches a block.
+ */
+static void cache_register(void){
+	if(cache.registered)
+		return;
+	cache.registered = 1;
+	pthread_once(&cache_key_once, cache_key_create);
+	pthread_setspecific(cache_key, &cache);
+}
+#else
+static void cache_register(void){
+}
+#endif
+
+void* malloc_aligned_wide(uint alignment, ulong size){
+#if HAVE_POSIX_MEMALIGN
+	void* result;
+	if(posix_memalign(&result, alignment, size ? size : alignment))
+		return NULL;
+	return result;
+#else
+	return size <= (uint)-1 ? malloc_aligned(alignment, (uint)size) : NULL;
+#endif
+}
+
+static void stat_add(ulong* counter, ulong value){
+	__atomic_fetch_add(counter, value, __ATOMIC_RELAXED);
+}
+
+static void stat_sub(ulong* counter, ulong value){
+	__atomic_fetch_sub(counter, value, __ATOMIC_RELAXED);
+}
+
+static struct PoolBlock* block_of(void* ptr){
+	return (struct PoolBlock*)((char*)ptr - SIMD_ALIGNMENT);
+}
+
+static void* block_data(struct PoolBlock* block){
+	return (char*)block + SIMD_ALIGNMENT;
+}
+
+static uint size_class(ulong size){
+	uint index = 0;
+	while(((ulong)1 << (POOL_MIN_SHIFT + index)) < size)
+		index++;
+	return index;
+}
+
+static uint cache_limit(uint index){
+	ulong limit = POOL_CACHE_BYTES >> (POOL_MIN_SHIFT + index);
+	return limit < POOL_CACHE_MIN ? POOL_CACHE_MIN : (uint)limit;
+}
+
+static void arena_link(struct PoolArena* arena, struct PoolBlock* block){
+	block->arena = arena;
+	block->owner = arena ? &cache : NULL;
+	block->prev = NULL;
+	block->next = arena ? arena->blocks : NULL;
+	if(!arena)
+		return;
+	if(arena->blocks)
+		arena->blocks->prev = block;
+	arena->blocks = block;
+}
+
+static void arena_unlink(struct PoolBlock* block){
+	struct PoolArena* arena = block->arena;
+	if(!arena)
+		return;
+	if(block->prev)
+		block->prev->next = block->next;
+	else
+		arena->blocks = block->next;
+	if(block->next)
+		block->next->prev = block->prev;
+	block->arena = NULL;
+}
+
+static void release(struct PoolBlock* block){
+	stat_add(&stats.frees, 1);
+	uint index = block->size_class;
+	if(index == POOL_LARGE || cache.count[index] >= cache_limit(index)){
+		free(block);
+		return;
+	}
+	cache_register();
+	block->next = cache.free[index];
+	cache.free[index] = block;
+	cache.count[index]++;
+	stat_add(&stats.cached_bytes, block->size);
+}
+
+void* pool_alloc(ulong size){
+	stat_add(&stats.allocs, 1);
+	struct PoolBlock* block;
+	if(size > POOL_MAX_BYTES){
+		stat_add(&stats.misses, 1);
+		if(size > (ulong)-1 - SIMD_ALIGNMENT)
+			return NULL;
+		block = malloc_aligned_wide(SIMD_ALIGNMENT, SIMD_ALIGNMENT + size);
+		if(!block)
+			return NULL;
+		block->size = size;
+		block->size_class = POOL_LARGE;
+	}
+	else{
+		uint index = size_class(size);
+		block = cache.free[index];
+		if(block){
+			stat_add(&stats.hits, 1);
+			stat_sub(&stats.cached_bytes, block->size);
+			cache.free[index] = block->next;
+			cache.count[index]--;
+		}
+		else{
+			stat_add(&stats.misses, 1);
+			ulong bytes = (ulong)1 << (POOL_MIN_SHIFT + index);
+			block = malloc_aligned_wide(SIMD_ALIGNMENT, SIMD_ALIGNMENT + bytes);
+			if(!block)
+				return NULL;
+			block->size = bytes;
+			block->size_class = index;
+		}
+	}
+	block->state = BLOCK_LIVE;
+	arena_link(cache.arena, block);
+	return block_data(block);
+}
+
+/*
+ * Whether block is in an arena of another thread, which then owns
+ * releasing it.
+ */
+static uint is_foreign(struct PoolBlock* block){
+	return block->owner && block->owner != &cache;
+}
+
+void pool_free(void* ptr){
+	if(!ptr)
+		return;
+	struct PoolBlock* block = block_of(ptr);
+	if(is_foreign(block)){
+		uint live = BLOCK_LIVE;
+		if(__atomic_compare_exchange_n(&block->state, &live, BLOCK_FREED, 0,
+					__ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+			return;
+		release(block);
+		return;
+	}
+	arena_unlink(block);
+	release(block);
+}
+
+ulong pool_size(void* ptr){
+	return ptr ? block_of(ptr)->size : 0;
+}
+
+/*
+ * Grows in place while the block's class still fits, which makes
+ * repeated appends amortized by the power of two classes. Blocks past
+ * the classes are sized exactly, so they grow by at least half each time
+ * for the same effect. The new block stays in the arena of the old one.
+ */
+void* pool_realloc(void* ptr, ulong size){
+	if(!ptr)
+		return pool_alloc(size);
+	struct PoolBlock* block = block_of(ptr);
+	if(size <= block->size)
+		return ptr;
+	ulong grown_size = block->size + block->size / 2;
+	void* result = NULL;
+	if(size > POOL_MAX_BYTES && size < grown_size)
+		result = pool_alloc(grown_size);
+	if(!result)
+		result = pool_alloc(size);
+	if(!result)
+		return NULL;
+	struct PoolBlock* grown = block_of(result);
+	if(!is_foreign(block) && grown->arena != block->arena){
+		arena_unlink(grown);
+		arena_link(block->arena, grown);
+	}
+	memcpy(result, ptr, block->size);
+	pool_free(ptr);
+	return result;
+}
+
+uint crunum_arena_begin(void){
+	struct PoolArena* arena = malloc(sizeof(struct PoolArena));
+	if(!arena)
+		return 0;
+	arena->blocks = NULL;
+	arena->parent = cache.arena;
+	cache.arena = arena;
+	return 1;
+}
+
+void crunum_arena_end(void){
+	struct PoolArena* arena = cache.arena;
+	if(!arena)
+		return;
+	while(arena->blocks){
+		struct PoolBlock* block = arena->blocks;
+		arena->blocks = block->next;
+		block->arena = NULL;
+		stat_add(&stats.arena_frees, 1);
+		release(block);
+	}
+	cache.arena = arena->parent;
+	free(arena);
+}
+
+void crunum_arena_leave(void){
+	struct PoolArena* arena = cache.arena;
+	if(!arena)
+		return;
+	while(arena->blocks){
+		struct PoolBlock* block = arena->blocks;
+		arena->blocks = block->next;
+		if(arena->parent && __atomic_load_n(&block->state, __ATOMIC_ACQUIRE) == BLOCK_LIVE){
+			arena_link(arena->parent, block);
+			continue;
+		}
+		uint live = BLOCK_LIVE;
+		block->arena = NULL;
+		if(arena->parent || !__atomic_compare_exchange_n(&block->state, &live,
+					BLOCK_UNTRACKED, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+			release(block);
+	}
+	cache.arena = arena->parent;
+	free(arena);
+}
+
+uint crunum_arena_depth(void){
+	uint depth = 0;
+	for(struct PoolArena* arena = cache.arena; arena; arena = arena->parent)
+		depth++;
+	return depth;
+}
+
+/*
+ * Releases the calling thread's cached blocks back to the system.
+ */
+void crunum_pool_trim(void){
+	for(uint index = 0; index < POOL_CLASSES; index++){
+		while(cache.free[index]){
+			struct PoolBlock* block = cache.free[index];
+			cache.free[index] = block->next;
+			stat_sub(&stats.cached_bytes, block->size);
+			free(block);
+		}
+		cache.count[index] = 0;
+	}
+}
+
+void crunum_pool_stats(struct PoolStats* result){
+	result->allocs = __atomic_load_n(&stats.allocs, __ATOMIC_RELAXED);
+	result->hits = __atomic_load_n(&stats.hits, __ATOMIC_RELAXED);
+	result->misses = __atomic_load_n(&stats.misses, __ATOMIC_RELAXED);
+	result->frees = __atomic_load_n(&stats.frees, __ATOMIC_RELAXED);
+	result->arena_frees = __atomic_load_n(&stats.arena_frees, __ATOMIC_RELAXED);
+	result->cached_bytes = __atomic_load_n(&stats.cached_bytes, __ATOMIC_RELAXED);
+}
+
+void crunum_pool_reset_stats(void){
+	__atomic_store_n(&stats.allocs, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&stats.hits, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&stats.misses, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&stats.frees, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&stats.arena_frees, 0, __ATOMIC_RELAXED);
+}
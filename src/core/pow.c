@@ -0,0 +1,206 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#include "config.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+
+/*
+ * Integer matrix powers.
+ *
+ * The general path is binary exponentiation over three buffers, the
+ * result, the running square and one product buffer whose storage is
+ * swapped in after every multiplication, so nothing is allocated inside
+ * the loop. A negative exponent inverts once through LU and then raises
+ * the inverse.
+ *
+ * Symmetric matrices with a huge exponent are diagonalized with cyclic
+ * Jacobi instead, A^e = V * diag(l^e) * V^T, which costs a fixed number
+ * of sweeps no matter how large e is. Otherwise matrices up to SMALL_MAX
+ * run the same loop on the stack with the unrolled products.
+ */
+
+#define POW_DIAGONALIZE (1u << 20)
+#define JACOBI_SWEEPS 64
+
+static void swap_values(struct Matrix* matrix1, struct Matrix* matrix2){
+	float* temp = matrix1->values;
+	matrix1->values = matrix2->values;
+	matrix2->values = temp;
+	uint ld = matrix1->ld;
+	matrix1->ld = matrix2->ld;
+	matrix2->ld = ld;
+}
+
+static uint is_symmetric(struct Matrix* matrix){
+	const uint n = matrix->rows;
+	for(uint i = 0; i < n; i++)
+		for(uint j = i + 1; j < n; j++)
+			if(matrix_load(matrix, i, j) != matrix_load(matrix, j, i))
+				return 0;
+	return 1;
+}
+
+static void rotate(double* values, uint n, uint index1, uint index2,
+		uint stride, uint step, double c, double s){
+	for(uint k = 0; k < n; k++){
+		double* value1 = &values[(ulong)index1 * stride + (ulong)k * step];
+		double* value2 = &values[(ulong)index2 * stride + (ulong)k * step];
+		double temp = *value1;
+		*value1 = c * temp - s * *value2;
+		*value2 = s * temp + c * *value2;
+	}
+}
+
+/*
+ * Eigen decomposition of a symmetric matrix, eigenvalues end up on the
+ * diagonal of a and the eigenvectors in the columns of v.
+ */
+static void jacobi(double* a, double* v, uint n){
+	for(uint sweep = 0; sweep < JACOBI_SWEEPS; sweep++){
+		double off = 0;
+		double norm = 0;
+		for(uint i = 0; i < n; i++)
+			for(uint j = 0; j < n; j++){
+				double value = a[(ulong)i * n + j] * a[(ulong)i * n + j];
+				norm += value;
+				if(i != j)
+					off += value;
+			}
+		if(off <= norm * 1e-24)
+			return;
+		for(uint p = 0; p < n; p++)
+			for(uint q = p + 1; q < n; q++){
+				double apq = a[(ulong)p * n + q];
+				if(apq == 0)
+					continue;
+				double theta = (a[(ulong)q * n + q] - a[(ulong)p * n + p]) / (2 * apq);
+				double t = (theta >= 0 ? 1 : -1) / (fabs(theta) + sqrt(theta * theta + 1));
+				double c = 1 / sqrt(t * t + 1);
+				double s = t * c;
+				rotate(a, n, p, q, 1, n, c, s);
+				rotate(a, n, p, q, n, 1, c, s);
+				rotate(v, n, p, q, 1, n, c, s);
+			}
+	}
+}
+
+/*
+ * result converted to dtype, result itself when it already has it.
+ */
+static struct Matrix* to_dtype(struct Matrix* result, enum Dtype dtype){
+	if(!result || result->dtype == dtype)
+		return result;
+	struct Matrix* converted = matrix_astype(result, dtype);
+	matrix_free(result);
+	return converted;
+}
+
+/*
+ * The eigenvectors are scaled in double and only rounded to the compute
+ * dtype of matrix for the final product.
+ */
+static struct Matrix* pow_symmetric(struct Matrix* matrix, int exp, uint* invertible){
+	const uint n = matrix->rows;
+	const enum Dtype dtype = dtype_compute(matrix->dtype);
+	double* a = malloc(sizeof(double) * n * n);
+	double* v = malloc(sizeof(double) * n * n);
+	struct Matrix* scaled = matrix_new_dtype(n, n, 0, dtype);
+	struct Matrix* vt = matrix_new_dtype(n, n, 0, dtype);
+	struct Matrix* result = NULL;
+	if(!a || !v || !scaled || !vt)
+		goto done;
+	for(uint i = 0; i < n; i++)
+		for(uint j = 0; j < n; j++){
+			a[(ulong)i * n + j] = matrix_load(matrix, i, j);
+			v[(ulong)i * n + j] = i == j;
+		}
+	jacobi(a, v, n);
+	for(uint k = 0; k < n; k++){
+		double lambda = a[(ulong)k * n + k];
+		if(exp < 0 && fabs(lambda) < NEAR_ZERO){
+			*invertible = 0;
+			goto done;
+		}
+		double scale = pow(lambda, exp);
+		for(uint i = 0; i < n; i++){
+			matrix_set(scaled, i, k, v[(ulong)i * n + k] * scale);
+			matrix_set(vt, k, i, v[(ulong)i * n + k]);
+		}
+	}
+	result = matrix_mul(scaled, vt);
+done:
+	free(a);
+	free(v);
+	matrix_free(scaled);
+	matrix_free(vt);
+	return result;
+}
+
+/*
+ * Powers of 16 bit matrices are taken in float32 and rounded once at the
+ * end, rounding every intermediate product would compound the error.
+ */
+struct Matrix* matrix_pow(struct Matrix* matrix, int exp, uint* invertible){
+	*invertible = 1;
+	const uint n = matrix->rows;
+	const enum Dtype dtype = dtype_compute(matrix->dtype);
+	if(matrix->rows != matrix->cols)
+		return NULL;
+	if(!exp)
+		return matrix_identity_dtype(n, matrix->dtype);
+	ulong remaining = exp < 0 ? -(ulong)exp : (ulong)exp;
+	if(remaining >= POW_DIAGONALIZE && is_symmetric(matrix))
+		return to_dtype(pow_symmetric(matrix, exp, invertible), matrix->dtype);
+	if(n && n <= SMALL_MAX)
+		return small_pow(matrix, exp, invertible);
+	struct Matrix* square;
+	if(exp < 0){
+		square = to_dtype(matrix_inverse(matrix, invertible), dtype);
+		if(!square)
+			return NULL;
+	}
+	else{
+		square = matrix_new_dtype(n, n, 0, dtype);
+		if(!square)
+			return NULL;
+		matrix_copy_values(square, matrix);
+	}
+	struct Matrix* result = matrix_new_dtype(n, n, 0, dtype);
+	struct Matrix* product = matrix_new_dtype(n, n, 0, dtype);
+	if(!result || !product){
+		matrix_free(square);
+		matrix_free(result);
+		matrix_free(product);
+		return NULL;
+	}
+	uint first = 1;
+	while(1){
+		if(remaining & 1){
+			if(first){
+				matrix_copy_values(result, square);
+				first = 0;
+			}
+			else{
+				matrix_mul_into(product, result, square);
+				swap_values(result, product);
+			}
+		}
+		remaining >>= 1;
+		if(!remaining)
+			break;
+		matrix_mul_into(product, square, square);
+		swap_values(square, product);
+	}
+	matrix_free(square);
+	matrix_free(product);
+	return to_dtype(result, matrix->dtype);
+}
@@ -0,0 +1,367 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#include "config.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+/*
+ * int8 quantized matrices.
+ *
+ * A matrix is quantized asymmetrically, each row or the whole matrix
+ * gets the scale and zero point that map its value range, widened to
+ * hold 0 so zero stays exact, onto [-128, 127]. The right-hand side of a
+ * product is quantized on the fly and symmetrically, per vector or per
+ * matrix column, so only the left side has a zero point and
+ *
+ *	y[i] = scale[i] * scale_x * (dot(q[i], q_x) - zero_point[i] * sum(q_x))
+ *
+ * costs one int8 dot product per output. The dot products run in the
+ * dot_i8 kernel in QUANT_CHUNK pieces, short enough that the kernel's
+ * int32 lanes can't overflow, summed in a long.
+ */
+
+#define QUANT_CHUNK (1 << 16)
+#define QUANT_BLOCK_BYTES (128 << 10)
+
+static uint min_uint(uint value1, uint value2){
+	return value1 < value2 ? value1 : value2;
+}
+
+static schar saturate(float value){
+	if(value < -128.0f)
+		return -128;
+	if(value > 127.0f)
+		return 127;
+	return (schar)lrintf(value);
+}
+
+static long dot_i8(const schar* src1, const schar* src2, ulong len){
+	long result = 0;
+	for(ulong i = 0; i < len; i += QUANT_CHUNK)
+		result += kernel_dot_i8(&src1[i], &src2[i],
+				len - i < QUANT_CHUNK ? len - i : QUANT_CHUNK);
+	return result;
+}
+
+/*
+ * Row of matrix as float32, in place when it already is, else widened
+ * into buffer.
+ */
+static const float* row_f32(const struct Matrix* matrix, uint row, float* buffer){
+	if(matrix->dtype == DTYPE_F32)
+		return (const float*)matrix_row_at(matrix, row);
+	dtype_convert(buffer, DTYPE_F32, matrix_row_at(matrix, row), matrix->dtype, matrix->cols);
+	return buffer;
+}
+
+static void widen_range(const float* values, uint len, float* low, float* high){
+	for(uint i = 0; i < len; i++){
+		if(values[i] < *low)
+			*low = values[i];
+		if(values[i] > *high)
+			*high = values[i];
+	}
+}
+
+static void range_params(float low, float high, float* scale, int* zero_point){
+	*scale = (high - low) / 255.0f;
+	*zero_point = 0;
+	if(!(*scale > 0.0f)){
+		*scale = 1.0f;
+		return;
+	}
+	*zero_point = saturate(-128.0f - low / *scale);
+}
+
+static void quantize_row(schar* dst, const float* src, uint len,
+		float scale, int zero_point){
+	for(uint i = 0; i < len; i++)
+		dst[i] = saturate(src[i] / scale + zero_point);
+}
+
+/*
+ * Symmetric scale of len values, max |value| maps to 127.
+ */
+static float symmetric_scale(const float* values, ulong len){
+	float high = 0.0f;
+	for(ulong i = 0; i < len; i++){
+		float magnitude = fabsf(values[i]);
+		if(magnitude > high)
+			high = magnitude;
+	}
+	return high > 0.0f ? high / 127.0f : 1.0f;
+}
+
+static struct QMatrix* qmatrix_alloc(uint rows, uint cols, uint per_row){
+	struct QMatrix* qmatrix = pool_alloc(sizeof(struct QMatrix));
+	if(!qmatrix)
+		return NULL;
+	const uint groups = per_row ? rows : 1;
+	qmatrix->rows = rows;
+	qmatrix->cols = cols;
+	qmatrix->ld = cols < SIMD_ALIGNMENT ? cols :
+		(cols + SIMD_ALIGNMENT - 1) / SIMD_ALIGNMENT * SIMD_ALIGNMENT;
+	qmatrix->per_row = per_row ? 1 : 0;
+	qmatrix->values = pool_alloc((ulong)rows * qmatrix->ld + 1);
+	qmatrix->scales = pool_alloc(sizeof(float) * (groups ? groups : 1));
+	qmatrix->zero_points = pool_alloc(sizeof(int) * (groups ? groups : 1));
+	if(!qmatrix->values || !qmatrix->scales || !qmatrix->zero_points){
+		qmatrix_free(qmatrix);
+		return NULL;
+	}
+	return qmatrix;
+}
+
+void qmatrix_free(struct QMatrix* qmatrix){
+	if(!qmatrix)
+		return;
+	pool_free(qmatrix->values);
+	pool_free(qmatrix->scales);
+	pool_free(qmatrix->zero_points);
+	pool_free(qmatrix);
+}
+
+/*
+ * Quantizes matrix with one scale and zero point per row when per_row is
+ * set, one for the whole matrix otherwise. Works from any dtype.
+ */
+struct QMatrix* matrix_quantize(struct Matrix* matrix, uint per_row){
+	struct QMatrix* qmatrix = qmatrix_alloc(matrix->rows, matrix->cols, per_row);
+	float* buffer = pool_alloc(sizeof(float) * (matrix->cols + 1));
+	if(!qmatrix || !buffer){
+		qmatrix_free(qmatrix);
+		pool_free(buffer);
+		return NULL;
+	}
+	if(!per_row){
+		float low = 0.0f, high = 0.0f;
+		for(uint i = 0; i < matrix->rows; i++)
+			widen_range(row_f32(matrix, i, buffer), matrix->cols, &low, &high);
+		range_params(low, high, &qmatrix->scales[0], &qmatrix->zero_points[0]);
+	}
+	for(uint i = 0; i < matrix->rows; i++){
+		const float* row = row_f32(matrix, i, buffer);
+		const uint group = per_row ? i : 0;
+		if(per_row){
+			float low = 0.0f, high = 0.0f;
+			widen_range(row, matrix->cols, &low, &high);
+			range_params(low, high, &qmatrix->scales[i], &qmatrix->zero_points[i]);
+		}
+		quantize_row(&qmatrix->values[(ulong)i * qmatrix->ld], row, matrix->cols,
+				qmatrix->scales[group], qmatrix->zero_points[group]);
+	}
+	pool_free(buffer);
+	return qmatrix;
+}
+
+struct Matrix* qmatrix_dequantize(struct QMatrix* qmatrix){
+	struct Matrix* result = matrix_new(qmatrix->rows, qmatrix->cols, 0);
+	if(!result)
+		return NULL;
+	for(uint i = 0; i < qmatrix->rows; i++){
+		const uint group = qmatrix->per_row ? i : 0;
+		const float scale = qmatrix->scales[group];
+		const int zero_point = qmatrix->zero_points[group];
+		const schar* src = &qmatrix->values[(ulong)i * qmatrix->ld];
+		float* dst = matrix_get(result, i, 0);
+		for(uint j = 0; j < qmatrix->cols; j++)
+			dst[j] = scale * (src[j] - zero_point);
+	}
+	return result;
+}
+
+/*
+ * The right-hand side in quantized form, column j is values[j * len]
+ * with scales[j] and sums[j].
+ */
+struct QOperand {
+	schar* values;
+	float* scales;
+	long* sums;
+	uint len;
+	uint count;
+};
+
+static uint operand_alloc(struct QOperand* operand, uint len, uint count){
+	operand->len = len;
+	operand->count = count;
+	operand->values = pool_alloc((ulong)len * count + 1);
+	operand->scales = pool_alloc(sizeof(float) * (count + 1));
+	operand->sums = pool_alloc(sizeof(long) * (count + 1));
+	return operand->values && operand->scales && operand->sums;
+}
+
+static void operand_free(struct QOperand* operand){
+	pool_free(operand->values);
+	pool_free(operand->scales);
+	pool_free(operand->sums);
+}
+
+static uint operand_vector(struct QOperand* operand, const struct Vector* vector){
+	if(!operand_alloc(operand, vector->len, 1))
+		return 0;
+	const float* values = vector->values;
+	float* buffer = NULL;
+	if(vector->dtype != DTYPE_F32){
+		buffer = pool_alloc(sizeof(float) * (vector->len + 1));
+		if(!buffer)
+			return 0;
+		dtype_convert(buffer, DTYPE_F32, vector->values, vector->dtype, vector->len);
+		values = buffer;
+	}
+	const float scale = symmetric_scale(values, vector->len);
+	long sum = 0;
+	for(uint i = 0; i < vector->len; i++){
+		operand->values[i] = saturate(values[i] / scale);
+		sum += operand->values[i];
+	}
+	operand->scales[0] = scale;
+	operand->sums[0] = sum;
+	pool_free(buffer);
+	return 1;
+}
+
+/*
+ * Quantizes the columns of matrix, transposed so each one is contiguous.
+ */
+static uint operand_matrix(struct QOperand* operand, const struct Matrix* matrix){
+	const uint k = matrix->rows;
+	const uint n = matrix->cols;
+	if(!operand_alloc(operand, k, n))
+		return 0;
+	float* buffer = pool_alloc(sizeof(float) * (n + 1));
+	if(!buffer)
+		return 0;
+	float* high = operand->scales;
+	for(uint j = 0; j < n; j++){
+		high[j] = 0.0f;
+		operand->sums[j] = 0;
+	}
+	for(uint i = 0; i < k; i++){
+		const float* row = row_f32(matrix, i, buffer);
+		for(uint j = 0; j < n; j++)
+			if(fabsf(row[j]) > high[j])
+				high[j] = fabsf(row[j]);
+	}
+	for(uint j = 0; j < n; j++)
+		operand->scales[j] = high[j] > 0.0f ? high[j] / 127.0f : 1.0f;
+	for(uint i = 0; i < k; i++){
+		const float* row = row_f32(matrix, i, buffer);
+		for(uint j = 0; j < n; j++){
+			schar value = saturate(row[j] / operand->scales[j]);
+			operand->values[(ulong)j * k + i] = value;
+			operand->sums[j] += value;
+		}
+	}
+	pool_free(buffer);
+	return 1;
+}
+
+struct QTask {
+	const struct QMatrix* qmatrix;
+	const struct QOperand* operand;
+	struct Matrix* dst;
+	struct Vector* dst_vector;
+};
+
+static double qdot(const struct QMatrix* qmatrix, const struct QOperand* operand,
+		uint row, uint col){
+	const uint group = qmatrix->per_row ? row : 0;
+	long dot = dot_i8(&qmatrix->values[(ulong)row * qmatrix->ld],
+			&operand->values[(ulong)col * operand->len], operand->len);
+	dot -= (long)qmatrix->zero_points[group] * operand->sums[col];
+	return (double)qmatrix->scales[group] * operand->scales[col] * (double)dot;
+}
+
+static void gemv_rows(void* arg, ulong begin, ulong end){
+	struct QTask* task = arg;
+	for(ulong i = begin; i < end; i++)
+		vector_set(task->dst_vector, (uint)i, qdot(task->qmatrix, task->operand, (uint)i, 0));
+}
+
+/*
+ * Columns are taken in blocks whose quantized values fit QUANT_BLOCK_BYTES,
+ * so a block stays cached while every row in the range passes over it.
+ */
+static void gemm_rows(void* arg, ulong begin, ulong end){
+	struct QTask* task = arg;
+	const uint n = task->operand->count;
+	const uint block = QUANT_BLOCK_BYTES / (task->operand->len + 1) + 1;
+	for(uint jb = 0; jb < n; jb += block){
+		const uint j_end = min_uint(n, jb + block);
+		for(ulong i = begin; i < end; i++)
+			for(uint j = jb; j < j_end; j++)
+				matrix_set(task->dst, (uint)i, j,
+						qdot(task->qmatrix, task->operand, (uint)i, j));
+	}
+}
+
+static void run_rows(void (*fn)(void* arg, ulong begin, ulong end),
+		struct QTask* task, ulong work_per_row){
+	const ulong rows = task->qmatrix->rows;
+	if(rows * work_per_row < PARALLEL_THRESHOLD)
+		fn(task, 0, rows);
+	else
+		parallel_for(rows, PARALLEL_GRAIN / (work_per_row + 1) + 1, fn, task);
+}
+
+struct Vector* qmatrix_mul_vector_into(struct Vector* dst,
+		struct QMatrix* qmatrix, struct Vector* vector){
+	if(vector->len != qmatrix->cols || dst->len != qmatrix->rows || dst == vector)
+		return NULL;
+	struct QOperand operand;
+	struct Vector* result = NULL;
+	if(operand_vector(&operand, vector)){
+		struct QTask task = {.qmatrix = qmatrix, .operand = &operand, .dst_vector = dst};
+		run_rows(gemv_rows, &task, qmatrix->cols);
+		result = dst;
+	}
+	operand_free(&operand);
+	return result;
+}
+
+struct Vector* qmatrix_mul_vector(struct QMatrix* qmatrix, struct Vector* vector){
+	struct Vector* result = vector_new(qmatrix->rows, 0);
+	if(!result)
+		return NULL;
+	if(!qmatrix_mul_vector_into(result, qmatrix, vector)){
+		vector_free(result);
+		return NULL;
+	}
+	return result;
+}
+
+struct Matrix* qmatrix_mul_into(struct Matrix* dst,
+		struct QMatrix* qmatrix, struct Matrix* matrix){
+	if(matrix->rows != qmatrix->cols || dst->rows != qmatrix->rows ||
+			dst->cols != matrix->cols || dst == matrix)
+		return NULL;
+	struct QOperand operand;
+	struct Matrix* result = NULL;
+	if(operand_matrix(&operand, matrix)){
+		struct QTask task = {.qmatrix = qmatrix, .operand = &operand, .dst = dst};
+		run_rows(gemm_rows, &task, (ulong)qmatrix->cols * matrix->cols);
+		result = dst;
+	}
+	operand_free(&operand);
+	return result;
+}
+
+struct Matrix* qmatrix_mul(struct QMatrix* qmatrix, struct Matrix* matrix){
+	struct Matrix* result = matrix_new(qmatrix->rows, matrix->cols, 0);
+	if(!result)
+		return NULL;
+	if(!qmatrix_mul_into(result, qmatrix, matrix)){
+		matrix_free(result);
+		return NULL;
+	}
+	return result;
+}
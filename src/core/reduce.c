@@ -0,0 +1,328 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#include "config.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+/*
+ * Reductions.
+ *
+ * Every enum Reduce maps onto a fold kernel (sum, absolute or squared
+ * sum, min, max or largest absolute value) and a finishing step: means
+ * divide, NORM2 takes the root, and the arg reductions run the find
+ * kernel for the first element equal to the min or max just found. The
+ * whole matrix is folded one contiguous run at a time, in PARALLEL_GRAIN
+ * element chunks across threads when it is large, and the partial
+ * results are combined in chunk order so the sum doesn't depend on the
+ * thread count. Each row is folded the same way. Columns fold whole rows
+ * into a row of accumulators instead, split across threads by column.
+ *
+ * float64 matrices fold in float64, the rest in float32 with 16 bit ones
+ * widened REDUCE_STAGE elements at a time.
+ */
+
+#define REDUCE_STAGE 256
+#define MATRIX_SIZE(matrix) ((ulong)(matrix)->rows * (matrix)->cols)
+
+static enum Fold fold_of(enum Reduce op){
+	switch(op){
+		case REDUCE_MIN:
+		case REDUCE_ARGMIN:
+			return FOLD_MIN;
+		case REDUCE_MAX:
+		case REDUCE_ARGMAX:
+			return FOLD_MAX;
+		case REDUCE_NORM1:
+			return FOLD_ABS_SUM;
+		case REDUCE_NORM2:
+			return FOLD_SQUARE_SUM;
+		case REDUCE_NORM_INF:
+			return FOLD_ABS_MAX;
+		default:
+			return FOLD_SUM;
+	}
+}
+
+static uint is_arg(enum Reduce op){
+	return op == REDUCE_ARGMIN || op == REDUCE_ARGMAX;
+}
+
+static double identity(enum Fold fold){
+	if(fold == FOLD_MIN)
+		return INFINITY;
+	if(fold == FOLD_MAX)
+		return -INFINITY;
+	return 0;
+}
+
+static double combine(double value1, double value2, enum Fold fold){
+	switch(fold){
+		case FOLD_MIN:
+			return value2 < value1 ? value2 : value1;
+		case FOLD_MAX:
+		case FOLD_ABS_MAX:
+			return value2 > value1 ? value2 : value1;
+		default:
+			return value1 + value2;
+	}
+}
+
+/*
+ * The reduction of count values whose fold is value. Extremes of nothing
+ * are NaN.
+ */
+static double finish(double value, ulong count, enum Reduce op){
+	switch(op){
+		case REDUCE_MEAN:
+			return value / count;
+		case REDUCE_NORM2:
+			return sqrt(value);
+		case REDUCE_MIN:
+		case REDUCE_MAX:
+		case REDUCE_ARGMIN:
+		case REDUCE_ARGMAX:
+			return count ? value : NAN;
+		default:
+			return value;
+	}
+}
+
+static void* at(const struct Matrix* matrix, ulong index){
+	return (char*)matrix->values +
+		matrix_offset(matrix, index) * dtype_size(matrix->dtype);
+}
+
+/*
+ * The float32 values from index on, widened into stage unless they
+ * already are float32. len is cut down to what stage holds.
+ */
+static const float* stage_in(const struct Matrix* matrix, ulong index, ulong* len,
+		float* stage){
+	if(matrix->dtype == DTYPE_F32)
+		return at(matrix, index);
+	*len = *len < REDUCE_STAGE ? *len : REDUCE_STAGE;
+	dtype_convert(stage, DTYPE_F32, at(matrix, index), matrix->dtype, *len);
+	return stage;
+}
+
+/*
+ * Fold of the elements [begin, end) in row major order.
+ */
+static double fold_range(const struct Matrix* matrix, ulong begin, ulong end,
+		enum Fold fold){
+	float stage[REDUCE_STAGE];
+	double result = identity(fold);
+	for(ulong index = begin, len; index < end; index += len){
+		len = matrix_run(matrix, index, end - index);
+		double value;
+		if(matrix->dtype == DTYPE_F64)
+			value = kernel_fold_f64(at(matrix, index), len, fold);
+		else{
+			const float* src = stage_in(matrix, index, &len, stage);
+			value = kernel_fold(src, len, fold);
+		}
+		result = combine(result, value, fold);
+	}
+	return result;
+}
+
+/*
+ * Index of the first element of [begin, end) equal to value, end when
+ * there is none.
+ */
+static ulong find_range(const struct Matrix* matrix, ulong begin, ulong end,
+		double value){
+	float stage[REDUCE_STAGE];
+	for(ulong index = begin, len; index < end; index += len){
+		len = matrix_run(matrix, index, end - index);
+		ulong found;
+		if(matrix->dtype == DTYPE_F64)
+			found = kernel_find_f64(at(matrix, index), len, value);
+		else{
+			const float* src = stage_in(matrix, index, &len, stage);
+			found = kernel_find(src, len, (float)value);
+		}
+		if(found < len)
+			return index + found;
+	}
+	return end;
+}
+
+static double reduce_range(const struct Matrix* matrix, ulong begin, ulong end,
+		enum Reduce op){
+	double value = finish(fold_range(matrix, begin, end, fold_of(op)), end - begin, op);
+	if(is_arg(op) && begin < end)
+		return find_range(matrix, begin, end, value) - begin;
+	return value;
+}
+
+struct FoldTask {
+	const struct Matrix* matrix;
+	enum Fold fold;
+	double* partials;
+};
+
+static void fold_chunks(void* arg, ulong begin, ulong end){
+	struct FoldTask* task = arg;
+	for(ulong chunk = begin; chunk < end; chunk += PARALLEL_GRAIN){
+		ulong chunk_end = end - chunk < PARALLEL_GRAIN ? end : chunk + PARALLEL_GRAIN;
+		task->partials[chunk / PARALLEL_GRAIN] = fold_range(task->matrix,
+				chunk, chunk_end, task->fold);
+	}
+}
+
+double matrix_reduce(struct Matrix* matrix, enum Reduce op){
+	const ulong size = MATRIX_SIZE(matrix);
+	const enum Fold fold = fold_of(op);
+	const ulong chunks = (size + PARALLEL_GRAIN - 1) / PARALLEL_GRAIN;
+	double* partials = size > PARALLEL_THRESHOLD ? malloc(sizeof(double) * chunks) : NULL;
+	if(!partials)
+		return reduce_range(matrix, 0, size, op);
+	struct FoldTask task = {.matrix = matrix, .fold = fold, .partials = partials};
+	parallel_for(size, PARALLEL_GRAIN, fold_chunks, &task);
+	double value = identity(fold);
+	for(ulong chunk = 0; chunk < chunks; chunk++)
+		value = combine(value, partials[chunk], fold);
+	free(partials);
+	value = finish(value, size, op);
+	return is_arg(op) ? find_range(matrix, 0, size, value) : value;
+}
+
+struct AxisTask {
+	const struct Matrix* matrix;
+	struct Vector* dst;
+	enum Reduce op;
+};
+
+static void reduce_rows(void* arg, ulong begin, ulong end){
+	struct AxisTask* task = arg;
+	const ulong cols = task->matrix->cols;
+	for(ulong i = begin; i < end; i++)
+		vector_set(task->dst, i, reduce_range(task->matrix, i * cols, (i + 1) * cols, task->op));
+}
+
+/*
+ * A grain of roughly PARALLEL_GRAIN elements when the axis spans len
+ * elements each, 0 to stay serial for small matrices.
+ */
+static ulong axis_grain(const struct Matrix* matrix, ulong len){
+	if(MATRIX_SIZE(matrix) <= PARALLEL_THRESHOLD)
+		return 0;
+	return len < PARALLEL_GRAIN ? PARALLEL_GRAIN / len : 1;
+}
+
+struct Vector* matrix_reduce_rows_into(struct Vector* dst,
+		struct Matrix* matrix, enum Reduce op){
+	if(dst->len != matrix->rows)
+		return NULL;
+	struct AxisTask task = {.matrix = matrix, .dst = dst, .op = op};
+	ulong grain = axis_grain(matrix, matrix->cols);
+	if(grain)
+		parallel_for(matrix->rows, grain, reduce_rows, &task);
+	else
+		reduce_rows(&task, 0, matrix->rows);
+	return dst;
+}
+
+/*
+ * Folds the columns [begin, end) of every row into acc, in the compute
+ * dtype of the matrix.
+ */
+static void fold_cols(const struct Matrix* matrix, void* acc, ulong begin, ulong end,
+		enum Fold fold){
+	float stage[REDUCE_STAGE];
+	for(ulong i = 0; i < matrix->rows; i++)
+		for(ulong j = begin, len; j < end; j += len){
+			const ulong index = i * matrix->cols + j;
+			len = end - j;
+			if(matrix->dtype == DTYPE_F64)
+				kernel_fold_into_f64((double*)acc + j, at(matrix, index), len, fold);
+			else{
+				const float* src = stage_in(matrix, index, &len, stage);
+				kernel_fold_into((float*)acc + j, src, len, fold);
+			}
+		}
+}
+
+/*
+ * Row of the first element of column j equal to acc[j], for the columns
+ * [begin, end), written back over acc.
+ */
+static void find_cols(const struct Matrix* matrix, void* acc, ulong begin, ulong end){
+	const enum Dtype dtype = dtype_compute(matrix->dtype);
+	for(ulong j = begin; j < end; j++){
+		const double value = dtype_load(acc, dtype, j);
+		ulong i = 0;
+		while(i < matrix->rows && matrix_load(matrix, i, j) != value)
+			i++;
+		dtype_store(acc, dtype, j, i);
+	}
+}
+
+struct ColsTask {
+	const struct Matrix* matrix;
+	void* acc;
+	enum Reduce op;
+};
+
+static void reduce_cols(void* arg, ulong begin, ulong end){
+	struct ColsTask* task = arg;
+	const enum Dtype dtype = dtype_compute(task->matrix->dtype);
+	const enum Fold fold = fold_of(task->op);
+	for(ulong j = begin; j < end; j++)
+		dtype_store(task->acc, dtype, j, identity(fold));
+	fold_cols(task->matrix, task->acc, begin, end, fold);
+	for(ulong j = begin; j < end; j++)
+		dtype_store(task->acc, dtype, j, finish(dtype_load(task->acc, dtype, j),
+					task->matrix->rows, task->op));
+	if(is_arg(task->op) && task->matrix->rows)
+		find_cols(task->matrix, task->acc, begin, end);
+}
+
+struct Vector* matrix_reduce_cols_into(struct Vector* dst,
+		struct Matrix* matrix, enum Reduce op){
+	if(dst->len != matrix->cols)
+		return NULL;
+	const enum Dtype dtype = dtype_compute(matrix->dtype);
+	void* acc = dst->values;
+	if(dst->dtype != dtype && !(acc = malloc(dtype_size(dtype) * (matrix->cols ? matrix->cols : 1))))
+		return NULL;
+	struct ColsTask task = {.matrix = matrix, .acc = acc, .op = op};
+	ulong grain = axis_grain(matrix, matrix->rows);
+	if(grain)
+		parallel_for(matrix->cols, grain, reduce_cols, &task);
+	else
+		reduce_cols(&task, 0, matrix->cols);
+	if(acc != dst->values){
+		dtype_convert(dst->values, dst->dtype, acc, dtype, matrix->cols);
+		free(acc);
+	}
+	return dst;
+}
+
+/*
+ * One value per row or per column, in the compute dtype of matrix.
+ */
+struct Vector* matrix_reduce_rows(struct Matrix* matrix, enum Reduce op){
+	struct Vector* result = vector_new_dtype(matrix->rows, 0,
+			dtype_compute(matrix->dtype));
+	if(result)
+		matrix_reduce_rows_into(result, matrix, op);
+	return result;
+}
+
+struct Vector* matrix_reduce_cols(struct Matrix* matrix, enum Reduce op){
+	struct Vector* result = vector_new_dtype(matrix->cols, 0,
+			dtype_compute(matrix->dtype));
+	if(result)
+		matrix_reduce_cols_into(result, matrix, op);
+	return result;
+}
@@ -0,0 +1,187 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#include "config.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "common.h"
+
+/*
+ * Square matrices up to SMALL_MAX.
+ *
+ * At these sizes packing for gemm or factoring with LU costs more than
+ * the arithmetic, so products, inverses, determinants and powers copy
+ * the operands onto the stack in the compute dtype and run the fully
+ * unrolled code of small_real.h, the 4x4 float32 product through the
+ * SIMD mul4 kernel. Nothing is allocated besides the result.
+ */
+
+#define REAL float
+#define REAL_NAME(name) name##_f32
+#define REAL_ADD(x, y) ((x) + (y))
+#define REAL_SUB(x, y) ((x) - (y))
+#define REAL_MUL(x, y) ((x) * (y))
+#define REAL_NEG(x) (-(x))
+#define REAL_RECIP(x) (1 / (x))
+#include "small_real.h"
+#undef REAL
+#undef REAL_NAME
+
+#define REAL double
+#define REAL_NAME(name) name##_f64
+#include "small_real.h"
+#undef REAL
+#undef REAL_NAME
+#undef REAL_ADD
+#undef REAL_SUB
+#undef REAL_MUL
+#undef REAL_NEG
+#undef REAL_RECIP
+
+#define SMALL_SIZE (SMALL_MAX * SMALL_MAX)
+
+/*
+ * op(matrix) row major into values, in dtype (float32 or float64).
+ */
+static void pack(void* values, enum Dtype dtype, const struct Matrix* matrix, uint trans){
+	const uint n = matrix->rows;
+	for(uint i = 0; i < n; i++)
+		for(uint j = 0; j < n; j++)
+			dtype_store(values, dtype, i * n + j,
+					trans ? matrix_load(matrix, j, i) : matrix_load(matrix, i, j));
+}
+
+static void unpack(struct Matrix* matrix, const void* values, enum Dtype dtype){
+	const uint n = matrix->rows;
+	for(uint i = 0; i < n; i++)
+		for(uint j = 0; j < n; j++)
+			matrix_set(matrix, i, j, dtype_load(values, dtype, i * n + j));
+}
+
+static void mul_packed(enum Dtype dtype, const void* a, const void* b, void* c, uint n){
+	if(dtype == DTYPE_F64)
+		small_mul_n_f64(a, b, c, n);
+	else if(n == 4)
+		kernel_mul4(a, b, c);
+	else
+		small_mul_n_f32(a, b, c, n);
+}
+
+static double det_packed(enum Dtype dtype, const void* a, uint n){
+	if(dtype == DTYPE_F64)
+		return small_det_n_f64(a, n);
+	return small_det_n_f32(a, n);
+}
+
+/*
+ * Singular when det is tiny next to the largest entry to the n-th
+ * power, the scale det would have for a well conditioned matrix. Like
+ * the pivot test of LU, which is also relative to the largest entry,
+ * this doesn't depend on how the matrix is scaled.
+ */
+static double singular_bound(enum Dtype dtype, const void* a, uint n){
+	double scale = 0;
+	for(uint k = 0; k < n * n; k++)
+		scale = fmax(scale, fabs(dtype_load(a, dtype, k)));
+	return NEAR_ZERO * pow(scale, n);
+}
+
+/*
+ * c = a^-1, c may be a. 0 when a is singular, c is then garbage.
+ */
+static uint inverse_packed(enum Dtype dtype, const void* a, void* c, uint n){
+	const double bound = singular_bound(dtype, a, n);
+	double det;
+	if(dtype == DTYPE_F64)
+		det = small_inverse_n_f64(a, c, n);
+	else
+		det = small_inverse_n_f32(a, c, n);
+	return fabs(det) > bound;
+}
+
+/*
+ * Accumulates op(matrix1) * op(matrix2) into dst, all n x n. Computes in
+ * float64 for a float64 dst and in float32 otherwise, like gemm.
+ */
+void small_mul(struct Matrix* dst, const struct Matrix* matrix1, uint trans1,
+		const struct Matrix* matrix2, uint trans2){
+	const uint n = dst->rows;
+	const enum Dtype dtype = dst->dtype == DTYPE_F64 ? DTYPE_F64 : DTYPE_F32;
+	double a[SMALL_SIZE], b[SMALL_SIZE], c[SMALL_SIZE];
+	pack(a, dtype, matrix1, trans1);
+	pack(b, dtype, matrix2, trans2);
+	mul_packed(dtype, a, b, c, n);
+	for(uint i = 0; i < n; i++)
+		for(uint j = 0; j < n; j++)
+			matrix_set(dst, i, j, matrix_load(dst, i, j) + dtype_load(c, dtype, i * n + j));
+}
+
+struct Matrix* small_inverse(struct Matrix* matrix, uint* invertible){
+	const uint n = matrix->rows;
+	const enum Dtype dtype = dtype_compute(matrix->dtype);
+	double a[SMALL_SIZE];
+	pack(a, dtype, matrix, 0);
+	*invertible = inverse_packed(dtype, a, a, n);
+	if(!*invertible)
+		return NULL;
+	struct Matrix* result = matrix_new_dtype(n, n, 0, matrix->dtype);
+	if(!result){
+		*invertible = 0;
+		return NULL;
+	}
+	unpack(result, a, dtype);
+	return result;
+}
+
+double small_det(struct Matrix* matrix){
+	const uint n = matrix->rows;
+	const enum Dtype dtype = dtype_compute(matrix->dtype);
+	double a[SMALL_SIZE];
+	if(!n)
+		return 1;
+	pack(a, dtype, matrix, 0);
+	return det_packed(dtype, a, n);
+}
+
+/*
+ * Binary exponentiation entirely on the stack, exp != 0.
+ */
+struct Matrix* small_pow(struct Matrix* matrix, int exp, uint* invertible){
+	const uint n = matrix->rows;
+	const enum Dtype dtype = dtype_compute(matrix->dtype);
+	const ulong size = sizeof(double) * SMALL_SIZE;
+	double square[SMALL_SIZE], result[SMALL_SIZE], product[SMALL_SIZE];
+	pack(square, dtype, matrix, 0);
+	*invertible = exp > 0 || inverse_packed(dtype, square, square, n);
+	if(!*invertible)
+		return NULL;
+	ulong remaining = exp < 0 ? -(ulong)exp : (ulong)exp;
+	uint first = 1;
+	while(1){
+		if(remaining & 1){
+			if(first){
+				memcpy(result, square, size);
+				first = 0;
+			}
+			else{
+				mul_packed(dtype, result, square, product, n);
+				memcpy(result, product, size);
+			}
+		}
+		remaining >>= 1;
+		if(!remaining)
+			break;
+		mul_packed(dtype, square, square, product, n);
+		memcpy(square, product, size);
+	}
+	struct Matrix* power = matrix_new_dtype(n, n, 0, matrix->dtype);
+	if(power)
+		unpack(power, result, dtype);
+	return power;
+}
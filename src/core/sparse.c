@@ -0,0 +1,367 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "common.h"
+
+/*
+ * Compressed sparse row and column matrices, float32 only.
+ *
+ * Everything is built by compress() from (row, col, value) triplets with
+ * two stable counting sorts, by the minor index and then by the major
+ * one, which leaves each row (or column) sorted and puts duplicates next
+ * to each other so they can be summed. Converting between formats goes
+ * through the same path, transposing only swaps the roles of the arrays.
+ *
+ * Products with a CSR matrix run one row per output row, SpMV gathers
+ * the dense vector under the row's indices and SpMM adds scaled rows of
+ * the dense operand, so rows can be split across threads. CSC products
+ * scatter into the output instead, SpMM splits the dense columns across
+ * threads and SpMV stays serial.
+ */
+
+static uint sparse_majors(const struct Sparse* sparse){
+	return sparse->format == SPARSE_CSR ? sparse->rows : sparse->cols;
+}
+
+static struct Sparse* sparse_alloc(uint rows, uint cols, uint nnz, enum SparseFormat format){
+	struct Sparse* sparse = pool_alloc(sizeof(struct Sparse));
+	if(!sparse)
+		return NULL;
+	sparse->rows = rows;
+	sparse->cols = cols;
+	sparse->nnz = nnz;
+	sparse->format = format;
+	sparse->values = pool_alloc(sizeof(float) * ((ulong)nnz + 1));
+	sparse->indices = pool_alloc(sizeof(uint) * ((ulong)nnz + 1));
+	sparse->offsets = pool_alloc(sizeof(uint) * ((ulong)sparse_majors(sparse) + 1));
+	if(!sparse->values || !sparse->indices || !sparse->offsets){
+		sparse_free(sparse);
+		return NULL;
+	}
+	return sparse;
+}
+
+void sparse_free(struct Sparse* sparse){
+	if(!sparse)
+		return;
+	pool_free(sparse->values);
+	pool_free(sparse->indices);
+	pool_free(sparse->offsets);
+	pool_free(sparse);
+}
+
+/*
+ * Stable counting sort of items (0 .. len - 1 when items is NULL) by
+ * keys[item] < buckets into dst.
+ */
+static void counting_sort(uint* dst, const uint* items, const uint* keys,
+		uint buckets, ulong len, uint* count){
+	memset(count, 0, sizeof(uint) * ((ulong)buckets + 1));
+	for(ulong k = 0; k < len; k++)
+		count[keys[items ? items[k] : k] + 1]++;
+	for(uint bucket = 0; bucket < buckets; bucket++)
+		count[bucket + 1] += count[bucket];
+	for(ulong k = 0; k < len; k++){
+		uint item = items ? items[k] : (uint)k;
+		dst[count[keys[item]]++] = item;
+	}
+}
+
+static struct Sparse* compress(uint rows, uint cols, uint nnz, const uint* row_index,
+		const uint* col_index, const float* values, enum SparseFormat format){
+	for(uint k = 0; k < nnz; k++)
+		if(row_index[k] >= rows || col_index[k] >= cols)
+			return NULL;
+	const uint* major = format == SPARSE_CSR ? row_index : col_index;
+	const uint* minor = format == SPARSE_CSR ? col_index : row_index;
+	const uint majors = format == SPARSE_CSR ? rows : cols;
+	const uint minors = format == SPARSE_CSR ? cols : rows;
+	struct Sparse* sparse = sparse_alloc(rows, cols, nnz, format);
+	uint* by_minor = pool_alloc(sizeof(uint) * ((ulong)nnz + 1));
+	uint* order = pool_alloc(sizeof(uint) * ((ulong)nnz + 1));
+	uint* count = pool_alloc(sizeof(uint) * ((ulong)(majors > minors ? majors : minors) + 1));
+	if(!sparse || !by_minor || !order || !count){
+		sparse_free(sparse);
+		sparse = NULL;
+		goto done;
+	}
+	counting_sort(by_minor, NULL, minor, minors, nnz, count);
+	counting_sort(order, by_minor, major, majors, nnz, count);
+	memset(sparse->offsets, 0, sizeof(uint) * ((ulong)majors + 1));
+	uint stored = 0;
+	for(uint k = 0; k < nnz; k++){
+		const uint item = order[k];
+		if(stored && major[order[k - 1]] == major[item] &&
+				sparse->indices[stored - 1] == minor[item]){
+			sparse->values[stored - 1] += values[item];
+			continue;
+		}
+		sparse->values[stored] = values[item];
+		sparse->indices[stored] = minor[item];
+		sparse->offsets[major[item] + 1]++;
+		stored++;
+	}
+	for(uint i = 0; i < majors; i++)
+		sparse->offsets[i + 1] += sparse->offsets[i];
+	sparse->nnz = stored;
+done:
+	pool_free(by_minor);
+	pool_free(order);
+	pool_free(count);
+	return sparse;
+}
+
+/*
+ * Duplicate (row, col) pairs are summed. NULL when an index is out of
+ * range.
+ */
+struct Sparse* sparse_from_triplets(uint rows, uint cols, uint nnz,
+		const uint* row_index, const uint* col_index, const float* values,
+		enum SparseFormat format){
+	return compress(rows, cols, nnz, row_index, col_index, values, format);
+}
+
+/*
+ * Keeps the nonzero elements of matrix, of any dtype.
+ */
+struct Sparse* sparse_from_matrix(struct Matrix* matrix, enum SparseFormat format){
+	uint nnz = 0;
+	for(uint i = 0; i < matrix->rows; i++)
+		for(uint j = 0; j < matrix->cols; j++)
+			nnz += (float)matrix_load(matrix, i, j) != 0;
+	uint* row_index = pool_alloc(sizeof(uint) * ((ulong)nnz + 1));
+	uint* col_index = pool_alloc(sizeof(uint) * ((ulong)nnz + 1));
+	float* values = pool_alloc(sizeof(float) * ((ulong)nnz + 1));
+	struct Sparse* sparse = NULL;
+	if(row_index && col_index && values){
+		uint k = 0;
+		for(uint i = 0; i < matrix->rows; i++)
+			for(uint j = 0; j < matrix->cols; j++){
+				float value = (float)matrix_load(matrix, i, j);
+				if(value == 0)
+					continue;
+				row_index[k] = i;
+				col_index[k] = j;
+				values[k++] = value;
+			}
+		sparse = compress(matrix->rows, matrix->cols, nnz, row_index, col_index,
+				values, format);
+	}
+	pool_free(row_index);
+	pool_free(col_index);
+	pool_free(values);
+	return sparse;
+}
+
+struct Matrix* sparse_to_matrix(struct Sparse* sparse){
+	struct Matrix* result = matrix_new(sparse->rows, sparse->cols, 0);
+	if(!result)
+		return NULL;
+	for(uint i = 0; i < sparse_majors(sparse); i++)
+		for(uint k = sparse->offsets[i]; k < sparse->offsets[i + 1]; k++){
+			if(sparse->format == SPARSE_CSR)
+				*matrix_get(result, i, sparse->indices[k]) = sparse->values[k];
+			else
+				*matrix_get(result, sparse->indices[k], i) = sparse->values[k];
+		}
+	return result;
+}
+
+static struct Sparse* sparse_copy(const struct Sparse* sparse){
+	struct Sparse* result = sparse_alloc(sparse->rows, sparse->cols, sparse->nnz,
+			sparse->format);
+	if(!result)
+		return NULL;
+	memcpy(result->values, sparse->values, sizeof(float) * sparse->nnz);
+	memcpy(result->indices, sparse->indices, sizeof(uint) * sparse->nnz);
+	memcpy(result->offsets, sparse->offsets,
+			sizeof(uint) * ((ulong)sparse_majors(sparse) + 1));
+	return result;
+}
+
+struct Sparse* sparse_convert(struct Sparse* sparse, enum SparseFormat format){
+	if(sparse->format == format)
+		return sparse_copy(sparse);
+	uint* major = pool_alloc(sizeof(uint) * ((ulong)sparse->nnz + 1));
+	if(!major)
+		return NULL;
+	for(uint i = 0; i < sparse_majors(sparse); i++)
+		for(uint k = sparse->offsets[i]; k < sparse->offsets[i + 1]; k++)
+			major[k] = i;
+	struct Sparse* result = sparse->format == SPARSE_CSR ?
+		compress(sparse->rows, sparse->cols, sparse->nnz, major, sparse->indices,
+				sparse->values, format) :
+		compress(sparse->rows, sparse->cols, sparse->nnz, sparse->indices, major,
+				sparse->values, format);
+	pool_free(major);
+	return result;
+}
+
+/*
+ * The arrays of a CSR matrix are the CSC arrays of its transpose, so the
+ * result is in the other format. sparse_convert() brings it back.
+ */
+struct Sparse* sparse_transpose(struct Sparse* sparse){
+	struct Sparse* result = sparse_copy(sparse);
+	if(!result)
+		return NULL;
+	result->rows = sparse->cols;
+	result->cols = sparse->rows;
+	result->format = sparse->format == SPARSE_CSR ? SPARSE_CSC : SPARSE_CSR;
+	return result;
+}
+
+struct SparseTask {
+	const struct Sparse* sparse;
+	const float* src;
+	ulong lds;
+	float* dst;
+	ulong ldd;
+	uint cols;
+};
+
+static void spmv_rows(void* arg, ulong begin, ulong end){
+	struct SparseTask* task = arg;
+	const struct Sparse* sparse = task->sparse;
+	for(ulong i = begin; i < end; i++){
+		const uint offset = sparse->offsets[i];
+		task->dst[i] = kernel_gather_dot(&sparse->values[offset], &sparse->indices[offset],
+				task->src, sparse->offsets[i + 1] - offset);
+	}
+}
+
+static void spmv_scatter(const struct SparseTask* task){
+	const struct Sparse* sparse = task->sparse;
+	memset(task->dst, 0, sizeof(float) * sparse->rows);
+	for(uint j = 0; j < sparse->cols; j++){
+		const float alpha = task->src[j];
+		for(uint k = sparse->offsets[j]; k < sparse->offsets[j + 1]; k++)
+			task->dst[sparse->indices[k]] += sparse->values[k] * alpha;
+	}
+}
+
+static void spmm_rows(void* arg, ulong begin, ulong end){
+	struct SparseTask* task = arg;
+	const struct Sparse* sparse = task->sparse;
+	for(ulong i = begin; i < end; i++){
+		float* dst = &task->dst[i * task->ldd];
+		memset(dst, 0, sizeof(float) * task->cols);
+		for(uint k = sparse->offsets[i]; k < sparse->offsets[i + 1]; k++)
+			kernel_axpy(dst, sparse->values[k],
+					&task->src[(ulong)sparse->indices[k] * task->lds], task->cols);
+	}
+}
+
+/*
+ * Columns begin .. end of the output, scattered from every column of
+ * the CSC matrix.
+ */
+static void spmm_scatter(void* arg, ulong begin, ulong end){
+	struct SparseTask* task = arg;
+	const struct Sparse* sparse = task->sparse;
+	const ulong cols = end - begin;
+	for(uint i = 0; i < sparse->rows; i++)
+		memset(&task->dst[i * task->ldd + begin], 0, sizeof(float) * cols);
+	for(uint j = 0; j < sparse->cols; j++){
+		const float* src = &task->src[j * task->lds + begin];
+		for(uint k = sparse->offsets[j]; k < sparse->offsets[j + 1]; k++)
+			kernel_axpy(&task->dst[sparse->indices[k] * task->ldd + begin],
+					sparse->values[k], src, cols);
+	}
+}
+
+struct Vector* sparse_mul_vector_into(struct Vector* dst,
+		struct Sparse* sparse, struct Vector* vector){
+	if(vector->len != sparse->cols || dst->len != sparse->rows || dst == vector)
+		return NULL;
+	struct Vector* vector_temp = NULL;
+	struct Vector* dst_temp = NULL;
+	struct Vector* result = NULL;
+	if(vector->dtype != DTYPE_F32 && !(vector = vector_temp = vector_astype(vector, DTYPE_F32)))
+		goto done;
+	if(dst->dtype != DTYPE_F32 && !(dst_temp = vector_new(dst->len, 0)))
+		goto done;
+	struct SparseTask task = {.sparse = sparse, .src = vector->values,
+		.dst = dst_temp ? dst_temp->values : dst->values};
+	if(sparse->format == SPARSE_CSC)
+		spmv_scatter(&task);
+	else if(sparse->nnz < PARALLEL_THRESHOLD)
+		spmv_rows(&task, 0, sparse->rows);
+	else
+		parallel_for(sparse->rows, PARALLEL_GRAIN * (ulong)sparse->rows / sparse->nnz + 1,
+				spmv_rows, &task);
+	if(dst_temp)
+		dtype_convert(dst->values, dst->dtype, dst_temp->values, DTYPE_F32, dst->len);
+	result = dst;
+done:
+	vector_free(vector_temp);
+	vector_free(dst_temp);
+	return result;
+}
+
+struct Vector* sparse_mul_vector(struct Sparse* sparse, struct Vector* vector){
+	struct Vector* result = vector_new(sparse->rows, 0);
+	if(!result)
+		return NULL;
+	if(!sparse_mul_vector_into(result, sparse, vector)){
+		vector_free(result);
+		return NULL;
+	}
+	return result;
+}
+
+struct Matrix* sparse_mul_into(struct Matrix* dst,
+		struct Sparse* sparse, struct Matrix* matrix){
+	if(matrix->rows != sparse->cols || dst->rows != sparse->rows ||
+			dst->cols != matrix->cols || dst == matrix)
+		return NULL;
+	struct Matrix* matrix_temp;
+	struct Matrix* dst_temp = NULL;
+	struct Matrix* result = NULL;
+	const struct Matrix* src = matrix_cast(matrix, DTYPE_F32, &matrix_temp);
+	if(!src)
+		goto done;
+	if(dst->dtype != DTYPE_F32 && !(dst_temp = matrix_new(dst->rows, dst->cols, 0)))
+		goto done;
+	struct Matrix* out = dst_temp ? dst_temp : dst;
+	struct SparseTask task = {.sparse = sparse, .src = src->values, .lds = src->ld,
+		.dst = out->values, .ldd = out->ld, .cols = matrix->cols};
+	const ulong work = (ulong)sparse->nnz * matrix->cols;
+	if(sparse->format == SPARSE_CSC){
+		if(work < PARALLEL_THRESHOLD)
+			spmm_scatter(&task, 0, matrix->cols);
+		else
+			parallel_for(matrix->cols, GEMM_NR_MAX * 4, spmm_scatter, &task);
+	}
+	else if(work < PARALLEL_THRESHOLD)
+		spmm_rows(&task, 0, sparse->rows);
+	else
+		parallel_for(sparse->rows, PARALLEL_GRAIN * (ulong)sparse->rows / work + 1,
+				spmm_rows, &task);
+	if(dst_temp)
+		matrix_copy_values(dst, dst_temp);
+	result = dst;
+done:
+	matrix_free(matrix_temp);
+	matrix_free(dst_temp);
+	return result;
+}
+
+struct Matrix* sparse_mul(struct Sparse* sparse, struct Matrix* matrix){
+	struct Matrix* result = matrix_new(sparse->rows, matrix->cols, 0);
+	if(!result)
+		return NULL;
+	if(!sparse_mul_into(result, sparse, matrix)){
+		matrix_free(result);
+		return NULL;
+	}
+	return result;
+}
@@ -0,0 +1,458 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+
+/*
+ * Matrix and vector storage on top of the pooled allocator, the headers
+ * and the values are separate pool blocks so values can grow on their
+ * own. Capacities report what the values block actually holds, which
+ * the power of two size classes round up, so appends only reallocate
+ * once a class is full.
+ *
+ * Matrix rows are SIMD_ALIGNMENT bytes apart at least once they are that
+ * wide, so every row starts on a SIMD_ALIGNMENT boundary and kernels run
+ * their vector loops from an aligned address. Narrower matrices stay
+ * dense, padding them would cost more memory than the tail loops save.
+ *
+ * Everything here works in bytes of the storage dtype, values only change
+ * type in dtype_convert().
+ */
+
+static void fill(void* values, enum Dtype dtype, ulong len, double value){
+	if(value == 0){
+		memset(values, 0, dtype_size(dtype) * len);
+		return;
+	}
+	if(dtype == DTYPE_F64){
+		double* dst = values;
+		for(ulong i = 0; i < len; i++)
+			dst[i] = value;
+		return;
+	}
+	if(dtype == DTYPE_F16 || dtype == DTYPE_BF16){
+		ushort* dst = values;
+		dtype_store(dst, dtype, 0, value);
+		for(ulong i = 1; i < len; i++)
+			dst[i] = dst[0];
+		return;
+	}
+	float* dst = values;
+	for(ulong i = 0; i < len; i++)
+		dst[i] = (float)value;
+}
+
+/*
+ * float32 is the hub, the 16 bit types only convert to and from it
+ * through the SIMD kernels. Other pairs are staged through a float32
+ * buffer CONVERT_STAGE elements at a time.
+ */
+#define CONVERT_STAGE 256
+
+static void widen(float* dst, const void* src, enum Dtype src_dtype, ulong len){
+	switch(src_dtype){
+		case DTYPE_F16:
+			kernel_widen_f16(dst, src, len);
+			break;
+		case DTYPE_BF16:
+			kernel_widen_bf16(dst, src, len);
+			break;
+		case DTYPE_F64:
+			for(ulong i = 0; i < len; i++)
+				dst[i] = (float)((const double*)src)[i];
+			break;
+		default:
+			memcpy(dst, src, sizeof(float) * len);
+	}
+}
+
+static void narrow(void* dst, enum Dtype dst_dtype, const float* src, ulong len){
+	switch(dst_dtype){
+		case DTYPE_F16:
+			kernel_narrow_f16(dst, src, len);
+			break;
+		case DTYPE_BF16:
+			kernel_narrow_bf16(dst, src, len);
+			break;
+		case DTYPE_F64:
+			for(ulong i = 0; i < len; i++)
+				((double*)dst)[i] = src[i];
+			break;
+		default:
+			memcpy(dst, src, sizeof(float) * len);
+	}
+}
+
+void dtype_convert(void* dst, enum Dtype dst_dtype, const void* src,
+		enum Dtype src_dtype, ulong len){
+	if(dst_dtype == src_dtype){
+		memcpy(dst, src, dtype_size(dst_dtype) * len);
+		return;
+	}
+	if(dst_dtype == DTYPE_F32){
+		widen(dst, src, src_dtype, len);
+		return;
+	}
+	if(src_dtype == DTYPE_F32){
+		narrow(dst, dst_dtype, src, len);
+		return;
+	}
+	float stage[CONVERT_STAGE];
+	const uint dst_size = dtype_size(dst_dtype);
+	const uint src_size = dtype_size(src_dtype);
+	for(ulong i = 0, step; i < len; i += step){
+		step = len - i < CONVERT_STAGE ? len - i : CONVERT_STAGE;
+		widen(stage, (const char*)src + i * src_size, src_dtype, step);
+		narrow((char*)dst + i * dst_size, dst_dtype, stage, step);
+	}
+}
+
+uint matrix_ld(uint cols, enum Dtype dtype){
+	const uint pad = SIMD_ALIGNMENT / dtype_size(dtype);
+	if(cols < pad)
+		return cols;
+	return (cols + pad - 1) / pad * pad;
+}
+
+static void set_rows_cap(struct Matrix* matrix){
+	matrix->rows_cap = matrix->ld ?
+		(uint)(pool_size(matrix->values) /
+				(dtype_size(matrix->dtype) * matrix->ld)) :
+		matrix->rows;
+}
+
+struct Matrix* matrix_new_dtype(uint rows, uint cols, double value, enum Dtype dtype){
+	struct Matrix* matrix = pool_alloc(sizeof(struct Matrix));
+	if(!matrix)
+		return NULL;
+	uint ld = matrix_ld(cols, dtype);
+	matrix->values = pool_alloc((ulong)dtype_size(dtype) * rows * ld);
+	if(!matrix->values){
+		pool_free(matrix);
+		return NULL;
+	}
+	matrix->rows = rows;
+	matrix->cols = cols;
+	matrix->cols_cap = matrix->ld = ld;
+	matrix->dtype = dtype;
+	set_rows_cap(matrix);
+	fill(matrix->values, dtype, (ulong)rows * ld, value);
+	return matrix;
+}
+
+struct Matrix* matrix_new(uint rows, uint cols, float value){
+	return matrix_new_dtype(rows, cols, value, DTYPE_F32);
+}
+
+struct Matrix* matrix_randinit_dtype(uint rows, uint cols, enum Dtype dtype){
+	struct Matrix* matrix = matrix_new_dtype(rows, cols, 0, dtype);
+	if(!matrix)
+		return NULL;
+	for(uint i = 0; i < rows; i++)
+		for(uint j = 0; j < cols; j++)
+			matrix_set(matrix, i, j, (double)rand() / RAND_MAX);
+	return matrix;
+}
+
+struct Matrix* matrix_randinit(uint rows, uint cols){
+	return matrix_randinit_dtype(rows, cols, DTYPE_F32);
+}
+
+struct Matrix* matrix_identity_dtype(uint size, enum Dtype dtype){
+	struct Matrix* matrix = matrix_new_dtype(size, size, 0, dtype);
+	if(!matrix)
+		return NULL;
+	for(uint i = 0; i < size; i++)
+		matrix_set(matrix, i, i, 1);
+	return matrix;
+}
+
+struct Matrix* matrix_identity(uint size){
+	return matrix_identity_dtype(size, DTYPE_F32);
+}
+
+struct Matrix* matrix_astype(struct Matrix* matrix, enum Dtype dtype){
+	struct Matrix* result = matrix_new_dtype(matrix->rows, matrix->cols, 0, dtype);
+	if(!result)
+		return NULL;
+	matrix_copy_values(result, matrix);
+	return result;
+}
+
+/*
+ * matrix itself when it already holds dtype, otherwise a converted copy
+ * left in *temp for the caller to free. NULL when the copy fails.
+ */
+const struct Matrix* matrix_cast(const struct Matrix* matrix, enum Dtype dtype,
+		struct Matrix** temp){
+	*temp = NULL;
+	if(matrix->dtype == dtype)
+		return matrix;
+	*temp = matrix_astype((struct Matrix*)matrix, dtype);
+	return *temp;
+}
+
+void matrix_free(struct Matrix* matrix){
+	if(!matrix)
+		return;
+	pool_free(matrix->values);
+	pool_free(matrix);
+}
+
+void matrix_clear(struct Matrix* matrix){
+	const ulong row = (ulong)dtype_size(matrix->dtype) * matrix->cols;
+	if(matrix->ld == matrix->cols){
+		memset(matrix->values, 0, row * matrix->rows);
+		return;
+	}
+	for(uint i = 0; i < matrix->rows; i++)
+		memset(matrix_row_at(matrix, i), 0, row);
+}
+
+/*
+ * Copies src into dst, both of the same shape but possibly of different
+ * leading dimensions and dtypes.
+ */
+void matrix_copy_values(struct Matrix* dst, const struct Matrix* src){
+	if(dst->values == src->values)
+		return;
+	if(dst->ld == dst->cols && src->ld == src->cols){
+		dtype_convert(dst->values, dst->dtype, src->values, src->dtype,
+				(ulong)src->rows * src->cols);
+		return;
+	}
+	for(uint i = 0; i < src->rows; i++)
+		dtype_convert(matrix_row_at(dst, i), dst->dtype, matrix_row_at(src, i), src->dtype,
+				src->cols);
+}
+
+/*
+ * O(1) when the rows are already contiguous, padded rows are packed in
+ * place first, which leaves the reshaped matrix dense.
+ */
+void matrix_reshape(struct Matrix* matrix, uint new_rows, uint new_cols){
+	const ulong row = (ulong)dtype_size(matrix->dtype) * matrix->cols;
+	if(matrix->ld != matrix->cols && matrix->rows > 1)
+		for(uint i = 1; i < matrix->rows; i++)
+			memmove((char*)matrix->values + i * row, matrix_row_at(matrix, i), row);
+	ulong cap = (ulong)matrix->rows_cap * matrix->ld;
+	matrix->rows = new_rows;
+	matrix->cols = new_cols;
+	matrix->cols_cap = matrix->ld = new_cols;
+	matrix->rows_cap = new_cols ? (uint)(cap / new_cols) : new_rows;
+}
+
+struct Vector* matrix_row(struct Matrix* matrix, uint row){
+	struct Vector* vector = vector_new_dtype(matrix->cols, 0, matrix->dtype);
+	if(!vector)
+		return NULL;
+	memcpy(vector->values, matrix_row_at(matrix, row),
+			(ulong)dtype_size(matrix->dtype) * matrix->cols);
+	return vector;
+}
+
+struct Vector* matrix_col(struct Matrix* matrix, uint col){
+	struct Vector* vector = vector_new_dtype(matrix->rows, 0, matrix->dtype);
+	if(!vector)
+		return NULL;
+	for(uint i = 0; i < matrix->rows; i++)
+		vector_set(vector, i, matrix_load(matrix, i, col));
+	return vector;
+}
+
+/*
+ * Copy of the rows x cols block at (row, col), in the matrix's dtype.
+ * Stands in for a view over storage views can't cover.
+ */
+struct Matrix* matrix_block(struct Matrix* matrix, uint row, uint col,
+		uint rows, uint cols){
+	struct Matrix* block = matrix_new_dtype(rows, cols, 0, matrix->dtype);
+	if(!block)
+		return NULL;
+	const uint size = dtype_size(matrix->dtype);
+	for(uint i = 0; i < rows; i++)
+		memcpy(matrix_row_at(block, i), matrix_row_at(matrix, row + i) + (ulong)col * size,
+				(ulong)size * cols);
+	return block;
+}
+
+/*
+ * Writes block over the matching block at (row, col), converting to the
+ * matrix's dtype. 0 when block doesn't fit.
+ */
+uint matrix_set_block(struct Matrix* matrix, uint row, uint col,
+		struct Matrix* block){
+	if((ulong)row + block->rows > matrix->rows || (ulong)col + block->cols > matrix->cols)
+		return 0;
+	const uint size = dtype_size(matrix->dtype);
+	for(uint i = 0; i < block->rows; i++)
+		dtype_convert(matrix_row_at(matrix, row + i) + (ulong)col * size, matrix->dtype,
+				matrix_row_at(block, i), block->dtype, block->cols);
+	return 1;
+}
+
+/*
+ * Moves the rows into a fresh block of at least rows rows spaced ld
+ * apart, the capacities then report what that block holds.
+ */
+static uint relayout(struct Matrix* matrix, uint rows, uint ld){
+	const uint size = dtype_size(matrix->dtype);
+	char* values = pool_alloc((ulong)size * rows * ld);
+	if(!values)
+		return 0;
+	for(uint i = 0; i < matrix->rows; i++)
+		memcpy(&values[(ulong)i * ld * size], matrix_row_at(matrix, i),
+				(ulong)size * matrix->cols);
+	pool_free(matrix->values);
+	matrix->values = (float*)values;
+	matrix->cols_cap = matrix->ld = ld;
+	set_rows_cap(matrix);
+	return 1;
+}
+
+uint matrix_reserve(struct Matrix* matrix, uint rows, uint cols){
+	if(rows <= matrix->rows_cap && cols <= matrix->ld)
+		return 1;
+	uint ld = cols > matrix->ld ? matrix_ld(cols, matrix->dtype) : matrix->ld;
+	return relayout(matrix, rows > matrix->rows ? rows : matrix->rows, ld);
+}
+
+/*
+ * Appended rows and columns are converted to the matrix dtype. The row
+ * capacity doubles when it runs out, like the row padding in push_col.
+ */
+void matrix_push_row(struct Matrix* matrix, struct Vector* vector){
+	if(matrix->ld < matrix->cols){
+		matrix->cols_cap = matrix->ld = matrix_ld(matrix->cols, matrix->dtype);
+		set_rows_cap(matrix);
+	}
+	if(matrix->rows < matrix->rows_cap){
+		dtype_convert(matrix_row_at(matrix, matrix->rows++), matrix->dtype,
+				vector->values, vector->dtype, matrix->cols);
+		return;
+	}
+	const uint size = dtype_size(matrix->dtype);
+	ulong rows_cap = matrix->rows_cap ? (ulong)matrix->rows_cap * 2 : 1;
+	float* values = pool_realloc(matrix->values, (ulong)size * rows_cap * matrix->ld);
+	if(!values)
+		return;
+	matrix->values = values;
+	dtype_convert(matrix_row_at(matrix, matrix->rows), matrix->dtype,
+			vector->values, vector->dtype, matrix->cols);
+	matrix->rows++;
+	set_rows_cap(matrix);
+}
+
+/*
+ * Columns are appended into the row padding. Once that runs out the row
+ * capacity doubles, so a matrix grown one column at a time costs O(rows)
+ * per append on average instead of moving every row each time.
+ */
+void matrix_push_col(struct Matrix* matrix, struct Vector* vector){
+	uint cols = matrix->cols + 1;
+	if(cols > matrix->ld || matrix->rows > matrix->rows_cap){
+		uint ld = matrix_ld(matrix->ld * 2 > cols ? matrix->ld * 2 : cols,
+				matrix->dtype);
+		if(!relayout(matrix, matrix->rows, ld))
+			return;
+	}
+	for(uint i = 0; i < matrix->rows; i++)
+		matrix_set(matrix, i, matrix->cols, vector_load(vector, i));
+	matrix->cols = cols;
+}
+
+/*
+ * The column is dropped by shrinking cols, the row stride stays.
+ */
+struct Vector* matrix_pop_col(struct Matrix* matrix){
+	struct Vector* vector = matrix_col(matrix, matrix->cols - 1);
+	if(vector)
+		matrix->cols--;
+	return vector;
+}
+
+struct Vector* vector_new_dtype(uint len, double value, enum Dtype dtype){
+	struct Vector* vector = pool_alloc(sizeof(struct Vector));
+	if(!vector)
+		return NULL;
+	vector->values = pool_alloc((ulong)dtype_size(dtype) * len);
+	if(!vector->values){
+		pool_free(vector);
+		return NULL;
+	}
+	vector->len = vector->cap = len;
+	vector->dtype = dtype;
+	fill(vector->values, dtype, len, value);
+	return vector;
+}
+
+struct Vector* vector_new(uint len, float value){
+	return vector_new_dtype(len, value, DTYPE_F32);
+}
+
+struct Vector* vector_randinit_dtype(uint len, enum Dtype dtype){
+	struct Vector* vector = vector_new_dtype(len, 0, dtype);
+	if(!vector)
+		return NULL;
+	for(uint i = 0; i < len; i++)
+		vector_set(vector, i, (double)rand() / RAND_MAX);
+	return vector;
+}
+
+struct Vector* vector_randinit(uint len){
+	return vector_randinit_dtype(len, DTYPE_F32);
+}
+
+struct Vector* vector_astype(struct Vector* vector, enum Dtype dtype){
+	struct Vector* result = vector_new_dtype(vector->len, 0, dtype);
+	if(!result)
+		return NULL;
+	dtype_convert(result->values, dtype, vector->values, vector->dtype, vector->len);
+	return result;
+}
+
+struct Vector* vector_from_matrix(struct Matrix* matrix){
+	struct Vector* vector = vector_new_dtype(matrix->rows * matrix->cols, 0,
+			matrix->dtype);
+	if(!vector)
+		return NULL;
+	struct Matrix dense = *matrix;
+	dense.values = vector->values;
+	dense.ld = matrix->cols;
+	matrix_copy_values(&dense, matrix);
+	return vector;
+}
+
+void vector_free(struct Vector* vector){
+	if(!vector)
+		return;
+	pool_free(vector->values);
+	pool_free(vector);
+}
+
+/*
+ * The capacity doubles when it runs out, so pushes are amortized O(1).
+ */
+void vector_push(struct Vector* vector, double value){
+	if(vector->len < vector->cap){
+		vector_set(vector, vector->len++, value);
+		return;
+	}
+	const uint size = dtype_size(vector->dtype);
+	ulong cap = vector->cap ? (ulong)vector->cap * 2 : 1;
+	float* values = pool_realloc(vector->values, (ulong)size * cap);
+	if(!values)
+		return;
+	vector->values = values;
+	vector_set(vector, vector->len++, value);
+	vector->cap = (uint)(pool_size(values) / size);
+}
@@ -0,0 +1,187 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+
+#if HAVE_PTHREAD_H
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include "common.h"
+
+static uint num_threads = 0;
+
+#if HAVE_PTHREAD_H
+struct ThreadPool {
+	pthread_mutex_t submit;
+	pthread_mutex_t lock;
+	pthread_cond_t work;
+	pthread_cond_t done;
+	pthread_t* threads;
+	uint workers;
+	uint active;
+	uint quit;
+	ulong generation;
+	void (*fn)(void* arg, ulong begin, ulong end);
+	void* arg;
+	ulong count;
+	ulong grain;
+	ulong next;
+};
+
+static struct ThreadPool pool = {
+	.submit = PTHREAD_MUTEX_INITIALIZER,
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.work = PTHREAD_COND_INITIALIZER,
+	.done = PTHREAD_COND_INITIALIZER,
+};
+
+static void run_chunks(void){
+	for(;;){
+		ulong begin = __atomic_fetch_add(&pool.next, pool.grain, __ATOMIC_RELAXED);
+		if(begin >= pool.count)
+			return;
+		ulong end = begin + pool.grain < pool.count ? begin + pool.grain : pool.count;
+		pool.fn(pool.arg, begin, end);
+	}
+}
+
+static void* worker(void* unused){
+	(void)unused;
+	ulong seen = 0;
+	pthread_mutex_lock(&pool.lock);
+	for(;;){
+		while(!pool.quit && pool.generation == seen)
+			pthread_cond_wait(&pool.work, &pool.lock);
+		if(pool.quit)
+			break;
+		seen = pool.generation;
+		pthread_mutex_unlock(&pool.lock);
+		run_chunks();
+		pthread_mutex_lock(&pool.lock);
+		if(!--pool.active)
+			pthread_cond_signal(&pool.done);
+	}
+	pthread_mutex_unlock(&pool.lock);
+	return NULL;
+}
+
+static void pool_stop(void){
+	if(!pool.workers)
+		return;
+	pthread_mutex_lock(&pool.lock);
+	pool.quit = 1;
+	pthread_cond_broadcast(&pool.work);
+	pthread_mutex_unlock(&pool.lock);
+	for(uint i = 0; i < pool.workers; i++)
+		pthread_join(pool.threads[i], NULL);
+	free(pool.threads);
+	pool.threads = NULL;
+	pool.workers = 0;
+	pool.quit = 0;
+}
+
+/*
+ * A forked child only has the thread that forked, the workers and
+ * whatever state they held the locks in stay behind in the parent. The
+ * child starts over with a pool that isn't started.
+ */
+static void pool_after_fork(void){
+	pthread_mutex_init(&pool.submit, NULL);
+	pthread_mutex_init(&pool.lock, NULL);
+	pthread_cond_init(&pool.work, NULL);
+	pthread_cond_init(&pool.done, NULL);
+	free(pool.threads);
+	pool.threads = NULL;
+	pool.workers = 0;
+	pool.active = 0;
+	pool.quit = 0;
+}
+
+static void pool_start(uint workers){
+	static uint registered = 0;
+	if(!registered && !pthread_atfork(NULL, NULL, pool_after_fork))
+		registered = 1;
+	pool.threads = malloc(sizeof(pthread_t) * workers);
+	if(!pool.threads)
+		return;
+	for(uint i = 0; i < workers; i++){
+		if(pthread_create(&pool.threads[i], NULL, worker, NULL))
+			break;
+		pool.workers++;
+	}
+}
+#endif
+
+static uint default_threads(void){
+	const char* env = getenv("CRUNUM_NUM_THREADS");
+	if(env && atoi(env) > 0)
+		return (uint)atoi(env);
+#if HAVE_PTHREAD_H
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	return cpus > 0 ? (uint)cpus : 1;
+#else
+	return 1;
+#endif
+}
+
+uint crunum_num_threads(void){
+	if(!num_threads)
+		num_threads = default_threads();
+	return num_threads;
+}
+
+void crunum_set_num_threads(uint threads){
+	threads = threads ? threads : default_threads();
+#if HAVE_PTHREAD_H
+	pthread_mutex_lock(&pool.submit);
+	if(pool.workers + 1 != threads)
+		pool_stop();
+	num_threads = threads;
+	pthread_mutex_unlock(&pool.submit);
+#else
+	num_threads = threads;
+#endif
+}
+
+void parallel_for(ulong count, ulong grain,
+		void (*fn)(void* arg, ulong begin, ulong end), void* arg){
+	grain = grain ? grain : 1;
+	if(!count)
+		return;
+#if HAVE_PTHREAD_H
+	uint threads = crunum_num_threads();
+	if(threads > 1 && count > grain && !pthread_mutex_trylock(&pool.submit)){
+		if(!pool.workers)
+			pool_start(threads - 1);
+		if(pool.workers){
+			pthread_mutex_lock(&pool.lock);
+			pool.fn = fn;
+			pool.arg = arg;
+			pool.count = count;
+			pool.grain = grain;
+			pool.next = 0;
+			pool.active = pool.workers;
+			pool.generation++;
+			pthread_cond_broadcast(&pool.work);
+			pthread_mutex_unlock(&pool.lock);
+			run_chunks();
+			pthread_mutex_lock(&pool.lock);
+			while(pool.active)
+				pthread_cond_wait(&pool.done, &pool.lock);
+			pthread_mutex_unlock(&pool.lock);
+			pthread_mutex_unlock(&pool.submit);
+			return;
+		}
+		pthread_mutex_unlock(&pool.submit);
+	}
+#endif
+	fn(arg, 0, count);
+}
@@ -0,0 +1,229 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "common.h"
+
+/*
+ * Physical transposes.
+ *
+ * The innermost step is a transpose_nr x transpose_nr tile shuffled in
+ * registers by the kernel table, 8x8 on AVX2/AVX-512 and 4x4 on SSE and
+ * NEON. Above it the matrix is halved along its longer side until a
+ * block fits TRANSPOSE_BLOCK on both sides, so the walk stays cache
+ * friendly without tuning for a particular cache size. Splits are kept
+ * on TRANSPOSE_ALIGN so only the right and bottom edges fall back to
+ * scalar code.
+ *
+ * Square matrices transpose in place by swapping mirrored tiles through
+ * a small stack buffer.
+ *
+ * Doubles and the 16 bit types have no register tiles, they are copied
+ * TRANSPOSE_BLOCK square blocks at a time so both sides of a block stay
+ * in cache. 16 bit elements move as raw bit patterns.
+ */
+
+#define TRANSPOSE_BLOCK 64
+#define TRANSPOSE_ALIGN 8
+#define TRANSPOSE_TILE_MAX 8
+
+struct TransposeTask {
+	const struct KernelTable* table;
+	uint rows;
+	uint cols;
+	const float* src;
+	ulong lds;
+	float* dst;
+	ulong ldd;
+};
+
+static void transpose_leaf(const struct KernelTable* table, uint rows, uint cols,
+		const float* src, ulong lds, float* dst, ulong ldd){
+	const uint nr = table->transpose_nr;
+	uint i = 0;
+	for(; i + nr <= rows; i += nr){
+		uint j = 0;
+		for(; j + nr <= cols; j += nr)
+			table->transpose_tile(&src[i * lds + j], lds, &dst[j * ldd + i], ldd);
+		for(; j < cols; j++)
+			for(uint r = i; r < i + nr; r++)
+				dst[j * ldd + r] = src[r * lds + j];
+	}
+	for(; i < rows; i++)
+		for(uint j = 0; j < cols; j++)
+			dst[j * ldd + i] = src[i * lds + j];
+}
+
+static uint transpose_split(uint len){
+	return (len / 2 + TRANSPOSE_ALIGN - 1) & ~(uint)(TRANSPOSE_ALIGN - 1);
+}
+
+static void transpose_rec(const struct KernelTable* table, uint rows, uint cols,
+		const float* src, ulong lds, float* dst, ulong ldd){
+	if(rows <= TRANSPOSE_BLOCK && cols <= TRANSPOSE_BLOCK){
+		transpose_leaf(table, rows, cols, src, lds, dst, ldd);
+		return;
+	}
+	if(rows >= cols){
+		uint half = transpose_split(rows);
+		transpose_rec(table, half, cols, src, lds, dst, ldd);
+		transpose_rec(table, rows - half, cols, &src[half * lds], lds, &dst[half], ldd);
+		return;
+	}
+	uint half = transpose_split(cols);
+	transpose_rec(table, rows, half, src, lds, dst, ldd);
+	transpose_rec(table, rows, cols - half, &src[half], lds, &dst[half * ldd], ldd);
+}
+
+static void transpose_stripes(void* arg, ulong begin, ulong end){
+	struct TransposeTask* task = arg;
+	for(ulong stripe = begin; stripe < end; stripe++){
+		uint row = (uint)stripe * TRANSPOSE_BLOCK;
+		uint rows = task->rows - row < TRANSPOSE_BLOCK ? task->rows - row : TRANSPOSE_BLOCK;
+		transpose_rec(task->table, rows, task->cols, &task->src[row * task->lds],
+				task->lds, &task->dst[row], task->ldd);
+	}
+}
+
+/*
+ * dst[j * ldd + i] = src[i * lds + j] for a rows x cols src, the two
+ * must not overlap. Also used to pack strided panels for the kernels.
+ */
+void transpose_block(uint rows, uint cols, const float* src, ulong lds,
+		float* dst, ulong ldd){
+	const struct KernelTable* table = kernels;
+	if((ulong)rows * cols < PARALLEL_THRESHOLD){
+		transpose_rec(table, rows, cols, src, lds, dst, ldd);
+		return;
+	}
+	struct TransposeTask task = {table, rows, cols, src, lds, dst, ldd};
+	ulong stripes = (rows + TRANSPOSE_BLOCK - 1) / TRANSPOSE_BLOCK;
+	parallel_for(stripes, 1, transpose_stripes, &task);
+}
+
+static void transpose_square(uint n, float* values, ulong ld){
+	const struct KernelTable* table = kernels;
+	const uint nr = table->transpose_nr;
+	const uint full = n - n % nr;
+	float tile[TRANSPOSE_TILE_MAX * TRANSPOSE_TILE_MAX];
+	for(uint bi = 0; bi < full; bi += TRANSPOSE_BLOCK)
+		for(uint bj = bi; bj < full; bj += TRANSPOSE_BLOCK){
+			uint end_i = bi + TRANSPOSE_BLOCK < full ? bi + TRANSPOSE_BLOCK : full;
+			uint end_j = bj + TRANSPOSE_BLOCK < full ? bj + TRANSPOSE_BLOCK : full;
+			for(uint i = bi; i < end_i; i += nr)
+				for(uint j = bj == bi ? i : bj; j < end_j; j += nr){
+					float* upper = &values[i * ld + j];
+					if(i == j){
+						table->transpose_tile(upper, ld, upper, ld);
+						continue;
+					}
+					float* lower = &values[j * ld + i];
+					table->transpose_tile(upper, ld, tile, nr);
+					table->transpose_tile(lower, ld, upper, ld);
+					for(uint r = 0; r < nr; r++)
+						memcpy(&lower[r * ld], &tile[r * nr], sizeof(float) * nr);
+				}
+		}
+	for(uint i = 0; i < n; i++)
+		for(uint j = i + 1 > full ? i + 1 : full; j < n; j++){
+			float temp = values[i * ld + j];
+			values[i * ld + j] = values[j * ld + i];
+			values[j * ld + i] = temp;
+		}
+}
+
+static uint block_end(uint begin, uint len){
+	return len - begin < TRANSPOSE_BLOCK ? len : begin + TRANSPOSE_BLOCK;
+}
+
+static void transpose_f64(uint rows, uint cols, const double* src, ulong lds,
+		double* dst, ulong ldd){
+	for(uint bi = 0; bi < rows; bi += TRANSPOSE_BLOCK)
+		for(uint bj = 0; bj < cols; bj += TRANSPOSE_BLOCK)
+			for(uint i = bi; i < block_end(bi, rows); i++)
+				for(uint j = bj; j < block_end(bj, cols); j++)
+					dst[j * ldd + i] = src[i * lds + j];
+}
+
+static void transpose_square_f64(uint n, double* values, ulong ld){
+	for(uint bi = 0; bi < n; bi += TRANSPOSE_BLOCK)
+		for(uint bj = bi; bj < n; bj += TRANSPOSE_BLOCK)
+			for(uint i = bi; i < block_end(bi, n); i++)
+				for(uint j = bj == bi ? i + 1 : bj; j < block_end(bj, n); j++){
+					double temp = values[i * ld + j];
+					values[i * ld + j] = values[j * ld + i];
+					values[j * ld + i] = temp;
+				}
+}
+
+static void transpose_half(uint rows, uint cols, const ushort* src, ulong lds,
+		ushort* dst, ulong ldd){
+	for(uint bi = 0; bi < rows; bi += TRANSPOSE_BLOCK)
+		for(uint bj = 0; bj < cols; bj += TRANSPOSE_BLOCK)
+			for(uint i = bi; i < block_end(bi, rows); i++)
+				for(uint j = bj; j < block_end(bj, cols); j++)
+					dst[j * ldd + i] = src[i * lds + j];
+}
+
+static void transpose_square_half(uint n, ushort* values, ulong ld){
+	for(uint bi = 0; bi < n; bi += TRANSPOSE_BLOCK)
+		for(uint bj = bi; bj < n; bj += TRANSPOSE_BLOCK)
+			for(uint i = bi; i < block_end(bi, n); i++)
+				for(uint j = bj == bi ? i + 1 : bj; j < block_end(bj, n); j++){
+					ushort temp = values[i * ld + j];
+					values[i * ld + j] = values[j * ld + i];
+					values[j * ld + i] = temp;
+				}
+}
+
+/*
+ * dst = matrix^T. dst may be matrix itself when it is square, any other
+ * overlap is rejected along with a shape mismatch. A matrix of another
+ * dtype than dst is converted first.
+ */
+struct Matrix* matrix_transpose_into(struct Matrix* dst, struct Matrix* matrix){
+	if(dst->rows != matrix->cols || dst->cols != matrix->rows)
+		return NULL;
+	if(dst == matrix || dst->values == matrix->values){
+		if(matrix->rows != matrix->cols || dst->dtype != matrix->dtype)
+			return NULL;
+		if(matrix->dtype == DTYPE_F64)
+			transpose_square_f64(matrix->rows, matrix->values_f64, matrix->ld);
+		else if(dtype_size(matrix->dtype) == sizeof(ushort))
+			transpose_square_half(matrix->rows, matrix->values_half, matrix->ld);
+		else
+			transpose_square(matrix->rows, matrix->values, matrix->ld);
+		return dst;
+	}
+	struct Matrix* temp;
+	const struct Matrix* src = matrix_cast(matrix, dst->dtype, &temp);
+	if(!src)
+		return NULL;
+	if(dst->dtype == DTYPE_F64)
+		transpose_f64(src->rows, src->cols, src->values_f64, src->ld,
+				dst->values_f64, dst->ld);
+	else if(dtype_size(dst->dtype) == sizeof(ushort))
+		transpose_half(src->rows, src->cols, src->values_half, src->ld,
+				dst->values_half, dst->ld);
+	else
+		transpose_block(src->rows, src->cols, src->values, src->ld,
+				dst->values, dst->ld);
+	matrix_free(temp);
+	return dst;
+}
+
+struct Matrix* matrix_transpose(struct Matrix* matrix){
+	struct Matrix* result = matrix_new_dtype(matrix->cols, matrix->rows, 0,
+			matrix->dtype);
+	if(!result)
+		return NULL;
+	matrix_transpose_into(result, matrix);
+	return result;
+}
@@ -0,0 +1,454 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+
+/*
+ * Non-owning views into matrix storage.
+ *
+ * A view is rows x cols elements whose rows start ld floats apart, so a
+ * row of a matrix is a 1 x cols view, a column a rows x 1 view with
+ * ld = cols and a sub-block keeps the ld of its matrix. Rows of a view
+ * are contiguous and go straight to the SIMD kernels. A column is walked
+ * VIEW_BLOCK elements at a time through stack buffers, so the kernels
+ * still see contiguous runs.
+ *
+ * Two views match when they have the same shape, or when both are one
+ * dimensional with the same length, so a row can be added to a column.
+ *
+ * A transposed view swaps the roles of rows and columns over the same
+ * storage, its rows are strided and go through the same blocked walk as
+ * columns do. Products hand the flag to gemm_trans, so A^T * B and
+ * friends are computed without materializing the transpose. Copying
+ * between a transposed and a plain 2D view goes through transpose_block,
+ * the two must not overlap then.
+ *
+ * Views only cover float32 storage, view_block refuses other dtypes and
+ * view_matrix/view_vector callers must check.
+ */
+
+#define VIEW_BLOCK 256
+
+/*
+ * One dimensional walk over a view, len elements stride floats apart.
+ */
+struct Line {
+	float* values;
+	ulong len;
+	ulong stride;
+};
+
+struct ViewOp {
+	void (*binary)(float* dst, const float* src1, const float* src2, ulong len);
+	void (*scalar)(float* dst, const float* src, float scalar, ulong len);
+	void (*scalar_left)(float* dst, float scalar, const float* src, ulong len);
+	float value;
+};
+
+struct ViewTask {
+	const struct ViewOp* op;
+	struct View* dst;
+	const struct View* view1;
+	const struct View* view2;
+};
+
+void view_matrix(struct View* view, struct Matrix* matrix){
+	view->values = matrix->values;
+	view->rows = matrix->rows;
+	view->cols = matrix->cols;
+	view->ld = matrix->ld;
+	view->transposed = 0;
+}
+
+void view_vector(struct View* view, struct Vector* vector){
+	view->values = vector->values;
+	view->rows = 1;
+	view->cols = vector->len;
+	view->ld = vector->len;
+	view->transposed = 0;
+}
+
+uint view_block(struct View* view, struct Matrix* matrix,
+		uint row, uint col, uint rows, uint cols){
+	if(matrix->dtype != DTYPE_F32 ||
+			row > matrix->rows || rows > matrix->rows - row ||
+			col > matrix->cols || cols > matrix->cols - col)
+		return 0;
+	view->values = matrix_get(matrix, row, col);
+	view->rows = rows;
+	view->cols = cols;
+	view->ld = matrix->ld;
+	view->transposed = 0;
+	return 1;
+}
+
+uint view_row(struct View* view, struct Matrix* matrix, uint row){
+	return view_block(view, matrix, row, 0, 1, matrix->cols);
+}
+
+uint view_col(struct View* view, struct Matrix* matrix, uint col){
+	return view_block(view, matrix, 0, col, matrix->rows, 1);
+}
+
+void view_transpose(struct View* dst, const struct View* view){
+	struct View result = *view;
+	result.rows = view->cols;
+	result.cols = view->rows;
+	result.transposed = !view->transposed;
+	*dst = result;
+}
+
+static ulong view_row_step(const struct View* view){
+	return view->transposed ? 1 : view->ld;
+}
+
+static ulong view_col_step(const struct View* view){
+	return view->transposed ? view->ld : 1;
+}
+
+static struct Line view_line(const struct View* view){
+	struct Line line = {view->values, (ulong)view->rows * view->cols,
+		view->rows == 1 ? view_col_step(view) : view_row_step(view)};
+	return line;
+}
+
+static struct Line view_row_line(const struct View* view, uint row){
+	struct Line line = {&view->values[row * view_row_step(view)], view->cols,
+		view_col_step(view)};
+	return line;
+}
+
+static uint view_match(const struct View* view1, const struct View* view2){
+	if(view1->rows == view2->rows && view1->cols == view2->cols)
+		return 1;
+	return view_is_1d(view1) && view_is_1d(view2) &&
+		(ulong)view1->rows * view1->cols == (ulong)view2->rows * view2->cols;
+}
+
+static void apply(const struct ViewOp* op, float* dst,
+		const float* src1, const float* src2, ulong len){
+	if(op->binary)
+		op->binary(dst, src1, src2, len);
+	else if(op->scalar)
+		op->scalar(dst, src1, op->value, len);
+	else
+		op->scalar_left(dst, op->value, src1, len);
+}
+
+static const float* gather(float* buffer, const struct Line* line,
+		ulong begin, ulong len){
+	const float* src = &line->values[begin * line->stride];
+	if(line->stride == 1)
+		return src;
+	for(ulong i = 0; i < len; i++)
+		buffer[i] = src[i * line->stride];
+	return buffer;
+}
+
+/*
+ * dst may be src1 or src2 element for element, gathers of a block finish
+ * before its scatter starts.
+ */
+static void apply_lines(const struct ViewOp* op, const struct Line* dst,
+		const struct Line* src1, const struct Line* src2){
+	if(dst->stride == 1 && src1->stride == 1 && (!src2 || src2->stride == 1)){
+		apply(op, dst->values, src1->values, src2 ? src2->values : NULL, dst->len);
+		return;
+	}
+	float buffer0[VIEW_BLOCK];
+	float buffer1[VIEW_BLOCK];
+	float buffer2[VIEW_BLOCK];
+	for(ulong begin = 0; begin < dst->len; begin += VIEW_BLOCK){
+		ulong len = dst->len - begin < VIEW_BLOCK ? dst->len - begin : VIEW_BLOCK;
+		const float* value1 = gather(buffer1, src1, begin, len);
+		const float* value2 = src2 ? gather(buffer2, src2, begin, len) : NULL;
+		float* out = &dst->values[begin * dst->stride];
+		if(dst->stride == 1){
+			apply(op, out, value1, value2, len);
+			continue;
+		}
+		apply(op, buffer0, value1, value2, len);
+		for(ulong i = 0; i < len; i++)
+			out[i * dst->stride] = buffer0[i];
+	}
+}
+
+static void view_rows(void* arg, ulong begin, ulong end){
+	struct ViewTask* task = arg;
+	const struct View* view2 = task->view2;
+	for(ulong i = begin; i < end; i++){
+		struct Line line0 = view_row_line(task->dst, i);
+		struct Line line1 = view_row_line(task->view1, i);
+		struct Line line2 = view2 ? view_row_line(view2, i) : line1;
+		apply_lines(task->op, &line0, &line1, view2 ? &line2 : NULL);
+	}
+}
+
+static struct View* run_view(const struct ViewOp* op, struct View* dst,
+		const struct View* view1, const struct View* view2){
+	if(!view_match(dst, view1) || (view2 && !view_match(dst, view2)))
+		return NULL;
+	if(view_is_1d(dst)){
+		struct Line line0 = view_line(dst);
+		struct Line line1 = view_line(view1);
+		struct Line line2 = view2 ? view_line(view2) : line1;
+		apply_lines(op, &line0, &line1, view2 ? &line2 : NULL);
+		return dst;
+	}
+	struct ViewTask task = {op, dst, view1, view2};
+	if((ulong)dst->rows * dst->cols < PARALLEL_THRESHOLD)
+		view_rows(&task, 0, dst->rows);
+	else
+		parallel_for(dst->rows, PARALLEL_GRAIN / dst->cols + 1, view_rows, &task);
+	return dst;
+}
+
+#define VIEW_BINARY(name, kernel) \
+	struct View* name##_into(struct View* dst, \
+			const struct View* view1, const struct View* view2){ \
+		struct ViewOp op = {kernel, NULL, NULL, 0}; \
+		return run_view(&op, dst, view1, view2); \
+	}
+
+#define VIEW_SCALAR(name, kernel) \
+	struct View* name##_into(struct View* dst, \
+			const struct View* view, float scalar){ \
+		struct ViewOp op = {NULL, kernel, NULL, scalar}; \
+		return run_view(&op, dst, view, NULL); \
+	}
+
+#define SCALAR_VIEW(name, kernel) \
+	struct View* name##_into(struct View* dst, \
+			float scalar, const struct View* view){ \
+		struct ViewOp op = {NULL, NULL, kernel, scalar}; \
+		return run_view(&op, dst, view, NULL); \
+	}
+
+VIEW_BINARY(view_add, kernel_add)
+VIEW_BINARY(view_sub, kernel_sub)
+VIEW_BINARY(view_mul, kernel_mul)
+VIEW_BINARY(view_div, kernel_div)
+VIEW_SCALAR(view_add_scalar, kernel_add_scalar)
+VIEW_SCALAR(view_sub_scalar, kernel_sub_scalar)
+VIEW_SCALAR(view_mul_scalar, kernel_mul_scalar)
+VIEW_SCALAR(view_div_scalar, kernel_div_scalar)
+SCALAR_VIEW(scalar_sub_view, kernel_scalar_sub)
+SCALAR_VIEW(scalar_div_view, kernel_scalar_div)
+
+static void copy_line(const struct Line* dst, const struct Line* src){
+	if(dst->stride == 1 && src->stride == 1){
+		memmove(dst->values, src->values, sizeof(float) * dst->len);
+		return;
+	}
+	for(ulong i = 0; i < dst->len; i++)
+		dst->values[i * dst->stride] = src->values[i * src->stride];
+}
+
+struct View* view_copy_into(struct View* dst, const struct View* view){
+	if(!view_match(dst, view))
+		return NULL;
+	if(!view_is_1d(dst) && dst->transposed && view->transposed){
+		struct View dst_t, view_t;
+		view_transpose(&dst_t, dst);
+		view_transpose(&view_t, view);
+		return view_copy_into(&dst_t, &view_t) ? dst : NULL;
+	}
+	if(!view_is_1d(dst) && dst->transposed != view->transposed){
+		if(view->transposed)
+			transpose_block(view->cols, view->rows, view->values, view->ld,
+					dst->values, dst->ld);
+		else
+			transpose_block(view->rows, view->cols, view->values, view->ld,
+					dst->values, dst->ld);
+		return dst;
+	}
+	if(!view_is_1d(dst)){
+		for(uint i = 0; i < dst->rows; i++){
+			struct Line line0 = view_row_line(dst, i);
+			struct Line line1 = view_row_line(view, i);
+			copy_line(&line0, &line1);
+		}
+		return dst;
+	}
+	struct Line line0 = view_line(dst);
+	struct Line line1 = view_line(view);
+	copy_line(&line0, &line1);
+	return dst;
+}
+
+struct View* view_fill(struct View* dst, float value){
+	for(uint i = 0; i < dst->rows; i++)
+		for(uint j = 0; j < dst->cols; j++)
+			*view_get(dst, i, j) = value;
+	return dst;
+}
+
+float view_dot(const struct View* view1, const struct View* view2){
+	if(!view_is_1d(view1) || !view_match(view1, view2))
+		return 0;
+	struct Line line1 = view_line(view1);
+	struct Line line2 = view_line(view2);
+	if(line1.stride == 1 && line2.stride == 1)
+		return kernel_dot(line1.values, line2.values, line1.len);
+	float buffer1[VIEW_BLOCK];
+	float buffer2[VIEW_BLOCK];
+	float sum = 0;
+	for(ulong begin = 0; begin < line1.len; begin += VIEW_BLOCK){
+		ulong len = line1.len - begin < VIEW_BLOCK ? line1.len - begin : VIEW_BLOCK;
+		sum += kernel_dot(gather(buffer1, &line1, begin, len),
+				gather(buffer2, &line2, begin, len), len);
+	}
+	return sum;
+}
+
+static uint eq_lines(const struct Line* line1, const struct Line* line2){
+	float buffer1[VIEW_BLOCK];
+	float buffer2[VIEW_BLOCK];
+	for(ulong begin = 0; begin < line1->len; begin += VIEW_BLOCK){
+		ulong len = line1->len - begin < VIEW_BLOCK ? line1->len - begin : VIEW_BLOCK;
+		if(!kernel_cmp(gather(buffer1, line1, begin, len),
+					gather(buffer2, line2, begin, len), len, CMP_EQ))
+			return 0;
+	}
+	return 1;
+}
+
+uint view_eq(const struct View* view1, const struct View* view2){
+	if(!view_match(view1, view2))
+		return 0;
+	if(!view_is_1d(view1)){
+		for(uint i = 0; i < view1->rows; i++){
+			struct Line line1 = view_row_line(view1, i);
+			struct Line line2 = view_row_line(view2, i);
+			if(!eq_lines(&line1, &line2))
+				return 0;
+		}
+		return 1;
+	}
+	struct Line line1 = view_line(view1);
+	struct Line line2 = view_line(view2);
+	return eq_lines(&line1, &line2);
+}
+
+struct Matrix* matrix_from_view(const struct View* view){
+	struct Matrix* result = matrix_new(view->rows, view->cols, 0);
+	if(!result)
+		return NULL;
+	struct View dst;
+	view_matrix(&dst, result);
+	view_copy_into(&dst, view);
+	return result;
+}
+
+struct Vector* vector_from_view(const struct View* view){
+	if(!view_is_1d(view))
+		return NULL;
+	struct Vector* result = vector_new(view->rows * view->cols, 0);
+	if(!result)
+		return NULL;
+	struct View dst;
+	view_vector(&dst, result);
+	view_copy_into(&dst, view);
+	return result;
+}
+
+/*
+ * y = op(A) * x with x and y contiguous. Rows of an untransposed A are
+ * dotted with x, a transposed A is accumulated one stored row at a time,
+ * so both read A in storage order.
+ */
+static void view_gemv(const struct View* view, const float* x, float* y){
+	if(!view->transposed){
+		for(uint i = 0; i < view->rows; i++)
+			y[i] = kernel_dot(&view->values[(ulong)i * view->ld], x, view->cols);
+		return;
+	}
+	memset(y, 0, sizeof(float) * view->rows);
+	for(uint p = 0; p < view->cols; p++)
+		kernel_axpy(y, x[p], &view->values[(ulong)p * view->ld], view->rows);
+}
+
+static struct View* view_matvec(struct View* dst,
+		const struct View* view, const struct View* vector){
+	struct Line x = view_line(vector);
+	struct Line y = view_line(dst);
+	float* buffer = NULL;
+	if(x.stride != 1 || y.stride != 1){
+		buffer = malloc(sizeof(float) * (x.len + y.len));
+		if(!buffer)
+			return NULL;
+	}
+	const float* values = x.values;
+	if(x.stride != 1){
+		for(ulong i = 0; i < x.len; i++)
+			buffer[i] = x.values[i * x.stride];
+		values = buffer;
+	}
+	if(y.stride == 1)
+		view_gemv(view, values, y.values);
+	else{
+		float* out = &buffer[x.len];
+		view_gemv(view, values, out);
+		for(ulong i = 0; i < y.len; i++)
+			y.values[i * y.stride] = out[i];
+	}
+	free(buffer);
+	return dst;
+}
+
+/*
+ * dst = view1 * view2, dst must not overlap either operand. Either side
+ * may be transposed, a transposed dst is filled as dst^T = view2^T * view1^T.
+ * A single row or column result takes the GEMV path instead of gemm.
+ */
+struct View* view_matmul_into(struct View* dst,
+		const struct View* view1, const struct View* view2){
+	if(view1->cols != view2->rows || dst->rows != view1->rows ||
+			dst->cols != view2->cols)
+		return NULL;
+	if(dst->transposed){
+		struct View dst_t, view1_t, view2_t;
+		view_transpose(&dst_t, dst);
+		view_transpose(&view1_t, view1);
+		view_transpose(&view2_t, view2);
+		return view_matmul_into(&dst_t, &view2_t, &view1_t) ? dst : NULL;
+	}
+	if(view2->cols == 1)
+		return view_matvec(dst, view1, view2);
+	if(view1->rows == 1){
+		struct View view1_t, view2_t;
+		view_transpose(&view1_t, view1);
+		view_transpose(&view2_t, view2);
+		return view_matvec(dst, &view2_t, &view1_t);
+	}
+	for(uint i = 0; i < dst->rows; i++)
+		memset(&dst->values[(ulong)i * dst->ld], 0, sizeof(float) * dst->cols);
+	gemm_trans(view1->transposed, view2->transposed, view1->rows, view2->cols,
+			view1->cols, view1->values, view1->ld, view2->values, view2->ld,
+			dst->values, dst->ld);
+	return dst;
+}
+
+struct Matrix* view_matmul(const struct View* view1, const struct View* view2){
+	if(view1->cols != view2->rows)
+		return NULL;
+	struct Matrix* result = matrix_new(view1->rows, view2->cols, 0);
+	if(!result)
+		return NULL;
+	struct View dst;
+	view_matrix(&dst, result);
+	if(!view_matmul_into(&dst, view1, view2)){
+		matrix_free(result);
+		return NULL;
+	}
+	return result;
+}
@@ -0,0 +1,216 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#pragma message "Lua batched matrix"
+
+#include "lua_bind.h"
+
+static int push_batch(lua_State* lua, struct Batch* batch){
+	if(!batch){
+		luaL_error(lua, "Not enough memory");
+		return 0;
+	}
+	struct Batch** result = lua_newuserdata(lua, sizeof(struct Batch*));
+	*result = batch;
+	luaL_getmetatable(lua, "CrunumBatch");
+	lua_setmetatable(lua, -2);
+	return 1;
+}
+
+static int push_dst(lua_State* lua, int index, void* result){
+	if(!result){
+		luaL_error(lua, "Destination shape doesn't match result shape");
+		return 0;
+	}
+	lua_pushvalue(lua, index);
+	return 1;
+}
+
+static uint check_index(lua_State* lua, int index, struct Batch* batch){
+	lua_Integer value = luaL_checkinteger(lua, index);
+	if(value < 1 || value > batch->count){
+		luaL_error(lua, "Out of bound");
+		return 0;
+	}
+	return (uint)value - 1;
+}
+
+static int l_batch_new(lua_State* lua){
+	lua_Integer count = luaL_checkinteger(lua, 1);
+	lua_Integer rows = luaL_checkinteger(lua, 2);
+	lua_Integer cols = luaL_checkinteger(lua, 3);
+	float value = (float)luaL_optnumber(lua, 4, 0);
+	if(count < 0 || rows < 0 || cols < 0){
+		luaL_error(lua, "Batch dimension can't be negative");
+		return 0;
+	}
+	return push_batch(lua, batch_new((uint)count, (uint)rows, (uint)cols, value));
+}
+
+static int l_batch_identity(lua_State* lua){
+	lua_Integer count = luaL_checkinteger(lua, 1);
+	lua_Integer size = luaL_checkinteger(lua, 2);
+	if(count < 0 || size < 0){
+		luaL_error(lua, "Batch dimension can't be negative");
+		return 0;
+	}
+	return push_batch(lua, batch_identity((uint)count, (uint)size));
+}
+
+/*
+ * crn.batch.stack({m1, m2, ...}), every matrix of the same shape.
+ */
+static int l_batch_stack(lua_State* lua){
+	luaL_checktype(lua, 1, LUA_TTABLE);
+	uint count = lua_rawlen(lua, 1);
+	if(!count){
+		luaL_error(lua, "Batch needs at least one matrix");
+		return 0;
+	}
+	lua_rawgeti(lua, 1, 1);
+	struct Matrix* first = *(struct Matrix**)luaL_checkudata(lua, -1, "CrunumMatrix");
+	lua_pop(lua, 1);
+	push_batch(lua, batch_new(count, first->rows, first->cols, 0));
+	struct Batch* batch = *(struct Batch**)lua_touserdata(lua, -1);
+	for(uint index = 0; index < count; index++){
+		lua_rawgeti(lua, 1, index + 1);
+		struct Matrix* matrix = *(struct Matrix**)luaL_checkudata(lua, -1, "CrunumMatrix");
+		if(!batch_set(batch, index, matrix)){
+			luaL_error(lua, "Matrices in a batch should have the same shape");
+			return 0;
+		}
+		lua_pop(lua, 1);
+	}
+	return 1;
+}
+
+static int l_batch_get(lua_State* lua){
+	struct Batch* batch = *(struct Batch**)luaL_checkudata(lua, 1, "CrunumBatch");
+	uint index = check_index(lua, 2, batch);
+	struct Matrix** result = lua_newuserdata(lua, sizeof(struct Matrix*));
+	*result = batch_get(batch, index);
+	luaL_getmetatable(lua, "CrunumMatrix");
+	lua_setmetatable(lua, -2);
+	return 1;
+}
+
+static int l_batch_set(lua_State* lua){
+	struct Batch* batch = *(struct Batch**)luaL_checkudata(lua, 1, "CrunumBatch");
+	uint index = check_index(lua, 2, batch);
+	struct Matrix* matrix = *(struct Matrix**)luaL_checkudata(lua, 3, "CrunumMatrix");
+	if(!batch_set(batch, index, matrix)){
+		luaL_error(lua, "Matrix shape doesn't match batch shape");
+		return 0;
+	}
+	return 0;
+}
+
+/*
+ * Product with a batch (either side may hold a single matrix, which is
+ * then applied to every matrix of the other) or with a vector applied to
+ * every matrix. An optional third argument receives the result.
+ */
+static int l_batch_mul(lua_State* lua){
+	struct Batch* batch = *(struct Batch**)luaL_checkudata(lua, 1, "CrunumBatch");
+	struct Batch** dst = luaL_testudata(lua, 3, "CrunumBatch");
+	struct Batch** other = luaL_testudata(lua, 2, "CrunumBatch");
+	if(other){
+		if(batch->cols != (*other)->rows){
+			luaL_error(lua, "Batch col size doesn't match another batch row size");
+			return 0;
+		}
+		if(batch->count != (*other)->count && batch->count != 1 && (*other)->count != 1){
+			luaL_error(lua, "Batch count doesn't match another batch count");
+			return 0;
+		}
+		if(dst)
+			return push_dst(lua, 3, batch_mul_into(*dst, batch, *other));
+		return push_batch(lua, batch_mul(batch, *other));
+	}
+	struct Vector* vector = *(struct Vector**)luaL_checkudata(lua, 2, "CrunumVector");
+	if(batch->cols != vector->len){
+		luaL_error(lua, "Batch col size doesn't match vector length");
+		return 0;
+	}
+	if(dst)
+		return push_dst(lua, 3, batch_mul_vector_into(*dst, batch, vector));
+	return push_batch(lua, batch_mul_vector(batch, vector));
+}
+
+static int l_batch_transpose(lua_State* lua){
+	struct Batch* batch = *(struct Batch**)luaL_checkudata(lua, 1, "CrunumBatch");
+	struct Batch** dst = luaL_testudata(lua, 2, "CrunumBatch");
+	if(dst)
+		return push_dst(lua, 2, batch_transpose_into(*dst, batch));
+	return push_batch(lua, batch_transpose(batch));
+}
+
+/*
+ * Returns the inverses and how many matrices were singular, those come
+ * out as NaN.
+ */
+static int l_batch_inverse(lua_State* lua){
+	struct Batch* batch = *(struct Batch**)luaL_checkudata(lua, 1, "CrunumBatch");
+	struct Batch** dst = luaL_testudata(lua, 2, "CrunumBatch");
+	if(batch->rows != batch->cols){
+		luaL_error(lua, "Batch isn't square");
+		return 0;
+	}
+	uint singular;
+	if(dst)
+		push_dst(lua, 2, batch_inverse_into(*dst, batch, &singular));
+	else
+		push_batch(lua, batch_inverse(batch, &singular));
+	lua_pushinteger(lua, singular);
+	return 2;
+}
+
+static int l_batch_count(lua_State* lua){
+	struct Batch* batch = *(struct Batch**)luaL_checkudata(lua, 1, "CrunumBatch");
+	lua_pushinteger(lua, batch->count);
+	return 1;
+}
+
+static int l_batch_rows(lua_State* lua){
+	struct Batch* batch = *(struct Batch**)luaL_checkudata(lua, 1, "CrunumBatch");
+	lua_pushinteger(lua, batch->rows);
+	return 1;
+}
+
+static int l_batch_cols(lua_State* lua){
+	struct Batch* batch = *(struct Batch**)luaL_checkudata(lua, 1, "CrunumBatch");
+	lua_pushinteger(lua, batch->cols);
+	return 1;
+}
+
+static int l_batch_gc(lua_State* lua){
+	struct Batch* batch = *(struct Batch**)luaL_checkudata(lua, 1, "CrunumBatch");
+	batch_free(batch);
+	return 0;
+}
+
+const luaL_Reg batch_functions[] = {
+	{"new", l_batch_new},
+	{"identity", l_batch_identity},
+	{"stack", l_batch_stack},
+	{NULL, NULL}
+};
+
+const luaL_Reg batch_methods[] = {
+	{"get", l_batch_get},
+	{"set", l_batch_set},
+	{"mul", l_batch_mul},
+	{"transpose", l_batch_transpose},
+	{"inverse", l_batch_inverse},
+	{"count", l_batch_count},
+	{"rows", l_batch_rows},
+	{"cols", l_batch_cols},
+	{"__mul", l_batch_mul},
+	{"__len", l_batch_count},
+	{"__gc", l_batch_gc},
+	{NULL, NULL}
+};
@@ -14,6 +14,121 @@
 
 #include "lua_bind.h"
 
+/*
+ * Element types are spelled like numpy's, a missing argument means
+ * float32.
+ */
+static const char* const dtype_names[] = {"float32", "float64", "float16", "bfloat16",
+	NULL};
+
+enum Dtype l_check_dtype(lua_State* lua, int index){
+	return (enum Dtype)luaL_checkoption(lua, index, "float32", dtype_names);
+}
+
+void l_push_dtype(lua_State* lua, enum Dtype dtype){
+	lua_pushstring(lua, dtype_names[dtype]);
+}
+
+static const char* const map_names[] = {"exp", "log", "tanh", "sigmoid", "erf", "sqrt",
+	"rsqrt", "abs", "clamp", "pow", NULL};
+
+/*
+ * A map function name at index and its parameters: clamp takes a lower
+ * and an upper bound, pow an exponent. Returns the index past them.
+ */
+int l_check_map(lua_State* lua, int index, enum MapFn* fn, double* param1, double* param2){
+	*fn = (enum MapFn)luaL_checkoption(lua, index, NULL, map_names);
+	*param1 = *param2 = 0;
+	if(*fn == MAP_CLAMP){
+		*param1 = luaL_checknumber(lua, index + 1);
+		*param2 = luaL_checknumber(lua, index + 2);
+		return index + 3;
+	}
+	if(*fn == MAP_POW){
+		*param1 = luaL_checknumber(lua, index + 1);
+		return index + 2;
+	}
+	return index + 1;
+}
+
+static int l_crunum_num_threads(lua_State* lua){
+	lua_pushinteger(lua, crunum_num_threads());
+	return 1;
+}
+
+static int l_crunum_set_num_threads(lua_State* lua){
+	int threads = luaL_checkinteger(lua, 1);
+	if(threads < 0){
+		luaL_error(lua, "Thread count can't be negative");
+		return 0;
+	}
+	crunum_set_num_threads((uint)threads);
+	return 0;
+}
+
+/*
+ * crn.arena(fn, ...) runs fn inside an allocator arena. Garbage is
+ * collected on the way out so the temporaries fn left behind go back to
+ * the pool together, anything still referenced, results included, is
+ * kept alive.
+ */
+static int l_crunum_arena(lua_State* lua){
+	luaL_checktype(lua, 1, LUA_TFUNCTION);
+	if(!crunum_arena_begin()){
+		luaL_error(lua, "Can't open an arena");
+		return 0;
+	}
+	int status = lua_pcall(lua, lua_gettop(lua) - 1, LUA_MULTRET, 0);
+	lua_gc(lua, LUA_GCCOLLECT, 0);
+	crunum_arena_leave();
+	if(status != LUA_OK){
+		lua_error(lua);
+		return 0;
+	}
+	return lua_gettop(lua);
+}
+
+static int l_crunum_pool_stats(lua_State* lua){
+	struct PoolStats stats;
+	crunum_pool_stats(&stats);
+	lua_createtable(lua, 0, 6);
+	lua_pushinteger(lua, (lua_Integer)stats.allocs);
+	lua_setfield(lua, -2, "allocs");
+	lua_pushinteger(lua, (lua_Integer)stats.hits);
+	lua_setfield(lua, -2, "hits");
+	lua_pushinteger(lua, (lua_Integer)stats.misses);
+	lua_setfield(lua, -2, "misses");
+	lua_pushinteger(lua, (lua_Integer)stats.frees);
+	lua_setfield(lua, -2, "frees");
+	lua_pushinteger(lua, (lua_Integer)stats.arena_frees);
+	lua_setfield(lua, -2, "arena_frees");
+	lua_pushinteger(lua, (lua_Integer)stats.cached_bytes);
+	lua_setfield(lua, -2, "cached_bytes");
+	return 1;
+}
+
+static int l_crunum_pool_reset_stats(lua_State* lua){
+	(void)lua;
+	crunum_pool_reset_stats();
+	return 0;
+}
+
+static int l_crunum_pool_trim(lua_State* lua){
+	(void)lua;
+	crunum_pool_trim();
+	return 0;
+}
+
+static const luaL_Reg crunum_functions[] = {
+	{"num_threads", l_crunum_num_threads},
+	{"set_num_threads", l_crunum_set_num_threads},
+	{"arena", l_crunum_arena},
+	{"pool_stats", l_crunum_pool_stats},
+	{"pool_reset_stats", l_crunum_pool_reset_stats},
+	{"pool_trim", l_crunum_pool_trim},
+	{NULL, NULL}
+};
+
 int luaopen_crunum(lua_State* lua){
 	srand(time(NULL));
 	luaL_newmetatable(lua, "CrunumMatrix");
@@ -24,12 +139,49 @@ int luaopen_crunum(lua_State* lua){
 	lua_pushvalue(lua, -1);
 	lua_setfield(lua, -2, "__index");
 	luaL_setfuncs(lua, vector_methods, 0);
+	luaL_newmetatable(lua, "CrunumExpr");
+	lua_pushvalue(lua, -1);
+	lua_setfield(lua, -2, "__index");
+	luaL_setfuncs(lua, expr_methods, 0);
+	lua_pop(lua, 1);
+	luaL_newmetatable(lua, "CrunumLU");
+	lua_pushvalue(lua, -1);
+	lua_setfield(lua, -2, "__index");
+	luaL_setfuncs(lua, lu_methods, 0);
+	lua_pop(lua, 1);
+	luaL_newmetatable(lua, "CrunumQMatrix");
+	lua_pushvalue(lua, -1);
+	lua_setfield(lua, -2, "__index");
+	luaL_setfuncs(lua, qmatrix_methods, 0);
+	lua_pop(lua, 1);
+	luaL_newmetatable(lua, "CrunumSparse");
+	lua_pushvalue(lua, -1);
+	lua_setfield(lua, -2, "__index");
+	luaL_setfuncs(lua, sparse_methods, 0);
+	lua_pop(lua, 1);
+	luaL_newmetatable(lua, "CrunumBatch");
+	lua_pushvalue(lua, -1);
+	lua_setfield(lua, -2, "__index");
+	luaL_setfuncs(lua, batch_methods, 0);
+	lua_pop(lua, 1);
+	luaL_newmetatable(lua, "CrunumMask");
+	lua_pushvalue(lua, -1);
+	lua_setfield(lua, -2, "__index");
+	luaL_setfuncs(lua, mask_methods, 0);
+	lua_pop(lua, 1);
+	luaL_newmetatable(lua, "CrunumView");
+	luaL_setfuncs(lua, view_methods, 0);
+	lua_pop(lua, 1);
 	lua_newtable(lua);
 	luaL_setfuncs(lua, matrix_functions, 0);
 	lua_setfield(lua, -2, "matrix");
 	lua_newtable(lua);
 	luaL_setfuncs(lua, vector_functions, 0);
 	lua_setfield(lua, -2, "vector");
+	lua_newtable(lua);
+	luaL_setfuncs(lua, batch_functions, 0);
+	lua_setfield(lua, -2, "batch");
+	luaL_setfuncs(lua, crunum_functions, 0);
 	lua_pushstring(lua, VERSION);
 	lua_setfield(lua, -2, "__version__");
 	return 1;
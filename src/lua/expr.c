@@ -0,0 +1,176 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#pragma message "Lua Expr"
+
+#include "lua_bind.h"
+
+/*
+ * Expression nodes are full userdata holding a struct Expr, their two
+ * user values keep the child nodes (or the leaf matrix) alive.
+ */
+static struct Expr* push_expr(lua_State* lua, int index){
+	struct Expr* expr = luaL_testudata(lua, index, "CrunumExpr");
+	if(expr){
+		lua_pushvalue(lua, index);
+		return expr;
+	}
+	struct Matrix** matrix = luaL_testudata(lua, index, "CrunumMatrix");
+	if(matrix){
+		expr = lua_newuserdatauv(lua, sizeof(struct Expr), 2);
+		expr_matrix(expr, *matrix);
+		lua_pushvalue(lua, index);
+		lua_setiuservalue(lua, -2, 1);
+	}
+	else if(lua_type(lua, index) == LUA_TNUMBER){
+		expr = lua_newuserdatauv(lua, sizeof(struct Expr), 2);
+		expr_scalar(expr, luaL_checknumber(lua, index));
+	}
+	else
+		return NULL;
+	luaL_getmetatable(lua, "CrunumExpr");
+	lua_setmetatable(lua, -2);
+	return expr;
+}
+
+static void push_eval(lua_State* lua, struct Expr* expr){
+	struct Matrix* matrix = expr_eval(expr);
+	if(!matrix){
+		luaL_error(lua, "Matrix size changed after the expression was built");
+		return;
+	}
+	struct Matrix** result = lua_newuserdata(lua, sizeof(struct Matrix*));
+	*result = matrix;
+	luaL_getmetatable(lua, "CrunumMatrix");
+	lua_setmetatable(lua, -2);
+}
+
+static void materialize(lua_State* lua, int index){
+	struct Expr* expr = luaL_testudata(lua, index, "CrunumExpr");
+	if(!expr)
+		return;
+	push_eval(lua, expr);
+	lua_replace(lua, index);
+}
+
+/*
+ * Only scaling stays lazy for *, a product of two matrices is a GEMM so
+ * both sides are materialized and handed to the matrix multiplication.
+ */
+static int l_expr_matmul(lua_State* lua){
+	materialize(lua, 1);
+	materialize(lua, 2);
+	int args = lua_gettop(lua);
+	if(!luaL_getmetafield(lua, 1, "mul")){
+		luaL_error(lua, "Left operand isn't a matrix");
+		return 0;
+	}
+	lua_insert(lua, 1);
+	lua_call(lua, args, 1);
+	return 1;
+}
+
+int l_expr_arith(lua_State* lua, enum ExprOp op){
+	if(op == EXPR_MUL && lua_type(lua, 1) != LUA_TNUMBER &&
+			lua_type(lua, 2) != LUA_TNUMBER)
+		return l_expr_matmul(lua);
+	struct Matrix** dst = luaL_testudata(lua, 3, "CrunumMatrix");
+	struct Expr* expr = lua_newuserdatauv(lua, sizeof(struct Expr), 2);
+	luaL_getmetatable(lua, "CrunumExpr");
+	lua_setmetatable(lua, -2);
+	struct Expr* left = push_expr(lua, 1);
+	if(!left){
+		luaL_error(lua, "Left operand aren't either matrix, expression or scalar");
+		return 0;
+	}
+	lua_setiuservalue(lua, -2, 1);
+	struct Expr* right = push_expr(lua, 2);
+	if(!right){
+		luaL_error(lua, "Right operand aren't either matrix, expression or scalar");
+		return 0;
+	}
+	lua_setiuservalue(lua, -2, 2);
+	if(!expr_binary(expr, op, left, right)){
+		luaL_error(lua, "Matrix size doesn't match another matrix size");
+		return 0;
+	}
+	if(dst){
+		if(!expr_eval_into(*dst, expr)){
+			luaL_error(lua, "Destination shape doesn't match result shape");
+			return 0;
+		}
+		lua_pushvalue(lua, 3);
+	}
+	return 1;
+}
+
+int l_expr_lazy(lua_State* lua){
+	luaL_checkudata(lua, 1, "CrunumMatrix");
+	push_expr(lua, 1);
+	return 1;
+}
+
+static int l_expr_eval(lua_State* lua){
+	struct Expr* expr = luaL_checkudata(lua, 1, "CrunumExpr");
+	struct Matrix** dst = luaL_testudata(lua, 2, "CrunumMatrix");
+	if(dst){
+		if(!expr_eval_into(*dst, expr)){
+			luaL_error(lua, "Destination shape doesn't match result shape");
+			return 0;
+		}
+		lua_pushvalue(lua, 2);
+		return 1;
+	}
+	push_eval(lua, expr);
+	return 1;
+}
+
+static int l_expr_rows(lua_State* lua){
+	struct Expr* expr = luaL_checkudata(lua, 1, "CrunumExpr");
+	lua_pushinteger(lua, expr->rows);
+	return 1;
+}
+
+static int l_expr_cols(lua_State* lua){
+	struct Expr* expr = luaL_checkudata(lua, 1, "CrunumExpr");
+	lua_pushinteger(lua, expr->cols);
+	return 1;
+}
+
+static int l_expr_tostring(lua_State* lua){
+	push_eval(lua, luaL_checkudata(lua, 1, "CrunumExpr"));
+	luaL_tolstring(lua, -1, NULL);
+	return 1;
+}
+
+static int l_expr_add(lua_State* lua){
+	return l_expr_arith(lua, EXPR_ADD);
+}
+
+static int l_expr_sub(lua_State* lua){
+	return l_expr_arith(lua, EXPR_SUB);
+}
+
+static int l_expr_mul(lua_State* lua){
+	return l_expr_arith(lua, EXPR_MUL);
+}
+
+static int l_expr_div(lua_State* lua){
+	return l_expr_arith(lua, EXPR_DIV);
+}
+
+const luaL_Reg expr_methods[] = {
+	{"eval", l_expr_eval},
+	{"rows", l_expr_rows},
+	{"cols", l_expr_cols},
+	{"__tostring", l_expr_tostring},
+	{"__add", l_expr_add},
+	{"__sub", l_expr_sub},
+	{"__mul", l_expr_mul},
+	{"__div", l_expr_div},
+	{NULL, NULL}
+};
@@ -0,0 +1,105 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#pragma message "Lua LU"
+
+#include "lua_bind.h"
+
+static struct LU* check_lu(lua_State* lua, int index){
+	struct Matrix* matrix = *(struct Matrix**)luaL_checkudata(lua, index, "CrunumMatrix");
+	if(matrix->rows != matrix->cols){
+		luaL_error(lua, "Matrix isn't a square");
+		return NULL;
+	}
+	struct LU* lu = matrix_lu(matrix);
+	if(!lu){
+		luaL_error(lua, "Not enough memory");
+		return NULL;
+	}
+	if(lu->singular){
+		lu_free(lu);
+		luaL_error(lua, "Matrix is singular");
+		return NULL;
+	}
+	return lu;
+}
+
+/*
+ * Solves for a matrix or a vector right-hand side, a vector is viewed as
+ * a single column matrix sharing its values.
+ */
+static int push_solve(lua_State* lua, struct LU* lu, int index){
+	struct Matrix** matrix = luaL_testudata(lua, index, "CrunumMatrix");
+	if(matrix){
+		if((*matrix)->rows != lu->size){
+			luaL_error(lua, "Matrix row size doesn't match LU size");
+			return 0;
+		}
+		struct Matrix** result = lua_newuserdata(lua, sizeof(struct Matrix*));
+		*result = lu_solve(lu, *matrix);
+		luaL_getmetatable(lua, "CrunumMatrix");
+		lua_setmetatable(lua, -2);
+		return 1;
+	}
+	struct Vector* vector = *(struct Vector**)luaL_checkudata(lua, index, "CrunumVector");
+	if(vector->len != lu->size){
+		luaL_error(lua, "Vector length doesn't match LU size");
+		return 0;
+	}
+	struct Vector** result = lua_newuserdata(lua, sizeof(struct Vector*));
+	*result = vector_new_dtype(vector->len, 0, dtype_promote(lu->dtype, vector->dtype));
+	luaL_getmetatable(lua, "CrunumVector");
+	lua_setmetatable(lua, -2);
+	struct Matrix src = {.values = vector->values, .rows = vector->len, .cols = 1, .ld = 1,
+		.dtype = vector->dtype};
+	struct Matrix dst = {.values = (*result)->values, .rows = vector->len, .cols = 1, .ld = 1,
+		.dtype = (*result)->dtype};
+	lu_solve_into(&dst, lu, &src);
+	return 1;
+}
+
+int l_matrix_lu(lua_State* lua){
+	struct LU** lu = lua_newuserdata(lua, sizeof(struct LU*));
+	*lu = NULL;
+	luaL_getmetatable(lua, "CrunumLU");
+	lua_setmetatable(lua, -2);
+	*lu = check_lu(lua, 1);
+	return 1;
+}
+
+int l_matrix_solve(lua_State* lua){
+	struct LU** lu = lua_newuserdata(lua, sizeof(struct LU*));
+	*lu = NULL;
+	luaL_getmetatable(lua, "CrunumLU");
+	lua_setmetatable(lua, -2);
+	*lu = check_lu(lua, 1);
+	return push_solve(lua, *lu, 2);
+}
+
+static int l_lu_solve(lua_State* lua){
+	struct LU* lu = *(struct LU**)luaL_checkudata(lua, 1, "CrunumLU");
+	return push_solve(lua, lu, 2);
+}
+
+static int l_lu_size(lua_State* lua){
+	struct LU* lu = *(struct LU**)luaL_checkudata(lua, 1, "CrunumLU");
+	lua_pushinteger(lua, lu->size);
+	return 1;
+}
+
+static int l_lu_gc(lua_State* lua){
+	struct LU* lu = *(struct LU**)luaL_checkudata(lua, 1, "CrunumLU");
+	lu_free(lu);
+	return 0;
+}
+
+const luaL_Reg lu_methods[] = {
+	{"solve", l_lu_solve},
+	{"size", l_lu_size},
+	{"__gc", l_lu_gc},
+	{NULL, NULL}
+};
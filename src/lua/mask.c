@@ -0,0 +1,82 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#pragma message "Lua comparison mask"
+
+#include "lua_bind.h"
+
+int l_push_mask(lua_State* lua, struct Mask* mask){
+	if(!mask){
+		luaL_error(lua, "Not enough memory");
+		return 0;
+	}
+	struct Mask** result = lua_newuserdata(lua, sizeof(struct Mask*));
+	*result = mask;
+	luaL_getmetatable(lua, "CrunumMask");
+	lua_setmetatable(lua, -2);
+	return 1;
+}
+
+static int l_mask_get(lua_State* lua){
+	struct Mask* mask = *(struct Mask**)luaL_checkudata(lua, 1, "CrunumMask");
+	lua_Integer i = luaL_checkinteger(lua, 2);
+	lua_Integer j = luaL_checkinteger(lua, 3);
+	if(i < 1 || i > mask->rows || j < 1 || j > mask->cols){
+		luaL_error(lua, "Out of bound");
+		return 0;
+	}
+	lua_pushboolean(lua, (int)mask_get(mask, (uint)i - 1, (uint)j - 1));
+	return 1;
+}
+
+static int l_mask_count_nonzero(lua_State* lua){
+	struct Mask* mask = *(struct Mask**)luaL_checkudata(lua, 1, "CrunumMask");
+	lua_pushinteger(lua, (lua_Integer)mask_count_nonzero(mask));
+	return 1;
+}
+
+static int l_mask_tomatrix(lua_State* lua){
+	struct Mask* mask = *(struct Mask**)luaL_checkudata(lua, 1, "CrunumMask");
+	struct Matrix* matrix = mask_to_matrix(mask);
+	if(!matrix){
+		luaL_error(lua, "Not enough memory");
+		return 0;
+	}
+	struct Matrix** result = lua_newuserdata(lua, sizeof(struct Matrix*));
+	*result = matrix;
+	luaL_getmetatable(lua, "CrunumMatrix");
+	lua_setmetatable(lua, -2);
+	return 1;
+}
+
+static int l_mask_rows(lua_State* lua){
+	struct Mask* mask = *(struct Mask**)luaL_checkudata(lua, 1, "CrunumMask");
+	lua_pushinteger(lua, mask->rows);
+	return 1;
+}
+
+static int l_mask_cols(lua_State* lua){
+	struct Mask* mask = *(struct Mask**)luaL_checkudata(lua, 1, "CrunumMask");
+	lua_pushinteger(lua, mask->cols);
+	return 1;
+}
+
+static int l_mask_gc(lua_State* lua){
+	struct Mask* mask = *(struct Mask**)luaL_checkudata(lua, 1, "CrunumMask");
+	mask_free(mask);
+	return 0;
+}
+
+const luaL_Reg mask_methods[] = {
+	{"get", l_mask_get},
+	{"count_nonzero", l_mask_count_nonzero},
+	{"tomatrix", l_mask_tomatrix},
+	{"rows", l_mask_rows},
+	{"cols", l_mask_cols},
+	{"__gc", l_mask_gc},
+	{NULL, NULL}
+};
@@ -7,8 +7,28 @@
 
 #pragma message "Lua Matrix"
 
+#include <math.h>
+#include <string.h>
+
 #include "lua_bind.h"
 
+/*
+ * The optional destination is the third argument. Anything but nil there
+ * has to be a name userdata, a wrong type raises instead of being ignored.
+ */
+static void* opt_dst(lua_State* lua, const char* name){
+	return lua_isnoneornil(lua, 3) ? NULL : luaL_checkudata(lua, 3, name);
+}
+
+static int push_dst(lua_State* lua, void* result){
+	if(!result){
+		luaL_error(lua, "Destination shape doesn't match result shape");
+		return 0;
+	}
+	lua_pushvalue(lua, 3);
+	return 1;
+}
+
 static int l_matrix_new(lua_State* lua){
 	int rows = luaL_checkinteger(lua, 1);
 	int cols = luaL_checkinteger(lua, 2);
@@ -16,9 +36,10 @@ static int l_matrix_new(lua_State* lua){
 		luaL_error(lua, "Matrix dimension can't be negative");
 		return 0;
 	}
+	double value = luaL_optnumber(lua, 3, 0);
+	enum Dtype dtype = l_check_dtype(lua, 4);
 	struct Matrix** matrix = lua_newuserdata(lua, sizeof(struct Matrix*));
-	*matrix = matrix_new((uint)rows, (uint)cols, 
-			(float)luaL_optnumber(lua, 3, 0));
+	*matrix = matrix_new_dtype((uint)rows, (uint)cols, value, dtype);
 	luaL_getmetatable(lua, "CrunumMatrix");
 	lua_setmetatable(lua, -2);
 	return 1;
@@ -31,8 +52,9 @@ static int l_matrix_randinit(lua_State* lua){
 		luaL_error(lua, "Matrix dimension can't be negative");
 		return 0;
 	}
+	enum Dtype dtype = l_check_dtype(lua, 3);
 	struct Matrix** matrix = lua_newuserdata(lua, sizeof(struct Matrix*));
-	*matrix = matrix_randinit((uint)rows, (uint)cols);
+	*matrix = matrix_randinit_dtype((uint)rows, (uint)cols, dtype);
 	luaL_getmetatable(lua, "CrunumMatrix");
 	lua_setmetatable(lua, -2);
 	return 1;
@@ -45,8 +67,9 @@ static int l_matrix_from(lua_State* lua){
 	luaL_checktype(lua, -1, LUA_TTABLE);
 	uint cols = lua_rawlen(lua, -1);
 	lua_pop(lua, 1);
+	enum Dtype dtype = l_check_dtype(lua, 2);
 	struct Matrix** matrix = lua_newuserdata(lua, sizeof(struct Matrix*));
-	*matrix = matrix_new(rows, cols, 0);
+	*matrix = matrix_new_dtype(rows, cols, 0, dtype);
 	for(uint i = 0; i < rows; i++){
 		lua_rawgeti(lua, 1, i + 1);
 		luaL_checktype(lua, -1, LUA_TTABLE);
@@ -66,14 +89,39 @@ static int l_matrix_from(lua_State* lua){
 	return 1;
 }
 
+static int l_matrix_frombytes(lua_State* lua){
+	int rows = luaL_checkinteger(lua, 1);
+	int cols = luaL_checkinteger(lua, 2);
+	size_t len;
+	const char* bytes = luaL_checklstring(lua, 3, &len);
+	if(rows < 0 || cols < 0){
+		luaL_error(lua, "Matrix size can't be negative");
+		return 0;
+	}
+	enum Dtype dtype = l_check_dtype(lua, 4);
+	ulong row = dtype_size(dtype) * (ulong)cols;
+	if(len != row * (ulong)rows){
+		luaL_error(lua, "Byte string size doesn't match matrix size");
+		return 0;
+	}
+	struct Matrix** matrix = lua_newuserdata(lua, sizeof(struct Matrix*));
+	*matrix = matrix_new_dtype((uint)rows, (uint)cols, 0, dtype);
+	luaL_getmetatable(lua, "CrunumMatrix");
+	lua_setmetatable(lua, -2);
+	for(uint i = 0; i < (uint)rows; i++)
+		memcpy(matrix_row_at(*matrix, i), &bytes[row * i], row);
+	return 1;
+}
+
 static int l_matrix_identity(lua_State* lua){
 	int size = luaL_checkinteger(lua, 1);
 	if(size < 0){
 		luaL_error(lua, "Matrix dimension can't be negative");
 		return 0;
 	}
+	enum Dtype dtype = l_check_dtype(lua, 2);
 	struct Matrix** matrix = lua_newuserdata(lua, sizeof(struct Matrix*));
-	*matrix = matrix_identity((uint)size);
+	*matrix = matrix_identity_dtype((uint)size, dtype);
 	luaL_getmetatable(lua, "CrunumMatrix");
 	lua_setmetatable(lua, -2);
 	return 1;
@@ -83,12 +131,12 @@ static int l_matrix_get(lua_State* lua){
 	struct Matrix* matrix = *(struct Matrix**)luaL_checkudata(lua, 1, "CrunumMatrix");
 	int row = luaL_checkinteger(lua, 2) - 1;
 	int col = luaL_checkinteger(lua, 3) - 1;
-	if((uint)row >= matrix->rows || (uint)col >= matrix->rows || 
+	if((uint)row >= matrix->rows || (uint)col >= matrix->cols ||
 			row < 0 || col < 0){
 		luaL_error(lua, "Out of bound");
 		return 0;
 	}
-	lua_pushnumber(lua, *matrix_get(matrix, (uint)row, (uint)col));
+	lua_pushnumber(lua, matrix_load(matrix, (uint)row, (uint)col));
 	return 1;
 }
 
@@ -96,13 +144,12 @@ static int l_matrix_set(lua_State* lua){
 	struct Matrix* matrix = *(struct Matrix**)luaL_checkudata(lua, 1, "CrunumMatrix");
 	int row = luaL_checkinteger(lua, 2) - 1;
 	int col = luaL_checkinteger(lua, 3) - 1;
-	if((uint)row >= matrix->rows || (uint)col >= matrix->rows || 
+	if((uint)row >= matrix->rows || (uint)col >= matrix->cols ||
 			row < 0 || col < 0){
 		luaL_error(lua, "Out of bound");
 		return 0;
 	}
-	float value = luaL_checknumber(lua, 4);
-	matrix_set(matrix, (uint)row, (uint)col, value);
+	matrix_set(matrix, (uint)row, (uint)col, luaL_checknumber(lua, 4));
 	return 0;
 }
 
@@ -113,11 +160,7 @@ static int l_matrix_row(lua_State* lua){
 		luaL_error(lua, "Out of bound");
 		return 0;
 	}
-	struct Vector** vector = lua_newuserdata(lua, sizeof(struct Vector*));
-	*vector = matrix_row(matrix, (uint)row);
-	luaL_getmetatable(lua, "CrunumVector");
-	lua_setmetatable(lua, -2);
-	return 1;
+	return l_view_push(lua, 1, (uint)row, 0, 1, matrix->cols, 1);
 }
 
 static int l_matrix_col(lua_State* lua){
@@ -127,10 +170,32 @@ static int l_matrix_col(lua_State* lua){
 		luaL_error(lua, "Out of bound");
 		return 0;
 	}
-	struct Vector** vector = lua_newuserdata(lua, sizeof(struct Vector*));
-	*vector = matrix_col(matrix, (uint)col);
-	luaL_getmetatable(lua, "CrunumVector");
-	lua_setmetatable(lua, -2);
+	return l_view_push(lua, 1, 0, (uint)col, matrix->rows, 1, 1);
+}
+
+static int l_matrix_block(lua_State* lua){
+	struct Matrix* matrix = *(struct Matrix**)luaL_checkudata(lua, 1, "CrunumMatrix");
+	int row = luaL_checkinteger(lua, 2) - 1;
+	int col = luaL_checkinteger(lua, 3) - 1;
+	int rows = luaL_checkinteger(lua, 4);
+	int cols = luaL_checkinteger(lua, 5);
+	if(row < 0 || col < 0 || rows < 0 || cols < 0 ||
+			(uint)row + (ulong)rows > matrix->rows ||
+			(uint)col + (ulong)cols > matrix->cols){
+		luaL_error(lua, "Out of bound");
+		return 0;
+	}
+	return l_view_push(lua, 1, (uint)row, (uint)col, (uint)rows, (uint)cols, 0);
+}
+
+static int l_matrix_tobytes(lua_State* lua){
+	struct Matrix* matrix = *(struct Matrix**)luaL_checkudata(lua, 1, "CrunumMatrix");
+	ulong row = dtype_size(matrix->dtype) * matrix->cols;
+	luaL_Buffer result;
+	char* bytes = luaL_buffinitsize(lua, &result, row * matrix->rows);
+	for(uint i = 0; i < matrix->rows; i++)
+		memcpy(&bytes[row * i], matrix_row_at(matrix, i), row);
+	luaL_pushresultsize(&result, row * matrix->rows);
 	return 1;
 }
 
@@ -146,8 +211,26 @@ static int l_matrix_cols(lua_State* lua){
 	return 1;
 }
 
+static int l_matrix_dtype(lua_State* lua){
+	struct Matrix* matrix = *(struct Matrix**)luaL_checkudata(lua, 1, "CrunumMatrix");
+	l_push_dtype(lua, matrix->dtype);
+	return 1;
+}
+
+static int l_matrix_astype(lua_State* lua){
+	struct Matrix* matrix = *(struct Matrix**)luaL_checkudata(lua, 1, "CrunumMatrix");
+	enum Dtype dtype = l_check_dtype(lua, 2);
+	struct Matrix** result = lua_newuserdata(lua, sizeof(struct Matrix*));
+	*result = matrix_astype(matrix, dtype);
+	luaL_getmetatable(lua, "CrunumMatrix");
+	lua_setmetatable(lua, -2);
+	return 1;
+}
+
 static int l_matrix_transpose(lua_State* lua){
 	struct Matrix* matrix = *(struct Matrix**)luaL_checkudata(lua, 1, "CrunumMatrix");
+	if(matrix->dtype == DTYPE_F32)
+		return l_view_transpose(lua);
 	struct Matrix** result = lua_newuserdata(lua, sizeof(struct Matrix*));
 	*result = matrix_transpose(matrix);
 	luaL_getmetatable(lua, "CrunumMatrix");
@@ -188,11 +271,139 @@ static int l_matrix_inverse(lua_State* lua){
 	return 1;
 }
 
+static int l_matrix_det(lua_State* lua){
+	struct Matrix* matrix = *(struct Matrix**)luaL_checkudata(lua, 1, "CrunumMatrix");
+	if(matrix->rows != matrix->cols){
+		luaL_error(lua, "Matrix isn't a square");
+		return 0;
+	}
+	double det;
+	if(!matrix_det(matrix, &det)){
+		luaL_error(lua, "Not enough memory");
+		return 0;
+	}
+	lua_pushnumber(lua, det);
+	return 1;
+}
+
+/*
+ * Over the whole matrix without an axis, otherwise one value per column
+ * (axis 1) or per row (axis 2), the axis collapsed like in NumPy but 1
+ * based. Indices are 1 based as well, over the whole matrix argmin and
+ * argmax give a row and a col.
+ */
+static int l_matrix_reduce(lua_State* lua, enum Reduce op, int axis_index){
+	struct Matrix* matrix = *(struct Matrix**)luaL_checkudata(lua, 1, "CrunumMatrix");
+	uint arg = op == REDUCE_ARGMIN || op == REDUCE_ARGMAX;
+	if(lua_isnoneornil(lua, axis_index)){
+		if((arg || op == REDUCE_MIN || op == REDUCE_MAX) && (!matrix->rows || !matrix->cols)){
+			luaL_error(lua, "Empty matrix");
+			return 0;
+		}
+		double value = matrix_reduce(matrix, op);
+		if(!arg){
+			lua_pushnumber(lua, value);
+			return 1;
+		}
+		lua_pushinteger(lua, (ulong)value / matrix->cols + 1);
+		lua_pushinteger(lua, (ulong)value % matrix->cols + 1);
+		return 2;
+	}
+	lua_Integer axis = luaL_checkinteger(lua, axis_index);
+	if(axis != 1 && axis != 2){
+		luaL_error(lua, "Axis should be 1 or 2");
+		return 0;
+	}
+	struct Vector* vector = axis == 1 ? matrix_reduce_cols(matrix, op) :
+		matrix_reduce_rows(matrix, op);
+	if(!vector){
+		luaL_error(lua, "Not enough memory");
+		return 0;
+	}
+	for(uint i = 0; arg && i < vector->len; i++)
+		vector_set(vector, i, vector_load(vector, i) + 1);
+	struct Vector** result = lua_newuserdata(lua, sizeof(struct Vector*));
+	*result = vector;
+	luaL_getmetatable(lua, "CrunumVector");
+	lua_setmetatable(lua, -2);
+	return 1;
+}
+
+static int l_matrix_sum(lua_State* lua){
+	return l_matrix_reduce(lua, REDUCE_SUM, 2);
+}
+
+static int l_matrix_mean(lua_State* lua){
+	return l_matrix_reduce(lua, REDUCE_MEAN, 2);
+}
+
+static int l_matrix_min(lua_State* lua){
+	return l_matrix_reduce(lua, REDUCE_MIN, 2);
+}
+
+static int l_matrix_max(lua_State* lua){
+	return l_matrix_reduce(lua, REDUCE_MAX, 2);
+}
+
+static int l_matrix_argmin(lua_State* lua){
+	return l_matrix_reduce(lua, REDUCE_ARGMIN, 2);
+}
+
+static int l_matrix_argmax(lua_State* lua){
+	return l_matrix_reduce(lua, REDUCE_ARGMAX, 2);
+}
+
+/*
+ * m:norm(ord, axis), ord 1, 2(default) or math.huge.
+ */
+static int l_matrix_norm(lua_State* lua){
+	lua_Number ord = luaL_optnumber(lua, 2, 2);
+	if(ord == 1)
+		return l_matrix_reduce(lua, REDUCE_NORM1, 3);
+	if(ord == 2)
+		return l_matrix_reduce(lua, REDUCE_NORM2, 3);
+	if(ord == HUGE_VAL)
+		return l_matrix_reduce(lua, REDUCE_NORM_INF, 3);
+	luaL_error(lua, "Norm order should be 1, 2 or math.huge");
+	return 0;
+}
+
+/*
+ * m:map(fn, params..., dst) applies fn ("exp", "log", "tanh", "sigmoid",
+ * "erf", "sqrt", "rsqrt", "abs", "clamp" with a lower and an upper bound
+ * or "pow" with an exponent) to every element. dst is optional and may
+ * be m itself.
+ */
+static int l_matrix_map(lua_State* lua){
+	struct Matrix* matrix = *(struct Matrix**)luaL_checkudata(lua, 1, "CrunumMatrix");
+	enum MapFn fn;
+	double param1, param2;
+	int dst_index = l_check_map(lua, 2, &fn, &param1, &param2);
+	struct Matrix** dst = luaL_testudata(lua, dst_index, "CrunumMatrix");
+	if(dst){
+		if(!matrix_map_into(*dst, matrix, fn, param1, param2)){
+			luaL_error(lua, "Destination shape doesn't match result shape");
+			return 0;
+		}
+		lua_pushvalue(lua, dst_index);
+		return 1;
+	}
+	struct Matrix* temp = matrix_map(matrix, fn, param1, param2);
+	if(!temp){
+		luaL_error(lua, "Not enough memory");
+		return 0;
+	}
+	struct Matrix** result = lua_newuserdata(lua, sizeof(struct Matrix*));
+	*result = temp;
+	luaL_getmetatable(lua, "CrunumMatrix");
+	lua_setmetatable(lua, -2);
+	return 1;
+}
+
 static int l_matrix_push_row(lua_State* lua){
 	struct Matrix* matrix = *(struct Matrix**)luaL_checkudata(lua, 1, "CrunumMatrix");
 	struct Vector* vector = *(struct Vector**)luaL_checkudata(lua, 2, "CrunumVector");
 	matrix->cols = matrix->cols ? matrix->cols : vector->len;
-	matrix->cols_cap = matrix->cols_cap ? matrix->cols_cap : vector->len;
 	if(matrix->cols != vector->len){
 		luaL_error(lua, "Matrix col size doesn't match vector length");
 		return 0;
@@ -205,7 +416,6 @@ static int l_matrix_push_col(lua_State* lua){
 	struct Matrix* matrix = *(struct Matrix**)luaL_checkudata(lua, 1, "CrunumMatrix");
 	struct Vector* vector = *(struct Vector**)luaL_checkudata(lua, 2, "CrunumVector");
 	matrix->rows = matrix->rows ? matrix->rows : vector->len;
-	matrix->rows_cap = matrix->rows_cap ? matrix->rows_cap : vector->len;
 	if(matrix->rows != vector->len){
 		luaL_error(lua, "Matrix row size doesn't match vector length");
 		return 0;
@@ -214,6 +424,21 @@ static int l_matrix_push_col(lua_State* lua){
 	return 0;
 }
 
+static int l_matrix_reserve(lua_State* lua){
+	struct Matrix* matrix = *(struct Matrix**)luaL_checkudata(lua, 1, "CrunumMatrix");
+	int rows = luaL_checkinteger(lua, 2);
+	int cols = luaL_checkinteger(lua, 3);
+	if(rows < 0 || cols < 0){
+		luaL_error(lua, "Matrix dimension can't be negative");
+		return 0;
+	}
+	if(!matrix_reserve(matrix, (uint)rows, (uint)cols)){
+		luaL_error(lua, "Can't allocate matrix storage");
+		return 0;
+	}
+	return 0;
+}
+
 static int l_matrix_pop_row(lua_State* lua){
 	struct Matrix* matrix = *(struct Matrix**)luaL_checkudata(lua, 1, "CrunumMatrix");
 	if(!matrix->rows){
@@ -254,7 +479,7 @@ static int l_matrix_tostring(lua_State* lua){
 		luaL_addstring(&result, "\n  {");
 		for(uint j = 0; j < matrix->cols; j++){
 			char num[16];
-			snprintf(num, sizeof(num), "%.2lf", *matrix_get(matrix, i, j));
+			snprintf(num, sizeof(num), "%.2lf", matrix_load(matrix, i, j));
 			luaL_addstring(&result, num);
 			if(j != matrix->cols - 1)
 				luaL_addstring(&result, ", ");
@@ -271,6 +496,10 @@ static int l_matrix_tostring(lua_State* lua){
 }
 
 static int l_matrix_add(lua_State* lua){
+	if(luaL_testudata(lua, 2, "CrunumExpr"))
+		return l_expr_arith(lua, EXPR_ADD);
+	if(luaL_testudata(lua, 2, "CrunumView"))
+		return l_view_arith(lua, EXPR_ADD);
 	if(lua_type(lua, 1) == LUA_TNUMBER){
 		struct Matrix* matrix = *(struct Matrix**)luaL_checkudata(lua, 2, "CrunumMatrix");
 		struct Matrix** result = lua_newuserdata(lua, sizeof(struct Matrix*));
@@ -281,12 +510,15 @@ static int l_matrix_add(lua_State* lua){
 	}
 	struct Matrix* matrix1 = *(struct Matrix**)luaL_checkudata(lua, 1, "CrunumMatrix");
 	struct Matrix** matrix2 = luaL_testudata(lua, 2, "CrunumMatrix");
+	struct Matrix** dst = opt_dst(lua, "CrunumMatrix");
 	if(matrix2){
 		if(matrix1->rows * matrix1->cols != 
 				(*matrix2)->rows * (*matrix2)->cols){
 			luaL_error(lua, "Matrix size doesn't match another matrix size");
 			return 0;
 		}
+		if(dst)
+			return push_dst(lua, matrix_add_into(*dst, matrix1, *matrix2));
 		struct Matrix** result = lua_newuserdata(lua, sizeof(struct Matrix*));
 		*result = matrix_add(matrix1, *matrix2);
 		luaL_getmetatable(lua, "CrunumMatrix");
@@ -294,6 +526,8 @@ static int l_matrix_add(lua_State* lua){
 		return 1;
 	}
 	if(lua_type(lua, 2) == LUA_TNUMBER){
+		if(dst)
+			return push_dst(lua, matrix_add_scalar_into(*dst, matrix1, luaL_checknumber(lua, 2)));
 		struct Matrix** result = lua_newuserdata(lua, sizeof(struct Matrix*));
 		*result = matrix_add_scalar(matrix1, luaL_checknumber(lua, 2));
 		luaL_getmetatable(lua, "CrunumMatrix");
@@ -305,6 +539,10 @@ static int l_matrix_add(lua_State* lua){
 }
 
 static int l_matrix_sub(lua_State* lua){
+	if(luaL_testudata(lua, 2, "CrunumExpr"))
+		return l_expr_arith(lua, EXPR_SUB);
+	if(luaL_testudata(lua, 2, "CrunumView"))
+		return l_view_arith(lua, EXPR_SUB);
 	if(lua_type(lua, 1) == LUA_TNUMBER){
 		struct Matrix* matrix = *(struct Matrix**)luaL_checkudata(lua, 2, "CrunumMatrix");
 		struct Matrix** result = lua_newuserdata(lua, sizeof(struct Matrix*));
@@ -315,12 +553,15 @@ static int l_matrix_sub(lua_State* lua){
 	}
 	struct Matrix* matrix1 = *(struct Matrix**)luaL_checkudata(lua, 1, "CrunumMatrix");
 	struct Matrix** matrix2 = luaL_testudata(lua, 2, "CrunumMatrix");
+	struct Matrix** dst = opt_dst(lua, "CrunumMatrix");
 	if(matrix2){
 		if(matrix1->rows * matrix1->cols != 
 				(*matrix2)->rows * (*matrix2)->cols){
 			luaL_error(lua, "Matrix size doesn't match another matrix size");
 			return 0;
 		}
+		if(dst)
+			return push_dst(lua, matrix_sub_into(*dst, matrix1, *matrix2));
 		struct Matrix** result = lua_newuserdata(lua, sizeof(struct Matrix*));
 		*result = matrix_sub(matrix1, *matrix2);
 		luaL_getmetatable(lua, "CrunumMatrix");
@@ -328,6 +569,8 @@ static int l_matrix_sub(lua_State* lua){
 		return 1;
 	}
 	if(lua_type(lua, 2) == LUA_TNUMBER){
+		if(dst)
+			return push_dst(lua, matrix_sub_scalar_into(*dst, matrix1, luaL_checknumber(lua, 2)));
 		struct Matrix** result = lua_newuserdata(lua, sizeof(struct Matrix*));
 		*result = matrix_sub_scalar(matrix1, luaL_checknumber(lua, 2));
 		luaL_getmetatable(lua, "CrunumMatrix");
@@ -339,6 +582,10 @@ static int l_matrix_sub(lua_State* lua){
 }
 
 static int l_matrix_mul(lua_State* lua){
+	if(luaL_testudata(lua, 2, "CrunumExpr"))
+		return l_expr_arith(lua, EXPR_MUL);
+	if(luaL_testudata(lua, 2, "CrunumView"))
+		return l_view_matmul(lua);
 	if(lua_type(lua, 1) == LUA_TNUMBER){
 		struct Matrix* matrix = *(struct Matrix**)luaL_checkudata(lua, 2, "CrunumMatrix");
 		struct Matrix** result = lua_newuserdata(lua, sizeof(struct Matrix*));
@@ -350,10 +597,17 @@ static int l_matrix_mul(lua_State* lua){
 	struct Matrix* matrix1 = *(struct Matrix**)luaL_checkudata(lua, 1, "CrunumMatrix");
 	struct Matrix** matrix2 = luaL_testudata(lua, 2, "CrunumMatrix");
 	if(matrix2){
-		if(matrix1->rows != (*matrix2)->cols){
-			luaL_error(lua, "Matrix row size doesn't match another matrix col size");
+		if(matrix1->cols != (*matrix2)->rows){
+			luaL_error(lua, "Matrix col size doesn't match another matrix row size");
+			return 0;
+		}
+		struct Matrix** dst = opt_dst(lua, "CrunumMatrix");
+		if(dst && (*dst == matrix1 || *dst == *matrix2)){
+			luaL_error(lua, "Destination aliases an operand");
 			return 0;
 		}
+		if(dst)
+			return push_dst(lua, matrix_mul_into(*dst, matrix1, *matrix2));
 		struct Matrix** result = lua_newuserdata(lua, sizeof(struct Matrix*));
 		*result = matrix_mul(matrix1, *matrix2);
 		luaL_getmetatable(lua, "CrunumMatrix");
@@ -366,6 +620,13 @@ static int l_matrix_mul(lua_State* lua){
 			luaL_error(lua, "Matrix col size doesn't match vector length");
 			return 0;
 		}
+		struct Vector** vector_dst = opt_dst(lua, "CrunumVector");
+		if(vector_dst && *vector_dst == *vector){
+			luaL_error(lua, "Destination aliases an operand");
+			return 0;
+		}
+		if(vector_dst)
+			return push_dst(lua, matrix_mul_vector_into(*vector_dst, matrix1, *vector));
 		struct Vector** result = lua_newuserdata(lua, sizeof(struct Vector*));
 		*result = matrix_mul_vector(matrix1, *vector);
 		luaL_getmetatable(lua, "CrunumVector");
@@ -373,6 +634,9 @@ static int l_matrix_mul(lua_State* lua){
 		return 1;
 	}
 	if(lua_type(lua, 2) == LUA_TNUMBER){
+		struct Matrix** dst = opt_dst(lua, "CrunumMatrix");
+		if(dst)
+			return push_dst(lua, matrix_mul_scalar_into(*dst, matrix1, luaL_checknumber(lua, 2)));
 		struct Matrix** result = lua_newuserdata(lua, sizeof(struct Matrix*));
 		*result = matrix_mul_scalar(matrix1, luaL_checknumber(lua, 2));
 		luaL_getmetatable(lua, "CrunumMatrix");
@@ -384,6 +648,10 @@ static int l_matrix_mul(lua_State* lua){
 }
 
 static int l_matrix_div(lua_State* lua){
+	if(luaL_testudata(lua, 2, "CrunumExpr"))
+		return l_expr_arith(lua, EXPR_DIV);
+	if(luaL_testudata(lua, 2, "CrunumView"))
+		return l_view_arith(lua, EXPR_DIV);
 	if(lua_type(lua, 1) == LUA_TNUMBER){
 		struct Matrix* matrix = *(struct Matrix**)luaL_checkudata(lua, 2, "CrunumMatrix");
 		struct Matrix** result = lua_newuserdata(lua, sizeof(struct Matrix*));
@@ -394,12 +662,15 @@ static int l_matrix_div(lua_State* lua){
 	}
 	struct Matrix* matrix1 = *(struct Matrix**)luaL_checkudata(lua, 1, "CrunumMatrix");
 	struct Matrix** matrix2 = luaL_testudata(lua, 2, "CrunumMatrix");
+	struct Matrix** dst = opt_dst(lua, "CrunumMatrix");
 	if(matrix2){
 		if(matrix1->rows * matrix1->cols != 
 				(*matrix2)->rows * (*matrix2)->cols){
 			luaL_error(lua, "Matrix size doesn't match another matrix size");
 			return 0;
 		}
+		if(dst)
+			return push_dst(lua, matrix_div_into(*dst, matrix1, *matrix2));
 		struct Matrix** result = lua_newuserdata(lua, sizeof(struct Matrix*));
 		*result = matrix_div(matrix1, *matrix2);
 		luaL_getmetatable(lua, "CrunumMatrix");
@@ -407,6 +678,8 @@ static int l_matrix_div(lua_State* lua){
 		return 1;
 	}
 	if(lua_type(lua, 2) == LUA_TNUMBER){
+		if(dst)
+			return push_dst(lua, matrix_div_scalar_into(*dst, matrix1, luaL_checknumber(lua, 2)));
 		struct Matrix** result = lua_newuserdata(lua, sizeof(struct Matrix*));
 		*result = matrix_div_scalar(matrix1, luaL_checknumber(lua, 2));
 		luaL_getmetatable(lua, "CrunumMatrix");
@@ -437,6 +710,8 @@ static int l_matrix_pow(lua_State* lua){
 }
 
 static int l_matrix_eq(lua_State* lua){
+	if(luaL_testudata(lua, 2, "CrunumView"))
+		return l_view_eq(lua);
 	if(lua_type(lua, 1) == LUA_TNUMBER){
 		struct Matrix* matrix = *(struct Matrix**)luaL_checkudata(lua, 2, "CrunumMatrix");
 		lua_pushboolean(lua, (int)!matrix_eq_scalar(
@@ -574,11 +849,77 @@ static int l_matrix_le(lua_State* lua){
 	return 1;
 }
 
+/*
+ * m:eq(other), m:gt(other), ... with a matrix of the same shape or a
+ * number, giving the mask of where the comparison holds.
+ */
+static int l_matrix_compare(lua_State* lua,
+		struct Mask* (*compare)(struct Matrix*, struct Matrix*),
+		struct Mask* (*compare_scalar)(struct Matrix*, double)){
+	struct Matrix* matrix1 = *(struct Matrix**)luaL_checkudata(lua, 1, "CrunumMatrix");
+	if(lua_type(lua, 2) == LUA_TNUMBER)
+		return l_push_mask(lua, compare_scalar(matrix1, lua_tonumber(lua, 2)));
+	struct Matrix* matrix2 = *(struct Matrix**)luaL_checkudata(lua, 2, "CrunumMatrix");
+	if(matrix1->rows != matrix2->rows ||
+			matrix1->cols != matrix2->cols){
+		luaL_error(lua, "Both matrix aren't the same size");
+		return 0;
+	}
+	return l_push_mask(lua, compare(matrix1, matrix2));
+}
+
+static int l_matrix_eq_mask(lua_State* lua){
+	return l_matrix_compare(lua, matrix_eq_mask, matrix_eq_scalar_mask);
+}
+
+static int l_matrix_neq_mask(lua_State* lua){
+	return l_matrix_compare(lua, matrix_neq_mask, matrix_neq_scalar_mask);
+}
+
+static int l_matrix_gt_mask(lua_State* lua){
+	return l_matrix_compare(lua, matrix_gt_mask, matrix_gt_scalar_mask);
+}
+
+static int l_matrix_ge_mask(lua_State* lua){
+	return l_matrix_compare(lua, matrix_ge_mask, matrix_ge_scalar_mask);
+}
+
+static int l_matrix_lt_mask(lua_State* lua){
+	return l_matrix_compare(lua, matrix_lt_mask, matrix_lt_scalar_mask);
+}
+
+static int l_matrix_le_mask(lua_State* lua){
+	return l_matrix_compare(lua, matrix_le_mask, matrix_le_scalar_mask);
+}
+
+/*
+ * m:allclose(other, rtol, atol), rtol defaulting to 1e-5 and atol to 1e-8.
+ */
+static int l_matrix_allclose(lua_State* lua){
+	struct Matrix* matrix1 = *(struct Matrix**)luaL_checkudata(lua, 1, "CrunumMatrix");
+	struct Matrix* matrix2 = *(struct Matrix**)luaL_checkudata(lua, 2, "CrunumMatrix");
+	double rtol = luaL_optnumber(lua, 3, 1e-5);
+	double atol = luaL_optnumber(lua, 4, 1e-8);
+	if(matrix1->rows != matrix2->rows ||
+			matrix1->cols != matrix2->cols){
+		luaL_error(lua, "Both matrix aren't the same size");
+		return 0;
+	}
+	lua_pushboolean(lua, (int)matrix_allclose(matrix1, matrix2, rtol, atol));
+	return 1;
+}
+
 const luaL_Reg matrix_functions[] = {
 	{"new", l_matrix_new},
 	{"randinit", l_matrix_randinit},
 	{"from", l_matrix_from},
+	{"frombytes", l_matrix_frombytes},
 	{"identity", l_matrix_identity},
+	{"lu", l_matrix_lu},
+	{"solve", l_matrix_solve},
+	{"quantize", l_matrix_quantize},
+	{"sparse", l_matrix_sparse},
+	{"sparse_triplets", l_matrix_sparse_triplets},
 	{NULL, NULL}
 };
 
@@ -587,13 +928,41 @@ const luaL_Reg matrix_methods[] = {
 	{"set", l_matrix_set},
 	{"row", l_matrix_row},
 	{"col", l_matrix_col},
+	{"block", l_matrix_block},
 	{"rows", l_matrix_rows},
 	{"cols", l_matrix_cols},
+	{"tobytes", l_matrix_tobytes},
+	{"dtype", l_matrix_dtype},
+	{"astype", l_matrix_astype},
 	{"transpose", l_matrix_transpose},
 	{"reshape", l_matrix_reshape},
 	{"inverse", l_matrix_inverse},
+	{"det", l_matrix_det},
+	{"sum", l_matrix_sum},
+	{"mean", l_matrix_mean},
+	{"min", l_matrix_min},
+	{"max", l_matrix_max},
+	{"argmin", l_matrix_argmin},
+	{"argmax", l_matrix_argmax},
+	{"norm", l_matrix_norm},
+	{"map", l_matrix_map},
+	{"eq", l_matrix_eq_mask},
+	{"neq", l_matrix_neq_mask},
+	{"gt", l_matrix_gt_mask},
+	{"ge", l_matrix_ge_mask},
+	{"lt", l_matrix_lt_mask},
+	{"le", l_matrix_le_mask},
+	{"allclose", l_matrix_allclose},
+	{"quantize", l_matrix_quantize},
+	{"sparse", l_matrix_sparse},
+	{"add", l_matrix_add},
+	{"sub", l_matrix_sub},
+	{"mul", l_matrix_mul},
+	{"div", l_matrix_div},
+	{"lazy", l_expr_lazy},
 	{"push_row", l_matrix_push_row},
 	{"push_col", l_matrix_push_col},
+	{"reserve", l_matrix_reserve},
 	{"pop_row", l_matrix_pop_row},
 	{"pop_col", l_matrix_pop_col},
 	{"__gc", l_matrix_gc},
@@ -0,0 +1,119 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#pragma message "Lua quantized matrix"
+
+#include "lua_bind.h"
+
+static int push_dst(lua_State* lua, void* result){
+	if(!result){
+		luaL_error(lua, "Destination shape doesn't match result shape");
+		return 0;
+	}
+	lua_pushvalue(lua, 3);
+	return 1;
+}
+
+int l_matrix_quantize(lua_State* lua){
+	struct Matrix* matrix = *(struct Matrix**)luaL_checkudata(lua, 1, "CrunumMatrix");
+	uint per_row = lua_toboolean(lua, 2);
+	struct QMatrix** qmatrix = lua_newuserdata(lua, sizeof(struct QMatrix*));
+	*qmatrix = matrix_quantize(matrix, per_row);
+	if(!*qmatrix){
+		luaL_error(lua, "Not enough memory");
+		return 0;
+	}
+	luaL_getmetatable(lua, "CrunumQMatrix");
+	lua_setmetatable(lua, -2);
+	return 1;
+}
+
+static int l_qmatrix_dequantize(lua_State* lua){
+	struct QMatrix* qmatrix = *(struct QMatrix**)luaL_checkudata(lua, 1, "CrunumQMatrix");
+	struct Matrix** result = lua_newuserdata(lua, sizeof(struct Matrix*));
+	*result = qmatrix_dequantize(qmatrix);
+	luaL_getmetatable(lua, "CrunumMatrix");
+	lua_setmetatable(lua, -2);
+	return 1;
+}
+
+/*
+ * Product with a matrix or a vector, always float32. An optional third
+ * argument of the result's shape receives it instead.
+ */
+static int l_qmatrix_mul(lua_State* lua){
+	struct QMatrix* qmatrix = *(struct QMatrix**)luaL_checkudata(lua, 1, "CrunumQMatrix");
+	struct Matrix** matrix = luaL_testudata(lua, 2, "CrunumMatrix");
+	if(matrix){
+		if(qmatrix->cols != (*matrix)->rows){
+			luaL_error(lua, "Matrix col size doesn't match another matrix row size");
+			return 0;
+		}
+		struct Matrix** dst = luaL_testudata(lua, 3, "CrunumMatrix");
+		if(dst)
+			return push_dst(lua, qmatrix_mul_into(*dst, qmatrix, *matrix));
+		struct Matrix** result = lua_newuserdata(lua, sizeof(struct Matrix*));
+		*result = qmatrix_mul(qmatrix, *matrix);
+		luaL_getmetatable(lua, "CrunumMatrix");
+		lua_setmetatable(lua, -2);
+		return 1;
+	}
+	struct Vector* vector = *(struct Vector**)luaL_checkudata(lua, 2, "CrunumVector");
+	if(qmatrix->cols != vector->len){
+		luaL_error(lua, "Matrix col size doesn't match vector length");
+		return 0;
+	}
+	struct Vector** dst = luaL_testudata(lua, 3, "CrunumVector");
+	if(dst)
+		return push_dst(lua, qmatrix_mul_vector_into(*dst, qmatrix, vector));
+	struct Vector** result = lua_newuserdata(lua, sizeof(struct Vector*));
+	*result = qmatrix_mul_vector(qmatrix, vector);
+	luaL_getmetatable(lua, "CrunumVector");
+	lua_setmetatable(lua, -2);
+	return 1;
+}
+
+static int l_qmatrix_rows(lua_State* lua){
+	struct QMatrix* qmatrix = *(struct QMatrix**)luaL_checkudata(lua, 1, "CrunumQMatrix");
+	lua_pushinteger(lua, qmatrix->rows);
+	return 1;
+}
+
+static int l_qmatrix_cols(lua_State* lua){
+	struct QMatrix* qmatrix = *(struct QMatrix**)luaL_checkudata(lua, 1, "CrunumQMatrix");
+	lua_pushinteger(lua, qmatrix->cols);
+	return 1;
+}
+
+static int l_qmatrix_scale(lua_State* lua){
+	struct QMatrix* qmatrix = *(struct QMatrix**)luaL_checkudata(lua, 1, "CrunumQMatrix");
+	lua_Integer row = luaL_optinteger(lua, 2, 1);
+	if(row < 1 || (qmatrix->per_row ? row > qmatrix->rows : row != 1)){
+		luaL_error(lua, "Out of bound");
+		return 0;
+	}
+	lua_pushnumber(lua, qmatrix->scales[row - 1]);
+	lua_pushinteger(lua, qmatrix->zero_points[row - 1]);
+	return 2;
+}
+
+static int l_qmatrix_gc(lua_State* lua){
+	struct QMatrix* qmatrix = *(struct QMatrix**)luaL_checkudata(lua, 1, "CrunumQMatrix");
+	qmatrix_free(qmatrix);
+	return 0;
+}
+
+const luaL_Reg qmatrix_methods[] = {
+	{"dequantize", l_qmatrix_dequantize},
+	{"mul", l_qmatrix_mul},
+	{"rows", l_qmatrix_rows},
+	{"cols", l_qmatrix_cols},
+	{"scale", l_qmatrix_scale},
+	{"__mul", l_qmatrix_mul},
+	{"__gc", l_qmatrix_gc},
+	{NULL, NULL}
+};
@@ -0,0 +1,189 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#pragma message "Lua sparse matrix"
+
+#include "lua_bind.h"
+
+static const char* const format_names[] = {"csr", "csc", NULL};
+
+static enum SparseFormat check_format(lua_State* lua, int index){
+	return (enum SparseFormat)luaL_checkoption(lua, index, "csr", format_names);
+}
+
+static int push_sparse(lua_State* lua, struct Sparse* sparse){
+	if(!sparse){
+		luaL_error(lua, "Not enough memory");
+		return 0;
+	}
+	struct Sparse** result = lua_newuserdata(lua, sizeof(struct Sparse*));
+	*result = sparse;
+	luaL_getmetatable(lua, "CrunumSparse");
+	lua_setmetatable(lua, -2);
+	return 1;
+}
+
+static int push_dst(lua_State* lua, void* result){
+	if(!result){
+		luaL_error(lua, "Destination shape doesn't match result shape");
+		return 0;
+	}
+	lua_pushvalue(lua, 3);
+	return 1;
+}
+
+int l_matrix_sparse(lua_State* lua){
+	struct Matrix* matrix = *(struct Matrix**)luaL_checkudata(lua, 1, "CrunumMatrix");
+	return push_sparse(lua, sparse_from_matrix(matrix, check_format(lua, 2)));
+}
+
+/*
+ * crn.matrix.sparse_triplets(rows, cols, {{i, j, value}, ...}, format),
+ * indices start at 1 and repeated (i, j) pairs are summed.
+ */
+int l_matrix_sparse_triplets(lua_State* lua){
+	lua_Integer rows = luaL_checkinteger(lua, 1);
+	lua_Integer cols = luaL_checkinteger(lua, 2);
+	luaL_checktype(lua, 3, LUA_TTABLE);
+	enum SparseFormat format = check_format(lua, 4);
+	if(rows < 0 || cols < 0){
+		luaL_error(lua, "Matrix dimension can't be negative");
+		return 0;
+	}
+	uint nnz = lua_rawlen(lua, 3);
+	uint* row_index = lua_newuserdata(lua, (sizeof(uint) * 2 + sizeof(float)) * ((ulong)nnz + 1));
+	uint* col_index = row_index + nnz;
+	float* values = (float*)(col_index + nnz);
+	for(uint k = 0; k < nnz; k++){
+		lua_rawgeti(lua, 3, k + 1);
+		luaL_checktype(lua, -1, LUA_TTABLE);
+		if(lua_rawlen(lua, -1) != 3){
+			luaL_error(lua, "Triplet should be {row, col, value}");
+			return 0;
+		}
+		lua_rawgeti(lua, -1, 1);
+		lua_rawgeti(lua, -2, 2);
+		lua_rawgeti(lua, -3, 3);
+		lua_Integer row = luaL_checkinteger(lua, -3) - 1;
+		lua_Integer col = luaL_checkinteger(lua, -2) - 1;
+		if(row < 0 || col < 0 || row >= rows || col >= cols){
+			luaL_error(lua, "Out of bound");
+			return 0;
+		}
+		row_index[k] = (uint)row;
+		col_index[k] = (uint)col;
+		values[k] = (float)luaL_checknumber(lua, -1);
+		lua_pop(lua, 4);
+	}
+	return push_sparse(lua, sparse_from_triplets((uint)rows, (uint)cols, nnz,
+				row_index, col_index, values, format));
+}
+
+static int l_sparse_todense(lua_State* lua){
+	struct Sparse* sparse = *(struct Sparse**)luaL_checkudata(lua, 1, "CrunumSparse");
+	struct Matrix** result = lua_newuserdata(lua, sizeof(struct Matrix*));
+	*result = sparse_to_matrix(sparse);
+	luaL_getmetatable(lua, "CrunumMatrix");
+	lua_setmetatable(lua, -2);
+	return 1;
+}
+
+static int l_sparse_transpose(lua_State* lua){
+	struct Sparse* sparse = *(struct Sparse**)luaL_checkudata(lua, 1, "CrunumSparse");
+	return push_sparse(lua, sparse_transpose(sparse));
+}
+
+static int l_sparse_tocsr(lua_State* lua){
+	struct Sparse* sparse = *(struct Sparse**)luaL_checkudata(lua, 1, "CrunumSparse");
+	return push_sparse(lua, sparse_convert(sparse, SPARSE_CSR));
+}
+
+static int l_sparse_tocsc(lua_State* lua){
+	struct Sparse* sparse = *(struct Sparse**)luaL_checkudata(lua, 1, "CrunumSparse");
+	return push_sparse(lua, sparse_convert(sparse, SPARSE_CSC));
+}
+
+/*
+ * Product with a dense matrix or vector, an optional third argument of
+ * the result's shape receives it instead.
+ */
+static int l_sparse_mul(lua_State* lua){
+	struct Sparse* sparse = *(struct Sparse**)luaL_checkudata(lua, 1, "CrunumSparse");
+	struct Matrix** matrix = luaL_testudata(lua, 2, "CrunumMatrix");
+	if(matrix){
+		if(sparse->cols != (*matrix)->rows){
+			luaL_error(lua, "Matrix col size doesn't match another matrix row size");
+			return 0;
+		}
+		struct Matrix** dst = luaL_testudata(lua, 3, "CrunumMatrix");
+		if(dst)
+			return push_dst(lua, sparse_mul_into(*dst, sparse, *matrix));
+		struct Matrix** result = lua_newuserdata(lua, sizeof(struct Matrix*));
+		*result = sparse_mul(sparse, *matrix);
+		luaL_getmetatable(lua, "CrunumMatrix");
+		lua_setmetatable(lua, -2);
+		return 1;
+	}
+	struct Vector* vector = *(struct Vector**)luaL_checkudata(lua, 2, "CrunumVector");
+	if(sparse->cols != vector->len){
+		luaL_error(lua, "Matrix col size doesn't match vector length");
+		return 0;
+	}
+	struct Vector** dst = luaL_testudata(lua, 3, "CrunumVector");
+	if(dst)
+		return push_dst(lua, sparse_mul_vector_into(*dst, sparse, vector));
+	struct Vector** result = lua_newuserdata(lua, sizeof(struct Vector*));
+	*result = sparse_mul_vector(sparse, vector);
+	luaL_getmetatable(lua, "CrunumVector");
+	lua_setmetatable(lua, -2);
+	return 1;
+}
+
+static int l_sparse_rows(lua_State* lua){
+	struct Sparse* sparse = *(struct Sparse**)luaL_checkudata(lua, 1, "CrunumSparse");
+	lua_pushinteger(lua, sparse->rows);
+	return 1;
+}
+
+static int l_sparse_cols(lua_State* lua){
+	struct Sparse* sparse = *(struct Sparse**)luaL_checkudata(lua, 1, "CrunumSparse");
+	lua_pushinteger(lua, sparse->cols);
+	return 1;
+}
+
+static int l_sparse_nnz(lua_State* lua){
+	struct Sparse* sparse = *(struct Sparse**)luaL_checkudata(lua, 1, "CrunumSparse");
+	lua_pushinteger(lua, sparse->nnz);
+	return 1;
+}
+
+static int l_sparse_format(lua_State* lua){
+	struct Sparse* sparse = *(struct Sparse**)luaL_checkudata(lua, 1, "CrunumSparse");
+	lua_pushstring(lua, format_names[sparse->format]);
+	return 1;
+}
+
+static int l_sparse_gc(lua_State* lua){
+	struct Sparse* sparse = *(struct Sparse**)luaL_checkudata(lua, 1, "CrunumSparse");
+	sparse_free(sparse);
+	return 0;
+}
+
+const luaL_Reg sparse_methods[] = {
+	{"todense", l_sparse_todense},
+	{"transpose", l_sparse_transpose},
+	{"tocsr", l_sparse_tocsr},
+	{"tocsc", l_sparse_tocsc},
+	{"mul", l_sparse_mul},
+	{"rows", l_sparse_rows},
+	{"cols", l_sparse_cols},
+	{"nnz", l_sparse_nnz},
+	{"format", l_sparse_format},
+	{"__mul", l_sparse_mul},
+	{"__gc", l_sparse_gc},
+	{NULL, NULL}
+};
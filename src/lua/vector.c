@@ -7,16 +7,37 @@
 
 #pragma message "Lua Vector"
 
+#include <string.h>
+
 #include "lua_bind.h"
 
+/*
+ * The optional destination is the third argument. Anything but nil there
+ * has to be a Vector, a wrong type raises instead of being ignored.
+ */
+static struct Vector** opt_dst(lua_State* lua){
+	return lua_isnoneornil(lua, 3) ? NULL : luaL_checkudata(lua, 3, "CrunumVector");
+}
+
+static int push_dst(lua_State* lua, void* result){
+	if(!result){
+		luaL_error(lua, "Destination length doesn't match result length");
+		return 0;
+	}
+	lua_pushvalue(lua, 3);
+	return 1;
+}
+
 static int l_vector_new(lua_State* lua){
 	int len = luaL_checkinteger(lua, 1);
 	if(len < 0){
 		luaL_error(lua, "Vector length can't be negative");
 		return 0;
 	}
+	double value = luaL_optnumber(lua, 2, 0);
+	enum Dtype dtype = l_check_dtype(lua, 3);
 	struct Vector** vector = lua_newuserdata(lua, sizeof(struct Vector*));
-	*vector = vector_new((uint)len, (float)luaL_optnumber(lua, 2, 0));
+	*vector = vector_new_dtype((uint)len, value, dtype);
 	luaL_getmetatable(lua, "CrunumVector");
 	lua_setmetatable(lua, -2);
 	return 1;
@@ -28,8 +49,9 @@ static int l_vector_randinit(lua_State* lua){
 		luaL_error(lua, "Vector length can't be negative");
 		return 0;
 	}
+	enum Dtype dtype = l_check_dtype(lua, 2);
 	struct Vector** vector = lua_newuserdata(lua, sizeof(struct Vector*));
-	*vector = vector_randinit((uint)len);
+	*vector = vector_randinit_dtype((uint)len, dtype);
 	luaL_getmetatable(lua, "CrunumVector");
 	lua_setmetatable(lua, -2);
 	return 1;
@@ -38,18 +60,57 @@ static int l_vector_randinit(lua_State* lua){
 static int l_vector_from(lua_State* lua){
 	luaL_checktype(lua, 1, LUA_TTABLE);
 	uint len = lua_rawlen(lua, 1);
+	enum Dtype dtype = l_check_dtype(lua, 2);
 	struct Vector** vector = lua_newuserdata(lua, sizeof(struct Vector*));
-	*vector = vector_new(len, 0);
+	*vector = vector_new_dtype(len, 0, dtype);
 	luaL_getmetatable(lua, "CrunumVector");
 	lua_setmetatable(lua, -2);
 	for(uint i = 0; i < len; i++){
 		lua_rawgeti(lua, 1, i + 1);
-		(*vector)->values[i] = luaL_checkinteger(lua, -1);
+		vector_set(*vector, i, luaL_checkinteger(lua, -1));
 		lua_pop(lua, 1);
 	}
 	return 1;
 }
 
+static int l_vector_frombytes(lua_State* lua){
+	size_t len;
+	const char* bytes = luaL_checklstring(lua, 1, &len);
+	enum Dtype dtype = l_check_dtype(lua, 2);
+	if(len % dtype_size(dtype)){
+		luaL_error(lua, "Byte string size isn't a multiple of the element size");
+		return 0;
+	}
+	struct Vector** vector = lua_newuserdata(lua, sizeof(struct Vector*));
+	*vector = vector_new_dtype((uint)(len / dtype_size(dtype)), 0, dtype);
+	luaL_getmetatable(lua, "CrunumVector");
+	lua_setmetatable(lua, -2);
+	memcpy((*vector)->values, bytes, len);
+	return 1;
+}
+
+static int l_vector_tobytes(lua_State* lua){
+	struct Vector* vector = *(struct Vector**)luaL_checkudata(lua, 1, "CrunumVector");
+	lua_pushlstring(lua, (const char*)vector->values, dtype_size(vector->dtype) * vector->len);
+	return 1;
+}
+
+static int l_vector_dtype(lua_State* lua){
+	struct Vector* vector = *(struct Vector**)luaL_checkudata(lua, 1, "CrunumVector");
+	l_push_dtype(lua, vector->dtype);
+	return 1;
+}
+
+static int l_vector_astype(lua_State* lua){
+	struct Vector* vector = *(struct Vector**)luaL_checkudata(lua, 1, "CrunumVector");
+	enum Dtype dtype = l_check_dtype(lua, 2);
+	struct Vector** result = lua_newuserdata(lua, sizeof(struct Vector*));
+	*result = vector_astype(vector, dtype);
+	luaL_getmetatable(lua, "CrunumVector");
+	lua_setmetatable(lua, -2);
+	return 1;
+}
+
 static int l_vector_len(lua_State* lua){
 	struct Vector* vector = *(struct Vector**)luaL_checkudata(lua, 1, "CrunumVector");
 	lua_pushinteger(lua, vector->len);
@@ -58,8 +119,7 @@ static int l_vector_len(lua_State* lua){
 
 static int l_vector_push(lua_State* lua){
 	struct Vector* vector = *(struct Vector**)luaL_checkudata(lua, 1, "CrunumVector");
-	float value = luaL_checknumber(lua, 2);
-	vector_push(vector, value);
+	vector_push(vector, luaL_checknumber(lua, 2));
 	return 0;
 }
 
@@ -88,7 +148,7 @@ static int l_vector_index(lua_State* lua){
 			luaL_error(lua, "Out of bound");
 			return 0;
 		}
-		lua_pushnumber(lua, vector->values[index]);
+		lua_pushnumber(lua, vector_load(vector, (uint)index));
 		return 1;
 	}
 	luaL_error(lua, "Invalid __index value");
@@ -102,8 +162,7 @@ static int l_vector_newindex(lua_State* lua){
 		luaL_error(lua, "Out of bound");
 		return 0;
 	}
-	float value = luaL_checknumber(lua, 3);
-	vector->values[index] = value;
+	vector_set(vector, (uint)index, luaL_checknumber(lua, 3));
 	return 0;
 }
 
@@ -120,7 +179,7 @@ static int l_vector_tostring(lua_State* lua){
 	luaL_addchar(&buffer, '{');
 	for(uint i = 0; i < vector->len; i++){
 		char num[16];
-		snprintf(num, sizeof(num), "%.2lf", vector->values[i]);
+		snprintf(num, sizeof(num), "%.2lf", vector_load(vector, i));
 		luaL_addstring(&buffer, num);
 		if(i != vector->len - 1)
 			luaL_addstring(&buffer, ", ");
@@ -131,13 +190,18 @@ static int l_vector_tostring(lua_State* lua){
 }
 
 static int l_vector_mul(lua_State* lua){
+	if(luaL_testudata(lua, 2, "CrunumView"))
+		return l_view_mul(lua);
 	struct Vector* vector1 = *(struct Vector**)luaL_checkudata(lua, 1, "CrunumVector");
 	struct Vector** vector2 = luaL_testudata(lua, 2, "CrunumVector");
+	struct Vector** dst = opt_dst(lua);
 	if(vector2){
 		if(vector1->len != (*vector2)->len){
 			luaL_error(lua, "Vector length doesn't match another vector length");
 			return 0;
 		}
+		if(dst)
+			return push_dst(lua, vector_mul_into(*dst, vector1, *vector2));
 		struct Vector** result = lua_newuserdata(lua, sizeof(struct Vector*));
 		*result = vector_mul(vector1, *vector2);
 		luaL_getmetatable(lua, "CrunumVector");
@@ -150,6 +214,12 @@ static int l_vector_mul(lua_State* lua){
 			luaL_error(lua, "Vector length doesn't match matrix row size");
 			return 0;
 		}
+		if(dst && *dst == vector1){
+			luaL_error(lua, "Destination aliases an operand");
+			return 0;
+		}
+		if(dst)
+			return push_dst(lua, vector_mul_matrix_into(*dst, vector1, *matrix));
 		struct Vector** result = lua_newuserdata(lua, sizeof(struct Vector*));
 		*result = vector_mul_matrix(vector1, *matrix);
 		luaL_getmetatable(lua, "CrunumVector");
@@ -157,6 +227,8 @@ static int l_vector_mul(lua_State* lua){
 		return 1;
 	}
 	if(lua_type(lua, 2) == LUA_TNUMBER){
+		if(dst)
+			return push_dst(lua, vector_mul_scalar_into(*dst, vector1, luaL_checknumber(lua, 2)));
 		struct Vector** result = lua_newuserdata(lua, sizeof(struct Vector*));
 		*result = vector_mul_scalar(vector1, luaL_checknumber(lua, 2));
 		luaL_getmetatable(lua, "CrunumVector");
@@ -168,13 +240,18 @@ static int l_vector_mul(lua_State* lua){
 }
 
 static int l_vector_add(lua_State* lua){
+	if(luaL_testudata(lua, 2, "CrunumView"))
+		return l_view_arith(lua, EXPR_ADD);
 	struct Vector* vector1 = *(struct Vector**)luaL_checkudata(lua, 1, "CrunumVector");
 	struct Vector** vector2 = luaL_testudata(lua, 2, "CrunumVector");
+	struct Vector** dst = opt_dst(lua);
 	if(vector2){
 		if(vector1->len != (*vector2)->len){
 			luaL_error(lua, "Vector length doesn't match another vector length");
 			return 0;
 		}
+		if(dst)
+			return push_dst(lua, vector_add_into(*dst, vector1, *vector2));
 		struct Vector** result = lua_newuserdata(lua, sizeof(struct Vector*));
 		*result = vector_add(vector1, *vector2);
 		luaL_getmetatable(lua, "CrunumVector");
@@ -182,6 +259,8 @@ static int l_vector_add(lua_State* lua){
 		return 1;
 	}
 	if(lua_type(lua, 2) == LUA_TNUMBER){
+		if(dst)
+			return push_dst(lua, vector_add_scalar_into(*dst, vector1, luaL_checknumber(lua, 2)));
 		struct Vector** result = lua_newuserdata(lua, sizeof(struct Vector*));
 		*result = vector_add_scalar(vector1, luaL_checknumber(lua, 2));
 		luaL_getmetatable(lua, "CrunumVector");
@@ -192,7 +271,38 @@ static int l_vector_add(lua_State* lua){
 	return 0;
 }
 
+/*
+ * v:map(fn, params..., dst), see m:map.
+ */
+static int l_vector_map(lua_State* lua){
+	struct Vector* vector = *(struct Vector**)luaL_checkudata(lua, 1, "CrunumVector");
+	enum MapFn fn;
+	double param1, param2;
+	int dst_index = l_check_map(lua, 2, &fn, &param1, &param2);
+	struct Vector** dst = luaL_testudata(lua, dst_index, "CrunumVector");
+	if(dst){
+		if(!vector_map_into(*dst, vector, fn, param1, param2)){
+			luaL_error(lua, "Destination length doesn't match result length");
+			return 0;
+		}
+		lua_pushvalue(lua, dst_index);
+		return 1;
+	}
+	struct Vector* temp = vector_map(vector, fn, param1, param2);
+	if(!temp){
+		luaL_error(lua, "Not enough memory");
+		return 0;
+	}
+	struct Vector** result = lua_newuserdata(lua, sizeof(struct Vector*));
+	*result = temp;
+	luaL_getmetatable(lua, "CrunumVector");
+	lua_setmetatable(lua, -2);
+	return 1;
+}
+
 static int l_vector_eq(lua_State* lua){
+	if(luaL_testudata(lua, 2, "CrunumView"))
+		return l_view_eq(lua);
 	struct Vector* vector1 = *(struct Vector**)luaL_checkudata(lua, 1, "CrunumVector");
 	struct Vector* vector2 = *(struct Vector**)luaL_checkudata(lua, 2, "CrunumVector");
 	if(vector1->len != vector2->len){
@@ -258,15 +368,84 @@ static int l_vector_le(lua_State* lua){
 	return 1;
 }
 
+/*
+ * v:eq(other), v:gt(other), ... with a vector of the same length or a
+ * number, giving a 1 x len mask of where the comparison holds.
+ */
+static int l_vector_compare(lua_State* lua,
+		struct Mask* (*compare)(struct Vector*, struct Vector*),
+		struct Mask* (*compare_scalar)(struct Vector*, double)){
+	struct Vector* vector1 = *(struct Vector**)luaL_checkudata(lua, 1, "CrunumVector");
+	if(lua_type(lua, 2) == LUA_TNUMBER)
+		return l_push_mask(lua, compare_scalar(vector1, lua_tonumber(lua, 2)));
+	struct Vector* vector2 = *(struct Vector**)luaL_checkudata(lua, 2, "CrunumVector");
+	if(vector1->len != vector2->len){
+		luaL_error(lua, "Both vector aren't the same length");
+		return 0;
+	}
+	return l_push_mask(lua, compare(vector1, vector2));
+}
+
+static int l_vector_eq_mask(lua_State* lua){
+	return l_vector_compare(lua, vector_eq_mask, vector_eq_scalar_mask);
+}
+
+static int l_vector_neq_mask(lua_State* lua){
+	return l_vector_compare(lua, vector_neq_mask, vector_neq_scalar_mask);
+}
+
+static int l_vector_gt_mask(lua_State* lua){
+	return l_vector_compare(lua, vector_gt_mask, vector_gt_scalar_mask);
+}
+
+static int l_vector_ge_mask(lua_State* lua){
+	return l_vector_compare(lua, vector_ge_mask, vector_ge_scalar_mask);
+}
+
+static int l_vector_lt_mask(lua_State* lua){
+	return l_vector_compare(lua, vector_lt_mask, vector_lt_scalar_mask);
+}
+
+static int l_vector_le_mask(lua_State* lua){
+	return l_vector_compare(lua, vector_le_mask, vector_le_scalar_mask);
+}
+
+static int l_vector_allclose(lua_State* lua){
+	struct Vector* vector1 = *(struct Vector**)luaL_checkudata(lua, 1, "CrunumVector");
+	struct Vector* vector2 = *(struct Vector**)luaL_checkudata(lua, 2, "CrunumVector");
+	double rtol = luaL_optnumber(lua, 3, 1e-5);
+	double atol = luaL_optnumber(lua, 4, 1e-8);
+	if(vector1->len != vector2->len){
+		luaL_error(lua, "Both vector aren't the same length");
+		return 0;
+	}
+	lua_pushboolean(lua, (int)vector_allclose(vector1, vector2, rtol, atol));
+	return 1;
+}
+
 const luaL_Reg vector_functions[] = {
 	{"new", l_vector_new},
 	{"randinit", l_vector_randinit},
 	{"from", l_vector_from},
+	{"frombytes", l_vector_frombytes},
 	{NULL, NULL}
 };
 
 const luaL_Reg vector_methods[] = {
 	{"len", l_vector_len},
+	{"tobytes", l_vector_tobytes},
+	{"dtype", l_vector_dtype},
+	{"astype", l_vector_astype},
+	{"add", l_vector_add},
+	{"mul", l_vector_mul},
+	{"map", l_vector_map},
+	{"eq", l_vector_eq_mask},
+	{"neq", l_vector_neq_mask},
+	{"gt", l_vector_gt_mask},
+	{"ge", l_vector_ge_mask},
+	{"lt", l_vector_lt_mask},
+	{"le", l_vector_le_mask},
+	{"allclose", l_vector_allclose},
 	{"push", l_vector_push},
 	{"pop", l_vector_pop},
 	{"__index", l_vector_index},
@@ -0,0 +1,524 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#pragma message "Lua View"
+
+#include "lua_bind.h"
+
+/*
+ * A view keeps its matrix userdata alive through its user value and only
+ * stores an offset, the values pointer is taken from the matrix on every
+ * use, so push_row/push_col reallocating it can't leave the view
+ * dangling. A view whose matrix no longer has the same cols, or lost the
+ * rows it covered, raises instead. rows and cols describe the stored
+ * block, a transposed view flips them when it is read. vector is set on
+ * views of a single row or col, those read as vectors, other views keep
+ * their 2D shape even when one side is 1.
+ */
+struct LuaView {
+	struct Matrix* matrix;
+	ulong offset;
+	uint rows;
+	uint cols;
+	uint ld;
+	uint transposed;
+	uint vector;
+};
+
+/*
+ * Matrices of other dtypes than float32 have no views, they get a copy
+ * of the block instead.
+ */
+int l_view_push(lua_State* lua, int index, uint row, uint col,
+		uint rows, uint cols, uint vector){
+	struct Matrix* matrix = *(struct Matrix**)luaL_checkudata(lua, index, "CrunumMatrix");
+	if(matrix->dtype != DTYPE_F32){
+		struct Matrix** result = lua_newuserdata(lua, sizeof(struct Matrix*));
+		*result = matrix_block(matrix, row, col, rows, cols);
+		luaL_getmetatable(lua, "CrunumMatrix");
+		lua_setmetatable(lua, -2);
+		return 1;
+	}
+	index = lua_absindex(lua, index);
+	struct LuaView* view = lua_newuserdatauv(lua, sizeof(struct LuaView), 1);
+	view->matrix = matrix;
+	view->offset = (ulong)row * matrix->ld + col;
+	view->rows = rows;
+	view->cols = cols;
+	view->ld = matrix->ld;
+	view->transposed = 0;
+	view->vector = vector;
+	luaL_getmetatable(lua, "CrunumView");
+	lua_setmetatable(lua, -2);
+	lua_pushvalue(lua, index);
+	lua_setiuservalue(lua, -2, 1);
+	return 1;
+}
+
+static struct View check_view(lua_State* lua, int index){
+	struct LuaView* view = luaL_checkudata(lua, index, "CrunumView");
+	struct Matrix* matrix = view->matrix;
+	struct View result = {NULL, view->rows, view->cols, view->ld, 0};
+	uint empty = !view->rows || !view->cols;
+	ulong row = view->ld ? view->offset / view->ld : 0;
+	ulong col = view->ld ? view->offset % view->ld : 0;
+	if(matrix->ld != view->ld || (!empty && (row + view->rows > matrix->rows ||
+					col + view->cols > matrix->cols))){
+		luaL_error(lua, "Matrix was resized under the view");
+		return result;
+	}
+	result.values = &matrix->values[view->offset];
+	if(view->transposed)
+		view_transpose(&result, &result);
+	return result;
+}
+
+/*
+ * O(1) transpose of a matrix or a view, the result is a view over the
+ * same storage with the transposed flag flipped.
+ */
+int l_view_transpose(lua_State* lua){
+	if(luaL_testudata(lua, 1, "CrunumMatrix")){
+		struct Matrix* matrix = *(struct Matrix**)lua_touserdata(lua, 1);
+		l_view_push(lua, 1, 0, 0, matrix->rows, matrix->cols, 0);
+		((struct LuaView*)lua_touserdata(lua, -1))->transposed = 1;
+		return 1;
+	}
+	struct LuaView* view = luaL_checkudata(lua, 1, "CrunumView");
+	check_view(lua, 1);
+	struct LuaView* result = lua_newuserdatauv(lua, sizeof(struct LuaView), 1);
+	*result = *view;
+	result->transposed = !view->transposed;
+	luaL_getmetatable(lua, "CrunumView");
+	lua_setmetatable(lua, -2);
+	lua_getiuservalue(lua, 1, 1);
+	lua_setiuservalue(lua, -2, 1);
+	return 1;
+}
+
+/*
+ * Views, matrices and vectors all read as views, vectors as 1 x len.
+ * Matrices and vectors of other dtypes are read through a float32 copy
+ * pushed on the stack, which keeps it alive for the call.
+ */
+static uint to_view(lua_State* lua, int index, struct View* view){
+	if(luaL_testudata(lua, index, "CrunumView")){
+		*view = check_view(lua, index);
+		return 1;
+	}
+	struct Matrix** matrix = luaL_testudata(lua, index, "CrunumMatrix");
+	if(matrix){
+		if((*matrix)->dtype != DTYPE_F32){
+			struct Matrix** copy = lua_newuserdata(lua, sizeof(struct Matrix*));
+			*copy = matrix_astype(*matrix, DTYPE_F32);
+			luaL_getmetatable(lua, "CrunumMatrix");
+			lua_setmetatable(lua, -2);
+			if(!*copy){
+				luaL_error(lua, "Not enough memory");
+				return 0;
+			}
+			matrix = copy;
+		}
+		view_matrix(view, *matrix);
+		return 1;
+	}
+	struct Vector** vector = luaL_testudata(lua, index, "CrunumVector");
+	if(vector){
+		if((*vector)->dtype != DTYPE_F32){
+			struct Vector** copy = lua_newuserdata(lua, sizeof(struct Vector*));
+			*copy = vector_astype(*vector, DTYPE_F32);
+			luaL_getmetatable(lua, "CrunumVector");
+			lua_setmetatable(lua, -2);
+			if(!*copy){
+				luaL_error(lua, "Not enough memory");
+				return 0;
+			}
+			vector = copy;
+		}
+		view_vector(view, *vector);
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Destinations are written in place, so they can't go through a copy.
+ */
+static uint to_dst(lua_State* lua, int index, struct View* view){
+	struct Matrix** matrix = luaL_testudata(lua, index, "CrunumMatrix");
+	struct Vector** vector = luaL_testudata(lua, index, "CrunumVector");
+	if((matrix && (*matrix)->dtype != DTYPE_F32) || (vector && (*vector)->dtype != DTYPE_F32)){
+		luaL_error(lua, "Only float32 destinations take view results");
+		return 0;
+	}
+	return to_view(lua, index, view);
+}
+
+/*
+ * Vectors and views of a single row or col read as vectors.
+ */
+static uint is_1d(lua_State* lua, int index){
+	struct LuaView* view = luaL_testudata(lua, index, "CrunumView");
+	return luaL_testudata(lua, index, "CrunumVector") || (view && view->vector);
+}
+
+/*
+ * Allocates the result in the shape of the operand at index, a vector
+ * for vectors, a matrix otherwise.
+ */
+static struct View push_result(lua_State* lua, int index, const struct View* shape){
+	struct View view;
+	if(is_1d(lua, index)){
+		struct Vector** result = lua_newuserdata(lua, sizeof(struct Vector*));
+		*result = vector_new(shape->rows * shape->cols, 0);
+		luaL_getmetatable(lua, "CrunumVector");
+		lua_setmetatable(lua, -2);
+		view_vector(&view, *result);
+		return view;
+	}
+	struct Matrix** result = lua_newuserdata(lua, sizeof(struct Matrix*));
+	*result = matrix_new(shape->rows, shape->cols, 0);
+	luaL_getmetatable(lua, "CrunumMatrix");
+	lua_setmetatable(lua, -2);
+	view_matrix(&view, *result);
+	return view;
+}
+
+/*
+ * Elementwise arithmetic between any two of view, matrix, vector and
+ * scalar, with an optional destination as the third argument.
+ */
+int l_view_arith(lua_State* lua, enum ExprOp op){
+	struct View view1, view2, dst;
+	uint has_dst = to_dst(lua, 3, &dst);
+	uint has_view1 = to_view(lua, 1, &view1);
+	uint has_view2 = to_view(lua, 2, &view2);
+	if(!has_view1 && !has_view2){
+		luaL_error(lua, "Expected a view, matrix or vector operand");
+		return 0;
+	}
+	if(!has_dst)
+		dst = push_result(lua, has_view1 ? 1 : 2, has_view1 ? &view1 : &view2);
+	struct View* result;
+	if(has_view1 && has_view2){
+		switch(op){
+			case EXPR_ADD:
+				result = view_add_into(&dst, &view1, &view2);
+				break;
+			case EXPR_SUB:
+				result = view_sub_into(&dst, &view1, &view2);
+				break;
+			case EXPR_MUL:
+				result = view_mul_into(&dst, &view1, &view2);
+				break;
+			default:
+				result = view_div_into(&dst, &view1, &view2);
+		}
+	}
+	else if(has_view1){
+		float scalar = luaL_checknumber(lua, 2);
+		switch(op){
+			case EXPR_ADD:
+				result = view_add_scalar_into(&dst, &view1, scalar);
+				break;
+			case EXPR_SUB:
+				result = view_sub_scalar_into(&dst, &view1, scalar);
+				break;
+			case EXPR_MUL:
+				result = view_mul_scalar_into(&dst, &view1, scalar);
+				break;
+			default:
+				result = view_div_scalar_into(&dst, &view1, scalar);
+		}
+	}
+	else{
+		float scalar = luaL_checknumber(lua, 1);
+		switch(op){
+			case EXPR_ADD:
+				result = view_add_scalar_into(&dst, &view2, scalar);
+				break;
+			case EXPR_SUB:
+				result = scalar_sub_view_into(&dst, scalar, &view2);
+				break;
+			case EXPR_MUL:
+				result = view_mul_scalar_into(&dst, &view2, scalar);
+				break;
+			default:
+				result = scalar_div_view_into(&dst, scalar, &view2);
+		}
+	}
+	if(!result){
+		luaL_error(lua, "View size doesn't match another operand size");
+		return 0;
+	}
+	if(has_dst)
+		lua_pushvalue(lua, 3);
+	return 1;
+}
+
+/*
+ * Matrix product of views and matrices, transposed operands go to the
+ * kernels as they are. A vector, or the view of a row or col, reads as a
+ * row on the left and a column on the right and makes the result a
+ * vector.
+ */
+int l_view_matmul(lua_State* lua){
+	struct View view1, view2;
+	if(!to_view(lua, 1, &view1) || !to_view(lua, 2, &view2)){
+		luaL_error(lua, "Expected view or matrix operands");
+		return 0;
+	}
+	uint vector1 = is_1d(lua, 1);
+	uint vector2 = is_1d(lua, 2);
+	if(vector1 && view1.rows != 1)
+		view_transpose(&view1, &view1);
+	if(vector2 && view2.cols != 1)
+		view_transpose(&view2, &view2);
+	if(view1.cols != view2.rows){
+		luaL_error(lua, "View col size doesn't match another operand row size");
+		return 0;
+	}
+	if(vector1 || vector2){
+		struct Vector** result = lua_newuserdata(lua, sizeof(struct Vector*));
+		*result = vector_new(vector1 ? view2.cols : view1.rows, 0);
+		luaL_getmetatable(lua, "CrunumVector");
+		lua_setmetatable(lua, -2);
+		struct View dst;
+		view_vector(&dst, *result);
+		if(!vector1)
+			view_transpose(&dst, &dst);
+		view_matmul_into(&dst, &view1, &view2);
+		return 1;
+	}
+	struct Matrix** result = lua_newuserdata(lua, sizeof(struct Matrix*));
+	*result = view_matmul(&view1, &view2);
+	luaL_getmetatable(lua, "CrunumMatrix");
+	lua_setmetatable(lua, -2);
+	return 1;
+}
+
+static int l_view_add(lua_State* lua){
+	return l_view_arith(lua, EXPR_ADD);
+}
+
+static int l_view_sub(lua_State* lua){
+	return l_view_arith(lua, EXPR_SUB);
+}
+
+/*
+ * Like matrices and vectors, * is a matrix product unless a scalar or
+ * two vectors, or views of a row or col, are involved, those multiply
+ * elementwise.
+ */
+int l_view_mul(lua_State* lua){
+	struct View view1, view2;
+	if(to_view(lua, 1, &view1) && to_view(lua, 2, &view2) &&
+			(!is_1d(lua, 1) || !is_1d(lua, 2)))
+		return l_view_matmul(lua);
+	return l_view_arith(lua, EXPR_MUL);
+}
+
+static int l_view_div(lua_State* lua){
+	return l_view_arith(lua, EXPR_DIV);
+}
+
+/*
+ * 1D views take one index, 2D views a row and a col, both 1-based.
+ */
+static float* view_element(lua_State* lua, const struct View* view,
+		int index, uint single){
+	int row, col;
+	if(single){
+		int i = luaL_checkinteger(lua, index) - 1;
+		row = view->rows == 1 ? 0 : i;
+		col = view->rows == 1 ? i : 0;
+	}
+	else{
+		row = luaL_checkinteger(lua, index) - 1;
+		col = luaL_checkinteger(lua, index + 1) - 1;
+	}
+	if((uint)row >= view->rows || (uint)col >= view->cols || row < 0 || col < 0){
+		luaL_error(lua, "Out of bound");
+		return NULL;
+	}
+	return view_get(view, (uint)row, (uint)col);
+}
+
+static int l_view_get(lua_State* lua){
+	struct View view = check_view(lua, 1);
+	uint single = view_is_1d(&view) && lua_isnoneornil(lua, 3);
+	lua_pushnumber(lua, *view_element(lua, &view, 2, single));
+	return 1;
+}
+
+static int l_view_set(lua_State* lua){
+	struct View view = check_view(lua, 1);
+	uint single = view_is_1d(&view) && lua_gettop(lua) == 3;
+	float* value = view_element(lua, &view, 2, single);
+	*value = luaL_checknumber(lua, single ? 3 : 4);
+	return 0;
+}
+
+static int l_view_index(lua_State* lua){
+	if(lua_type(lua, 2) == LUA_TSTRING){
+		luaL_getmetatable(lua, "CrunumView");
+		lua_pushvalue(lua, 2);
+		lua_rawget(lua, -2);
+		return 1;
+	}
+	struct View view = check_view(lua, 1);
+	if(!view_is_1d(&view)){
+		luaL_error(lua, "2D views are indexed with get(row, col)");
+		return 0;
+	}
+	lua_pushnumber(lua, *view_element(lua, &view, 2, 1));
+	return 1;
+}
+
+static int l_view_newindex(lua_State* lua){
+	struct View view = check_view(lua, 1);
+	if(!view_is_1d(&view)){
+		luaL_error(lua, "2D views are indexed with set(row, col, value)");
+		return 0;
+	}
+	float* value = view_element(lua, &view, 2, 1);
+	*value = luaL_checknumber(lua, 3);
+	return 0;
+}
+
+static int l_view_rows(lua_State* lua){
+	struct View view = check_view(lua, 1);
+	lua_pushinteger(lua, view.rows);
+	return 1;
+}
+
+static int l_view_cols(lua_State* lua){
+	struct View view = check_view(lua, 1);
+	lua_pushinteger(lua, view.cols);
+	return 1;
+}
+
+static int l_view_len(lua_State* lua){
+	struct View view = check_view(lua, 1);
+	lua_pushinteger(lua, (lua_Integer)view.rows * view.cols);
+	return 1;
+}
+
+static int l_view_copy(lua_State* lua){
+	struct View view = check_view(lua, 1);
+	if(is_1d(lua, 1)){
+		struct Vector** result = lua_newuserdata(lua, sizeof(struct Vector*));
+		*result = vector_from_view(&view);
+		luaL_getmetatable(lua, "CrunumVector");
+		lua_setmetatable(lua, -2);
+		return 1;
+	}
+	struct Matrix** result = lua_newuserdata(lua, sizeof(struct Matrix*));
+	*result = matrix_from_view(&view);
+	luaL_getmetatable(lua, "CrunumMatrix");
+	lua_setmetatable(lua, -2);
+	return 1;
+}
+
+static int l_view_assign(lua_State* lua){
+	struct View view = check_view(lua, 1);
+	if(lua_type(lua, 2) == LUA_TNUMBER){
+		view_fill(&view, luaL_checknumber(lua, 2));
+		return 0;
+	}
+	struct View src;
+	if(!to_view(lua, 2, &src)){
+		luaL_error(lua, "Expected a view, matrix, vector or scalar");
+		return 0;
+	}
+	if(!view_copy_into(&view, &src)){
+		luaL_error(lua, "View size doesn't match another operand size");
+		return 0;
+	}
+	return 0;
+}
+
+static int l_view_dot(lua_State* lua){
+	struct View view1 = check_view(lua, 1);
+	struct View view2;
+	if(!to_view(lua, 2, &view2)){
+		luaL_error(lua, "Expected a view or vector");
+		return 0;
+	}
+	if(!view_is_1d(&view1) || !view_is_1d(&view2) ||
+			(ulong)view1.rows * view1.cols != (ulong)view2.rows * view2.cols){
+		luaL_error(lua, "dot needs 1D operands of the same length");
+		return 0;
+	}
+	lua_pushnumber(lua, view_dot(&view1, &view2));
+	return 1;
+}
+
+int l_view_eq(lua_State* lua){
+	struct View view1, view2;
+	if(!to_view(lua, 1, &view1) || !to_view(lua, 2, &view2)){
+		lua_pushboolean(lua, 0);
+		return 1;
+	}
+	lua_pushboolean(lua, (int)view_eq(&view1, &view2));
+	return 1;
+}
+
+static int l_view_tostring(lua_State* lua){
+	struct View view = check_view(lua, 1);
+	luaL_Buffer result;
+	luaL_buffinit(lua, &result);
+	luaL_addchar(&result, '{');
+	for(uint i = 0; i < view.rows; i++){
+		if(view.rows > 1)
+			luaL_addstring(&result, "\n  {");
+		for(uint j = 0; j < view.cols; j++){
+			char num[16];
+			snprintf(num, sizeof(num), "%.2lf", *view_get(&view, i, j));
+			luaL_addstring(&result, num);
+			if(j != view.cols - 1)
+				luaL_addstring(&result, ", ");
+		}
+		if(view.rows > 1){
+			luaL_addchar(&result, '}');
+			if(i != view.rows - 1)
+				luaL_addchar(&result, ',');
+			else
+				luaL_addchar(&result, '\n');
+		}
+	}
+	luaL_addchar(&result, '}');
+	luaL_pushresult(&result);
+	return 1;
+}
+
+const luaL_Reg view_methods[] = {
+	{"get", l_view_get},
+	{"set", l_view_set},
+	{"rows", l_view_rows},
+	{"cols", l_view_cols},
+	{"len", l_view_len},
+	{"copy", l_view_copy},
+	{"assign", l_view_assign},
+	{"dot", l_view_dot},
+	{"matmul", l_view_matmul},
+	{"transpose", l_view_transpose},
+	{"add", l_view_add},
+	{"sub", l_view_sub},
+	{"mul", l_view_mul},
+	{"div", l_view_div},
+	{"__index", l_view_index},
+	{"__newindex", l_view_newindex},
+	{"__len", l_view_len},
+	{"__tostring", l_view_tostring},
+	{"__add", l_view_add},
+	{"__sub", l_view_sub},
+	{"__mul", l_view_mul},
+	{"__div", l_view_div},
+	{"__eq", l_view_eq},
+	{NULL, NULL}
+};
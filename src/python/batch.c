@@ -0,0 +1,336 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#pragma message "Python batched matrix"
+
+#include "python_bind.h"
+
+static PyObject* crn_batch_wrap(struct Batch* batch){
+	if(!batch)
+		return PyErr_NoMemory();
+	struct CrunumBatch* crn_batch = PyObject_New(struct CrunumBatch, &crn_batch_type);
+	if(!crn_batch){
+		batch_free(batch);
+		return NULL;
+	}
+	crn_batch->batch = batch;
+	return (PyObject*)crn_batch;
+}
+
+static PyObject* crn_batch_new(PyObject* self, PyObject* args, PyObject* kwargs){
+	(void)self;
+	uint count, rows, cols;
+	float value = 0;
+	static char* keywords[] = {"count", "rows", "cols", "value", NULL};
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "III|f", keywords, &count, &rows, &cols, &value))
+		return NULL;
+	return crn_batch_wrap(batch_new(count, rows, cols, value));
+}
+
+static PyObject* crn_batch_identity(PyObject* self, PyObject* args){
+	(void)self;
+	uint count, size;
+	if(!PyArg_ParseTuple(args, "II", &count, &size))
+		return NULL;
+	return crn_batch_wrap(batch_identity(count, size));
+}
+
+static PyObject* crn_batch_stack(PyObject* self, PyObject* obj){
+	(void)self;
+	PyObject* matrices = PySequence_Fast(obj, "Expected a sequence of matrices");
+	if(!matrices)
+		return NULL;
+	uint count = (uint)PySequence_Fast_GET_SIZE(matrices);
+	PyObject* result = NULL;
+	if(!count){
+		PyErr_SetString(PyExc_ValueError, "Batch needs at least one matrix");
+		goto done;
+	}
+	for(uint index = 0; index < count; index++)
+		if(!PyObject_TypeCheck(PySequence_Fast_GET_ITEM(matrices, index), &crn_matrix_type)){
+			PyErr_SetString(PyExc_TypeError, "Expected a sequence of matrices");
+			goto done;
+		}
+	struct Matrix* first = ((struct CrunumMatrix*)PySequence_Fast_GET_ITEM(matrices, 0))->matrix;
+	result = crn_batch_wrap(batch_new(count, first->rows, first->cols, 0));
+	if(!result)
+		goto done;
+	for(uint index = 0; index < count; index++){
+		struct Matrix* matrix = ((struct CrunumMatrix*)PySequence_Fast_GET_ITEM(matrices, index))->matrix;
+		if(!batch_set(((struct CrunumBatch*)result)->batch, index, matrix)){
+			PyErr_SetString(PyExc_ValueError, "Matrices in a batch should have the same shape");
+			Py_CLEAR(result);
+			goto done;
+		}
+	}
+done:
+	Py_DECREF(matrices);
+	return result;
+}
+
+/*
+ * Shape check of batch times other, which is a batch or a vector.
+ */
+static int crn_batch_mul_check(struct Batch* batch, PyObject* other){
+	if(PyObject_TypeCheck(other, &crn_batch_type)){
+		struct Batch* batch2 = ((struct CrunumBatch*)other)->batch;
+		if(batch->cols != batch2->rows){
+			PyErr_SetString(PyExc_ValueError, "Batch col size doesn't match another batch row size");
+			return 0;
+		}
+		if(batch->count != batch2->count && batch->count != 1 && batch2->count != 1){
+			PyErr_SetString(PyExc_ValueError, "Batch count doesn't match another batch count");
+			return 0;
+		}
+		return 1;
+	}
+	if(batch->cols != ((struct CrunumVector*)other)->vector->len){
+		PyErr_SetString(PyExc_ValueError, "Batch col size doesn't match vector length");
+		return 0;
+	}
+	return 1;
+}
+
+static PyObject* crn_batch_mul(PyObject* left, PyObject* right){
+	if(!PyObject_TypeCheck(left, &crn_batch_type) || (!PyObject_TypeCheck(right, &crn_batch_type) &&
+				!PyObject_TypeCheck(right, &crn_vector_type)))
+		Py_RETURN_NOTIMPLEMENTED;
+	struct Batch* batch = ((struct CrunumBatch*)left)->batch;
+	if(!crn_batch_mul_check(batch, right))
+		return NULL;
+	if(PyObject_TypeCheck(right, &crn_batch_type))
+		return crn_batch_wrap(batch_mul(batch, ((struct CrunumBatch*)right)->batch));
+	return crn_batch_wrap(batch_mul_vector(batch, ((struct CrunumVector*)right)->vector));
+}
+
+static int crn_batch_check_out(PyObject* out){
+	if(!PyObject_TypeCheck(out, &crn_batch_type)){
+		PyErr_SetString(PyExc_TypeError, "out must be a batch");
+		return 0;
+	}
+	return 1;
+}
+
+static PyObject* crn_batch_done(PyObject* out, struct Batch* result){
+	if(!result){
+		PyErr_SetString(PyExc_ValueError,
+				"out shape doesn't match result shape or aliases an operand");
+		return NULL;
+	}
+	Py_INCREF(out);
+	return out;
+}
+
+static PyObject* crn_batch_mul_out(struct CrunumBatch* self,
+		PyObject* args, PyObject* kwargs){
+	PyObject* other;
+	PyObject* out = NULL;
+	static char* keywords[] = {"other", "out", NULL};
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", keywords, &other, &out))
+		return NULL;
+	if(!out || out == Py_None)
+		return crn_batch_mul((PyObject*)self, other);
+	if(!PyObject_TypeCheck(other, &crn_batch_type) && !PyObject_TypeCheck(other, &crn_vector_type)){
+		PyErr_SetString(PyExc_TypeError, "Expected a batch or a vector");
+		return NULL;
+	}
+	if(!crn_batch_mul_check(self->batch, other) || !crn_batch_check_out(out))
+		return NULL;
+	struct Batch* dst = ((struct CrunumBatch*)out)->batch;
+	if(PyObject_TypeCheck(other, &crn_batch_type))
+		return crn_batch_done(out, batch_mul_into(dst, self->batch,
+					((struct CrunumBatch*)other)->batch));
+	return crn_batch_done(out, batch_mul_vector_into(dst, self->batch,
+				((struct CrunumVector*)other)->vector));
+}
+
+static PyObject* crn_batch_transpose(struct CrunumBatch* self,
+		PyObject* args, PyObject* kwargs){
+	PyObject* out = NULL;
+	static char* keywords[] = {"out", NULL};
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", keywords, &out))
+		return NULL;
+	if(!out || out == Py_None)
+		return crn_batch_wrap(batch_transpose(self->batch));
+	if(!crn_batch_check_out(out))
+		return NULL;
+	return crn_batch_done(out, batch_transpose_into(((struct CrunumBatch*)out)->batch,
+				self->batch));
+}
+
+static PyObject* crn_batch_inverse(struct CrunumBatch* self,
+		PyObject* args, PyObject* kwargs){
+	PyObject* out = NULL;
+	static char* keywords[] = {"out", NULL};
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", keywords, &out))
+		return NULL;
+	if(self->batch->rows != self->batch->cols){
+		PyErr_SetString(PyExc_ValueError, "Batch isn't square");
+		return NULL;
+	}
+	uint singular;
+	PyObject* result;
+	if(!out || out == Py_None)
+		result = crn_batch_wrap(batch_inverse(self->batch, &singular));
+	else if(!crn_batch_check_out(out))
+		return NULL;
+	else
+		result = crn_batch_done(out, batch_inverse_into(((struct CrunumBatch*)out)->batch,
+					self->batch, &singular));
+	if(!result)
+		return NULL;
+	return Py_BuildValue("(NI)", result, singular);
+}
+
+static Py_ssize_t crn_batch_len(PyObject* self){
+	return ((struct CrunumBatch*)self)->batch->count;
+}
+
+static int crn_batch_index(struct Batch* batch, PyObject* key, uint* index){
+	Py_ssize_t value = PyLong_AsSsize_t(key);
+	if(value == -1 && PyErr_Occurred())
+		return 0;
+	if(value < 0)
+		value += batch->count;
+	if(value < 0 || value >= (Py_ssize_t)batch->count){
+		PyErr_SetString(PyExc_IndexError, "Index out of range");
+		return 0;
+	}
+	*index = (uint)value;
+	return 1;
+}
+
+static PyObject* crn_batch_get(PyObject* self, PyObject* key){
+	struct Batch* batch = ((struct CrunumBatch*)self)->batch;
+	uint index;
+	if(!crn_batch_index(batch, key, &index))
+		return NULL;
+	struct CrunumMatrix* result = crn_matrix_alloc();
+	if(!result)
+		return NULL;
+	result->matrix = batch_get(batch, index);
+	return (PyObject*)result;
+}
+
+static int crn_batch_set(PyObject* self, PyObject* key, PyObject* value){
+	struct Batch* batch = ((struct CrunumBatch*)self)->batch;
+	uint index;
+	if(!value){
+		PyErr_SetString(PyExc_TypeError, "Can't delete a matrix from a batch");
+		return -1;
+	}
+	if(!crn_batch_index(batch, key, &index))
+		return -1;
+	if(!PyObject_TypeCheck(value, &crn_matrix_type)){
+		PyErr_SetString(PyExc_TypeError, "Expected a matrix");
+		return -1;
+	}
+	if(!batch_set(batch, index, ((struct CrunumMatrix*)value)->matrix)){
+		PyErr_SetString(PyExc_ValueError, "Matrix shape doesn't match batch shape");
+		return -1;
+	}
+	return 0;
+}
+
+static void crn_batch_free(struct CrunumBatch* self){
+	batch_free(self->batch);
+	Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static PyObject* crn_batch_get_attro(PyObject* self, PyObject* attr_name){
+	struct Batch* batch = ((struct CrunumBatch*)self)->batch;
+	if(!PyUnicode_Check(attr_name)){
+		PyErr_SetString(PyExc_TypeError, "Attribute name isn't a string");
+		return NULL;
+	}
+	if(!PyUnicode_CompareWithASCIIString(attr_name, "count"))
+		return PyLong_FromUnsignedLong((ulong)batch->count);
+	if(!PyUnicode_CompareWithASCIIString(attr_name, "rows"))
+		return PyLong_FromUnsignedLong((ulong)batch->rows);
+	if(!PyUnicode_CompareWithASCIIString(attr_name, "cols"))
+		return PyLong_FromUnsignedLong((ulong)batch->cols);
+	return PyObject_GenericGetAttr(self, attr_name);
+}
+
+static PyMethodDef crn_batch_methods[] = {
+	{"mul", (PyCFunction)(void(*)(void))crn_batch_mul_out, METH_VARARGS | METH_KEYWORDS,
+		"Params: Batch or Vector, out(optional),\n"
+		"Return: Batch,\n"
+		"Desc: Product of each pair of matrices, a batch of one matrix or a vector is applied to every matrix, writing into out when given\n"
+		"Example: batch_var.mul(batch_var2, out=batch_var3)"
+	},
+	{"transpose", (PyCFunction)(void(*)(void))crn_batch_transpose, METH_VARARGS | METH_KEYWORDS,
+		"Params: out(optional),\n"
+		"Return: Batch,\n"
+		"Desc: Transpose of every matrix\n"
+		"Example: batch_var.transpose()"
+	},
+	{"inverse", (PyCFunction)(void(*)(void))crn_batch_inverse, METH_VARARGS | METH_KEYWORDS,
+		"Params: out(optional),\n"
+		"Return: (Batch, int),\n"
+		"Desc: Inverse of every matrix and how many were singular, those come out as NaN\n"
+		"Example: inverse, singular = batch_var.inverse()"
+	},
+	{NULL, NULL, 0, NULL},
+};
+
+static PyNumberMethods crn_batch_as_number = {
+	.nb_multiply = crn_batch_mul,
+};
+
+static PyMappingMethods crn_batch_as_mapping = {
+	.mp_length = crn_batch_len,
+	.mp_subscript = crn_batch_get,
+	.mp_ass_subscript = crn_batch_set,
+};
+
+PyTypeObject crn_batch_type = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "crunum.batch.Batch",
+	.tp_basicsize = sizeof(struct CrunumBatch),
+	.tp_itemsize = 0,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_dealloc = (destructor)crn_batch_free,
+	.tp_methods = crn_batch_methods,
+	.tp_as_number = &crn_batch_as_number,
+	.tp_as_mapping = &crn_batch_as_mapping,
+	.tp_getattro = crn_batch_get_attro,
+};
+
+static PyMethodDef crn_batch_functions[] = {
+	{"new", (PyCFunction)(void(*)(void))crn_batch_new, METH_VARARGS | METH_KEYWORDS,
+		"Params: count, rows, cols, value(optional),\n"
+		"Return: Batch,\n"
+		"Desc: count matrices of rows x cols filled with value\n"
+		"Example: crn.batch.new(1000, 4, 4)"
+	},
+	{"identity", (PyCFunction)crn_batch_identity, METH_VARARGS,
+		"Params: count, size,\n"
+		"Return: Batch,\n"
+		"Desc: count identity matrices of size x size\n"
+		"Example: crn.batch.identity(1000, 4)"
+	},
+	{"stack", (PyCFunction)crn_batch_stack, METH_O,
+		"Params: sequence of Matrix,\n"
+		"Return: Batch,\n"
+		"Desc: Batch holding copies of same-shape matrices\n"
+		"Example: crn.batch.stack([mat_var, mat_var2])"
+	},
+	{NULL, NULL, 0, NULL},
+};
+
+PyModuleDef crn_batch_def = {
+	PyModuleDef_HEAD_INIT,
+	"batch",
+	"Batch submodule",
+	-1,
+	crn_batch_functions,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+};
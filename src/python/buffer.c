@@ -0,0 +1,279 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#pragma message "Python Buffer"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "python_bind.h"
+
+/*
+ * Buffer protocol, matrices export a 2D and vectors a 1D buffer over
+ * their own values, format "f" for float32, "d" for float64, "e" for
+ * float16 and "H" for bfloat16, which has no format character of its
+ * own and goes out as its raw 16 bit patterns. Padded
+ * matrix rows are exported through the row stride, so only consumers
+ * that accept strides get one. from_buffer goes the other way and views
+ * a writable, element aligned buffer of one of those in place, or
+ * copies it when it is read only or copy=True.
+ */
+
+static char* crn_buffer_format(enum Dtype dtype){
+	switch(dtype){
+		case DTYPE_F64:
+			return "d";
+		case DTYPE_F16:
+			return "e";
+		case DTYPE_BF16:
+			return "H";
+		default:
+			return "f";
+	}
+}
+
+static int crn_fill_buffer(PyObject* obj, Py_buffer* view, int flags, void* values,
+		enum Dtype dtype, int ndim, Py_ssize_t rows, Py_ssize_t cols, Py_ssize_t ld){
+	const Py_ssize_t size = (Py_ssize_t)dtype_size(dtype);
+	if(ld != cols && rows > 1 && (flags & PyBUF_STRIDES) != PyBUF_STRIDES){
+		PyErr_SetString(PyExc_BufferError, "Matrix rows are padded, buffer needs strides");
+		return -1;
+	}
+	Py_ssize_t* dims = PyMem_Malloc(sizeof(Py_ssize_t) * 4);
+	if(!dims){
+		PyErr_NoMemory();
+		return -1;
+	}
+	dims[0] = ndim == 2 ? rows : cols;
+	dims[1] = cols;
+	dims[2] = ndim == 2 ? ld * size : size;
+	dims[3] = size;
+	view->buf = values;
+	view->obj = obj;
+	Py_INCREF(obj);
+	view->len = rows * cols * size;
+	view->itemsize = size;
+	view->readonly = 0;
+	view->ndim = ndim;
+	view->format = flags & PyBUF_FORMAT ? crn_buffer_format(dtype) : NULL;
+	view->shape = flags & PyBUF_ND ? dims : NULL;
+	view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? &dims[2] : NULL;
+	view->suboffsets = NULL;
+	view->internal = dims;
+	return 0;
+}
+
+static int crn_matrix_getbuffer(PyObject* self, Py_buffer* view, int flags){
+	struct CrunumMatrix* crn_matrix = (struct CrunumMatrix*)self;
+	struct Matrix* matrix = crn_matrix->matrix;
+	if(crn_fill_buffer(self, view, flags, matrix->values, matrix->dtype, 2,
+				matrix->rows, matrix->cols, matrix->ld) < 0)
+		return -1;
+	crn_matrix->exports++;
+	return 0;
+}
+
+static void crn_matrix_releasebuffer(PyObject* self, Py_buffer* view){
+	PyMem_Free(view->internal);
+	((struct CrunumMatrix*)self)->exports--;
+}
+
+static int crn_vector_getbuffer(PyObject* self, Py_buffer* view, int flags){
+	struct CrunumVector* crn_vector = (struct CrunumVector*)self;
+	struct Vector* vector = crn_vector->vector;
+	if(crn_fill_buffer(self, view, flags, vector->values, vector->dtype, 1, 1, vector->len,
+				vector->len) < 0)
+		return -1;
+	crn_vector->exports++;
+	return 0;
+}
+
+static void crn_vector_releasebuffer(PyObject* self, Py_buffer* view){
+	PyMem_Free(view->internal);
+	((struct CrunumVector*)self)->exports--;
+}
+
+PyBufferProcs crn_matrix_as_buffer = {
+	.bf_getbuffer = crn_matrix_getbuffer,
+	.bf_releasebuffer = crn_matrix_releasebuffer,
+};
+
+PyBufferProcs crn_vector_as_buffer = {
+	.bf_getbuffer = crn_vector_getbuffer,
+	.bf_releasebuffer = crn_vector_releasebuffer,
+};
+
+void crn_buffer_free(Py_buffer* source){
+	if(!source)
+		return;
+	PyBuffer_Release(source);
+	PyMem_Free(source);
+}
+
+/*
+ * Acquires a float32, float64 or float16 C contiguous buffer, writable
+ * when possible, and sets dtype from its format. Untyped bytes keep the
+ * dtype passed in, as do uint16 ones when that is bfloat16. The returned buffer is owned by the caller and released
+ * with crn_buffer_free.
+ */
+static Py_buffer* crn_buffer_acquire(PyObject* obj, enum Dtype* dtype){
+	Py_buffer* source = PyMem_Malloc(sizeof(Py_buffer));
+	if(!source){
+		PyErr_NoMemory();
+		return NULL;
+	}
+	if(PyObject_GetBuffer(obj, source, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | PyBUF_WRITABLE) < 0){
+		PyErr_Clear();
+		if(PyObject_GetBuffer(obj, source, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) < 0){
+			PyMem_Free(source);
+			return NULL;
+		}
+	}
+	const char* format = source->format ? source->format : "B";
+	if(format[0] == '<' || format[0] == '=' || format[0] == '@')
+		format++;
+	if(!strcmp(format, "f"))
+		*dtype = DTYPE_F32;
+	else if(!strcmp(format, "d"))
+		*dtype = DTYPE_F64;
+	else if(!strcmp(format, "e"))
+		*dtype = DTYPE_F16;
+	else if(strcmp(format, "B") && (strcmp(format, "H") || *dtype != DTYPE_BF16)){
+		crn_buffer_free(source);
+		PyErr_SetString(PyExc_TypeError,
+				"Buffer must hold float32, float64 or float16 values");
+		return NULL;
+	}
+	if(source->len % (Py_ssize_t)dtype_size(*dtype)){
+		crn_buffer_free(source);
+		PyErr_SetString(PyExc_ValueError, "Buffer size isn't a multiple of the element size");
+		return NULL;
+	}
+	return source;
+}
+
+static uint crn_buffer_viewable(Py_buffer* source, enum Dtype dtype, int copy){
+	return !copy && !source->readonly &&
+		(uintptr_t)source->buf % dtype_size(dtype) == 0;
+}
+
+PyObject* crn_matrix_from_buffer(PyObject* self, PyObject* args, PyObject* kwargs){
+	(void)self;
+	PyObject* obj;
+	long rows = -1, cols = -1;
+	int copy = 0;
+	enum Dtype dtype = DTYPE_F32;
+	static char* keywords[] = {"buffer", "rows", "cols", "copy", "dtype", NULL};
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "O|llpO&", keywords,
+				&obj, &rows, &cols, &copy, crn_dtype_converter, &dtype))
+		return NULL;
+	Py_buffer* source = crn_buffer_acquire(obj, &dtype);
+	if(!source)
+		return NULL;
+	const ulong size = dtype_size(dtype);
+	Py_ssize_t len = source->len / (Py_ssize_t)size;
+	if(rows < 0 && cols < 0){
+		if(source->ndim == 2 && source->itemsize == (Py_ssize_t)size){
+			rows = source->shape[0];
+			cols = source->shape[1];
+		}
+		else{
+			rows = 1;
+			cols = len;
+		}
+	}
+	else if(rows < 0)
+		rows = cols ? len / cols : 0;
+	else if(cols < 0)
+		cols = rows ? len / rows : 0;
+	if((Py_ssize_t)rows * cols != len || (ulong)rows > (uint)-1 || (ulong)cols > (uint)-1){
+		crn_buffer_free(source);
+		PyErr_SetString(PyExc_ValueError, "Buffer size doesn't match matrix size");
+		return NULL;
+	}
+	struct Matrix* matrix;
+	uint viewed = crn_buffer_viewable(source, dtype, copy);
+	if(viewed){
+		matrix = PyMem_Malloc(sizeof(struct Matrix));
+		if(matrix){
+			matrix->values = source->buf;
+			matrix->rows = matrix->rows_cap = (uint)rows;
+			matrix->cols = matrix->cols_cap = matrix->ld = (uint)cols;
+			matrix->dtype = dtype;
+		}
+	}
+	else
+		matrix = matrix_new_dtype((uint)rows, (uint)cols, 0, dtype);
+	struct CrunumMatrix* result = matrix ? crn_matrix_alloc() : NULL;
+	if(!result){
+		if(viewed)
+			PyMem_Free(matrix);
+		else if(matrix)
+			matrix_free(matrix);
+		crn_buffer_free(source);
+		return matrix ? NULL : PyErr_NoMemory();
+	}
+	result->matrix = matrix;
+	if(viewed){
+		result->source = source;
+		return (PyObject*)result;
+	}
+	for(uint i = 0; i < (uint)rows; i++)
+		memcpy(matrix_row_at(matrix, i), (char*)source->buf + size * i * (ulong)cols,
+				size * (ulong)cols);
+	crn_buffer_free(source);
+	return (PyObject*)result;
+}
+
+PyObject* crn_vector_from_buffer(PyObject* self, PyObject* args, PyObject* kwargs){
+	(void)self;
+	PyObject* obj;
+	int copy = 0;
+	enum Dtype dtype = DTYPE_F32;
+	static char* keywords[] = {"buffer", "copy", "dtype", NULL};
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "O|pO&", keywords, &obj, &copy,
+				crn_dtype_converter, &dtype))
+		return NULL;
+	Py_buffer* source = crn_buffer_acquire(obj, &dtype);
+	if(!source)
+		return NULL;
+	Py_ssize_t len = source->len / (Py_ssize_t)dtype_size(dtype);
+	if((ulong)len > (uint)-1){
+		crn_buffer_free(source);
+		PyErr_SetString(PyExc_ValueError, "Buffer is too large for a vector");
+		return NULL;
+	}
+	struct Vector* vector;
+	uint viewed = crn_buffer_viewable(source, dtype, copy);
+	if(viewed){
+		vector = PyMem_Malloc(sizeof(struct Vector));
+		if(vector){
+			vector->values = source->buf;
+			vector->len = vector->cap = (uint)len;
+			vector->dtype = dtype;
+		}
+	}
+	else
+		vector = vector_new_dtype((uint)len, 0, dtype);
+	struct CrunumVector* result = vector ? crn_vector_alloc() : NULL;
+	if(!result){
+		if(viewed)
+			PyMem_Free(vector);
+		else if(vector)
+			vector_free(vector);
+		crn_buffer_free(source);
+		return vector ? NULL : PyErr_NoMemory();
+	}
+	result->vector = vector;
+	if(viewed){
+		result->source = source;
+		return (PyObject*)result;
+	}
+	memcpy(vector->values, source->buf, source->len);
+	crn_buffer_free(source);
+	return (PyObject*)result;
+}
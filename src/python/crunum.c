@@ -8,12 +8,204 @@
 #include "config.h"
 #include "python_bind.h"
 
+/*
+ * "O&" converter for dtype arguments, spelled like numpy's. None keeps
+ * the float32 default.
+ */
+static const char* const crn_dtype_names[] = {"float32", "float64", "float16", "bfloat16"};
+
+int crn_dtype_converter(PyObject* obj, void* dtype){
+	if(obj == Py_None){
+		*(enum Dtype*)dtype = DTYPE_F32;
+		return 1;
+	}
+	if(PyUnicode_Check(obj))
+		for(uint i = 0; i < sizeof(crn_dtype_names) / sizeof(*crn_dtype_names); i++)
+			if(!PyUnicode_CompareWithASCIIString(obj, crn_dtype_names[i])){
+				*(enum Dtype*)dtype = (enum Dtype)i;
+				return 1;
+			}
+	PyErr_SetString(PyExc_ValueError, "dtype must be 'float32', 'float64', 'float16' or 'bfloat16'");
+	return 0;
+}
+
+PyObject* crn_dtype_name(enum Dtype dtype){
+	return PyUnicode_FromString(crn_dtype_names[dtype]);
+}
+
+static const char* const crn_map_names[] = {"exp", "log", "tanh", "sigmoid", "erf",
+	"sqrt", "rsqrt", "abs", "clamp", "pow"};
+
+/*
+ * Arguments of the map methods: (fn, param1, param2, out=None), clamp
+ * taking a lower and an upper bound, pow an exponent and the other
+ * functions nothing.
+ */
+int crn_map_parse(PyObject* args, PyObject* kwargs, enum MapFn* fn,
+		double* param1, double* param2, PyObject** out){
+	PyObject* name;
+	PyObject* params[2] = {NULL, NULL};
+	static char* keywords[] = {"fn", "param1", "param2", "out", NULL};
+	*out = NULL;
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "U|OOO", keywords, &name,
+				&params[0], &params[1], out))
+		return 0;
+	uint found = 0;
+	for(uint i = 0; !found && i < sizeof(crn_map_names) / sizeof(*crn_map_names); i++)
+		if(!PyUnicode_CompareWithASCIIString(name, crn_map_names[i])){
+			*fn = (enum MapFn)i;
+			found = 1;
+		}
+	if(!found){
+		PyErr_SetString(PyExc_ValueError, "fn must be 'exp', 'log', 'tanh', 'sigmoid', "
+				"'erf', 'sqrt', 'rsqrt', 'abs', 'clamp' or 'pow'");
+		return 0;
+	}
+	uint count = *fn == MAP_CLAMP ? 2 : *fn == MAP_POW ? 1 : 0;
+	if((count > 0 && !params[0]) || (count > 1 && !params[1]) || (count < 2 && params[1]) ||
+			(!count && params[0])){
+		PyErr_SetString(PyExc_TypeError, count == 2 ? "clamp takes a lower and an upper bound" :
+				count ? "pow takes an exponent" : "fn takes no parameter");
+		return 0;
+	}
+	double values[2] = {0, 0};
+	for(uint i = 0; i < count; i++){
+		values[i] = PyFloat_AsDouble(params[i]);
+		if(values[i] == -1 && PyErr_Occurred())
+			return 0;
+	}
+	*param1 = values[0];
+	*param2 = values[1];
+	return 1;
+}
+
+static PyObject* crn_num_threads(PyObject* self, PyObject* noargs){
+	(void)self;
+	(void)noargs;
+	return PyLong_FromUnsignedLong((ulong)crunum_num_threads());
+}
+
+static PyObject* crn_set_num_threads(PyObject* self, PyObject* args){
+	(void)self;
+	uint threads;
+	if(!PyArg_ParseTuple(args, "I", &threads))
+		return NULL;
+	crunum_set_num_threads(threads);
+	Py_RETURN_NONE;
+}
+
+static PyObject* crn_pool_stats(PyObject* self, PyObject* noargs){
+	(void)self;
+	(void)noargs;
+	struct PoolStats stats;
+	crunum_pool_stats(&stats);
+	return Py_BuildValue("{s:k,s:k,s:k,s:k,s:k,s:k}",
+			"allocs", stats.allocs, "hits", stats.hits, "misses", stats.misses,
+			"frees", stats.frees, "arena_frees", stats.arena_frees,
+			"cached_bytes", stats.cached_bytes);
+}
+
+static PyObject* crn_pool_reset_stats(PyObject* self, PyObject* noargs){
+	(void)self;
+	(void)noargs;
+	crunum_pool_reset_stats();
+	Py_RETURN_NONE;
+}
+
+static PyObject* crn_pool_trim(PyObject* self, PyObject* noargs){
+	(void)self;
+	(void)noargs;
+	crunum_pool_trim();
+	Py_RETURN_NONE;
+}
+
+/*
+ * with crn.arena(): opens an allocator arena for the block. Garbage is
+ * collected on exit so temporaries caught in reference cycles go back to
+ * the pool along with the rest, objects still referenced are kept.
+ */
+static PyObject* crn_arena_enter(PyObject* self, PyObject* noargs){
+	(void)noargs;
+	if(!crunum_arena_begin())
+		return PyErr_NoMemory();
+	Py_INCREF(self);
+	return self;
+}
+
+static PyObject* crn_arena_exit(PyObject* self, PyObject* args){
+	(void)self;
+	(void)args;
+	PyGC_Collect();
+	crunum_arena_leave();
+	Py_RETURN_FALSE;
+}
+
+static PyMethodDef crn_arena_methods[] = {
+	{"__enter__", (PyCFunction)crn_arena_enter, METH_NOARGS,
+		"Params: None,\n"
+		"Return: Arena,\n"
+		"Desc: Open an allocator arena\n"
+		"Example: with crn.arena(): ..."
+	},
+	{"__exit__", (PyCFunction)crn_arena_exit, METH_VARARGS,
+		"Params: exc_type, exc_value, traceback,\n"
+		"Return: False,\n"
+		"Desc: Close the arena, keeping objects still referenced\n"
+		"Example: with crn.arena(): ..."
+	},
+	{NULL, NULL, 0, NULL},
+};
+
+static PyTypeObject crn_arena_type = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "crunum.arena",
+	.tp_basicsize = sizeof(PyObject),
+	.tp_itemsize = 0,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_new = PyType_GenericNew,
+	.tp_methods = crn_arena_methods,
+};
+
+static PyMethodDef crn_crunum_methods[] = {
+	{"num_threads", (PyCFunction)crn_num_threads, METH_NOARGS,
+		"Params: None,\n"
+		"Return: int,\n"
+		"Desc: Get the number of threads used by large operations\n"
+		"Example: crn.num_threads()"
+	},
+	{"set_num_threads", (PyCFunction)crn_set_num_threads, METH_VARARGS,
+		"Params: threads,\n"
+		"Return: None,\n"
+		"Desc: Set the number of threads, 0 restores the default\n"
+		"Example: crn.set_num_threads(4)"
+	},
+	{"pool_stats", (PyCFunction)crn_pool_stats, METH_NOARGS,
+		"Params: None,\n"
+		"Return: dict,\n"
+		"Desc: Allocator counters, hits are allocations served from the pool\n"
+		"Example: crn.pool_stats()[\"hits\"]"
+	},
+	{"pool_reset_stats", (PyCFunction)crn_pool_reset_stats, METH_NOARGS,
+		"Params: None,\n"
+		"Return: None,\n"
+		"Desc: Reset the allocator counters\n"
+		"Example: crn.pool_reset_stats()"
+	},
+	{"pool_trim", (PyCFunction)crn_pool_trim, METH_NOARGS,
+		"Params: None,\n"
+		"Return: None,\n"
+		"Desc: Return this thread's cached blocks to the system\n"
+		"Example: crn.pool_trim()"
+	},
+	{NULL, NULL, 0, NULL},
+};
+
 static struct PyModuleDef crn_crunum_def = {
 	PyModuleDef_HEAD_INIT,
   .m_name = "crunum",
 	.m_doc = "Library for matrix and vector operations",
 	.m_size = -1,
-	.m_methods = NULL,
+	.m_methods = crn_crunum_methods,
 };
 
 PyMODINIT_FUNC PyInit_crunum(void){
@@ -49,6 +241,18 @@ PyMODINIT_FUNC PyInit_crunum(void){
 		Py_DECREF(crunum);
 		return NULL;
 	}
+	PyObject* batch = PyModule_Create(&crn_batch_def);
+	if(!batch)
+		return NULL;
+	if(PyModule_AddObject(crunum, "batch", batch) < 0){
+		Py_DECREF(batch);
+		Py_DECREF(crunum);
+		return NULL;
+	}
+	if(!PyImport_AddModule("crunum.batch")){
+		Py_DECREF(crunum);
+		return NULL;
+	}
 	if(PyType_Ready(&crn_matrix_type) < 0)
 		return NULL;
 	Py_INCREF(&crn_matrix_type);
@@ -57,5 +261,37 @@ PyMODINIT_FUNC PyInit_crunum(void){
 		return NULL;
 	Py_INCREF(&crn_vector_type);
 	PyModule_AddObject(vector, "Vector", (PyObject*)&crn_vector_type);
+	if(PyType_Ready(&crn_expr_type) < 0)
+		return NULL;
+	Py_INCREF(&crn_expr_type);
+	PyModule_AddObject(matrix, "Expr", (PyObject*)&crn_expr_type);
+	if(PyType_Ready(&crn_lu_type) < 0)
+		return NULL;
+	Py_INCREF(&crn_lu_type);
+	PyModule_AddObject(matrix, "LU", (PyObject*)&crn_lu_type);
+	if(PyType_Ready(&crn_view_type) < 0)
+		return NULL;
+	Py_INCREF(&crn_view_type);
+	PyModule_AddObject(matrix, "View", (PyObject*)&crn_view_type);
+	if(PyType_Ready(&crn_qmatrix_type) < 0)
+		return NULL;
+	Py_INCREF(&crn_qmatrix_type);
+	PyModule_AddObject(matrix, "QMatrix", (PyObject*)&crn_qmatrix_type);
+	if(PyType_Ready(&crn_sparse_type) < 0)
+		return NULL;
+	Py_INCREF(&crn_sparse_type);
+	PyModule_AddObject(matrix, "Sparse", (PyObject*)&crn_sparse_type);
+	if(PyType_Ready(&crn_mask_type) < 0)
+		return NULL;
+	Py_INCREF(&crn_mask_type);
+	PyModule_AddObject(matrix, "Mask", (PyObject*)&crn_mask_type);
+	if(PyType_Ready(&crn_batch_type) < 0)
+		return NULL;
+	Py_INCREF(&crn_batch_type);
+	PyModule_AddObject(batch, "Batch", (PyObject*)&crn_batch_type);
+	if(PyType_Ready(&crn_arena_type) < 0)
+		return NULL;
+	Py_INCREF(&crn_arena_type);
+	PyModule_AddObject(crunum, "arena", (PyObject*)&crn_arena_type);
 	return crunum;
 }
@@ -0,0 +1,209 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#pragma message "Python Expr"
+
+#include "python_bind.h"
+
+static struct CrunumExpr* crn_expr_alloc(PyObject* left, PyObject* right){
+	struct CrunumExpr* crn_expr = PyObject_New(struct CrunumExpr, &crn_expr_type);
+	if(!crn_expr)
+		return NULL;
+	Py_XINCREF(left);
+	Py_XINCREF(right);
+	crn_expr->left = left;
+	crn_expr->right = right;
+	return crn_expr;
+}
+
+static struct CrunumExpr* crn_expr_from(PyObject* obj){
+	if(PyObject_TypeCheck(obj, &crn_expr_type)){
+		Py_INCREF(obj);
+		return (struct CrunumExpr*)obj;
+	}
+	if(PyObject_TypeCheck(obj, &crn_matrix_type)){
+		struct CrunumExpr* crn_expr = crn_expr_alloc(obj, NULL);
+		if(crn_expr)
+			expr_matrix(&crn_expr->expr, ((struct CrunumMatrix*)obj)->matrix);
+		return crn_expr;
+	}
+	if(PyFloat_Check(obj) || PyLong_Check(obj)){
+		struct CrunumExpr* crn_expr = crn_expr_alloc(NULL, NULL);
+		if(crn_expr)
+			expr_scalar(&crn_expr->expr, PyFloat_AsDouble(obj));
+		return crn_expr;
+	}
+	return NULL;
+}
+
+static PyObject* crn_expr_binary(PyObject* left, PyObject* right, enum ExprOp op){
+	struct CrunumExpr* expr1 = crn_expr_from(left);
+	if(!expr1)
+		Py_RETURN_NOTIMPLEMENTED;
+	struct CrunumExpr* expr2 = crn_expr_from(right);
+	if(!expr2){
+		Py_DECREF(expr1);
+		Py_RETURN_NOTIMPLEMENTED;
+	}
+	struct CrunumExpr* result = crn_expr_alloc((PyObject*)expr1, (PyObject*)expr2);
+	Py_DECREF(expr1);
+	Py_DECREF(expr2);
+	if(!result)
+		return NULL;
+	if(!expr_binary(&result->expr, op, &expr1->expr, &expr2->expr)){
+		Py_DECREF(result);
+		PyErr_SetString(PyExc_ValueError, "Matrix size doesn't match another matrix size");
+		return NULL;
+	}
+	return (PyObject*)result;
+}
+
+static struct CrunumMatrix* crn_expr_eval_new(struct CrunumExpr* self){
+	if(self->expr.op == EXPR_SCALAR){
+		PyErr_SetString(PyExc_ValueError, "Expression doesn't contain any matrix");
+		return NULL;
+	}
+	struct Matrix* matrix = expr_eval(&self->expr);
+	if(!matrix){
+		PyErr_SetString(PyExc_ValueError, "Matrix size changed after the expression was built");
+		return NULL;
+	}
+	struct CrunumMatrix* result = crn_matrix_alloc();
+	if(!result){
+		matrix_free(matrix);
+		return NULL;
+	}
+	result->matrix = matrix;
+	return result;
+}
+
+static PyObject* crn_expr_materialize(PyObject* obj){
+	if(PyObject_TypeCheck(obj, &crn_expr_type))
+		return (PyObject*)crn_expr_eval_new((struct CrunumExpr*)obj);
+	Py_INCREF(obj);
+	return obj;
+}
+
+static PyObject* crn_expr_eval(struct CrunumExpr* self, PyObject* args, PyObject* kwargs){
+	PyObject* out = NULL;
+	static char* keywords[] = {"out", NULL};
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", keywords, &out))
+		return NULL;
+	if(!out || out == Py_None)
+		return (PyObject*)crn_expr_eval_new(self);
+	if(!PyObject_TypeCheck(out, &crn_matrix_type)){
+		PyErr_SetString(PyExc_TypeError, "out must be a matrix");
+		return NULL;
+	}
+	if(!expr_eval_into(((struct CrunumMatrix*)out)->matrix, &self->expr)){
+		PyErr_SetString(PyExc_ValueError, "out shape doesn't match result shape");
+		return NULL;
+	}
+	Py_INCREF(out);
+	return out;
+}
+
+static PyObject* crn_expr_add(PyObject* left, PyObject* right){
+	return crn_expr_binary(left, right, EXPR_ADD);
+}
+
+static PyObject* crn_expr_sub(PyObject* left, PyObject* right){
+	return crn_expr_binary(left, right, EXPR_SUB);
+}
+
+static PyObject* crn_expr_div(PyObject* left, PyObject* right){
+	return crn_expr_binary(left, right, EXPR_DIV);
+}
+
+/*
+ * Only scaling stays lazy, a product of two matrices is a GEMM so both
+ * sides are materialized and handed to the matrix multiplication.
+ */
+static PyObject* crn_expr_mul(PyObject* left, PyObject* right){
+	if(PyFloat_Check(left) || PyLong_Check(left) ||
+			PyFloat_Check(right) || PyLong_Check(right))
+		return crn_expr_binary(left, right, EXPR_MUL);
+	PyObject* operand1 = crn_expr_materialize(left);
+	if(!operand1)
+		return NULL;
+	PyObject* operand2 = crn_expr_materialize(right);
+	if(!operand2){
+		Py_DECREF(operand1);
+		return NULL;
+	}
+	PyObject* result = PyNumber_Multiply(operand1, operand2);
+	Py_DECREF(operand1);
+	Py_DECREF(operand2);
+	return result;
+}
+
+static void crn_expr_free(struct CrunumExpr* self){
+	Py_XDECREF(self->left);
+	Py_XDECREF(self->right);
+	Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static PyObject* crn_expr_str(PyObject* self){
+	struct CrunumMatrix* matrix = crn_expr_eval_new((struct CrunumExpr*)self);
+	if(!matrix)
+		return NULL;
+	PyObject* result = PyObject_Str((PyObject*)matrix);
+	Py_DECREF(matrix);
+	return result;
+}
+
+static PyObject* crn_expr_get_attro(PyObject* self, PyObject* attr_name){
+	struct CrunumExpr* crn_expr = (struct CrunumExpr*)self;
+	if(!PyUnicode_Check(attr_name)){
+		PyErr_SetString(PyExc_TypeError, "Attribute name isn't a string");
+		return NULL;
+	}
+	if(!PyUnicode_CompareWithASCIIString(attr_name, "rows"))
+		return PyLong_FromUnsignedLong((ulong)crn_expr->expr.rows);
+	if(!PyUnicode_CompareWithASCIIString(attr_name, "cols"))
+		return PyLong_FromUnsignedLong((ulong)crn_expr->expr.cols);
+	return PyObject_GenericGetAttr(self, attr_name);
+}
+
+PyObject* crn_expr_lazy(PyObject* self, PyObject* noargs){
+	(void)noargs;
+	if(!PyObject_TypeCheck(self, &crn_matrix_type)){
+		PyErr_SetString(PyExc_TypeError, "Expected a matrix");
+		return NULL;
+	}
+	return (PyObject*)crn_expr_from(self);
+}
+
+static PyMethodDef crn_expr_methods[] = {
+	{"eval", (PyCFunction)(void(*)(void))crn_expr_eval, METH_VARARGS | METH_KEYWORDS,
+		"Params: out(optional),\n"
+		"Return: Matrix,\n"
+		"Desc: Evaluate the expression in a single pass, writing into out when given\n"
+		"Example: ((mat_var.lazy() * 2 + mat_var2) / mat_var3).eval()"
+	},
+	{NULL, NULL, 0, NULL},
+};
+
+static PyNumberMethods crn_expr_as_number = {
+	.nb_add = crn_expr_add,
+	.nb_subtract = crn_expr_sub,
+	.nb_multiply = crn_expr_mul,
+	.nb_true_divide = crn_expr_div,
+};
+
+PyTypeObject crn_expr_type = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "crunum.matrix.Expr",
+	.tp_basicsize = sizeof(struct CrunumExpr),
+	.tp_itemsize = 0,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_dealloc = (destructor)crn_expr_free,
+	.tp_methods = crn_expr_methods,
+	.tp_str = crn_expr_str,
+	.tp_as_number = &crn_expr_as_number,
+	.tp_getattro = crn_expr_get_attro,
+};
@@ -0,0 +1,146 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#pragma message "Python LU"
+
+#include "python_bind.h"
+
+/*
+ * Solves for a matrix or a vector right-hand side, a vector is viewed as
+ * a single column matrix sharing its values.
+ */
+static PyObject* crn_lu_solve_rhs(struct LU* lu, PyObject* rhs){
+	if(PyObject_TypeCheck(rhs, &crn_matrix_type)){
+		struct Matrix* matrix = ((struct CrunumMatrix*)rhs)->matrix;
+		if(matrix->rows != lu->size){
+			PyErr_SetString(PyExc_ValueError, "Matrix row size doesn't match LU size");
+			return NULL;
+		}
+		struct CrunumMatrix* result = crn_matrix_alloc();
+		if(!result)
+			return NULL;
+		result->matrix = lu_solve(lu, matrix);
+		return (PyObject*)result;
+	}
+	if(PyObject_TypeCheck(rhs, &crn_vector_type)){
+		struct Vector* vector = ((struct CrunumVector*)rhs)->vector;
+		if(vector->len != lu->size){
+			PyErr_SetString(PyExc_ValueError, "Vector length doesn't match LU size");
+			return NULL;
+		}
+		struct CrunumVector* result = crn_vector_alloc();
+		if(!result)
+			return NULL;
+		result->vector = vector_new_dtype(vector->len, 0, dtype_promote(lu->dtype, vector->dtype));
+		struct Matrix src = {.values = vector->values, .rows = vector->len, .cols = 1, .ld = 1,
+			.dtype = vector->dtype};
+		struct Matrix dst = {.values = result->vector->values, .rows = vector->len, .cols = 1, .ld = 1,
+			.dtype = result->vector->dtype};
+		lu_solve_into(&dst, lu, &src);
+		return (PyObject*)result;
+	}
+	PyErr_SetString(PyExc_TypeError, "Expected a matrix or a vector");
+	return NULL;
+}
+
+static struct LU* crn_lu_factor(PyObject* obj){
+	if(!PyObject_TypeCheck(obj, &crn_matrix_type)){
+		PyErr_SetString(PyExc_TypeError, "Expected a matrix");
+		return NULL;
+	}
+	struct Matrix* matrix = ((struct CrunumMatrix*)obj)->matrix;
+	if(matrix->rows != matrix->cols){
+		PyErr_SetString(PyExc_ValueError, "Matrix isn't a square");
+		return NULL;
+	}
+	struct LU* lu = matrix_lu(matrix);
+	if(!lu){
+		PyErr_NoMemory();
+		return NULL;
+	}
+	if(lu->singular){
+		lu_free(lu);
+		PyErr_SetString(PyExc_ValueError, "Matrix is singular");
+		return NULL;
+	}
+	return lu;
+}
+
+PyObject* crn_matrix_lu(PyObject* self, PyObject* args){
+	(void)self;
+	PyObject* obj;
+	if(!PyArg_ParseTuple(args, "O", &obj))
+		return NULL;
+	struct LU* lu = crn_lu_factor(obj);
+	if(!lu)
+		return NULL;
+	struct CrunumLU* crn_lu = PyObject_New(struct CrunumLU, &crn_lu_type);
+	if(!crn_lu){
+		lu_free(lu);
+		return NULL;
+	}
+	crn_lu->lu = lu;
+	return (PyObject*)crn_lu;
+}
+
+PyObject* crn_matrix_solve(PyObject* self, PyObject* args){
+	(void)self;
+	PyObject* obj;
+	PyObject* rhs;
+	if(!PyArg_ParseTuple(args, "OO", &obj, &rhs))
+		return NULL;
+	struct LU* lu = crn_lu_factor(obj);
+	if(!lu)
+		return NULL;
+	PyObject* result = crn_lu_solve_rhs(lu, rhs);
+	lu_free(lu);
+	return result;
+}
+
+static PyObject* crn_lu_solve(struct CrunumLU* self, PyObject* args){
+	PyObject* rhs;
+	if(!PyArg_ParseTuple(args, "O", &rhs))
+		return NULL;
+	return crn_lu_solve_rhs(self->lu, rhs);
+}
+
+static void crn_lu_free(struct CrunumLU* self){
+	lu_free(self->lu);
+	Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static PyObject* crn_lu_get_attro(PyObject* self, PyObject* attr_name){
+	struct CrunumLU* crn_lu = (struct CrunumLU*)self;
+	if(!PyUnicode_Check(attr_name)){
+		PyErr_SetString(PyExc_TypeError, "Attribute name isn't a string");
+		return NULL;
+	}
+	if(!PyUnicode_CompareWithASCIIString(attr_name, "size"))
+		return PyLong_FromUnsignedLong((ulong)crn_lu->lu->size);
+	return PyObject_GenericGetAttr(self, attr_name);
+}
+
+static PyMethodDef crn_lu_methods[] = {
+	{"solve", (PyCFunction)crn_lu_solve, METH_VARARGS,
+		"Params: Matrix or Vector,\n"
+		"Return: Matrix or Vector,\n"
+		"Desc: Solve A * X = B with the factorization of A\n"
+		"Example: lu_var.solve(mat_var)"
+	},
+	{NULL, NULL, 0, NULL},
+};
+
+PyTypeObject crn_lu_type = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "crunum.matrix.LU",
+	.tp_basicsize = sizeof(struct CrunumLU),
+	.tp_itemsize = 0,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_dealloc = (destructor)crn_lu_free,
+	.tp_methods = crn_lu_methods,
+	.tp_getattro = crn_lu_get_attro,
+};
@@ -0,0 +1,110 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#pragma message "Python comparison mask"
+
+#include "python_bind.h"
+
+PyObject* crn_mask_wrap(struct Mask* mask){
+	if(!mask)
+		return PyErr_NoMemory();
+	struct CrunumMask* crn_mask = PyObject_New(struct CrunumMask, &crn_mask_type);
+	if(!crn_mask){
+		mask_free(mask);
+		return NULL;
+	}
+	crn_mask->mask = mask;
+	return (PyObject*)crn_mask;
+}
+
+static PyObject* crn_mask_count_nonzero(struct CrunumMask* self, PyObject* noargs){
+	(void)noargs;
+	return PyLong_FromUnsignedLong(mask_count_nonzero(self->mask));
+}
+
+static PyObject* crn_mask_tomatrix(struct CrunumMask* self, PyObject* noargs){
+	(void)noargs;
+	struct Matrix* matrix = mask_to_matrix(self->mask);
+	if(!matrix)
+		return PyErr_NoMemory();
+	struct CrunumMatrix* result = crn_matrix_alloc();
+	if(!result){
+		matrix_free(matrix);
+		return NULL;
+	}
+	result->matrix = matrix;
+	return (PyObject*)result;
+}
+
+/*
+ * mask[i, j], negative indices counting from the end.
+ */
+static PyObject* crn_mask_get(PyObject* self, PyObject* key){
+	struct Mask* mask = ((struct CrunumMask*)self)->mask;
+	Py_ssize_t i, j;
+	if(!PyTuple_Check(key) || !PyArg_ParseTuple(key, "nn", &i, &j)){
+		PyErr_SetString(PyExc_TypeError, "Mask index must be a pair of integers");
+		return NULL;
+	}
+	i += i < 0 ? mask->rows : 0;
+	j += j < 0 ? mask->cols : 0;
+	if(i < 0 || i >= (Py_ssize_t)mask->rows || j < 0 || j >= (Py_ssize_t)mask->cols){
+		PyErr_SetString(PyExc_IndexError, "Index out of range");
+		return NULL;
+	}
+	return PyBool_FromLong(mask_get(mask, (uint)i, (uint)j));
+}
+
+static void crn_mask_free(struct CrunumMask* self){
+	mask_free(self->mask);
+	Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static PyObject* crn_mask_get_attro(PyObject* self, PyObject* attr_name){
+	struct Mask* mask = ((struct CrunumMask*)self)->mask;
+	if(!PyUnicode_Check(attr_name)){
+		PyErr_SetString(PyExc_TypeError, "Attribute name isn't a string");
+		return NULL;
+	}
+	if(!PyUnicode_CompareWithASCIIString(attr_name, "rows"))
+		return PyLong_FromUnsignedLong((ulong)mask->rows);
+	if(!PyUnicode_CompareWithASCIIString(attr_name, "cols"))
+		return PyLong_FromUnsignedLong((ulong)mask->cols);
+	return PyObject_GenericGetAttr(self, attr_name);
+}
+
+static PyMethodDef crn_mask_methods[] = {
+	{"count_nonzero", (PyCFunction)crn_mask_count_nonzero, METH_NOARGS,
+		"Params: None,\n"
+		"Return: int,\n"
+		"Desc: Number of elements where the comparison held\n"
+		"Example: mask_var.count_nonzero()"
+	},
+	{"tomatrix", (PyCFunction)crn_mask_tomatrix, METH_NOARGS,
+		"Params: None,\n"
+		"Return: Matrix,\n"
+		"Desc: float32 matrix of 1 where the comparison held and 0 elsewhere\n"
+		"Example: mask_var.tomatrix()"
+	},
+	{NULL, NULL, 0, NULL},
+};
+
+static PyMappingMethods crn_mask_as_mapping = {
+	.mp_subscript = crn_mask_get,
+};
+
+PyTypeObject crn_mask_type = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "crunum.matrix.Mask",
+	.tp_basicsize = sizeof(struct CrunumMask),
+	.tp_itemsize = 0,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_dealloc = (destructor)crn_mask_free,
+	.tp_methods = crn_mask_methods,
+	.tp_as_mapping = &crn_mask_as_mapping,
+	.tp_getattro = crn_mask_get_attro,
+};
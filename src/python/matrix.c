@@ -9,36 +9,44 @@
 
 #include "python_bind.h"
 
-static struct CrunumMatrix* crn_matrix_new(PyObject* self, PyObject* args){
+static struct CrunumMatrix* crn_matrix_new(PyObject* self, PyObject* args, PyObject* kwargs){
 	(void)self;
 	uint rows, cols;
 	double value = 0;
-	static char* keywords = {"rows", "cols", "value", NULL};
-	if(!PyArg_ParseTupleAndKeywords(args, keywords, "II|d", &rows, &cols, &value))
+	enum Dtype dtype = DTYPE_F32;
+	static char* keywords[] = {"rows", "cols", "value", "dtype", NULL};
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "II|dO&", keywords, &rows, &cols, &value,
+				crn_dtype_converter, &dtype))
 		return NULL;
-	struct CrunumMatrix* crn_matrix = PyObject_New(struct CrunumMatrix, &crn_matrix_type);
+	struct CrunumMatrix* crn_matrix = crn_matrix_alloc();
 	if(!crn_matrix)
 		return NULL;
-	crn_matrix->matrix = matrix_new(rows, cols, (float)value);
+	crn_matrix->matrix = matrix_new_dtype(rows, cols, value, dtype);
 	return crn_matrix;
 }
 
-static struct CrunumMatrix* crn_matrix_randinit(PyObject* self, PyObject* args){
+static struct CrunumMatrix* crn_matrix_randinit(PyObject* self, PyObject* args, PyObject* kwargs){
 	(void)self;
 	uint rows, cols;
-	if(!PyArg_ParseTuple(args, "II", &rows, &cols))
+	enum Dtype dtype = DTYPE_F32;
+	static char* keywords[] = {"rows", "cols", "dtype", NULL};
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "II|O&", keywords, &rows, &cols,
+				crn_dtype_converter, &dtype))
 		return NULL;
-	struct CrunumMatrix* crn_matrix = PyObject_New(struct CrunumMatrix, &crn_matrix_type);
+	struct CrunumMatrix* crn_matrix = crn_matrix_alloc();
 	if(!crn_matrix)
 		return NULL;
-	crn_matrix->matrix = matrix_randinit(rows, cols);
+	crn_matrix->matrix = matrix_randinit_dtype(rows, cols, dtype);
 	return crn_matrix;
 }
 
-static struct CrunumMatrix* crn_matrix_from_list(PyObject* self, PyObject* args){
+static struct CrunumMatrix* crn_matrix_from_list(PyObject* self, PyObject* args, PyObject* kwargs){
 	(void)self;
 	PyObject* outer_list;
-	if(!PyArg_ParseTuple(args, "O", &outer_list))
+	enum Dtype dtype = DTYPE_F32;
+	static char* keywords[] = {"list", "dtype", NULL};
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O&", keywords, &outer_list,
+				crn_dtype_converter, &dtype))
 		return NULL;
 	if(!PyList_Check(outer_list)){
 		PyErr_SetString(PyExc_TypeError, "Expected a 2D list");
@@ -63,10 +71,10 @@ static struct CrunumMatrix* crn_matrix_from_list(PyObject* self, PyObject* args)
 			first = 0;
 		}
 	}
-	struct CrunumMatrix* crn_matrix = PyObject_New(struct CrunumMatrix, &crn_matrix_type);
+	struct CrunumMatrix* crn_matrix = crn_matrix_alloc();
 	if(!crn_matrix)
 		return NULL;
-	crn_matrix->matrix = matrix_new(rows, cols, 0);
+	crn_matrix->matrix = matrix_new_dtype(rows, cols, 0, dtype);
 	for(uint i = 0; i < rows; i++){
 		PyObject* inner_list = PyList_GetItem(outer_list, i);
 		for(uint j = 0; j < cols; j++){
@@ -77,26 +85,34 @@ static struct CrunumMatrix* crn_matrix_from_list(PyObject* self, PyObject* args)
 				PyObject_Del(crn_matrix);
 				return NULL;
 			}
-			matrix_set(crn_matrix->matrix, i, j, (float)PyFloat_AsDouble(item));
+			matrix_set(crn_matrix->matrix, i, j, PyFloat_AsDouble(item));
 		}
 	}
 	return crn_matrix;
 }
 
-static struct CrunumMatrix* crn_matrix_identity(PyObject* self, PyObject* args){
+static struct CrunumMatrix* crn_matrix_identity(PyObject* self, PyObject* args, PyObject* kwargs){
 	(void)self;
 	uint size;
-	if(!PyArg_ParseTuple(args, "I", &size))
+	enum Dtype dtype = DTYPE_F32;
+	static char* keywords[] = {"size", "dtype", NULL};
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "I|O&", keywords, &size,
+				crn_dtype_converter, &dtype))
 		return NULL;
-	struct CrunumMatrix* crn_matrix = PyObject_New(struct CrunumMatrix, &crn_matrix_type);
+	struct CrunumMatrix* crn_matrix = crn_matrix_alloc();
 	if(!crn_matrix)
 		return NULL;
-	crn_matrix->matrix = matrix_identity(size);
+	crn_matrix->matrix = matrix_identity_dtype(size, dtype);
 	return crn_matrix;
 }
 
 static void crn_matrix_free(struct CrunumMatrix* self){
-	matrix_free(self->matrix);
+	if(self->source){
+		PyMem_Free(self->matrix);
+		crn_buffer_free(self->source);
+	}
+	else
+		matrix_free(self->matrix);
 	Py_TYPE(self)->tp_free((PyObject*)self);
 }
 
@@ -108,13 +124,13 @@ static PyObject* crn_matrix_get(struct CrunumMatrix* self, PyObject* args){
 		PyErr_SetString(PyExc_IndexError, "Out of bound");
 		return NULL;
 	}
-	return PyFloat_FromDouble((double)*matrix_get(self->matrix, row, col));
+	return PyFloat_FromDouble(matrix_load(self->matrix, row, col));
 }
 
 static PyObject* crn_matrix_set(struct CrunumMatrix* self, PyObject* args){
 	uint row, col;
-	float value;
-	if(!PyArg_ParseTuple(args, "IIf", &row, &col, &value))
+	double value;
+	if(!PyArg_ParseTuple(args, "IId", &row, &col, &value))
 		return NULL;
 	if(row >= self->matrix->rows || col >= self->matrix->cols){
 		PyErr_SetString(PyExc_IndexError, "Out of bound");
@@ -134,11 +150,7 @@ static PyObject* crn_matrix_row(struct CrunumMatrix* self, PyObject* key){
 		PyErr_SetString(PyExc_IndexError, "Out of bound");
 		return NULL;
 	}
-	struct CrunumVector* crn_vector = PyObject_New(struct CrunumVector, &crn_vector_type);
-	if(!crn_vector)
-		return NULL;
-	crn_vector->vector = matrix_row(self->matrix, (uint)row);
-	return (PyObject*)crn_vector;
+	return crn_view_new(self, (uint)row, 0, 1, self->matrix->cols, 1);
 }
 
 static PyObject* crn_matrix_col(struct CrunumMatrix* self, PyObject* key){
@@ -151,11 +163,124 @@ static PyObject* crn_matrix_col(struct CrunumMatrix* self, PyObject* key){
 		PyErr_SetString(PyExc_IndexError, "Out of bound");
 		return NULL;
 	}
-	struct CrunumVector* crn_vector = PyObject_New(struct CrunumVector, &crn_vector_type);
-	if(!crn_vector)
+	return crn_view_new(self, 0, (uint)col, self->matrix->rows, 1, 1);
+}
+
+/*
+ * Reads one axis of a subscript, an integer selects a single row or col
+ * and a slice a contiguous range. Steps other than 1 aren't views.
+ */
+static int crn_matrix_axis(PyObject* key, uint size, uint* start, uint* len){
+	if(PyLong_Check(key)){
+		long index = PyLong_AsLong(key);
+		if(index < 0 || (ulong)index >= size){
+			PyErr_SetString(PyExc_IndexError, "Out of bound");
+			return -1;
+		}
+		*start = (uint)index;
+		*len = 1;
+		return 0;
+	}
+	if(PySlice_Check(key)){
+		Py_ssize_t begin, end, step, count;
+		if(PySlice_GetIndicesEx(key, size, &begin, &end, &step, &count) < 0)
+			return -1;
+		if(step != 1){
+			PyErr_SetString(PyExc_ValueError, "Slice step must be 1");
+			return -1;
+		}
+		*start = count ? (uint)begin : 0;
+		*len = (uint)count;
+		return 0;
+	}
+	PyErr_SetString(PyExc_TypeError, "Matrix indices must be integers or slices");
+	return -1;
+}
+
+/*
+ * m[i] is row i, m[i, j] an element, anything with a slice a view. A
+ * view with an integer on one axis is a vector, like row and col.
+ * Returns 1 for a single element, 0 for a view and -1 on error.
+ */
+static int crn_matrix_key(struct Matrix* matrix, PyObject* key,
+		uint* row, uint* col, uint* rows, uint* cols){
+	if(!PyTuple_Check(key)){
+		if(crn_matrix_axis(key, matrix->rows, row, rows) < 0)
+			return -1;
+		*col = 0;
+		*cols = matrix->cols;
+		return 0;
+	}
+	if(PyTuple_Size(key) != 2){
+		PyErr_SetString(PyExc_TypeError, "Matrix takes at most 2 indices");
+		return -1;
+	}
+	PyObject* key1 = PyTuple_GetItem(key, 0);
+	PyObject* key2 = PyTuple_GetItem(key, 1);
+	if(crn_matrix_axis(key1, matrix->rows, row, rows) < 0 ||
+			crn_matrix_axis(key2, matrix->cols, col, cols) < 0)
+		return -1;
+	return PyLong_Check(key1) && PyLong_Check(key2);
+}
+
+static PyObject* crn_matrix_subscript(PyObject* self, PyObject* key){
+	struct CrunumMatrix* crn_matrix = (struct CrunumMatrix*)self;
+	uint row, col, rows, cols;
+	int element = crn_matrix_key(crn_matrix->matrix, key, &row, &col, &rows, &cols);
+	if(element < 0)
 		return NULL;
-	crn_vector->vector = matrix_col(self->matrix, (uint)col);
-	return (PyObject*)crn_vector;
+	if(element)
+		return PyFloat_FromDouble(matrix_load(crn_matrix->matrix, row, col));
+	uint vector = PyTuple_Check(key) ? PyLong_Check(PyTuple_GetItem(key, 0)) ||
+		PyLong_Check(PyTuple_GetItem(key, 1)) : PyLong_Check(key);
+	return crn_view_new(crn_matrix, row, col, rows, cols, vector);
+}
+
+/*
+ * Slice assignment for dtypes views don't cover, through a float32 copy
+ * of the block written back once assigned.
+ */
+static int crn_matrix_assign_block(struct Matrix* matrix, uint row, uint col,
+		uint rows, uint cols, PyObject* value){
+	struct Matrix* block = matrix_block(matrix, row, col, rows, cols);
+	struct Matrix* scratch = block ? matrix_astype(block, DTYPE_F32) : NULL;
+	if(block)
+		matrix_free(block);
+	if(!scratch){
+		PyErr_NoMemory();
+		return -1;
+	}
+	struct View view;
+	view_matrix(&view, scratch);
+	int status = crn_view_assign_to(&view, value);
+	if(!status)
+		matrix_set_block(matrix, row, col, scratch);
+	matrix_free(scratch);
+	return status;
+}
+
+static int crn_matrix_ass_subscript(PyObject* self, PyObject* key, PyObject* value){
+	struct CrunumMatrix* crn_matrix = (struct CrunumMatrix*)self;
+	if(!value){
+		PyErr_SetString(PyExc_TypeError, "Matrix elements can't be deleted");
+		return -1;
+	}
+	uint row, col, rows, cols;
+	int element = crn_matrix_key(crn_matrix->matrix, key, &row, &col, &rows, &cols);
+	if(element < 0)
+		return -1;
+	if(element){
+		if(!PyFloat_Check(value) && !PyLong_Check(value)){
+			PyErr_SetString(PyExc_TypeError, "Value must be float or integer");
+			return -1;
+		}
+		matrix_set(crn_matrix->matrix, row, col, PyFloat_AsDouble(value));
+		return 0;
+	}
+	struct View view;
+	if(view_block(&view, crn_matrix->matrix, row, col, rows, cols))
+		return crn_view_assign_to(&view, value);
+	return crn_matrix_assign_block(crn_matrix->matrix, row, col, rows, cols, value);
 }
 
 static PyObject* crn_matrix_get_attro(PyObject* self, PyObject* attr_name){
@@ -168,17 +293,36 @@ static PyObject* crn_matrix_get_attro(PyObject* self, PyObject* attr_name){
 		return PyLong_FromUnsignedLong((ulong)crn_matrix->matrix->rows);
 	if(!PyUnicode_CompareWithASCIIString(attr_name, "cols"))
 		return PyLong_FromUnsignedLong((ulong)crn_matrix->matrix->cols);
+	if(!PyUnicode_CompareWithASCIIString(attr_name, "dtype"))
+		return crn_dtype_name(crn_matrix->matrix->dtype);
 	return PyObject_GenericGetAttr(self, attr_name);
 }
 
 static PyObject* crn_matrix_transpose(struct CrunumMatrix* self, PyObject* noargs){
 	(void)noargs;
-	struct CrunumMatrix* result = PyObject_New(struct CrunumMatrix, &crn_vector_type);
+	if(self->matrix->dtype == DTYPE_F32)
+		return crn_view_transpose((PyObject*)self);
+	struct CrunumMatrix* result = crn_matrix_alloc();
+	if(!result)
+		return NULL;
 	result->matrix = matrix_transpose(self->matrix);
 	return (PyObject*)result;
 }
 
+static struct CrunumMatrix* crn_matrix_astype(struct CrunumMatrix* self, PyObject* args){
+	enum Dtype dtype;
+	if(!PyArg_ParseTuple(args, "O&", crn_dtype_converter, &dtype))
+		return NULL;
+	struct CrunumMatrix* result = crn_matrix_alloc();
+	if(!result)
+		return NULL;
+	result->matrix = matrix_astype(self->matrix, dtype);
+	return result;
+}
+
 static PyObject* crn_matrix_reshape(struct CrunumMatrix* self, PyObject* args){
+	if(crn_matrix_pinned(self))
+		return NULL;
 	uint new_rows, new_cols;
 	if(!PyArg_ParseTuple(args, "II", &new_rows, &new_cols))
 		return NULL;
@@ -202,14 +346,202 @@ static struct CrunumMatrix* crn_matrix_inverse(struct CrunumMatrix* self, PyObje
 		PyErr_SetString(PyExc_ValueError, "Matrix can't be inversed");
 		return NULL;
 	}
-	struct CrunumMatrix* result = PyObject_New(struct CrunumMatrix, &crn_matrix_type);
+	struct CrunumMatrix* result = crn_matrix_alloc();
 	if(!result)
 		return NULL;
 	result->matrix = temp;
 	return result;
 }
 
+static PyObject* crn_matrix_det(struct CrunumMatrix* self, PyObject* noargs){
+	(void)noargs;
+	if(self->matrix->rows != self->matrix->cols){
+		PyErr_SetString(PyExc_ValueError, "Matrix isn't a square");
+		return NULL;
+	}
+	double det;
+	if(!matrix_det(self->matrix, &det))
+		return PyErr_NoMemory();
+	return PyFloat_FromDouble(det);
+}
+
+/*
+ * Over the whole matrix when axis is None, otherwise one value per
+ * column (axis 0) or per row (axis 1) like NumPy. argmin and argmax over
+ * the whole matrix give a row major index.
+ */
+static PyObject* crn_matrix_reduce(struct CrunumMatrix* self, PyObject* axis, enum Reduce op){
+	struct Matrix* matrix = self->matrix;
+	uint arg = op == REDUCE_ARGMIN || op == REDUCE_ARGMAX;
+	if(!axis || axis == Py_None){
+		if((arg || op == REDUCE_MIN || op == REDUCE_MAX) && (!matrix->rows || !matrix->cols)){
+			PyErr_SetString(PyExc_ValueError, "Empty matrix");
+			return NULL;
+		}
+		double value = matrix_reduce(matrix, op);
+		if(arg)
+			return PyLong_FromUnsignedLong((ulong)value);
+		return PyFloat_FromDouble(value);
+	}
+	long index = PyLong_AsLong(axis);
+	if(index == -1 && PyErr_Occurred())
+		return NULL;
+	if(index < 0)
+		index += 2;
+	if(index != 0 && index != 1){
+		PyErr_SetString(PyExc_ValueError, "axis must be 0, 1 or None");
+		return NULL;
+	}
+	struct CrunumVector* result = crn_vector_alloc();
+	if(!result)
+		return NULL;
+	result->vector = index ? matrix_reduce_rows(matrix, op) : matrix_reduce_cols(matrix, op);
+	return (PyObject*)result;
+}
+
+static PyObject* crn_matrix_reduce_axis(struct CrunumMatrix* self,
+		PyObject* args, PyObject* kwargs, enum Reduce op){
+	PyObject* axis = NULL;
+	static char* keywords[] = {"axis", NULL};
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", keywords, &axis))
+		return NULL;
+	return crn_matrix_reduce(self, axis, op);
+}
+
+static PyObject* crn_matrix_sum(struct CrunumMatrix* self, PyObject* args, PyObject* kwargs){
+	return crn_matrix_reduce_axis(self, args, kwargs, REDUCE_SUM);
+}
+
+static PyObject* crn_matrix_mean(struct CrunumMatrix* self, PyObject* args, PyObject* kwargs){
+	return crn_matrix_reduce_axis(self, args, kwargs, REDUCE_MEAN);
+}
+
+static PyObject* crn_matrix_min(struct CrunumMatrix* self, PyObject* args, PyObject* kwargs){
+	return crn_matrix_reduce_axis(self, args, kwargs, REDUCE_MIN);
+}
+
+static PyObject* crn_matrix_max(struct CrunumMatrix* self, PyObject* args, PyObject* kwargs){
+	return crn_matrix_reduce_axis(self, args, kwargs, REDUCE_MAX);
+}
+
+static PyObject* crn_matrix_argmin(struct CrunumMatrix* self, PyObject* args, PyObject* kwargs){
+	return crn_matrix_reduce_axis(self, args, kwargs, REDUCE_ARGMIN);
+}
+
+static PyObject* crn_matrix_argmax(struct CrunumMatrix* self, PyObject* args, PyObject* kwargs){
+	return crn_matrix_reduce_axis(self, args, kwargs, REDUCE_ARGMAX);
+}
+
+static PyObject* crn_matrix_norm(struct CrunumMatrix* self, PyObject* args, PyObject* kwargs){
+	double ord = 2;
+	PyObject* axis = NULL;
+	static char* keywords[] = {"ord", "axis", NULL};
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "|dO", keywords, &ord, &axis))
+		return NULL;
+	if(ord == 1)
+		return crn_matrix_reduce(self, axis, REDUCE_NORM1);
+	if(ord == 2)
+		return crn_matrix_reduce(self, axis, REDUCE_NORM2);
+	if(ord == HUGE_VAL)
+		return crn_matrix_reduce(self, axis, REDUCE_NORM_INF);
+	PyErr_SetString(PyExc_ValueError, "ord must be 1, 2 or inf");
+	return NULL;
+}
+
+static PyObject* crn_matrix_map(struct CrunumMatrix* self, PyObject* args, PyObject* kwargs){
+	enum MapFn fn;
+	double param1, param2;
+	PyObject* out;
+	if(!crn_map_parse(args, kwargs, &fn, &param1, &param2, &out))
+		return NULL;
+	if(!out || out == Py_None){
+		struct CrunumMatrix* result = crn_matrix_alloc();
+		if(!result)
+			return NULL;
+		result->matrix = matrix_map(self->matrix, fn, param1, param2);
+		return (PyObject*)result;
+	}
+	if(!PyObject_TypeCheck(out, &crn_matrix_type)){
+		PyErr_SetString(PyExc_TypeError, "out must be a matrix");
+		return NULL;
+	}
+	if(!matrix_map_into(((struct CrunumMatrix*)out)->matrix, self->matrix, fn, param1, param2)){
+		PyErr_SetString(PyExc_ValueError, "out shape doesn't match result shape");
+		return NULL;
+	}
+	Py_INCREF(out);
+	return out;
+}
+
+/*
+ * Mask of where self op other holds elementwise, other being a matrix of
+ * the same shape or a number.
+ */
+static PyObject* crn_matrix_mask(struct CrunumMatrix* self, PyObject* other,
+		struct Mask* (*compare)(struct Matrix*, struct Matrix*),
+		struct Mask* (*compare_scalar)(struct Matrix*, double)){
+	if(PyFloat_Check(other) || PyLong_Check(other)){
+		double scalar = PyFloat_AsDouble(other);
+		if(scalar == -1 && PyErr_Occurred())
+			return NULL;
+		return crn_mask_wrap(compare_scalar(self->matrix, scalar));
+	}
+	if(!PyObject_TypeCheck(other, &crn_matrix_type)){
+		PyErr_SetString(PyExc_TypeError, "Expected a matrix or a number");
+		return NULL;
+	}
+	struct Matrix* matrix2 = ((struct CrunumMatrix*)other)->matrix;
+	if(self->matrix->rows != matrix2->rows ||
+			self->matrix->cols != matrix2->cols){
+		PyErr_SetString(PyExc_ValueError, "Matrix shape doesn't match another matrix shape");
+		return NULL;
+	}
+	return crn_mask_wrap(compare(self->matrix, matrix2));
+}
+
+static PyObject* crn_matrix_eq_mask(struct CrunumMatrix* self, PyObject* other){
+	return crn_matrix_mask(self, other, matrix_eq_mask, matrix_eq_scalar_mask);
+}
+
+static PyObject* crn_matrix_neq_mask(struct CrunumMatrix* self, PyObject* other){
+	return crn_matrix_mask(self, other, matrix_neq_mask, matrix_neq_scalar_mask);
+}
+
+static PyObject* crn_matrix_gt_mask(struct CrunumMatrix* self, PyObject* other){
+	return crn_matrix_mask(self, other, matrix_gt_mask, matrix_gt_scalar_mask);
+}
+
+static PyObject* crn_matrix_ge_mask(struct CrunumMatrix* self, PyObject* other){
+	return crn_matrix_mask(self, other, matrix_ge_mask, matrix_ge_scalar_mask);
+}
+
+static PyObject* crn_matrix_lt_mask(struct CrunumMatrix* self, PyObject* other){
+	return crn_matrix_mask(self, other, matrix_lt_mask, matrix_lt_scalar_mask);
+}
+
+static PyObject* crn_matrix_le_mask(struct CrunumMatrix* self, PyObject* other){
+	return crn_matrix_mask(self, other, matrix_le_mask, matrix_le_scalar_mask);
+}
+
+static PyObject* crn_matrix_allclose(struct CrunumMatrix* self, PyObject* args, PyObject* kwargs){
+	PyObject* other;
+	double rtol = 1e-5, atol = 1e-8;
+	static char* keywords[] = {"other", "rtol", "atol", NULL};
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "O!|dd", keywords,
+				&crn_matrix_type, &other, &rtol, &atol))
+		return NULL;
+	struct Matrix* matrix2 = ((struct CrunumMatrix*)other)->matrix;
+	if(self->matrix->rows != matrix2->rows ||
+			self->matrix->cols != matrix2->cols){
+		PyErr_SetString(PyExc_ValueError, "Matrix shape doesn't match another matrix shape");
+		return NULL;
+	}
+	return PyBool_FromLong(matrix_allclose(self->matrix, matrix2, rtol, atol));
+}
+
 static PyObject* crn_matrix_push_row(struct CrunumMatrix* self, PyObject* args){
+	if(crn_matrix_pinned(self))
+		return NULL;
 	PyObject* obj;
 	if(!PyArg_ParseTuple(args, "O", &obj))
 		return NULL;
@@ -220,44 +552,57 @@ static PyObject* crn_matrix_push_row(struct CrunumMatrix* self, PyObject* args){
 	struct CrunumVector* crn_vector = (struct CrunumVector*)obj;
 	self->matrix->cols = self->matrix->cols ? 
 		self->matrix->cols : crn_vector->vector->len;
-	self->matrix->cols_cap = self->matrix->cols_cap ? 
-		self->matrix->cols_cap : crn_vector->vector->len;
 	if(self->matrix->cols != crn_vector->vector->len){
 		PyErr_SetString(PyExc_ValueError, 
 				"Matrix col size doesn't match vector length");
+		return NULL;
 	}
 	matrix_push_row(self->matrix, crn_vector->vector);
 	Py_RETURN_NONE;
 }
 
 static PyObject* crn_matrix_push_col(struct CrunumMatrix* self, PyObject* args){
+	if(crn_matrix_pinned(self))
+		return NULL;
 	PyObject* obj;
 	if(!PyArg_ParseTuple(args, "O", &obj))
 		return NULL;
-	if(!PyObject_TypeCheck(obj, &crn_matrix_type)){
+	if(!PyObject_TypeCheck(obj, &crn_vector_type)){
 		PyErr_SetString(PyExc_TypeError, "Expected a vector");
 		return NULL;
 	}
 	struct CrunumVector* crn_vector = (struct CrunumVector*)obj;
 	self->matrix->rows = self->matrix->rows ? 
 		self->matrix->rows : crn_vector->vector->len;
-	self->matrix->rows_cap = self->matrix->rows_cap ? 
-		self->matrix->rows_cap : crn_vector->vector->len;
 	if(self->matrix->rows != crn_vector->vector->len){
 		PyErr_SetString(PyExc_ValueError, 
 				"Matrix row size doesn't match vector length");
+		return NULL;
 	}
 	matrix_push_col(self->matrix, crn_vector->vector);
 	Py_RETURN_NONE;
 }
 
+static PyObject* crn_matrix_reserve(struct CrunumMatrix* self, PyObject* args){
+	if(crn_matrix_pinned(self))
+		return NULL;
+	uint rows, cols;
+	if(!PyArg_ParseTuple(args, "II", &rows, &cols))
+		return NULL;
+	if(!matrix_reserve(self->matrix, rows, cols))
+		return PyErr_NoMemory();
+	Py_RETURN_NONE;
+}
+
 static PyObject* crn_matrix_pop_row(struct CrunumMatrix* self, PyObject* noargs){
 	(void)noargs;
+	if(crn_matrix_pinned(self))
+		return NULL;
 	if(!self->matrix->rows){
 		PyErr_SetString(PyExc_ValueError, "Empty matrix");
 		return NULL;
 	}
-	struct CrunumVector* crn_vector = PyObject_New(struct CrunumVector, &crn_vector_type);
+	struct CrunumVector* crn_vector = crn_vector_alloc();
 	if(!crn_vector)
 		return NULL;
 	crn_vector->vector = matrix_pop_row(self->matrix);
@@ -266,11 +611,13 @@ static PyObject* crn_matrix_pop_row(struct CrunumMatrix* self, PyObject* noargs)
 
 static PyObject* crn_matrix_pop_col(struct CrunumMatrix* self, PyObject* noargs){
 	(void)noargs;
+	if(crn_matrix_pinned(self))
+		return NULL;
 	if(!self->matrix->cols){
 		PyErr_SetString(PyExc_ValueError, "Empty matrix");
 		return NULL;
 	}
-	struct CrunumVector* crn_vector = PyObject_New(struct CrunumVector, &crn_vector_type);
+	struct CrunumVector* crn_vector = crn_vector_alloc();
 	if(!crn_vector)
 		return NULL;
 	crn_vector->vector = matrix_pop_col(self->matrix);
@@ -284,7 +631,7 @@ static PyObject* crn_matrix_str(PyObject* self){
 		PyUnicode_Append(&result, PyUnicode_FromString("\n  ["));
 		for(uint j = 0; j < matrix->cols; j++){
 			char num[16];
-			snprintf(num, sizeof(num), "%.2lf", *matrix_get(matrix, i, j));
+			snprintf(num, sizeof(num), "%.2lf", matrix_load(matrix, i, j));
 			PyUnicode_Append(&result, PyUnicode_FromString(num));
 			if(j != matrix->cols - 1)
 				PyUnicode_Append(&result, PyUnicode_FromString(", "));
@@ -301,9 +648,9 @@ static PyObject* crn_matrix_str(PyObject* self){
 
 static PyObject* crn_matrix_add(PyObject* left, PyObject* right){
 	if(PyFloat_Check(left) || PyLong_Check(left)){
-		float scalar = (float)PyFloat_AsDouble(left);
+		double scalar = PyFloat_AsDouble(left);
 		struct Matrix* matrix = ((struct CrunumMatrix*)right)->matrix;
-		struct CrunumMatrix* result = PyObject_New(struct CrunumMatrix, &crn_matrix_type);
+		struct CrunumMatrix* result = crn_matrix_alloc();
 		result->matrix = matrix_add_scalar(matrix, scalar);
 		return (PyObject*)result;
 	}
@@ -316,13 +663,13 @@ static PyObject* crn_matrix_add(PyObject* left, PyObject* right){
 			PyErr_SetString(PyExc_ValueError, "Matrix size doesn't match another matrix size");
 			return NULL;
 		}
-		struct CrunumMatrix* result = PyObject_New(struct CrunumMatrix, &crn_matrix_type);
+		struct CrunumMatrix* result = crn_matrix_alloc();
 		result->matrix = matrix_add(matrix1, matrix2);
 		return (PyObject*)result;
 	}
 	if(PyFloat_Check(right) || PyLong_Check(right)){
-		float scalar = (float)PyFloat_AsDouble(right);
-		struct CrunumMatrix* result = PyObject_New(struct CrunumMatrix, &crn_matrix_type);
+		double scalar = PyFloat_AsDouble(right);
+		struct CrunumMatrix* result = crn_matrix_alloc();
 		result->matrix = matrix_add_scalar(matrix1, scalar);
 		return (PyObject*)result;
 	}
@@ -331,9 +678,9 @@ static PyObject* crn_matrix_add(PyObject* left, PyObject* right){
 
 static PyObject* crn_matrix_sub(PyObject* left, PyObject* right){
 	if(PyFloat_Check(left) || PyLong_Check(left)){
-		float scalar = (float)PyFloat_AsDouble(left);
+		double scalar = PyFloat_AsDouble(left);
 		struct Matrix* matrix = ((struct CrunumMatrix*)right)->matrix;
-		struct CrunumMatrix* result = PyObject_New(struct CrunumMatrix, &crn_matrix_type);
+		struct CrunumMatrix* result = crn_matrix_alloc();
 		result->matrix = scalar_sub_matrix(scalar, matrix);
 		return (PyObject*)result;
 	}
@@ -346,13 +693,13 @@ static PyObject* crn_matrix_sub(PyObject* left, PyObject* right){
 			PyErr_SetString(PyExc_ValueError, "Matrix size doesn't match another matrix size");
 			return NULL;
 		}
-		struct CrunumMatrix* result = PyObject_New(struct CrunumMatrix, &crn_matrix_type);
+		struct CrunumMatrix* result = crn_matrix_alloc();
 		result->matrix = matrix_sub(matrix1, matrix2);
 		return (PyObject*)result;
 	}
 	if(PyFloat_Check(right) || PyLong_Check(right)){
-		float scalar = (float)PyFloat_AsDouble(right);
-		struct CrunumMatrix* result = PyObject_New(struct CrunumMatrix, &crn_matrix_type);
+		double scalar = PyFloat_AsDouble(right);
+		struct CrunumMatrix* result = crn_matrix_alloc();
 		result->matrix = matrix_sub_scalar(matrix1, scalar);
 		return (PyObject*)result;
 	}
@@ -361,9 +708,9 @@ static PyObject* crn_matrix_sub(PyObject* left, PyObject* right){
 
 static PyObject* crn_matrix_mul(PyObject* left, PyObject* right){
 	if(PyFloat_Check(left) || PyLong_Check(left)){
-		float scalar = (float)PyFloat_AsDouble(left);
+		double scalar = PyFloat_AsDouble(left);
 		struct Matrix* matrix = ((struct CrunumMatrix*)right)->matrix;
-		struct CrunumMatrix* result = PyObject_New(struct CrunumMatrix, &crn_matrix_type);
+		struct CrunumMatrix* result = crn_matrix_alloc();
 		result->matrix = matrix_mul_scalar(matrix, scalar);
 		return (PyObject*)result;
 	}
@@ -376,7 +723,7 @@ static PyObject* crn_matrix_mul(PyObject* left, PyObject* right){
 			PyErr_SetString(PyExc_ValueError, "Matrix col size doesn't match another matrix row size");
 			return NULL;
 		}
-		struct CrunumMatrix* result = PyObject_New(struct CrunumMatrix, &crn_matrix_type);
+		struct CrunumMatrix* result = crn_matrix_alloc();
 		result->matrix = matrix_mul(matrix1, matrix2);
 		return (PyObject*)result;
 	}
@@ -386,13 +733,13 @@ static PyObject* crn_matrix_mul(PyObject* left, PyObject* right){
 			PyErr_SetString(PyExc_ValueError, "Matrix col size doesn't match vector length");
 			return NULL;
 		}
-		struct CrunumVector* result = PyObject_New(struct CrunumVector, &crn_vector_type);
+		struct CrunumVector* result = crn_vector_alloc();
 		result->vector = matrix_mul_vector(matrix1, vector);
 		return (PyObject*)result;
 	}
 	if(PyFloat_Check(right) || PyLong_Check(right)){
-		float scalar = (float)PyFloat_AsDouble(right);
-		struct CrunumMatrix* result = PyObject_New(struct CrunumMatrix, &crn_matrix_type);
+		double scalar = PyFloat_AsDouble(right);
+		struct CrunumMatrix* result = crn_matrix_alloc();
 		result->matrix = matrix_mul_scalar(matrix1, scalar);
 		return (PyObject*)result;
 	}
@@ -401,9 +748,9 @@ static PyObject* crn_matrix_mul(PyObject* left, PyObject* right){
 
 static PyObject* crn_matrix_div(PyObject* left, PyObject* right){
 	if(PyFloat_Check(left) || PyLong_Check(left)){
-		float scalar = (float)PyFloat_AsDouble(left);
+		double scalar = PyFloat_AsDouble(left);
 		struct Matrix* matrix = ((struct CrunumMatrix*)right)->matrix;
-		struct CrunumMatrix* result = PyObject_New(struct CrunumMatrix, &crn_matrix_type);
+		struct CrunumMatrix* result = crn_matrix_alloc();
 		result->matrix = scalar_div_matrix(scalar, matrix);
 		return (PyObject*)result;
 	}
@@ -416,13 +763,13 @@ static PyObject* crn_matrix_div(PyObject* left, PyObject* right){
 			PyErr_SetString(PyExc_ValueError, "Matrix size doesn't match another matrix size");
 			return NULL;
 		}
-		struct CrunumMatrix* result = PyObject_New(struct CrunumMatrix, &crn_matrix_type);
+		struct CrunumMatrix* result = crn_matrix_alloc();
 		result->matrix = matrix_div(matrix1, matrix2);
 		return (PyObject*)result;
 	}
 	if(PyFloat_Check(right) || PyLong_Check(right)){
-		float scalar = (float)PyFloat_AsDouble(right);
-		struct CrunumMatrix* result = PyObject_New(struct CrunumMatrix, &crn_matrix_type);
+		double scalar = PyFloat_AsDouble(right);
+		struct CrunumMatrix* result = crn_matrix_alloc();
 		result->matrix = matrix_div_scalar(matrix1, scalar);
 		return (PyObject*)result;
 	}
@@ -439,21 +786,137 @@ static PyObject* crn_matrix_pow(PyObject* base, PyObject* exp, PyObject* mod){
 		PyErr_SetString(PyExc_ValueError, "Matrix isn't a square");
 		return NULL;
 	}
-	float scalar = (float)PyFloat_AsDouble(exp);
-	struct CrunumMatrix* result = PyObject_New(struct CrunumMatrix, &crn_matrix_type);
 	uint invertible;
-	result->matrix = matrix_pow(matrix, scalar, &invertible);
+	struct Matrix* temp = matrix_pow(matrix, (int)PyFloat_AsDouble(exp), &invertible);
 	if(!invertible){
 		PyErr_SetString(PyExc_ValueError, "Matrix can't be inversed");
 		return NULL;
 	}
+	struct CrunumMatrix* result = crn_matrix_alloc();
+	if(!result){
+		matrix_free(temp);
+		return NULL;
+	}
+	result->matrix = temp;
 	return (PyObject*)result;
 }
 
+static PyObject* crn_matrix_elementwise_out(struct CrunumMatrix* self,
+		PyObject* args, PyObject* kwargs, binaryfunc op,
+		struct Matrix* (*into)(struct Matrix*, struct Matrix*, struct Matrix*),
+		struct Matrix* (*scalar_into)(struct Matrix*, struct Matrix*, double)){
+	PyObject* other;
+	PyObject* out = NULL;
+	static char* keywords[] = {"other", "out", NULL};
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", keywords, &other, &out))
+		return NULL;
+	if(!out || out == Py_None)
+		return op((PyObject*)self, other);
+	if(!PyObject_TypeCheck(out, &crn_matrix_type)){
+		PyErr_SetString(PyExc_TypeError, "out must be a matrix");
+		return NULL;
+	}
+	struct Matrix* dst = ((struct CrunumMatrix*)out)->matrix;
+	struct Matrix* matrix1 = self->matrix;
+	struct Matrix* result;
+	if(PyObject_TypeCheck(other, &crn_matrix_type)){
+		struct Matrix* matrix2 = ((struct CrunumMatrix*)other)->matrix;
+		if(matrix1->rows * matrix1->cols != matrix2->rows * matrix2->cols){
+			PyErr_SetString(PyExc_ValueError, "Matrix size doesn't match another matrix size");
+			return NULL;
+		}
+		result = into(dst, matrix1, matrix2);
+	}
+	else if(PyFloat_Check(other) || PyLong_Check(other))
+		result = scalar_into(dst, matrix1, PyFloat_AsDouble(other));
+	else
+		Py_RETURN_NOTIMPLEMENTED;
+	if(!result){
+		PyErr_SetString(PyExc_ValueError, "out shape doesn't match result shape");
+		return NULL;
+	}
+	Py_INCREF(out);
+	return out;
+}
+
+static PyObject* crn_matrix_add_out(struct CrunumMatrix* self,
+		PyObject* args, PyObject* kwargs){
+	return crn_matrix_elementwise_out(self, args, kwargs, crn_matrix_add,
+			matrix_add_into, matrix_add_scalar_into);
+}
+
+static PyObject* crn_matrix_sub_out(struct CrunumMatrix* self,
+		PyObject* args, PyObject* kwargs){
+	return crn_matrix_elementwise_out(self, args, kwargs, crn_matrix_sub,
+			matrix_sub_into, matrix_sub_scalar_into);
+}
+
+static PyObject* crn_matrix_div_out(struct CrunumMatrix* self,
+		PyObject* args, PyObject* kwargs){
+	return crn_matrix_elementwise_out(self, args, kwargs, crn_matrix_div,
+			matrix_div_into, matrix_div_scalar_into);
+}
+
+static PyObject* crn_matrix_mul_out(struct CrunumMatrix* self,
+		PyObject* args, PyObject* kwargs){
+	PyObject* other;
+	PyObject* out = NULL;
+	static char* keywords[] = {"other", "out", NULL};
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", keywords, &other, &out))
+		return NULL;
+	if(!out || out == Py_None)
+		return crn_matrix_mul((PyObject*)self, other);
+	struct Matrix* matrix1 = self->matrix;
+	uint done;
+	if(PyObject_TypeCheck(other, &crn_matrix_type)){
+		struct Matrix* matrix2 = ((struct CrunumMatrix*)other)->matrix;
+		if(matrix1->cols != matrix2->rows){
+			PyErr_SetString(PyExc_ValueError, "Matrix col size doesn't match another matrix row size");
+			return NULL;
+		}
+		if(!PyObject_TypeCheck(out, &crn_matrix_type)){
+			PyErr_SetString(PyExc_TypeError, "out must be a matrix");
+			return NULL;
+		}
+		done = matrix_mul_into(((struct CrunumMatrix*)out)->matrix,
+				matrix1, matrix2) != NULL;
+	}
+	else if(PyObject_TypeCheck(other, &crn_vector_type)){
+		struct Vector* vector = ((struct CrunumVector*)other)->vector;
+		if(matrix1->cols != vector->len){
+			PyErr_SetString(PyExc_ValueError, "Matrix col size doesn't match vector length");
+			return NULL;
+		}
+		if(!PyObject_TypeCheck(out, &crn_vector_type)){
+			PyErr_SetString(PyExc_TypeError, "out must be a vector");
+			return NULL;
+		}
+		done = matrix_mul_vector_into(((struct CrunumVector*)out)->vector,
+				matrix1, vector) != NULL;
+	}
+	else if(PyFloat_Check(other) || PyLong_Check(other)){
+		if(!PyObject_TypeCheck(out, &crn_matrix_type)){
+			PyErr_SetString(PyExc_TypeError, "out must be a matrix");
+			return NULL;
+		}
+		done = matrix_mul_scalar_into(((struct CrunumMatrix*)out)->matrix,
+				matrix1, PyFloat_AsDouble(other)) != NULL;
+	}
+	else
+		Py_RETURN_NOTIMPLEMENTED;
+	if(!done){
+		PyErr_SetString(PyExc_ValueError,
+				"out shape doesn't match result shape or aliases an operand");
+		return NULL;
+	}
+	Py_INCREF(out);
+	return out;
+}
+
 static PyObject* crn_matrix_compare(PyObject* left, PyObject* right, int op){
 	uint cmp_result;
 	if(PyFloat_Check(left) || PyLong_Check(left)){
-		float scalar = (float)PyFloat_AsDouble(left);
+		double scalar = PyFloat_AsDouble(left);
 		struct Matrix* matrix = ((struct CrunumMatrix*)right)->matrix;
 		switch(op){
 			case Py_EQ:
@@ -515,7 +978,7 @@ static PyObject* crn_matrix_compare(PyObject* left, PyObject* right, int op){
 		Py_RETURN_FALSE;
 	}
 	if(PyFloat_Check(right) || PyLong_Check(right)){
-		float scalar = (float)PyFloat_AsDouble(right);
+		double scalar = PyFloat_AsDouble(right);
 		switch(op){
 			case Py_EQ:
 				cmp_result = matrix_eq_scalar(matrix1, scalar);
@@ -546,26 +1009,42 @@ static PyObject* crn_matrix_compare(PyObject* left, PyObject* right, int op){
 }
 
 PyMethodDef crn_matrix_methods[] = {
-	{"new", (PyCFunction)crn_matrix_new, METH_VARARGS,
-		"Params: rows, cols, value(optional),\n"
+	{"new", (PyCFunction)(void(*)(void))crn_matrix_new, METH_VARARGS | METH_KEYWORDS,
+		"Params: rows, cols, value(optional), dtype(optional),\n"
 		"Return: Matrix,\n"
-		"Desc: Create a new matrix with initialized value(default=0)\n"
-		"Example: crn.matrix.new(10, 10, value=2.3)"
+		"Desc: Create a new matrix with initialized value(default=0) and\n"
+		"dtype 'float32'(default), 'float64', 'float16' or 'bfloat16'\n"
+		"Example: crn.matrix.new(10, 10, value=2.3, dtype='float64')"
 	},
-	{"randinit", (PyCFunction)crn_matrix_randinit, METH_VARARGS,
-		"Params: rows, cols,\n"
+	{"randinit", (PyCFunction)(void(*)(void))crn_matrix_randinit, METH_VARARGS | METH_KEYWORDS,
+		"Params: rows, cols, dtype(optional),\n"
 		"Return: Matrix,\n"
 		"Desc: Create a new randomized matrix with range 0-1\n"
 		"Example: crn.matrix.randinit(2, 10)"
 	},
-	{"from_list", (PyCFunction)crn_matrix_from_list, METH_VARARGS,
-		"Params: 2d list,\n"
+	{"from_list", (PyCFunction)(void(*)(void))crn_matrix_from_list, METH_VARARGS | METH_KEYWORDS,
+		"Params: 2d list, dtype(optional),\n"
 		"Return: Matrix,\n"
 		"Desc: Create a new matrix based of the 2d list given by the user\n"
 		"Example: crn.matrix.from_list([[2, 2]])"
 	},
-	{"identity", (PyCFunction)crn_matrix_identity, METH_VARARGS,
-		"Params: size,\n"
+	{"from_buffer", (PyCFunction)(void(*)(void))crn_matrix_from_buffer, METH_VARARGS | METH_KEYWORDS,
+		"Params: buffer, rows(optional), cols(optional), copy(optional), dtype(optional),\n"
+		"Return: Matrix,\n"
+		"Desc: Create a matrix over a float32, float64 or float16 C contiguous buffer\n"
+		"without copying when it's writable, or from a copy of it otherwise or\n"
+		"with copy=True. Untyped bytes, and uint16 ones with dtype='bfloat16',\n"
+		"are read as dtype(default='float32')\n"
+		"Example: crn.matrix.from_buffer(numpy_array)"
+	},
+	{"frombuffer", (PyCFunction)(void(*)(void))crn_matrix_from_buffer, METH_VARARGS | METH_KEYWORDS,
+		"Params: buffer, rows(optional), cols(optional), copy(optional), dtype(optional),\n"
+		"Return: Matrix,\n"
+		"Desc: Alias of from_buffer\n"
+		"Example: crn.matrix.frombuffer(data, 2, 2)"
+	},
+	{"identity", (PyCFunction)(void(*)(void))crn_matrix_identity, METH_VARARGS | METH_KEYWORDS,
+		"Params: size, dtype(optional),\n"
 		"Return: Matrix,\n"
 		"Desc: Create a new identity matrix\n"
 		"Example: crn.matrix.identity(10)"
@@ -582,24 +1061,35 @@ PyMethodDef crn_matrix_methods[] = {
 		"Desc: Set matrix element to specified value\n"
 		"Example: mat_var.set(0, 0, 2.2)"
 	},
-	{"row", (PyCFunction)crn_matrix_row, METH_VARARGS,
+	{"row", (PyCFunction)crn_matrix_row, METH_O,
 		"Params: row,\n"
-		"Return: Vector,\n"
-		"Desc: Get row from matrix\n"
+		"Return: View,\n"
+		"Desc: Get a view of a row of matrix, no values are copied. Matrices\n"
+		"of other dtypes than float32 return a 1 x cols copy\n"
 		"Example: mat_var.row(0)"
 	},
-	{"col", (PyCFunction)crn_matrix_col, METH_VARARGS,
+	{"col", (PyCFunction)crn_matrix_col, METH_O,
 		"Params: col,\n"
-		"Return: Vector,\n"
-		"Desc: Get col from matrix\n"
+		"Return: View,\n"
+		"Desc: Get a view of a col of matrix, no values are copied. Matrices\n"
+		"of other dtypes than float32 return a rows x 1 copy\n"
 		"Example: mat_var.col(2)"
 	},
 	{"transpose", (PyCFunction)crn_matrix_transpose, METH_NOARGS,
 		"Params: None,\n"
-		"Return: Matrix,\n"
-		"Desc: Transpose a matrix\n"
+		"Return: View,\n"
+		"Desc: Transposed view of a matrix in O(1), copy() materializes it.\n"
+		"Matrices of other dtypes than float32 have no views and return a\n"
+		"transposed copy\n"
 		"Example: mat_var.transpose()"
 	},
+	{"astype", (PyCFunction)crn_matrix_astype, METH_VARARGS,
+		"Params: dtype,\n"
+		"Return: Matrix,\n"
+		"Desc: Copy of the matrix converted to 'float32', 'float64', 'float16'\n"
+		"or 'bfloat16'\n"
+		"Example: mat_var.astype('float64')"
+	},
 	{"reshape", (PyCFunction)crn_matrix_reshape, METH_VARARGS,
 		"Params: new_rows, new_cols,\n"
 		"Return: None,\n"
@@ -612,6 +1102,165 @@ PyMethodDef crn_matrix_methods[] = {
 		"Desc: Inverse matrix\n"
 		"Example: mat_var.inverse()"
 	},
+	{"det", (PyCFunction)crn_matrix_det, METH_NOARGS,
+		"Params: None,\n"
+		"Return: float,\n"
+		"Desc: Determinant, closed form up to 4x4\n"
+		"Example: mat_var.det()"
+	},
+	{"sum", (PyCFunction)(void(*)(void))crn_matrix_sum, METH_VARARGS | METH_KEYWORDS,
+		"Params: axis(optional),\n"
+		"Return: float or Vector,\n"
+		"Desc: Sum of every element, or of each column (axis=0) or row (axis=1)\n"
+		"Example: mat_var.sum(axis=1)"
+	},
+	{"mean", (PyCFunction)(void(*)(void))crn_matrix_mean, METH_VARARGS | METH_KEYWORDS,
+		"Params: axis(optional),\n"
+		"Return: float or Vector,\n"
+		"Desc: Mean of every element, or of each column (axis=0) or row (axis=1)\n"
+		"Example: mat_var.mean()"
+	},
+	{"min", (PyCFunction)(void(*)(void))crn_matrix_min, METH_VARARGS | METH_KEYWORDS,
+		"Params: axis(optional),\n"
+		"Return: float or Vector,\n"
+		"Desc: Smallest element, or smallest of each column (axis=0) or row (axis=1)\n"
+		"Example: mat_var.min(axis=0)"
+	},
+	{"max", (PyCFunction)(void(*)(void))crn_matrix_max, METH_VARARGS | METH_KEYWORDS,
+		"Params: axis(optional),\n"
+		"Return: float or Vector,\n"
+		"Desc: Largest element, or largest of each column (axis=0) or row (axis=1)\n"
+		"Example: mat_var.max()"
+	},
+	{"argmin", (PyCFunction)(void(*)(void))crn_matrix_argmin, METH_VARARGS | METH_KEYWORDS,
+		"Params: axis(optional),\n"
+		"Return: int or Vector,\n"
+		"Desc: Row major index of the first smallest element, or its row in each column (axis=0) or col in each row (axis=1)\n"
+		"Example: mat_var.argmin()"
+	},
+	{"argmax", (PyCFunction)(void(*)(void))crn_matrix_argmax, METH_VARARGS | METH_KEYWORDS,
+		"Params: axis(optional),\n"
+		"Return: int or Vector,\n"
+		"Desc: Row major index of the first largest element, or its row in each column (axis=0) or col in each row (axis=1)\n"
+		"Example: mat_var.argmax(axis=1)"
+	},
+	{"norm", (PyCFunction)(void(*)(void))crn_matrix_norm, METH_VARARGS | METH_KEYWORDS,
+		"Params: ord(optional), axis(optional),\n"
+		"Return: float or Vector,\n"
+		"Desc: Entrywise 1, 2(default) or inf norm of the matrix, or of each column (axis=0) or row (axis=1)\n"
+		"Example: mat_var.norm(1, axis=0)"
+	},
+	{"map", (PyCFunction)(void(*)(void))crn_matrix_map, METH_VARARGS | METH_KEYWORDS,
+		"Params: fn, param1(optional), param2(optional), out(optional),\n"
+		"Return: Matrix,\n"
+		"Desc: Apply 'exp', 'log', 'tanh', 'sigmoid', 'erf', 'sqrt', 'rsqrt', 'abs',\n"
+		"'clamp' (lower and upper bound) or 'pow' (exponent) to every element,\n"
+		"writing into out when given, which may be the matrix itself\n"
+		"Example: mat_var.map('clamp', 0, 1, out=mat_var)"
+	},	{"eq", (PyCFunction)crn_matrix_eq_mask, METH_O,
+		"Params: Matrix or number,\n"
+		"Return: Mask,\n"
+		"Desc: Mask of where the matrix equals other elementwise\n"
+		"Example: mat_var.eq(mat_var2).count_nonzero()"
+	},
+	{"ne", (PyCFunction)crn_matrix_neq_mask, METH_O,
+		"Params: Matrix or number,\n"
+		"Return: Mask,\n"
+		"Desc: Mask of where the matrix differs from other elementwise\n"
+		"Example: mat_var.ne(mat_var2).count_nonzero()"
+	},
+	{"gt", (PyCFunction)crn_matrix_gt_mask, METH_O,
+		"Params: Matrix or number,\n"
+		"Return: Mask,\n"
+		"Desc: Mask of where the matrix is greater than other elementwise\n"
+		"Example: mat_var.gt(mat_var2).count_nonzero()"
+	},
+	{"ge", (PyCFunction)crn_matrix_ge_mask, METH_O,
+		"Params: Matrix or number,\n"
+		"Return: Mask,\n"
+		"Desc: Mask of where the matrix is greater than or equal to other elementwise\n"
+		"Example: mat_var.ge(mat_var2).count_nonzero()"
+	},
+	{"lt", (PyCFunction)crn_matrix_lt_mask, METH_O,
+		"Params: Matrix or number,\n"
+		"Return: Mask,\n"
+		"Desc: Mask of where the matrix is less than other elementwise\n"
+		"Example: mat_var.lt(mat_var2).count_nonzero()"
+	},
+	{"le", (PyCFunction)crn_matrix_le_mask, METH_O,
+		"Params: Matrix or number,\n"
+		"Return: Mask,\n"
+		"Desc: Mask of where the matrix is less than or equal to other elementwise\n"
+		"Example: mat_var.le(mat_var2).count_nonzero()"
+	},
+	{"allclose", (PyCFunction)(void(*)(void))crn_matrix_allclose, METH_VARARGS | METH_KEYWORDS,
+		"Params: Matrix, rtol(optional), atol(optional),\n"
+		"Return: bool,\n"
+		"Desc: Whether every |matrix - other| <= atol + rtol * |other|, rtol defaulting to 1e-5 and atol to 1e-8,\n"
+		"stopping at the first element that isn't close\n"
+		"Example: mat_var.allclose(mat_var2, rtol=1e-4)"
+	},
+
+	{"lu", (PyCFunction)crn_matrix_lu, METH_VARARGS,
+		"Params: Matrix,\n"
+		"Return: LU,\n"
+		"Desc: Factorize a square matrix once to solve against it many times\n"
+		"Example: crn.matrix.lu(mat_var)"
+	},
+	{"solve", (PyCFunction)crn_matrix_solve, METH_VARARGS,
+		"Params: Matrix, Matrix or Vector,\n"
+		"Return: Matrix or Vector,\n"
+		"Desc: Solve A * X = B without forming the inverse of A\n"
+		"Example: crn.matrix.solve(mat_var, vec_var)"
+	},
+	{"quantize", (PyCFunction)(void(*)(void))crn_matrix_quantize, METH_VARARGS | METH_KEYWORDS,
+		"Params: Matrix, per_row(optional),\n"
+		"Return: QMatrix,\n"
+		"Desc: Quantize to int8 with one scale and zero point per row or for the whole matrix\n"
+		"Example: crn.matrix.quantize(mat_var, per_row=True)"
+	},
+	{"sparse", (PyCFunction)(void(*)(void))crn_matrix_sparse, METH_VARARGS | METH_KEYWORDS,
+		"Params: Matrix, format(optional),\n"
+		"Return: Sparse,\n"
+		"Desc: Keep the nonzeros of a matrix in 'csr' (default) or 'csc' format\n"
+		"Example: crn.matrix.sparse(mat_var, format=\"csc\")"
+	},
+	{"sparse_triplets", (PyCFunction)(void(*)(void))crn_matrix_sparse_triplets, METH_VARARGS | METH_KEYWORDS,
+		"Params: rows, cols, triplets, format(optional),\n"
+		"Return: Sparse,\n"
+		"Desc: Build a sparse matrix from (row, col, value) triplets, repeated pairs are summed\n"
+		"Example: crn.matrix.sparse_triplets(3, 3, [(0, 1, 2.5), (2, 0, 1)])"
+	},
+	{"add", (PyCFunction)(void(*)(void))crn_matrix_add_out, METH_VARARGS | METH_KEYWORDS,
+		"Params: other, out(optional),\n"
+		"Return: Matrix,\n"
+		"Desc: Add matrix or scalar, writing into out when given\n"
+		"Example: mat_var.add(mat_var2, out=mat_var)"
+	},
+	{"sub", (PyCFunction)(void(*)(void))crn_matrix_sub_out, METH_VARARGS | METH_KEYWORDS,
+		"Params: other, out(optional),\n"
+		"Return: Matrix,\n"
+		"Desc: Subtract matrix or scalar, writing into out when given\n"
+		"Example: mat_var.sub(2.5, out=mat_var)"
+	},
+	{"mul", (PyCFunction)(void(*)(void))crn_matrix_mul_out, METH_VARARGS | METH_KEYWORDS,
+		"Params: other, out(optional),\n"
+		"Return: Matrix or Vector,\n"
+		"Desc: Multiply by matrix, vector or scalar, writing into out when given\n"
+		"Example: mat_var.mul(mat_var2, out=mat_var3)"
+	},
+	{"div", (PyCFunction)(void(*)(void))crn_matrix_div_out, METH_VARARGS | METH_KEYWORDS,
+		"Params: other, out(optional),\n"
+		"Return: Matrix,\n"
+		"Desc: Divide by matrix or scalar, writing into out when given\n"
+		"Example: mat_var.div(mat_var2, out=mat_var)"
+	},
+	{"lazy", (PyCFunction)crn_expr_lazy, METH_NOARGS,
+		"Params: None,\n"
+		"Return: Expr,\n"
+		"Desc: Start a lazy expression, + - / and scalar * are fused until eval\n"
+		"Example: (mat_var.lazy() * 2 + mat_var2).eval()"
+	},
 	{"push_row", (PyCFunction)crn_matrix_push_row, METH_VARARGS,
 		"Params: Vector,\n"
 		"Return: None,\n"
@@ -624,6 +1273,12 @@ PyMethodDef crn_matrix_methods[] = {
 		"Desc: Push vector as a new col of matrix\n"
 		"Example: mat_var.push_col(vec_var)"
 	},
+	{"reserve", (PyCFunction)crn_matrix_reserve, METH_VARARGS,
+		"Params: rows, cols,\n"
+		"Return: None,\n"
+		"Desc: Make room for rows x cols so pushes up to that size don't reallocate\n"
+		"Example: mat_var.reserve(1000, 64)"
+	},
 	{"pop_row", (PyCFunction)crn_matrix_pop_row, METH_NOARGS,
 		"Params: None,\n"
 		"Return: Vector,\n"
@@ -639,6 +1294,11 @@ PyMethodDef crn_matrix_methods[] = {
 	{NULL, NULL, 0, NULL},
 };
 
+static PyMappingMethods crn_matrix_as_mapping = {
+	.mp_subscript = crn_matrix_subscript,
+	.mp_ass_subscript = crn_matrix_ass_subscript,
+};
+
 static PyNumberMethods crn_matrix_as_number = {
 	.nb_add = crn_matrix_add,
 	.nb_subtract = crn_matrix_sub,
@@ -657,8 +1317,9 @@ PyTypeObject crn_matrix_type = {
 	.tp_dealloc = (destructor)crn_matrix_free,
 	.tp_methods = crn_matrix_methods,
 	.tp_str = crn_matrix_str,
-	.tp_as_mapping = NULL,
+	.tp_as_mapping = &crn_matrix_as_mapping,
 	.tp_as_number = &crn_matrix_as_number,
+	.tp_as_buffer = &crn_matrix_as_buffer,
 	.tp_richcompare = crn_matrix_compare,
 	.tp_getattro = crn_matrix_get_attro,
 };
@@ -0,0 +1,193 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#pragma message "Python quantized matrix"
+
+#include "python_bind.h"
+
+PyObject* crn_matrix_quantize(PyObject* self, PyObject* args, PyObject* kwargs){
+	(void)self;
+	PyObject* obj;
+	int per_row = 0;
+	static char* keywords[] = {"matrix", "per_row", NULL};
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "O|p", keywords, &obj, &per_row))
+		return NULL;
+	if(!PyObject_TypeCheck(obj, &crn_matrix_type)){
+		PyErr_SetString(PyExc_TypeError, "Expected a matrix");
+		return NULL;
+	}
+	struct CrunumQMatrix* crn_qmatrix = PyObject_New(struct CrunumQMatrix, &crn_qmatrix_type);
+	if(!crn_qmatrix)
+		return NULL;
+	crn_qmatrix->qmatrix = matrix_quantize(((struct CrunumMatrix*)obj)->matrix, (uint)per_row);
+	if(!crn_qmatrix->qmatrix){
+		Py_DECREF(crn_qmatrix);
+		return PyErr_NoMemory();
+	}
+	return (PyObject*)crn_qmatrix;
+}
+
+static PyObject* crn_qmatrix_dequantize(struct CrunumQMatrix* self, PyObject* noargs){
+	(void)noargs;
+	struct CrunumMatrix* result = crn_matrix_alloc();
+	if(!result)
+		return NULL;
+	result->matrix = qmatrix_dequantize(self->qmatrix);
+	return (PyObject*)result;
+}
+
+static PyObject* crn_qmatrix_mul(PyObject* left, PyObject* right){
+	if(!PyObject_TypeCheck(left, &crn_qmatrix_type))
+		Py_RETURN_NOTIMPLEMENTED;
+	struct QMatrix* qmatrix = ((struct CrunumQMatrix*)left)->qmatrix;
+	if(PyObject_TypeCheck(right, &crn_matrix_type)){
+		struct Matrix* matrix = ((struct CrunumMatrix*)right)->matrix;
+		if(qmatrix->cols != matrix->rows){
+			PyErr_SetString(PyExc_ValueError, "Matrix col size doesn't match another matrix row size");
+			return NULL;
+		}
+		struct CrunumMatrix* result = crn_matrix_alloc();
+		if(!result)
+			return NULL;
+		result->matrix = qmatrix_mul(qmatrix, matrix);
+		return (PyObject*)result;
+	}
+	if(PyObject_TypeCheck(right, &crn_vector_type)){
+		struct Vector* vector = ((struct CrunumVector*)right)->vector;
+		if(qmatrix->cols != vector->len){
+			PyErr_SetString(PyExc_ValueError, "Matrix col size doesn't match vector length");
+			return NULL;
+		}
+		struct CrunumVector* result = crn_vector_alloc();
+		if(!result)
+			return NULL;
+		result->vector = qmatrix_mul_vector(qmatrix, vector);
+		return (PyObject*)result;
+	}
+	Py_RETURN_NOTIMPLEMENTED;
+}
+
+static PyObject* crn_qmatrix_mul_out(struct CrunumQMatrix* self,
+		PyObject* args, PyObject* kwargs){
+	PyObject* other;
+	PyObject* out = NULL;
+	static char* keywords[] = {"other", "out", NULL};
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", keywords, &other, &out))
+		return NULL;
+	if(!out || out == Py_None)
+		return crn_qmatrix_mul((PyObject*)self, other);
+	struct QMatrix* qmatrix = self->qmatrix;
+	uint done;
+	if(PyObject_TypeCheck(other, &crn_matrix_type)){
+		struct Matrix* matrix = ((struct CrunumMatrix*)other)->matrix;
+		if(qmatrix->cols != matrix->rows){
+			PyErr_SetString(PyExc_ValueError, "Matrix col size doesn't match another matrix row size");
+			return NULL;
+		}
+		if(!PyObject_TypeCheck(out, &crn_matrix_type)){
+			PyErr_SetString(PyExc_TypeError, "out must be a matrix");
+			return NULL;
+		}
+		done = qmatrix_mul_into(((struct CrunumMatrix*)out)->matrix,
+				qmatrix, matrix) != NULL;
+	}
+	else if(PyObject_TypeCheck(other, &crn_vector_type)){
+		struct Vector* vector = ((struct CrunumVector*)other)->vector;
+		if(qmatrix->cols != vector->len){
+			PyErr_SetString(PyExc_ValueError, "Matrix col size doesn't match vector length");
+			return NULL;
+		}
+		if(!PyObject_TypeCheck(out, &crn_vector_type)){
+			PyErr_SetString(PyExc_TypeError, "out must be a vector");
+			return NULL;
+		}
+		done = qmatrix_mul_vector_into(((struct CrunumVector*)out)->vector,
+				qmatrix, vector) != NULL;
+	}
+	else
+		Py_RETURN_NOTIMPLEMENTED;
+	if(!done){
+		PyErr_SetString(PyExc_ValueError,
+				"out shape doesn't match result shape or aliases an operand");
+		return NULL;
+	}
+	Py_INCREF(out);
+	return out;
+}
+
+static void crn_qmatrix_free(struct CrunumQMatrix* self){
+	qmatrix_free(self->qmatrix);
+	Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static PyObject* crn_qmatrix_params(struct QMatrix* qmatrix, uint zero_points){
+	uint groups = qmatrix->per_row ? qmatrix->rows : 1;
+	PyObject* list = PyList_New(groups);
+	if(!list)
+		return NULL;
+	for(uint i = 0; i < groups; i++){
+		PyObject* item = zero_points ? PyLong_FromLong(qmatrix->zero_points[i]) :
+			PyFloat_FromDouble(qmatrix->scales[i]);
+		if(!item){
+			Py_DECREF(list);
+			return NULL;
+		}
+		PyList_SET_ITEM(list, i, item);
+	}
+	return list;
+}
+
+static PyObject* crn_qmatrix_get_attro(PyObject* self, PyObject* attr_name){
+	struct QMatrix* qmatrix = ((struct CrunumQMatrix*)self)->qmatrix;
+	if(!PyUnicode_Check(attr_name)){
+		PyErr_SetString(PyExc_TypeError, "Attribute name isn't a string");
+		return NULL;
+	}
+	if(!PyUnicode_CompareWithASCIIString(attr_name, "rows"))
+		return PyLong_FromUnsignedLong((ulong)qmatrix->rows);
+	if(!PyUnicode_CompareWithASCIIString(attr_name, "cols"))
+		return PyLong_FromUnsignedLong((ulong)qmatrix->cols);
+	if(!PyUnicode_CompareWithASCIIString(attr_name, "per_row"))
+		return PyBool_FromLong(qmatrix->per_row);
+	if(!PyUnicode_CompareWithASCIIString(attr_name, "scales"))
+		return crn_qmatrix_params(qmatrix, 0);
+	if(!PyUnicode_CompareWithASCIIString(attr_name, "zero_points"))
+		return crn_qmatrix_params(qmatrix, 1);
+	return PyObject_GenericGetAttr(self, attr_name);
+}
+
+static PyMethodDef crn_qmatrix_methods[] = {
+	{"dequantize", (PyCFunction)crn_qmatrix_dequantize, METH_NOARGS,
+		"Params: None,\n"
+		"Return: Matrix,\n"
+		"Desc: Float32 matrix the quantized values stand for\n"
+		"Example: qmat_var.dequantize()"
+	},
+	{"mul", (PyCFunction)(void(*)(void))crn_qmatrix_mul_out, METH_VARARGS | METH_KEYWORDS,
+		"Params: Matrix or Vector, out(optional),\n"
+		"Return: Matrix or Vector,\n"
+		"Desc: int8 product with int32 accumulation and a float32 result, writing into out when given\n"
+		"Example: qmat_var.mul(vec_var, out=vec_var2)"
+	},
+	{NULL, NULL, 0, NULL},
+};
+
+static PyNumberMethods crn_qmatrix_as_number = {
+	.nb_multiply = crn_qmatrix_mul,
+};
+
+PyTypeObject crn_qmatrix_type = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "crunum.matrix.QMatrix",
+	.tp_basicsize = sizeof(struct CrunumQMatrix),
+	.tp_itemsize = 0,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_dealloc = (destructor)crn_qmatrix_free,
+	.tp_methods = crn_qmatrix_methods,
+	.tp_as_number = &crn_qmatrix_as_number,
+	.tp_getattro = crn_qmatrix_get_attro,
+};
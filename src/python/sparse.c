@@ -0,0 +1,279 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#pragma message "Python sparse matrix"
+
+#include <stdlib.h>
+
+#include "python_bind.h"
+
+static const char* const crn_format_names[] = {"csr", "csc"};
+
+static int crn_format_converter(PyObject* obj, void* format){
+	if(obj == Py_None){
+		*(enum SparseFormat*)format = SPARSE_CSR;
+		return 1;
+	}
+	if(PyUnicode_Check(obj))
+		for(uint i = 0; i < sizeof(crn_format_names) / sizeof(*crn_format_names); i++)
+			if(!PyUnicode_CompareWithASCIIString(obj, crn_format_names[i])){
+				*(enum SparseFormat*)format = (enum SparseFormat)i;
+				return 1;
+			}
+	PyErr_SetString(PyExc_ValueError, "format must be 'csr' or 'csc'");
+	return 0;
+}
+
+static PyObject* crn_sparse_wrap(struct Sparse* sparse){
+	if(!sparse)
+		return PyErr_NoMemory();
+	struct CrunumSparse* crn_sparse = PyObject_New(struct CrunumSparse, &crn_sparse_type);
+	if(!crn_sparse){
+		sparse_free(sparse);
+		return NULL;
+	}
+	crn_sparse->sparse = sparse;
+	return (PyObject*)crn_sparse;
+}
+
+PyObject* crn_matrix_sparse(PyObject* self, PyObject* args, PyObject* kwargs){
+	(void)self;
+	PyObject* obj;
+	enum SparseFormat format = SPARSE_CSR;
+	static char* keywords[] = {"matrix", "format", NULL};
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O&", keywords, &obj,
+				crn_format_converter, &format))
+		return NULL;
+	if(!PyObject_TypeCheck(obj, &crn_matrix_type)){
+		PyErr_SetString(PyExc_TypeError, "Expected a matrix");
+		return NULL;
+	}
+	return crn_sparse_wrap(sparse_from_matrix(((struct CrunumMatrix*)obj)->matrix, format));
+}
+
+/*
+ * Triplets are (row, col, value) with 0 based indices, repeated pairs
+ * are summed.
+ */
+PyObject* crn_matrix_sparse_triplets(PyObject* self, PyObject* args, PyObject* kwargs){
+	(void)self;
+	uint rows, cols;
+	PyObject* obj;
+	enum SparseFormat format = SPARSE_CSR;
+	static char* keywords[] = {"rows", "cols", "triplets", "format", NULL};
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "IIO|O&", keywords, &rows, &cols, &obj,
+				crn_format_converter, &format))
+		return NULL;
+	PyObject* triplets = PySequence_Fast(obj, "triplets must be a sequence");
+	if(!triplets)
+		return NULL;
+	uint nnz = (uint)PySequence_Fast_GET_SIZE(triplets);
+	uint* row_index = malloc(sizeof(uint) * ((ulong)nnz + 1));
+	uint* col_index = malloc(sizeof(uint) * ((ulong)nnz + 1));
+	float* values = malloc(sizeof(float) * ((ulong)nnz + 1));
+	PyObject* result = NULL;
+	if(!row_index || !col_index || !values){
+		PyErr_NoMemory();
+		goto done;
+	}
+	for(uint k = 0; k < nnz; k++){
+		uint row, col;
+		float value;
+		if(!PyArg_ParseTuple(PySequence_Fast_GET_ITEM(triplets, k), "IIf", &row, &col, &value))
+			goto done;
+		if(row >= rows || col >= cols){
+			PyErr_SetString(PyExc_IndexError, "Triplet index out of range");
+			goto done;
+		}
+		row_index[k] = row;
+		col_index[k] = col;
+		values[k] = value;
+	}
+	result = crn_sparse_wrap(sparse_from_triplets(rows, cols, nnz, row_index, col_index,
+				values, format));
+done:
+	free(row_index);
+	free(col_index);
+	free(values);
+	Py_DECREF(triplets);
+	return result;
+}
+
+static PyObject* crn_sparse_todense(struct CrunumSparse* self, PyObject* noargs){
+	(void)noargs;
+	struct CrunumMatrix* result = crn_matrix_alloc();
+	if(!result)
+		return NULL;
+	result->matrix = sparse_to_matrix(self->sparse);
+	return (PyObject*)result;
+}
+
+static PyObject* crn_sparse_transpose(struct CrunumSparse* self, PyObject* noargs){
+	(void)noargs;
+	return crn_sparse_wrap(sparse_transpose(self->sparse));
+}
+
+static PyObject* crn_sparse_tocsr(struct CrunumSparse* self, PyObject* noargs){
+	(void)noargs;
+	return crn_sparse_wrap(sparse_convert(self->sparse, SPARSE_CSR));
+}
+
+static PyObject* crn_sparse_tocsc(struct CrunumSparse* self, PyObject* noargs){
+	(void)noargs;
+	return crn_sparse_wrap(sparse_convert(self->sparse, SPARSE_CSC));
+}
+
+static PyObject* crn_sparse_mul(PyObject* left, PyObject* right){
+	if(!PyObject_TypeCheck(left, &crn_sparse_type))
+		Py_RETURN_NOTIMPLEMENTED;
+	struct Sparse* sparse = ((struct CrunumSparse*)left)->sparse;
+	if(PyObject_TypeCheck(right, &crn_matrix_type)){
+		struct Matrix* matrix = ((struct CrunumMatrix*)right)->matrix;
+		if(sparse->cols != matrix->rows){
+			PyErr_SetString(PyExc_ValueError, "Matrix col size doesn't match another matrix row size");
+			return NULL;
+		}
+		struct CrunumMatrix* result = crn_matrix_alloc();
+		if(!result)
+			return NULL;
+		result->matrix = sparse_mul(sparse, matrix);
+		return (PyObject*)result;
+	}
+	if(PyObject_TypeCheck(right, &crn_vector_type)){
+		struct Vector* vector = ((struct CrunumVector*)right)->vector;
+		if(sparse->cols != vector->len){
+			PyErr_SetString(PyExc_ValueError, "Matrix col size doesn't match vector length");
+			return NULL;
+		}
+		struct CrunumVector* result = crn_vector_alloc();
+		if(!result)
+			return NULL;
+		result->vector = sparse_mul_vector(sparse, vector);
+		return (PyObject*)result;
+	}
+	Py_RETURN_NOTIMPLEMENTED;
+}
+
+static PyObject* crn_sparse_mul_out(struct CrunumSparse* self,
+		PyObject* args, PyObject* kwargs){
+	PyObject* other;
+	PyObject* out = NULL;
+	static char* keywords[] = {"other", "out", NULL};
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", keywords, &other, &out))
+		return NULL;
+	if(!out || out == Py_None)
+		return crn_sparse_mul((PyObject*)self, other);
+	struct Sparse* sparse = self->sparse;
+	uint done;
+	if(PyObject_TypeCheck(other, &crn_matrix_type)){
+		struct Matrix* matrix = ((struct CrunumMatrix*)other)->matrix;
+		if(sparse->cols != matrix->rows){
+			PyErr_SetString(PyExc_ValueError, "Matrix col size doesn't match another matrix row size");
+			return NULL;
+		}
+		if(!PyObject_TypeCheck(out, &crn_matrix_type)){
+			PyErr_SetString(PyExc_TypeError, "out must be a matrix");
+			return NULL;
+		}
+		done = sparse_mul_into(((struct CrunumMatrix*)out)->matrix,
+				sparse, matrix) != NULL;
+	}
+	else if(PyObject_TypeCheck(other, &crn_vector_type)){
+		struct Vector* vector = ((struct CrunumVector*)other)->vector;
+		if(sparse->cols != vector->len){
+			PyErr_SetString(PyExc_ValueError, "Matrix col size doesn't match vector length");
+			return NULL;
+		}
+		if(!PyObject_TypeCheck(out, &crn_vector_type)){
+			PyErr_SetString(PyExc_TypeError, "out must be a vector");
+			return NULL;
+		}
+		done = sparse_mul_vector_into(((struct CrunumVector*)out)->vector,
+				sparse, vector) != NULL;
+	}
+	else
+		Py_RETURN_NOTIMPLEMENTED;
+	if(!done){
+		PyErr_SetString(PyExc_ValueError,
+				"out shape doesn't match result shape or aliases an operand");
+		return NULL;
+	}
+	Py_INCREF(out);
+	return out;
+}
+
+static void crn_sparse_free(struct CrunumSparse* self){
+	sparse_free(self->sparse);
+	Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static PyObject* crn_sparse_get_attro(PyObject* self, PyObject* attr_name){
+	struct Sparse* sparse = ((struct CrunumSparse*)self)->sparse;
+	if(!PyUnicode_Check(attr_name)){
+		PyErr_SetString(PyExc_TypeError, "Attribute name isn't a string");
+		return NULL;
+	}
+	if(!PyUnicode_CompareWithASCIIString(attr_name, "rows"))
+		return PyLong_FromUnsignedLong((ulong)sparse->rows);
+	if(!PyUnicode_CompareWithASCIIString(attr_name, "cols"))
+		return PyLong_FromUnsignedLong((ulong)sparse->cols);
+	if(!PyUnicode_CompareWithASCIIString(attr_name, "nnz"))
+		return PyLong_FromUnsignedLong((ulong)sparse->nnz);
+	if(!PyUnicode_CompareWithASCIIString(attr_name, "format"))
+		return PyUnicode_FromString(crn_format_names[sparse->format]);
+	return PyObject_GenericGetAttr(self, attr_name);
+}
+
+static PyMethodDef crn_sparse_methods[] = {
+	{"todense", (PyCFunction)crn_sparse_todense, METH_NOARGS,
+		"Params: None,\n"
+		"Return: Matrix,\n"
+		"Desc: Dense float32 copy\n"
+		"Example: sparse_var.todense()"
+	},
+	{"transpose", (PyCFunction)crn_sparse_transpose, METH_NOARGS,
+		"Params: None,\n"
+		"Return: Sparse,\n"
+		"Desc: Transpose, CSR becomes CSC and the other way around without reordering\n"
+		"Example: sparse_var.transpose()"
+	},
+	{"tocsr", (PyCFunction)crn_sparse_tocsr, METH_NOARGS,
+		"Params: None,\n"
+		"Return: Sparse,\n"
+		"Desc: Copy in compressed sparse row format\n"
+		"Example: sparse_var.tocsr()"
+	},
+	{"tocsc", (PyCFunction)crn_sparse_tocsc, METH_NOARGS,
+		"Params: None,\n"
+		"Return: Sparse,\n"
+		"Desc: Copy in compressed sparse column format\n"
+		"Example: sparse_var.tocsc()"
+	},
+	{"mul", (PyCFunction)(void(*)(void))crn_sparse_mul_out, METH_VARARGS | METH_KEYWORDS,
+		"Params: Matrix or Vector, out(optional),\n"
+		"Return: Matrix or Vector,\n"
+		"Desc: Sparse times dense product, writing into out when given\n"
+		"Example: sparse_var.mul(vec_var, out=vec_var2)"
+	},
+	{NULL, NULL, 0, NULL},
+};
+
+static PyNumberMethods crn_sparse_as_number = {
+	.nb_multiply = crn_sparse_mul,
+};
+
+PyTypeObject crn_sparse_type = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "crunum.matrix.Sparse",
+	.tp_basicsize = sizeof(struct CrunumSparse),
+	.tp_itemsize = 0,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_dealloc = (destructor)crn_sparse_free,
+	.tp_methods = crn_sparse_methods,
+	.tp_as_number = &crn_sparse_as_number,
+	.tp_getattro = crn_sparse_get_attro,
+};
@@ -9,46 +9,54 @@
 
 #include "python_bind.h"
 
-static struct CrunumVector* crn_vector_new(PyObject* self, PyObject* args){
+static struct CrunumVector* crn_vector_new(PyObject* self, PyObject* args, PyObject* kwargs){
 	(void)self;
 	uint len;
 	double value = 0;
-	static char* keywords = {"len", "value", NULL};
-	if(!PyArg_ParseTupleAndKeywords(args, keywords, "I|d", &len, &value))
+	enum Dtype dtype = DTYPE_F32;
+	static char* keywords[] = {"len", "value", "dtype", NULL};
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "I|dO&", keywords, &len, &value,
+				crn_dtype_converter, &dtype))
 		return NULL;
-	struct CrunumVector* crn_vector = PyObject_New(struct CrunumVector, &crn_vector_type);
+	struct CrunumVector* crn_vector = crn_vector_alloc();
 	if(!crn_vector)
 		return NULL;
-	crn_vector->vector = vector_new(len, (float)value);
+	crn_vector->vector = vector_new_dtype(len, value, dtype);
 	return crn_vector;
 }
 
-static struct CrunumVector* crn_vector_randinit(PyObject* self, PyObject* args){
+static struct CrunumVector* crn_vector_randinit(PyObject* self, PyObject* args, PyObject* kwargs){
 	(void)self;
 	uint len;
-	if(!PyArg_ParseTuple(args, "I", &len))
+	enum Dtype dtype = DTYPE_F32;
+	static char* keywords[] = {"len", "dtype", NULL};
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "I|O&", keywords, &len,
+				crn_dtype_converter, &dtype))
 		return NULL;
-	struct CrunumVector* crn_vector = PyObject_New(struct CrunumVector, &crn_vector_type);
+	struct CrunumVector* crn_vector = crn_vector_alloc();
 	if(!crn_vector)
 		return NULL;
-	crn_vector->vector = vector_randinit(len);
+	crn_vector->vector = vector_randinit_dtype(len, dtype);
 	return crn_vector;
 }
 
-static struct CrunumVector* crn_vector_from_list(PyObject* self, PyObject* args){
+static struct CrunumVector* crn_vector_from_list(PyObject* self, PyObject* args, PyObject* kwargs){
 	(void)self;
 	PyObject* list;
-	if(!PyArg_ParseTuple(args, "O", &list))
+	enum Dtype dtype = DTYPE_F32;
+	static char* keywords[] = {"list", "dtype", NULL};
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O&", keywords, &list,
+				crn_dtype_converter, &dtype))
 		return NULL;
 	if(!PyList_Check(list)){
 		PyErr_SetString(PyExc_TypeError, "Expected a list");
 		return NULL;
 	}
 	uint len = (uint)PyList_Size(list);
-	struct CrunumVector* crn_vector = PyObject_New(struct CrunumVector, &crn_vector_type);
+	struct CrunumVector* crn_vector = crn_vector_alloc();
 	if(!crn_vector)
 		return NULL;
-	crn_vector->vector = vector_new(len, 0);
+	crn_vector->vector = vector_new_dtype(len, 0, dtype);
 	for(uint i = 0; i < len; i++){
 		PyObject* item = PyList_GetItem(list, i);
 		if(!PyFloat_Check(item) && !PyLong_Check(item)){
@@ -57,7 +65,7 @@ static struct CrunumVector* crn_vector_from_list(PyObject* self, PyObject* args)
 			PyObject_Del(crn_vector);
 			return NULL;
 		}
-		crn_vector->vector->values[i] = (float)PyFloat_AsDouble(item);
+		vector_set(crn_vector->vector, i, PyFloat_AsDouble(item));
 	}
 	return crn_vector;
 }
@@ -70,12 +78,27 @@ static PyObject* crn_vector_get_attro(PyObject* self, PyObject* attr_name){
 	}
 	if(!PyUnicode_CompareWithASCIIString(attr_name, "len"))
 		return PyLong_FromUnsignedLong((ulong)crn_vector->vector->len);
+	if(!PyUnicode_CompareWithASCIIString(attr_name, "dtype"))
+		return crn_dtype_name(crn_vector->vector->dtype);
 	return PyObject_GenericGetAttr(self, attr_name);
 }
 
+static struct CrunumVector* crn_vector_astype(struct CrunumVector* self, PyObject* args){
+	enum Dtype dtype;
+	if(!PyArg_ParseTuple(args, "O&", crn_dtype_converter, &dtype))
+		return NULL;
+	struct CrunumVector* result = crn_vector_alloc();
+	if(!result)
+		return NULL;
+	result->vector = vector_astype(self->vector, dtype);
+	return result;
+}
+
 static PyObject* crn_vector_push(struct CrunumVector* self, PyObject* args){
-	float value;
-	if(!PyArg_ParseTuple(args, "f", &value))
+	if(crn_vector_pinned(self))
+		return NULL;
+	double value;
+	if(!PyArg_ParseTuple(args, "d", &value))
 		return NULL;
 	vector_push(self->vector, value);
 	Py_RETURN_NONE;
@@ -83,11 +106,18 @@ static PyObject* crn_vector_push(struct CrunumVector* self, PyObject* args){
 
 static PyObject* crn_vector_pop(struct CrunumVector* self, PyObject* noargs){
 	(void)noargs;
+	if(crn_vector_pinned(self))
+		return NULL;
 	return PyFloat_FromDouble(vector_pop(self->vector));
 }
 
 static void crn_vector_free(struct CrunumVector* self){
-	vector_free(self->vector);
+	if(self->source){
+		PyMem_Free(self->vector);
+		crn_buffer_free(self->source);
+	}
+	else
+		vector_free(self->vector);
 	Py_TYPE(self)->tp_free((PyObject*)self);
 }
 
@@ -102,7 +132,7 @@ static PyObject* crn_vector_get(PyObject* self, PyObject* key){
 		PyErr_SetString(PyExc_IndexError, "Out of bound");
 		return NULL;
 	}
-	return PyFloat_FromDouble(crn_vector->vector->values[index]);
+	return PyFloat_FromDouble(vector_load(crn_vector->vector, index));
 }
 
 static int crn_vector_set(PyObject* self, PyObject* key, PyObject* value){
@@ -120,7 +150,7 @@ static int crn_vector_set(PyObject* self, PyObject* key, PyObject* value){
 		PyErr_SetString(PyExc_TypeError, "Value must be float or integer");
 		return -1;
 	}
-	crn_vector->vector->values[index] = (float)PyFloat_AsDouble(value);
+	vector_set(crn_vector->vector, index, PyFloat_AsDouble(value));
 	return 0;
 }
 
@@ -129,7 +159,7 @@ static PyObject* crn_vector_str(PyObject* self){
 	PyObject* result = PyUnicode_FromString("[");
 	for(uint i = 0; i < vector->len; i++){
 		char num[16];
-		snprintf(num, sizeof(num), "%.2lf", vector->values[i]);
+		snprintf(num, sizeof(num), "%.2lf", vector_load(vector, i));
 		PyUnicode_Append(&result, PyUnicode_FromString(num));
 		if(i != vector->len - 1)
 			PyUnicode_Append(&result, PyUnicode_FromString(", "));
@@ -140,9 +170,9 @@ static PyObject* crn_vector_str(PyObject* self){
 
 static PyObject* crn_vector_add(PyObject* left, PyObject* right){
 	if(PyFloat_Check(left) || PyLong_Check(left)){
-		float scalar = (float)PyFloat_AsDouble(left);
+		double scalar = PyFloat_AsDouble(left);
 		struct Vector* vector = ((struct CrunumVector*)right)->vector;
-		struct CrunumVector* result = PyObject_New(struct CrunumVector, &crn_vector_type);
+		struct CrunumVector* result = crn_vector_alloc();
 		result->vector = vector_add_scalar(vector, scalar);
 		return (PyObject*)result;
 	}
@@ -155,13 +185,13 @@ static PyObject* crn_vector_add(PyObject* left, PyObject* right){
 			PyErr_SetString(PyExc_ValueError, "Vector length doesn't match another vector length");
 			return NULL;
 		}
-		struct CrunumVector* result = PyObject_New(struct CrunumVector, &crn_vector_type);
+		struct CrunumVector* result = crn_vector_alloc();
 		result->vector = vector_add(vector1, vector2);
 		return (PyObject*)result;
 	}
 	if(PyFloat_Check(right) || PyLong_Check(right)){
-		float scalar = (float)PyFloat_AsDouble(right);
-		struct CrunumVector* result = PyObject_New(struct CrunumVector, &crn_vector_type);
+		double scalar = PyFloat_AsDouble(right);
+		struct CrunumVector* result = crn_vector_alloc();
 		result->vector = vector_add_scalar(vector1, scalar);
 		return (PyObject*)result;
 	}
@@ -170,9 +200,9 @@ static PyObject* crn_vector_add(PyObject* left, PyObject* right){
 
 static PyObject* crn_vector_sub(PyObject* left, PyObject* right){
 	if(PyFloat_Check(left) || PyLong_Check(left)){
-		float scalar = (float)PyFloat_AsDouble(left);
+		double scalar = PyFloat_AsDouble(left);
 		struct Vector* vector = ((struct CrunumVector*)right)->vector;
-		struct CrunumVector* result = PyObject_New(struct CrunumVector, &crn_vector_type);
+		struct CrunumVector* result = crn_vector_alloc();
 		result->vector = scalar_sub_vector(scalar, vector);
 		return (PyObject*)result;
 	}
@@ -185,13 +215,13 @@ static PyObject* crn_vector_sub(PyObject* left, PyObject* right){
 			PyErr_SetString(PyExc_ValueError, "Vector length doesn't match another vector length");
 			return NULL;
 		}
-		struct CrunumVector* result = PyObject_New(struct CrunumVector, &crn_vector_type);
+		struct CrunumVector* result = crn_vector_alloc();
 		result->vector = vector_sub(vector1, vector2);
 		return (PyObject*)result;
 	}
 	if(PyFloat_Check(right) || PyLong_Check(right)){
-		float scalar = (float)PyFloat_AsDouble(right);
-		struct CrunumVector* result = PyObject_New(struct CrunumVector, &crn_vector_type);
+		double scalar = PyFloat_AsDouble(right);
+		struct CrunumVector* result = crn_vector_alloc();
 		result->vector = vector_sub_scalar(vector1, scalar);
 		return (PyObject*)result;
 	}
@@ -200,9 +230,9 @@ static PyObject* crn_vector_sub(PyObject* left, PyObject* right){
 
 static PyObject* crn_vector_mul(PyObject* left, PyObject* right){
 	if(PyFloat_Check(left) || PyLong_Check(left)){
-		float scalar = (float)PyFloat_AsDouble(left);
+		double scalar = PyFloat_AsDouble(left);
 		struct Vector* vector = ((struct CrunumVector*)right)->vector;
-		struct CrunumVector* result = PyObject_New(struct CrunumVector, &crn_vector_type);
+		struct CrunumVector* result = crn_vector_alloc();
 		result->vector = vector_mul_scalar(vector, scalar);
 		return (PyObject*)result;
 	}
@@ -215,7 +245,7 @@ static PyObject* crn_vector_mul(PyObject* left, PyObject* right){
 			PyErr_SetString(PyExc_ValueError, "Vector length doesn't match another vector length");
 			return NULL;
 		}
-		struct CrunumVector* result = PyObject_New(struct CrunumVector, &crn_vector_type);
+		struct CrunumVector* result = crn_vector_alloc();
 		result->vector = vector_mul(vector1, vector2);
 		return (PyObject*)result;
 	}
@@ -225,13 +255,13 @@ static PyObject* crn_vector_mul(PyObject* left, PyObject* right){
 			PyErr_SetString(PyExc_ValueError, "Vector length doesn't match matrix row size");
 			return NULL;
 		}
-		struct CrunumVector* result = PyObject_New(struct CrunumVector, &crn_vector_type);
+		struct CrunumVector* result = crn_vector_alloc();
 		result->vector = vector_mul_matrix(vector1, matrix);
 		return (PyObject*)result;
 	}
 	if(PyFloat_Check(right) || PyLong_Check(right)){
-		float scalar = (float)PyFloat_AsDouble(right);
-		struct CrunumVector* result = PyObject_New(struct CrunumVector, &crn_vector_type);
+		double scalar = PyFloat_AsDouble(right);
+		struct CrunumVector* result = crn_vector_alloc();
 		result->vector = vector_mul_scalar(vector1, scalar);
 		return (PyObject*)result;
 	}
@@ -240,9 +270,9 @@ static PyObject* crn_vector_mul(PyObject* left, PyObject* right){
 
 static PyObject* crn_vector_div(PyObject* left, PyObject* right){
 	if(PyFloat_Check(left) || PyLong_Check(left)){
-		float scalar = (float)PyFloat_AsDouble(left);
+		double scalar = PyFloat_AsDouble(left);
 		struct Vector* vector = ((struct CrunumVector*)right)->vector;
-		struct CrunumVector* result = PyObject_New(struct CrunumVector, &crn_vector_type);
+		struct CrunumVector* result = crn_vector_alloc();
 		result->vector = scalar_div_vector(scalar, vector);
 		return (PyObject*)result;
 	}
@@ -255,23 +285,184 @@ static PyObject* crn_vector_div(PyObject* left, PyObject* right){
 			PyErr_SetString(PyExc_ValueError, "Vector length doesn't match another vector length");
 			return NULL;
 		}
-		struct CrunumVector* result = PyObject_New(struct CrunumVector, &crn_vector_type);
+		struct CrunumVector* result = crn_vector_alloc();
 		result->vector = vector_div(vector1, vector2);
 		return (PyObject*)result;
 	}
 	if(PyFloat_Check(right) || PyLong_Check(right)){
-		float scalar = (float)PyFloat_AsDouble(right);
-		struct CrunumVector* result = PyObject_New(struct CrunumVector, &crn_vector_type);
+		double scalar = PyFloat_AsDouble(right);
+		struct CrunumVector* result = crn_vector_alloc();
 		result->vector = vector_div_scalar(vector1, scalar);
 		return (PyObject*)result;
 	}
 	Py_RETURN_NOTIMPLEMENTED;
 }
 
+static PyObject* crn_vector_elementwise_out(struct CrunumVector* self,
+		PyObject* args, PyObject* kwargs, binaryfunc op,
+		struct Vector* (*into)(struct Vector*, struct Vector*, struct Vector*),
+		struct Vector* (*scalar_into)(struct Vector*, struct Vector*, double),
+		struct Vector* (*matrix_into)(struct Vector*, struct Vector*, struct Matrix*)){
+	PyObject* other;
+	PyObject* out = NULL;
+	static char* keywords[] = {"other", "out", NULL};
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", keywords, &other, &out))
+		return NULL;
+	if(!out || out == Py_None)
+		return op((PyObject*)self, other);
+	if(!PyObject_TypeCheck(out, &crn_vector_type)){
+		PyErr_SetString(PyExc_TypeError, "out must be a vector");
+		return NULL;
+	}
+	struct Vector* dst = ((struct CrunumVector*)out)->vector;
+	struct Vector* vector1 = self->vector;
+	struct Vector* result;
+	if(PyObject_TypeCheck(other, &crn_vector_type)){
+		struct Vector* vector2 = ((struct CrunumVector*)other)->vector;
+		if(vector1->len != vector2->len){
+			PyErr_SetString(PyExc_ValueError, "Vector length doesn't match another vector length");
+			return NULL;
+		}
+		result = into(dst, vector1, vector2);
+	}
+	else if(matrix_into && PyObject_TypeCheck(other, &crn_matrix_type)){
+		struct Matrix* matrix = ((struct CrunumMatrix*)other)->matrix;
+		if(vector1->len != matrix->rows){
+			PyErr_SetString(PyExc_ValueError, "Vector length doesn't match matrix row size");
+			return NULL;
+		}
+		result = matrix_into(dst, vector1, matrix);
+	}
+	else if(PyFloat_Check(other) || PyLong_Check(other))
+		result = scalar_into(dst, vector1, PyFloat_AsDouble(other));
+	else
+		Py_RETURN_NOTIMPLEMENTED;
+	if(!result){
+		PyErr_SetString(PyExc_ValueError,
+				"out length doesn't match result length or aliases an operand");
+		return NULL;
+	}
+	Py_INCREF(out);
+	return out;
+}
+
+static PyObject* crn_vector_add_out(struct CrunumVector* self,
+		PyObject* args, PyObject* kwargs){
+	return crn_vector_elementwise_out(self, args, kwargs, crn_vector_add,
+			vector_add_into, vector_add_scalar_into, NULL);
+}
+
+static PyObject* crn_vector_sub_out(struct CrunumVector* self,
+		PyObject* args, PyObject* kwargs){
+	return crn_vector_elementwise_out(self, args, kwargs, crn_vector_sub,
+			vector_sub_into, vector_sub_scalar_into, NULL);
+}
+
+static PyObject* crn_vector_mul_out(struct CrunumVector* self,
+		PyObject* args, PyObject* kwargs){
+	return crn_vector_elementwise_out(self, args, kwargs, crn_vector_mul,
+			vector_mul_into, vector_mul_scalar_into, vector_mul_matrix_into);
+}
+
+static PyObject* crn_vector_div_out(struct CrunumVector* self,
+		PyObject* args, PyObject* kwargs){
+	return crn_vector_elementwise_out(self, args, kwargs, crn_vector_div,
+			vector_div_into, vector_div_scalar_into, NULL);
+}
+
+static PyObject* crn_vector_map(struct CrunumVector* self, PyObject* args, PyObject* kwargs){
+	enum MapFn fn;
+	double param1, param2;
+	PyObject* out;
+	if(!crn_map_parse(args, kwargs, &fn, &param1, &param2, &out))
+		return NULL;
+	if(!out || out == Py_None){
+		struct CrunumVector* result = crn_vector_alloc();
+		if(!result)
+			return NULL;
+		result->vector = vector_map(self->vector, fn, param1, param2);
+		return (PyObject*)result;
+	}
+	if(!PyObject_TypeCheck(out, &crn_vector_type)){
+		PyErr_SetString(PyExc_TypeError, "out must be a vector");
+		return NULL;
+	}
+	if(!vector_map_into(((struct CrunumVector*)out)->vector, self->vector, fn, param1, param2)){
+		PyErr_SetString(PyExc_ValueError, "out length doesn't match result length");
+		return NULL;
+	}
+	Py_INCREF(out);
+	return out;
+}
+
+/*
+ * Mask of where self op other holds elementwise, other being a vector of
+ * the same length or a number.
+ */
+static PyObject* crn_vector_mask(struct CrunumVector* self, PyObject* other,
+		struct Mask* (*compare)(struct Vector*, struct Vector*),
+		struct Mask* (*compare_scalar)(struct Vector*, double)){
+	if(PyFloat_Check(other) || PyLong_Check(other)){
+		double scalar = PyFloat_AsDouble(other);
+		if(scalar == -1 && PyErr_Occurred())
+			return NULL;
+		return crn_mask_wrap(compare_scalar(self->vector, scalar));
+	}
+	if(!PyObject_TypeCheck(other, &crn_vector_type)){
+		PyErr_SetString(PyExc_TypeError, "Expected a vector or a number");
+		return NULL;
+	}
+	struct Vector* vector2 = ((struct CrunumVector*)other)->vector;
+	if(self->vector->len != vector2->len){
+		PyErr_SetString(PyExc_ValueError, "Vector length doesn't match another vector length");
+		return NULL;
+	}
+	return crn_mask_wrap(compare(self->vector, vector2));
+}
+
+static PyObject* crn_vector_eq_mask(struct CrunumVector* self, PyObject* other){
+	return crn_vector_mask(self, other, vector_eq_mask, vector_eq_scalar_mask);
+}
+
+static PyObject* crn_vector_neq_mask(struct CrunumVector* self, PyObject* other){
+	return crn_vector_mask(self, other, vector_neq_mask, vector_neq_scalar_mask);
+}
+
+static PyObject* crn_vector_gt_mask(struct CrunumVector* self, PyObject* other){
+	return crn_vector_mask(self, other, vector_gt_mask, vector_gt_scalar_mask);
+}
+
+static PyObject* crn_vector_ge_mask(struct CrunumVector* self, PyObject* other){
+	return crn_vector_mask(self, other, vector_ge_mask, vector_ge_scalar_mask);
+}
+
+static PyObject* crn_vector_lt_mask(struct CrunumVector* self, PyObject* other){
+	return crn_vector_mask(self, other, vector_lt_mask, vector_lt_scalar_mask);
+}
+
+static PyObject* crn_vector_le_mask(struct CrunumVector* self, PyObject* other){
+	return crn_vector_mask(self, other, vector_le_mask, vector_le_scalar_mask);
+}
+
+static PyObject* crn_vector_allclose(struct CrunumVector* self, PyObject* args, PyObject* kwargs){
+	PyObject* other;
+	double rtol = 1e-5, atol = 1e-8;
+	static char* keywords[] = {"other", "rtol", "atol", NULL};
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "O!|dd", keywords,
+				&crn_vector_type, &other, &rtol, &atol))
+		return NULL;
+	struct Vector* vector2 = ((struct CrunumVector*)other)->vector;
+	if(self->vector->len != vector2->len){
+		PyErr_SetString(PyExc_ValueError, "Vector length doesn't match another vector length");
+		return NULL;
+	}
+	return PyBool_FromLong(vector_allclose(self->vector, vector2, rtol, atol));
+}
+
 static PyObject* crn_vector_compare(PyObject* left, PyObject* right, int op){
 	uint cmp_result;
 	if(PyFloat_Check(left) || PyLong_Check(left)){
-		float scalar = (float)PyFloat_AsDouble(left);
+		double scalar = PyFloat_AsDouble(left);
 		struct Vector* vector = ((struct CrunumVector*)right)->vector;
 		switch(op){
 			case Py_EQ:
@@ -333,7 +524,7 @@ static PyObject* crn_vector_compare(PyObject* left, PyObject* right, int op){
 		Py_RETURN_FALSE;
 	}
 	if(PyFloat_Check(right) || PyLong_Check(right)){
-		float scalar = (float)PyFloat_AsDouble(right);
+		double scalar = PyFloat_AsDouble(right);
 		switch(op){
 			case Py_EQ:
 				cmp_result = vector_eq_scalar(vector1, scalar);
@@ -364,24 +555,120 @@ static PyObject* crn_vector_compare(PyObject* left, PyObject* right, int op){
 }
 
 PyMethodDef crn_vector_methods[] = {
-	{"new", (PyCFunction)crn_vector_new, METH_VARARGS,
-		"Params: len,\n"
+	{"new", (PyCFunction)(void(*)(void))crn_vector_new, METH_VARARGS | METH_KEYWORDS,
+		"Params: len, value(optional), dtype(optional),\n"
 		"Return: Vector,\n"
-		"Desc: Create a new vector\n"
-		"Example: crn.vector.new(10)"
+		"Desc: Create a new vector of dtype 'float32'(default), 'float64',\n"
+		"'float16' or 'bfloat16'\n"
+		"Example: crn.vector.new(10, dtype='float64')"
 	},
-	{"randinit", (PyCFunction)crn_vector_randinit, METH_VARARGS,
-		"Params: len,\n"
+	{"randinit", (PyCFunction)(void(*)(void))crn_vector_randinit, METH_VARARGS | METH_KEYWORDS,
+		"Params: len, dtype(optional),\n"
 		"Return: Vector,\n"
 		"Desc: Create a new randomized vector\n"
 		"Example: crn.vector.randinit(10)"
 	},
-	{"from_list", (PyCFunction)crn_vector_from_list, METH_VARARGS,
-		"Params: list,\n"
+	{"from_list", (PyCFunction)(void(*)(void))crn_vector_from_list, METH_VARARGS | METH_KEYWORDS,
+		"Params: list, dtype(optional),\n"
 		"Return: Vector,\n"
 		"Desc: Create a new vector based of the list given by the user\n"
 		"Example: crn.vector.from_list([1, 2.3])"
 	},
+	{"from_buffer", (PyCFunction)(void(*)(void))crn_vector_from_buffer, METH_VARARGS | METH_KEYWORDS,
+		"Params: buffer, copy(optional), dtype(optional),\n"
+		"Return: Vector,\n"
+		"Desc: Create a vector over a float32, float64 or float16 C contiguous buffer\n"
+		"without copying when it's writable, or from a copy of it otherwise or\n"
+		"with copy=True. Untyped bytes, and uint16 ones with dtype='bfloat16',\n"
+		"are read as dtype(default='float32')\n"
+		"Example: crn.vector.from_buffer(numpy_array)"
+	},
+	{"frombuffer", (PyCFunction)(void(*)(void))crn_vector_from_buffer, METH_VARARGS | METH_KEYWORDS,
+		"Params: buffer, copy(optional), dtype(optional),\n"
+		"Return: Vector,\n"
+		"Desc: Alias of from_buffer\n"
+		"Example: crn.vector.frombuffer(data)"
+	},
+	{"add", (PyCFunction)(void(*)(void))crn_vector_add_out, METH_VARARGS | METH_KEYWORDS,
+		"Params: other, out(optional),\n"
+		"Return: Vector,\n"
+		"Desc: Add vector or scalar, writing into out when given\n"
+		"Example: vec_var.add(vec_var2, out=vec_var)"
+	},
+	{"sub", (PyCFunction)(void(*)(void))crn_vector_sub_out, METH_VARARGS | METH_KEYWORDS,
+		"Params: other, out(optional),\n"
+		"Return: Vector,\n"
+		"Desc: Subtract vector or scalar, writing into out when given\n"
+		"Example: vec_var.sub(1.5, out=vec_var)"
+	},
+	{"mul", (PyCFunction)(void(*)(void))crn_vector_mul_out, METH_VARARGS | METH_KEYWORDS,
+		"Params: other, out(optional),\n"
+		"Return: Vector,\n"
+		"Desc: Multiply by vector, matrix or scalar, writing into out when given\n"
+		"Example: vec_var.mul(mat_var, out=vec_var2)"
+	},
+	{"div", (PyCFunction)(void(*)(void))crn_vector_div_out, METH_VARARGS | METH_KEYWORDS,
+		"Params: other, out(optional),\n"
+		"Return: Vector,\n"
+		"Desc: Divide by vector or scalar, writing into out when given\n"
+		"Example: vec_var.div(vec_var2, out=vec_var)"
+	},
+	{"map", (PyCFunction)(void(*)(void))crn_vector_map, METH_VARARGS | METH_KEYWORDS,
+		"Params: fn, param1(optional), param2(optional), out(optional),\n"
+		"Return: Vector,\n"
+		"Desc: Apply an elementwise function like Matrix.map\n"
+		"Example: vec_var.map('sigmoid')"
+	},	{"eq", (PyCFunction)crn_vector_eq_mask, METH_O,
+		"Params: Vector or number,\n"
+		"Return: Mask,\n"
+		"Desc: Mask of where the vector equals other elementwise\n"
+		"Example: vec_var.eq(vec_var2).count_nonzero()"
+	},
+	{"ne", (PyCFunction)crn_vector_neq_mask, METH_O,
+		"Params: Vector or number,\n"
+		"Return: Mask,\n"
+		"Desc: Mask of where the vector differs from other elementwise\n"
+		"Example: vec_var.ne(vec_var2).count_nonzero()"
+	},
+	{"gt", (PyCFunction)crn_vector_gt_mask, METH_O,
+		"Params: Vector or number,\n"
+		"Return: Mask,\n"
+		"Desc: Mask of where the vector is greater than other elementwise\n"
+		"Example: vec_var.gt(vec_var2).count_nonzero()"
+	},
+	{"ge", (PyCFunction)crn_vector_ge_mask, METH_O,
+		"Params: Vector or number,\n"
+		"Return: Mask,\n"
+		"Desc: Mask of where the vector is greater than or equal to other elementwise\n"
+		"Example: vec_var.ge(vec_var2).count_nonzero()"
+	},
+	{"lt", (PyCFunction)crn_vector_lt_mask, METH_O,
+		"Params: Vector or number,\n"
+		"Return: Mask,\n"
+		"Desc: Mask of where the vector is less than other elementwise\n"
+		"Example: vec_var.lt(vec_var2).count_nonzero()"
+	},
+	{"le", (PyCFunction)crn_vector_le_mask, METH_O,
+		"Params: Vector or number,\n"
+		"Return: Mask,\n"
+		"Desc: Mask of where the vector is less than or equal to other elementwise\n"
+		"Example: vec_var.le(vec_var2).count_nonzero()"
+	},
+	{"allclose", (PyCFunction)(void(*)(void))crn_vector_allclose, METH_VARARGS | METH_KEYWORDS,
+		"Params: Vector, rtol(optional), atol(optional),\n"
+		"Return: bool,\n"
+		"Desc: Whether every |vector - other| <= atol + rtol * |other|, rtol defaulting to 1e-5 and atol to 1e-8,\n"
+		"stopping at the first element that isn't close\n"
+		"Example: vec_var.allclose(vec_var2, rtol=1e-4)"
+	},
+
+	{"astype", (PyCFunction)crn_vector_astype, METH_VARARGS,
+		"Params: dtype,\n"
+		"Return: Vector,\n"
+		"Desc: Copy of the vector converted to 'float32', 'float64', 'float16'\n"
+		"or 'bfloat16'\n"
+		"Example: vec_var.astype('float64')"
+	},
 	{"push", (PyCFunction)crn_vector_push, METH_VARARGS,
 		"Params: value,\n"
 		"Return: None,\n"
@@ -421,6 +708,7 @@ PyTypeObject crn_vector_type = {
 	.tp_str = crn_vector_str,
 	.tp_as_mapping = &crn_vector_as_mapping,
 	.tp_as_number = &crn_vector_as_number,
+	.tp_as_buffer = &crn_vector_as_buffer,
 	.tp_richcompare = crn_vector_compare,
 	.tp_getattro = crn_vector_get_attro,
 };
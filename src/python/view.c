@@ -0,0 +1,566 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0
+ * Copyright (C) 2025 Vgwws
+ *
+ * This file is licensed under the GPL-3.0 License. See LICENSE for details.
+ */
+
+#pragma message "Python View"
+
+#include "python_bind.h"
+
+/*
+ * A view holds a reference to its matrix and counts as one of its
+ * exports, so the matrix can't be reallocated or reshaped under it.
+ * Matrices of other dtypes than float32 have no views, they get a copy
+ * of the block instead.
+ */
+
+PyObject* crn_view_new(struct CrunumMatrix* base, uint row, uint col,
+		uint rows, uint cols, uint vector){
+	if(base->matrix->dtype != DTYPE_F32){
+		struct Matrix* block = matrix_block(base->matrix, row, col, rows, cols);
+		if(!block)
+			return PyErr_NoMemory();
+		struct CrunumMatrix* result = crn_matrix_alloc();
+		if(!result){
+			matrix_free(block);
+			return NULL;
+		}
+		result->matrix = block;
+		return (PyObject*)result;
+	}
+	struct CrunumView* crn_view = PyObject_New(struct CrunumView, &crn_view_type);
+	if(!crn_view)
+		return NULL;
+	view_block(&crn_view->view, base->matrix, row, col, rows, cols);
+	crn_view->vector = vector;
+	Py_INCREF(base);
+	crn_view->base = base;
+	base->exports++;
+	return (PyObject*)crn_view;
+}
+
+/*
+ * O(1) transpose, a view over the same matrix with the transposed flag
+ * flipped. Works on a matrix or on another view, a vector stays one.
+ */
+PyObject* crn_view_transpose(PyObject* obj){
+	struct CrunumMatrix* base;
+	struct View view;
+	uint vector = 0;
+	if(PyObject_TypeCheck(obj, &crn_view_type)){
+		base = ((struct CrunumView*)obj)->base;
+		view = ((struct CrunumView*)obj)->view;
+		vector = ((struct CrunumView*)obj)->vector;
+	}
+	else{
+		base = (struct CrunumMatrix*)obj;
+		view_matrix(&view, base->matrix);
+	}
+	struct CrunumView* crn_view = (struct CrunumView*)crn_view_new(base, 0, 0, 0, 0, vector);
+	if(!crn_view)
+		return NULL;
+	view_transpose(&crn_view->view, &view);
+	return (PyObject*)crn_view;
+}
+
+static void crn_view_free(struct CrunumView* self){
+	self->base->exports--;
+	Py_DECREF(self->base);
+	Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+/*
+ * Views, matrices and vectors all read as views, vectors as 1 x len.
+ * float64 operands don't, so mixing them with views is unsupported.
+ */
+static uint crn_to_view(PyObject* obj, struct View* view){
+	if(PyObject_TypeCheck(obj, &crn_view_type)){
+		*view = ((struct CrunumView*)obj)->view;
+		return 1;
+	}
+	if(PyObject_TypeCheck(obj, &crn_matrix_type)){
+		struct Matrix* matrix = ((struct CrunumMatrix*)obj)->matrix;
+		if(matrix->dtype != DTYPE_F32)
+			return 0;
+		view_matrix(view, matrix);
+		return 1;
+	}
+	if(PyObject_TypeCheck(obj, &crn_vector_type)){
+		struct Vector* vector = ((struct CrunumVector*)obj)->vector;
+		if(vector->dtype != DTYPE_F32)
+			return 0;
+		view_vector(view, vector);
+		return 1;
+	}
+	return 0;
+}
+
+static PyObject* crn_vector_wrap(struct Vector* vector){
+	if(!vector)
+		return PyErr_NoMemory();
+	struct CrunumVector* result = crn_vector_alloc();
+	if(!result){
+		vector_free(vector);
+		return NULL;
+	}
+	result->vector = vector;
+	return (PyObject*)result;
+}
+
+static PyObject* crn_matrix_wrap(struct Matrix* matrix){
+	if(!matrix)
+		return PyErr_NoMemory();
+	struct CrunumMatrix* result = crn_matrix_alloc();
+	if(!result){
+		matrix_free(matrix);
+		return NULL;
+	}
+	result->matrix = matrix;
+	return (PyObject*)result;
+}
+
+/*
+ * Vectors and views of a single row or col read as vectors.
+ */
+static uint crn_is_1d(PyObject* obj){
+	return PyObject_TypeCheck(obj, &crn_vector_type) ||
+		(PyObject_TypeCheck(obj, &crn_view_type) && ((struct CrunumView*)obj)->vector);
+}
+
+/*
+ * Allocates the result in the shape of obj, a vector for vectors, a
+ * matrix otherwise.
+ */
+static PyObject* crn_view_result(PyObject* obj, const struct View* shape,
+		struct View* dst){
+	if(crn_is_1d(obj)){
+		struct Vector* vector = vector_new(shape->rows * shape->cols, 0);
+		if(vector)
+			view_vector(dst, vector);
+		return crn_vector_wrap(vector);
+	}
+	struct Matrix* matrix = matrix_new(shape->rows, shape->cols, 0);
+	if(matrix)
+		view_matrix(dst, matrix);
+	return crn_matrix_wrap(matrix);
+}
+
+/*
+ * Matrix product of views and matrices, transposed operands go to the
+ * kernels as they are. A vector, or the view of a row or col, reads as a
+ * row on the left and a column on the right and makes the result a
+ * vector.
+ */
+static PyObject* crn_view_matmul(PyObject* left, PyObject* right){
+	struct View view1, view2;
+	if(!crn_to_view(left, &view1) || !crn_to_view(right, &view2))
+		Py_RETURN_NOTIMPLEMENTED;
+	uint vector1 = crn_is_1d(left);
+	uint vector2 = crn_is_1d(right);
+	if(vector1 && view1.rows != 1)
+		view_transpose(&view1, &view1);
+	if(vector2 && view2.cols != 1)
+		view_transpose(&view2, &view2);
+	if(view1.cols != view2.rows){
+		PyErr_SetString(PyExc_ValueError, "View col size doesn't match another operand row size");
+		return NULL;
+	}
+	if(vector1 || vector2){
+		struct Vector* result = vector_new(vector1 ? view2.cols : view1.rows, 0);
+		if(result){
+			struct View dst;
+			view_vector(&dst, result);
+			if(!vector1)
+				view_transpose(&dst, &dst);
+			view_matmul_into(&dst, &view1, &view2);
+		}
+		return crn_vector_wrap(result);
+	}
+	return crn_matrix_wrap(view_matmul(&view1, &view2));
+}
+
+/*
+ * Elementwise arithmetic between any two of view, matrix, vector and
+ * scalar, written into out when it's given.
+ */
+static PyObject* crn_view_arith(PyObject* left, PyObject* right,
+		PyObject* out, enum ExprOp op){
+	struct View view1, view2, dst;
+	uint has_view1 = crn_to_view(left, &view1);
+	uint has_view2 = crn_to_view(right, &view2);
+	if((!has_view1 && !PyFloat_Check(left) && !PyLong_Check(left)) ||
+			(!has_view2 && !PyFloat_Check(right) && !PyLong_Check(right)))
+		Py_RETURN_NOTIMPLEMENTED;
+	PyObject* result;
+	if(out){
+		if(!crn_to_view(out, &dst)){
+			PyErr_SetString(PyExc_TypeError, "out must be a view, matrix or vector");
+			return NULL;
+		}
+		Py_INCREF(out);
+		result = out;
+	}
+	else{
+		result = has_view1 ? crn_view_result(left, &view1, &dst) :
+			crn_view_result(right, &view2, &dst);
+		if(!result)
+			return NULL;
+	}
+	struct View* done;
+	if(has_view1 && has_view2){
+		switch(op){
+			case EXPR_ADD:
+				done = view_add_into(&dst, &view1, &view2);
+				break;
+			case EXPR_SUB:
+				done = view_sub_into(&dst, &view1, &view2);
+				break;
+			case EXPR_MUL:
+				done = view_mul_into(&dst, &view1, &view2);
+				break;
+			default:
+				done = view_div_into(&dst, &view1, &view2);
+		}
+	}
+	else if(has_view1){
+		float scalar = (float)PyFloat_AsDouble(right);
+		switch(op){
+			case EXPR_ADD:
+				done = view_add_scalar_into(&dst, &view1, scalar);
+				break;
+			case EXPR_SUB:
+				done = view_sub_scalar_into(&dst, &view1, scalar);
+				break;
+			case EXPR_MUL:
+				done = view_mul_scalar_into(&dst, &view1, scalar);
+				break;
+			default:
+				done = view_div_scalar_into(&dst, &view1, scalar);
+		}
+	}
+	else{
+		float scalar = (float)PyFloat_AsDouble(left);
+		switch(op){
+			case EXPR_ADD:
+				done = view_add_scalar_into(&dst, &view2, scalar);
+				break;
+			case EXPR_SUB:
+				done = scalar_sub_view_into(&dst, scalar, &view2);
+				break;
+			case EXPR_MUL:
+				done = view_mul_scalar_into(&dst, &view2, scalar);
+				break;
+			default:
+				done = scalar_div_view_into(&dst, scalar, &view2);
+		}
+	}
+	if(!done){
+		Py_DECREF(result);
+		PyErr_SetString(PyExc_ValueError, "View size doesn't match another operand size");
+		return NULL;
+	}
+	return result;
+}
+
+static PyObject* crn_view_add(PyObject* left, PyObject* right){
+	return crn_view_arith(left, right, NULL, EXPR_ADD);
+}
+
+static PyObject* crn_view_sub(PyObject* left, PyObject* right){
+	return crn_view_arith(left, right, NULL, EXPR_SUB);
+}
+
+/*
+ * Like matrices and vectors, * is a matrix product unless a scalar or
+ * two vectors, or views of a row or col, are involved, those multiply
+ * elementwise.
+ */
+static PyObject* crn_view_mul(PyObject* left, PyObject* right){
+	struct View view1, view2;
+	if(crn_to_view(left, &view1) && crn_to_view(right, &view2) &&
+			(!crn_is_1d(left) || !crn_is_1d(right)))
+		return crn_view_matmul(left, right);
+	return crn_view_arith(left, right, NULL, EXPR_MUL);
+}
+
+static PyObject* crn_view_div(PyObject* left, PyObject* right){
+	return crn_view_arith(left, right, NULL, EXPR_DIV);
+}
+
+static PyObject* crn_view_out(struct CrunumView* self, PyObject* args,
+		PyObject* kwargs, enum ExprOp op){
+	PyObject* other;
+	PyObject* out = NULL;
+	static char* keywords[] = {"other", "out", NULL};
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", keywords, &other, &out))
+		return NULL;
+	PyObject* result = crn_view_arith((PyObject*)self, other,
+			out == Py_None ? NULL : out, op);
+	if(result == Py_NotImplemented){
+		Py_DECREF(result);
+		PyErr_SetString(PyExc_TypeError, "Expected a view, matrix, vector or scalar");
+		return NULL;
+	}
+	return result;
+}
+
+static PyObject* crn_view_add_out(struct CrunumView* self, PyObject* args, PyObject* kwargs){
+	return crn_view_out(self, args, kwargs, EXPR_ADD);
+}
+
+static PyObject* crn_view_sub_out(struct CrunumView* self, PyObject* args, PyObject* kwargs){
+	return crn_view_out(self, args, kwargs, EXPR_SUB);
+}
+
+static PyObject* crn_view_mul_out(struct CrunumView* self, PyObject* args, PyObject* kwargs){
+	return crn_view_out(self, args, kwargs, EXPR_MUL);
+}
+
+static PyObject* crn_view_div_out(struct CrunumView* self, PyObject* args, PyObject* kwargs){
+	return crn_view_out(self, args, kwargs, EXPR_DIV);
+}
+
+static PyObject* crn_view_matmul_method(struct CrunumView* self, PyObject* other){
+	PyObject* result = crn_view_matmul((PyObject*)self, other);
+	if(result == Py_NotImplemented){
+		Py_DECREF(result);
+		PyErr_SetString(PyExc_TypeError, "Expected a view or matrix");
+		return NULL;
+	}
+	return result;
+}
+
+static PyObject* crn_view_transpose_method(struct CrunumView* self, PyObject* noargs){
+	(void)noargs;
+	return crn_view_transpose((PyObject*)self);
+}
+
+static PyObject* crn_view_copy(struct CrunumView* self, PyObject* noargs){
+	(void)noargs;
+	if(self->vector)
+		return crn_vector_wrap(vector_from_view(&self->view));
+	return crn_matrix_wrap(matrix_from_view(&self->view));
+}
+
+int crn_view_assign_to(struct View* view, PyObject* value){
+	if(PyFloat_Check(value) || PyLong_Check(value)){
+		view_fill(view, (float)PyFloat_AsDouble(value));
+		return 0;
+	}
+	struct View src;
+	if(!crn_to_view(value, &src)){
+		PyErr_SetString(PyExc_TypeError, "Expected a view, matrix, vector or scalar");
+		return -1;
+	}
+	if(!view_copy_into(view, &src)){
+		PyErr_SetString(PyExc_ValueError, "View size doesn't match another operand size");
+		return -1;
+	}
+	return 0;
+}
+
+static PyObject* crn_view_assign(struct CrunumView* self, PyObject* value){
+	if(crn_view_assign_to(&self->view, value) < 0)
+		return NULL;
+	Py_RETURN_NONE;
+}
+
+static PyObject* crn_view_dot(struct CrunumView* self, PyObject* other){
+	struct View view;
+	if(!crn_to_view(other, &view)){
+		PyErr_SetString(PyExc_TypeError, "Expected a view or vector");
+		return NULL;
+	}
+	if(!view_is_1d(&self->view) || !view_is_1d(&view) ||
+			(ulong)view.rows * view.cols != (ulong)self->view.rows * self->view.cols){
+		PyErr_SetString(PyExc_ValueError, "dot needs 1D operands of the same length");
+		return NULL;
+	}
+	return PyFloat_FromDouble(view_dot(&self->view, &view));
+}
+
+/*
+ * 1D views take an index, 2D views a (row, col) tuple.
+ */
+static float* crn_view_element(struct View* view, PyObject* key){
+	long row, col;
+	if(PyLong_Check(key) && view_is_1d(view)){
+		long index = PyLong_AsLong(key);
+		row = view->rows == 1 ? 0 : index;
+		col = view->rows == 1 ? index : 0;
+	}
+	else if(PyTuple_Check(key) && PyTuple_Size(key) == 2 &&
+			PyLong_Check(PyTuple_GetItem(key, 0)) && PyLong_Check(PyTuple_GetItem(key, 1))){
+		row = PyLong_AsLong(PyTuple_GetItem(key, 0));
+		col = PyLong_AsLong(PyTuple_GetItem(key, 1));
+	}
+	else{
+		PyErr_SetString(PyExc_TypeError, "View indices must be an integer or (row, col)");
+		return NULL;
+	}
+	if(row < 0 || col < 0 || (ulong)row >= view->rows || (ulong)col >= view->cols){
+		PyErr_SetString(PyExc_IndexError, "Out of bound");
+		return NULL;
+	}
+	return view_get(view, (uint)row, (uint)col);
+}
+
+static PyObject* crn_view_get(PyObject* self, PyObject* key){
+	float* value = crn_view_element(&((struct CrunumView*)self)->view, key);
+	if(!value)
+		return NULL;
+	return PyFloat_FromDouble(*value);
+}
+
+static int crn_view_set(PyObject* self, PyObject* key, PyObject* value){
+	float* element = crn_view_element(&((struct CrunumView*)self)->view, key);
+	if(!element)
+		return -1;
+	if(!value || (!PyFloat_Check(value) && !PyLong_Check(value))){
+		PyErr_SetString(PyExc_TypeError, "Value must be float or integer");
+		return -1;
+	}
+	*element = (float)PyFloat_AsDouble(value);
+	return 0;
+}
+
+static Py_ssize_t crn_view_len(PyObject* self){
+	struct View* view = &((struct CrunumView*)self)->view;
+	return (Py_ssize_t)view->rows * view->cols;
+}
+
+static PyObject* crn_view_compare(PyObject* left, PyObject* right, int op){
+	struct View view1, view2;
+	if((op != Py_EQ && op != Py_NE) ||
+			!crn_to_view(left, &view1) || !crn_to_view(right, &view2))
+		Py_RETURN_NOTIMPLEMENTED;
+	if(view_eq(&view1, &view2) == (op == Py_EQ))
+		Py_RETURN_TRUE;
+	Py_RETURN_FALSE;
+}
+
+static PyObject* crn_view_str(PyObject* self){
+	struct View* view = &((struct CrunumView*)self)->view;
+	PyObject* result = PyUnicode_FromString("[");
+	for(uint i = 0; i < view->rows; i++){
+		if(view->rows > 1)
+			PyUnicode_Append(&result, PyUnicode_FromString("\n  ["));
+		for(uint j = 0; j < view->cols; j++){
+			char num[16];
+			snprintf(num, sizeof(num), "%.2lf", *view_get(view, i, j));
+			PyUnicode_Append(&result, PyUnicode_FromString(num));
+			if(j != view->cols - 1)
+				PyUnicode_Append(&result, PyUnicode_FromString(", "));
+		}
+		if(view->rows > 1){
+			PyUnicode_Append(&result, PyUnicode_FromString("]"));
+			PyUnicode_Append(&result, PyUnicode_FromString(
+						i != view->rows - 1 ? "," : "\n"));
+		}
+	}
+	PyUnicode_Append(&result, PyUnicode_FromString("]"));
+	return result;
+}
+
+static PyObject* crn_view_get_attro(PyObject* self, PyObject* attr_name){
+	struct CrunumView* crn_view = (struct CrunumView*)self;
+	if(!PyUnicode_Check(attr_name)){
+		PyErr_SetString(PyExc_TypeError, "Attribute name isn't a string");
+		return NULL;
+	}
+	if(!PyUnicode_CompareWithASCIIString(attr_name, "rows"))
+		return PyLong_FromUnsignedLong((ulong)crn_view->view.rows);
+	if(!PyUnicode_CompareWithASCIIString(attr_name, "cols"))
+		return PyLong_FromUnsignedLong((ulong)crn_view->view.cols);
+	if(!PyUnicode_CompareWithASCIIString(attr_name, "len"))
+		return PyLong_FromUnsignedLong((ulong)crn_view->view.rows * crn_view->view.cols);
+	return PyObject_GenericGetAttr(self, attr_name);
+}
+
+static PyMethodDef crn_view_methods[] = {
+	{"copy", (PyCFunction)crn_view_copy, METH_NOARGS,
+		"Params: None,\n"
+		"Return: Matrix or Vector,\n"
+		"Desc: Copy the view into a new vector when 1D or a new matrix\n"
+		"Example: view_var.copy()"
+	},
+	{"assign", (PyCFunction)crn_view_assign, METH_O,
+		"Params: View, Matrix, Vector or scalar,\n"
+		"Return: None,\n"
+		"Desc: Write values through the view into its matrix\n"
+		"Example: mat_var.row(0).assign(vec_var)"
+	},
+	{"dot", (PyCFunction)crn_view_dot, METH_O,
+		"Params: View or Vector,\n"
+		"Return: float,\n"
+		"Desc: Dot product of two 1D operands\n"
+		"Example: mat_var.col(0).dot(mat_var.col(1))"
+	},
+	{"matmul", (PyCFunction)crn_view_matmul_method, METH_O,
+		"Params: View, Matrix or Vector,\n"
+		"Return: Matrix or Vector,\n"
+		"Desc: Matrix product reading both operands in place, transposed or not\n"
+		"Example: mat_var.transpose().matmul(mat_var2)"
+	},
+	{"transpose", (PyCFunction)crn_view_transpose_method, METH_NOARGS,
+		"Params: None,\n"
+		"Return: View,\n"
+		"Desc: Transposed view of the same values, nothing is copied\n"
+		"Example: mat_var[0:2, 1:3].transpose()"
+	},
+	{"add", (PyCFunction)(void(*)(void))crn_view_add_out, METH_VARARGS | METH_KEYWORDS,
+		"Params: other, out(optional),\n"
+		"Return: Matrix, Vector or out,\n"
+		"Desc: Elementwise add, writing into out when given\n"
+		"Example: mat_var.row(0).add(1, out=mat_var.row(0))"
+	},
+	{"sub", (PyCFunction)(void(*)(void))crn_view_sub_out, METH_VARARGS | METH_KEYWORDS,
+		"Params: other, out(optional),\n"
+		"Return: Matrix, Vector or out,\n"
+		"Desc: Elementwise subtract, writing into out when given\n"
+		"Example: mat_var.col(1).sub(vec_var, out=mat_var.col(1))"
+	},
+	{"mul", (PyCFunction)(void(*)(void))crn_view_mul_out, METH_VARARGS | METH_KEYWORDS,
+		"Params: other, out(optional),\n"
+		"Return: Matrix, Vector or out,\n"
+		"Desc: Elementwise multiply, writing into out when given\n"
+		"Example: mat_var.row(1).mul(2, out=mat_var.row(1))"
+	},
+	{"div", (PyCFunction)(void(*)(void))crn_view_div_out, METH_VARARGS | METH_KEYWORDS,
+		"Params: other, out(optional),\n"
+		"Return: Matrix, Vector or out,\n"
+		"Desc: Elementwise divide, writing into out when given\n"
+		"Example: mat_var.row(1).div(2, out=mat_var.row(1))"
+	},
+	{NULL, NULL, 0, NULL},
+};
+
+static PyMappingMethods crn_view_as_mapping = {
+	.mp_length = crn_view_len,
+	.mp_subscript = crn_view_get,
+	.mp_ass_subscript = crn_view_set,
+};
+
+static PyNumberMethods crn_view_as_number = {
+	.nb_add = crn_view_add,
+	.nb_subtract = crn_view_sub,
+	.nb_multiply = crn_view_mul,
+	.nb_true_divide = crn_view_div,
+};
+
+PyTypeObject crn_view_type = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "crunum.matrix.View",
+	.tp_basicsize = sizeof(struct CrunumView),
+	.tp_itemsize = 0,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_dealloc = (destructor)crn_view_free,
+	.tp_methods = crn_view_methods,
+	.tp_str = crn_view_str,
+	.tp_as_mapping = &crn_view_as_mapping,
+	.tp_as_number = &crn_view_as_number,
+	.tp_richcompare = crn_view_compare,
+	.tp_getattro = crn_view_get_attro,
+};
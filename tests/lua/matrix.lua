@@ -37,6 +37,16 @@ print("Pushed matrix: ", empty_mat)
 
 print("Last row: ", empty_mat:pop_row())
 
+local features = crn.matrix.new(2, 0)
+features:reserve(2, 40)
+
+for j = 1, 40 do
+	features:push_col(crn.vector.from({j, -j}))
+end
+
+assert(features:cols() == 40, "push_col should append columns")
+assert(features:get(2, 40) == -40, "pushed columns should keep their values")
+
 local fibo = crn.matrix.new(2, 2)
 fibo:set(1, 1, 1)
 fibo:set(1, 2, 1)
@@ -74,4 +84,197 @@ print("Matrix 1 ~= Matrix 2: ", mat1 ~= mat2)
 
 print("Identity == Identity: ", crn.matrix.identity(10) == crn.matrix.identity(10))
 
+local big = crn.matrix.randinit(70, 45)
+
+assert(crn.matrix.identity(70) * big == big, "identity * big should be big")
+
+crn.set_num_threads(3)
+
+assert(crn.num_threads() == 3, "thread count should be 3")
+
+local large = crn.matrix.new(300, 300, 1.5)
+
+assert(large + large == crn.matrix.new(300, 300, 3), "large + large should be all 3")
+assert(crn.matrix.identity(300) * large == large, "identity * large should be large")
+
+crn.set_num_threads(0)
+
+local out = crn.matrix.new(300, 300)
+
+assert(large:add(large, out) == out, "add should return the destination")
+assert(out == crn.matrix.new(300, 300, 3), "out should be all 3")
+
+out:mul(0.5, out)
+
+assert(out == large, "out should be large after halving in place")
+
+local square = crn.matrix.from({{1, 2}, {3, 4}})
+local ok, err = pcall(square.mul, square, square, square)
+
+assert(not ok and err:find("aliases"), "mul into an operand should report the alias")
+assert(not pcall(square.add, square, square, crn.vector.new(4)), "a vector destination should be rejected")
+
+local lazy = (large:lazy() * 2 + large) / large - 1
+
+assert(lazy:eval() == crn.matrix.new(300, 300, 2), "lazy expression should be all 2")
+assert(lazy:eval(out) == out, "eval should return the destination")
+assert(out == crn.matrix.new(300, 300, 2), "out should be all 2")
+assert(large:lazy() * crn.matrix.identity(300) == large, "lazy * identity should be large")
+
+local system = crn.matrix.from({{4, 2}, {2, 3}})
+local lu = crn.matrix.lu(system)
+
+assert(lu:solve(crn.vector.from({8, 8})) == crn.vector.from({1, 2}), "lu solve should be {1, 2}")
+assert(crn.matrix.solve(system, system) == crn.matrix.identity(2), "system \\ system should be identity")
+
+assert(crn.matrix.from({{2, 0}, {0, 4}}) ^ -2 == crn.matrix.from({{0.25, 0}, {0, 0.0625}}),
+	"{{2, 0}, {0, 4}} ^ -2 should be {{0.25, 0}, {0, 0.0625}}")
+assert(crn.matrix.from({{1, 2}, {3, 4}}):det() == -2, "det of {{1, 2}, {3, 4}} should be -2")
+local shear = crn.matrix.from({{1, 2, 0, 0}, {0, 1, 0, 0}, {0, 0, 2, 0}, {0, 0, 0, 4}})
+assert(shear:inverse() == crn.matrix.from({{1, -2, 0, 0}, {0, 1, 0, 0}, {0, 0, 0.5, 0}, {0, 0, 0, 0.25}}),
+	"4x4 inverse should be closed form")
+
+local scores = crn.matrix.from({{3, -1, 4}, {1, 5, -9}})
+assert(scores:sum() == 3 and scores:mean() == 0.5, "sum should be 3 and mean 0.5")
+assert(scores:min() == -9 and scores:max() == 5, "min should be -9 and max 5")
+local row, col = scores:argmin()
+assert(row == 2 and col == 3, "argmin should be at 2, 3")
+assert(scores:sum(1) == crn.vector.from({4, 4, -5}), "column sums should be {4, 4, -5}")
+assert(scores:argmax(2) == crn.vector.from({3, 2}), "row argmax should be {3, 2}")
+assert(scores:norm(1) == 23 and scores:norm(math.huge) == 9, "norms should be 23 and 9")
+assert(crn.matrix.from({{3, 4}}):norm() == 5, "2-norm of {{3, 4}} should be 5")
+
+local logits = crn.matrix.from({{0, 1}, {-2, 4}})
+
+assert(logits:map("exp"):map("log") == logits, "log should undo exp")
+assert(math.abs(logits:map("sigmoid"):get(1, 1) - 0.5) < 1e-6, "sigmoid of 0 should be 0.5")
+assert(logits:map("clamp", -1, 2) == crn.matrix.from({{0, 1}, {-1, 2}}), "clamp should bound to [-1, 2]")
+assert(logits:map("pow", 3) == crn.matrix.from({{0, 1}, {-8, 64}}), "odd powers should keep the sign")
+assert(logits:map("abs", logits) == logits and logits:get(2, 1) == 2, "map should write into the destination")
+assert(crn.vector.from({4, 9}):map("sqrt") == crn.vector.from({2, 3}), "vector sqrt should be {2, 3}")
+assert(not pcall(logits.map, logits, "clamp", 0), "clamp without an upper bound should fail")
+
+local results = crn.matrix.from({{0.1, 0.2}, {0.3, 0.4}})
+local expected = crn.matrix.from({{0.1, 0.2}, {0.3, 0.5}})
+
+assert(results:lt(expected):count_nonzero() == 1, "only one element should be less")
+assert(results:ge(0.25):get(2, 1) and not results:ge(0.25):get(1, 2), "mask should mark elements >= 0.25")
+assert(results:gt(0.15):tomatrix() == crn.matrix.from({{0, 1}, {1, 1}}), "tomatrix should give 0 and 1")
+assert((results * 3 / 3):allclose(results), "arithmetic round trip should be close")
+assert(not results:allclose(expected) and results:allclose(expected, 0, 0.2), "atol should widen allclose")
+assert(crn.vector.from({1, 2, 3}):neq(2):count_nonzero() == 2, "two elements should differ from 2")
+
+local weights = crn.matrix.randinit(3, 4)
+
+assert(#weights:tobytes() == 48, "3x4 matrix should be 48 bytes")
+assert(crn.matrix.frombytes(3, 4, weights:tobytes()) == weights, "bytes round trip should keep the matrix")
+
+local wide = crn.matrix.randinit(3, 20)
+local packed = crn.matrix.frombytes(1, 60, wide:tobytes())
+
+assert(#wide:tobytes() == 240, "padded rows shouldn't show up in bytes")
+assert(crn.matrix.frombytes(3, 20, wide:tobytes()) == wide, "padded bytes round trip should keep the matrix")
+packed:reshape(3, 20)
+assert(packed == wide, "dense and padded matrices should compare equal")
+wide:reshape(6, 10)
+assert(wide:get(6, 10) == packed:get(3, 20), "reshape should pack padded rows")
+
+local grid = crn.matrix.from({{1, 2, 3}, {4, 5, 6}})
+grid:col(2):assign(crn.vector.from({7, 8}))
+
+assert(grid:row(2) == crn.vector.from({4, 8, 6}), "column view should write through")
+assert(grid:block(1, 2, 2, 2) + 1 == crn.matrix.from({{8, 4}, {9, 7}}), "block view should read in place")
+assert(grid:col(1):dot(grid:col(3)) == 27, "column views should dot in place")
+assert(grid:transpose():get(3, 2) == 6, "transpose should swap indices")
+assert(grid:transpose():copy() == crn.matrix.from({{1, 4}, {7, 8}, {3, 6}}), "copy should materialize the transpose")
+assert(grid:transpose() * grid == crn.matrix.from({{17, 39, 27}, {39, 113, 69}, {27, 69, 45}}),
+	"A^T * A should multiply without copying")
+assert(grid * grid:transpose() == crn.matrix.from({{59, 78}, {78, 116}}), "A * A^T should multiply without copying")
+
+local column1 = crn.matrix.from({{1}, {2}, {3}})
+local column2 = crn.matrix.from({{4}, {5}, {6}})
+local row = crn.matrix.from({{1, 2, 3}})
+
+assert(column1 * column2:transpose() == crn.matrix.from({{4, 5, 6}, {8, 10, 12}, {12, 15, 18}}),
+	"a column times a transposed column should be an outer product")
+assert(row:transpose() * row == crn.matrix.from({{1, 2, 3}, {2, 4, 6}, {3, 6, 9}}),
+	"a transposed row times the row should be an outer product")
+assert(column1:transpose() * column2 == crn.matrix.from({{32}}), "a transposed column times a column should be 1 x 1")
+assert(column1:transpose():copy() == crn.matrix.from({{1, 2, 3}}), "copy should keep the transposed shape")
+
+local precise = crn.matrix.from({{1, 2}, {3, 4}}, "float64")
+precise:set(1, 1, 1 + 1e-12)
+
+assert(precise:dtype() == "float64", "dtype should be float64")
+assert(precise:get(1, 1) == 1 + 1e-12, "float64 should keep double precision")
+precise:set(1, 1, 1)
+assert((precise + crn.matrix.new(2, 2, 1)):dtype() == "float64", "mixed operands should promote to float64")
+assert(precise * precise == crn.matrix.from({{7, 10}, {15, 22}}), "float64 product should be exact")
+assert(precise:transpose() == crn.matrix.from({{1, 3}, {2, 4}}), "float64 transpose should copy")
+assert(#precise:tobytes() == 32, "2x2 float64 matrix should be 32 bytes")
+assert(crn.matrix.frombytes(2, 2, precise:tobytes(), "float64") == precise, "float64 bytes round trip")
+assert(precise:astype("float32"):dtype() == "float32", "astype should convert")
+assert(precise:row(2) == crn.matrix.from({{3, 4}}), "float64 rows should copy")
+assert(precise:col(1):dtype() == "float64", "float64 columns should copy in float64")
+assert(crn.matrix.new(1, 2, 1):row(1) + precise:row(1) == crn.vector.from({2, 3}),
+	"float64 operands should mix with views")
+
+local half = crn.matrix.from({{1, 2}, {3, 4}}, "float16")
+half:set(1, 1, 1 + 1e-4)
+
+assert(half:dtype() == "float16", "dtype should be float16")
+assert(half:get(1, 1) == 1, "float16 should round to its 11 bit mantissa")
+assert((half * half):dtype() == "float16", "float16 products should stay float16")
+assert(half * half == crn.matrix.from({{7, 10}, {15, 22}}), "float16 product should be exact")
+assert((half + half:astype("bfloat16")):dtype() == "float32", "float16 and bfloat16 should meet in float32")
+assert(#half:tobytes() == 8, "2x2 float16 matrix should be 8 bytes")
+assert(crn.matrix.frombytes(2, 2, half:astype("bfloat16"):tobytes(), "bfloat16") == half, "bfloat16 bytes round trip")
+
+local weights = crn.matrix.from({{1, -2, 0.5}, {4, 0, -1}})
+local quantized = weights:quantize(true)
+local restored = quantized:dequantize()
+
+assert(quantized:rows() == 2 and quantized:cols() == 3, "quantized shape should match")
+assert(restored:get(2, 2) == 0, "zero should quantize exactly")
+assert(math.abs(restored:get(2, 1) - 4) <= quantized:scale(2), "dequantized value should be within a step")
+assert(not pcall(crn.matrix.quantize(weights).scale, crn.matrix.quantize(weights), 2),
+	"per tensor quantization should keep one scale")
+local product = quantized * crn.vector.from({1, 2, 3})
+assert(math.abs(product[1] + 1.5) < 0.05 and math.abs(product[2] - 1) < 0.05, "int8 product should be close")
+local out = crn.matrix.new(2, 2)
+assert(quantized:mul(crn.matrix.from({{1, 0}, {0, 1}, {0, 0}}), out) == out, "mul should write into out")
+assert(math.abs(out:get(2, 1) - 4) < 0.05, "int8 matrix product should be close")
+
+local adjacency = crn.matrix.from({{0, 2, 0}, {0, 0, 0}, {1, 0, 3}})
+local sparse = adjacency:sparse()
+
+assert(sparse:nnz() == 3 and sparse:format() == "csr", "sparse should keep the nonzeros")
+assert(sparse:todense() == adjacency, "todense should round trip")
+assert(sparse * crn.vector.from({1, 2, 3}) == crn.vector.from({4, 0, 10}), "SpMV should match dense")
+assert(sparse * adjacency == crn.matrix.from({{0, 0, 0}, {0, 0, 0}, {3, 2, 9}}), "SpMM should match dense")
+assert(sparse:transpose():todense() == adjacency:transpose(), "sparse transpose should match dense")
+assert(crn.matrix.sparse(adjacency, "csc"):tocsr():todense() == adjacency, "csc should convert to csr")
+local triplets = crn.matrix.sparse_triplets(3, 3, {{1, 2, 2}, {3, 3, 1}, {3, 1, 1}, {3, 3, 2}})
+assert(triplets:nnz() == 3 and triplets:todense() == adjacency, "repeated triplets should be summed")
+assert(not pcall(crn.matrix.sparse_triplets, 2, 2, {{3, 1, 1}}), "out of range triplets should fail")
+
+local rotate = crn.matrix.from({{0, -1}, {1, 0}})
+local scale = crn.matrix.from({{2, 0}, {0, 3}})
+local transforms = crn.batch.stack({rotate, scale, rotate})
+
+assert(#transforms == 3 and transforms:rows() == 2, "batch should hold three 2x2 matrices")
+assert(transforms:get(2) == scale, "get should copy a matrix out")
+assert((transforms * transforms):get(1) == crn.matrix.from({{-1, 0}, {0, -1}}), "batched mul should match")
+assert((crn.batch.stack({scale}) * transforms):get(3) == crn.matrix.from({{0, -2}, {3, 0}}),
+	"a single matrix should broadcast")
+local moved = transforms * crn.vector.from({1, 2})
+assert(moved:cols() == 1 and moved:get(2) == crn.matrix.from({{2}, {6}}), "batched mul vector should match")
+assert(transforms:transpose():get(1) == rotate:transpose(), "batched transpose should match")
+transforms:set(3, crn.matrix.from({{1, 2}, {2, 4}}))
+local inverse, singular = transforms:inverse()
+assert(singular == 1, "one matrix should be singular")
+assert(inverse:get(2) == crn.matrix.from({{0.5, 0}, {0, 1 / 3}}), "batched inverse should match")
+local into = crn.batch.new(3, 2, 2)
+assert(transforms:mul(transforms, into) == into, "mul should write into the destination")
+
 print("[SUCCESS]")
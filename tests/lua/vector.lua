@@ -47,4 +47,37 @@ print("Push: ", empty_vec)
 
 print("Last number: ", empty_vec:pop())
 
+local packed = crn.vector.frombytes(string.pack("ffff", 1, 2, 3, 4))
+
+assert(packed == crn.vector.from({1, 2, 3, 4}), "frombytes should read packed floats")
+assert(packed:tobytes() == string.pack("ffff", 1, 2, 3, 4), "tobytes should write packed floats")
+
+local precise = crn.vector.from({1, 2, 3}, "float64")
+precise[1] = 1 + 1e-12
+
+assert(precise:dtype() == "float64", "dtype should be float64")
+assert(precise[1] == 1 + 1e-12, "float64 should keep double precision")
+assert((precise + crn.vector.new(3)):dtype() == "float64", "mixed operands should promote to float64")
+assert(#precise:tobytes() == 24, "3 float64 values should be 24 bytes")
+
+local half = crn.vector.from({1, 2, 3}, "bfloat16")
+
+assert(half:dtype() == "bfloat16", "dtype should be bfloat16")
+assert(half * 2 + half == crn.vector.from({3, 6, 9}), "bfloat16 ops should compute in float32")
+assert((half * 2):dtype() == "bfloat16", "scalar ops should keep bfloat16")
+assert(#half:tobytes() == 6, "3 bfloat16 values should be 6 bytes")
+
+crn.pool_reset_stats()
+local total = crn.arena(function()
+	local sum = crn.vector.new(3, 0)
+	for _ = 1, 100 do
+		sum = sum + crn.vector.from({1, 2, 3})
+	end
+	return sum
+end)
+local stats = crn.pool_stats()
+
+assert(total == crn.vector.from({100, 200, 300}), "arena results should survive the scope")
+assert(stats.frees >= 400, "arena exit should return the temporaries to the pool")
+
 print("[SUCCESS]")
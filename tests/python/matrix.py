@@ -1,6 +1,7 @@
 #!/bin/python3
 
 import sys
+import array
 import vector
 sys.path = ['']
 
@@ -29,7 +30,7 @@ def main():
     mat1.set(2, 1, 3.4)
     mat1.set(1, 0, 11.55)
 
-    assert_eq_list(mat1, [[2.2, 0, 0], [11.55, 0, 0], [0, 3.4, 0]])
+    assert_eq_list(mat1, [[2.2, 3.3, 3.3], [11.55, 3.3, 3.3], [3.3, 3.4, 3.3]])
 
     fibo = crn.matrix.new(2, 2)
 
@@ -39,6 +40,11 @@ def main():
 
     assert_eq_list(fibo, [[1, 1], [1, 0]])
     assert_eq_list(fibo ** 5, [[8, 5], [5, 3]])
+    assert_eq_list(fibo ** 30, [[1346269, 832040], [832040, 514229]])
+
+    scale = crn.matrix.from_list([[2, 0], [0, 4]])
+
+    assert_eq_list(scale ** -2, [[0.25, 0], [0, 0.0625]])
 
     base = crn.matrix.new(2, 2)
 
@@ -52,6 +58,203 @@ def main():
     assert_eq_list(base + base, [[2, 4], [6, 8]])
     assert_eq_scalar(base - base, 0)
     assert_eq_list(base * base, [[7, 10], [15, 22]])
+
+    big = crn.matrix.randinit(70, 45)
+
+    assert crn.matrix.identity(70) * big == big, "identity * big should be big"
+
+    crn.set_num_threads(3)
+
+    assert crn.num_threads() == 3, f"thread count isn't 3, error={crn.num_threads()}"
+
+    large = crn.matrix.new(300, 300, value=1.5)
+
+    assert_eq_scalar(large + large, 3)
+    assert_eq_scalar(large * 2, 3)
+    assert_eq_scalar(crn.matrix.identity(300) * large, 1.5)
+
+    crn.set_num_threads(0)
+
+    out = crn.matrix.new(2, 2)
+
+    assert base.add(base, out=out) is out, "add should return out"
+    assert_eq_list(out, [[2, 4], [6, 8]])
+
+    out.mul(0.5, out=out)
+
+    assert out == base, f"out should be base, error={out}"
+
+    lazy = (base.lazy() * 2 + base) / base - 1
+
+    assert_eq_scalar(lazy.eval(), 2)
+    assert lazy.eval(out=out) is out, "eval should return out"
+    assert_eq_scalar(out, 2)
+    assert_eq_list(base.lazy() * base, [[7, 10], [15, 22]])
+
+    assert_eq_scalar(((large.lazy() + large) * 0.5).eval(), 1.5)
+
+    system = crn.matrix.from_list([[4, 2], [2, 3]])
+    lu = crn.matrix.lu(system)
+
+    vector.assert_eq_list(lu.solve(crn.vector.from_list([8, 8])), [1, 2])
+    assert_eq_list(crn.matrix.solve(system, system), [[1, 0], [0, 1]])
+
+    data = array.array("f", [1, 2, 3, 4, 5, 6])
+    view = crn.matrix.from_buffer(data, 2, 3)
+
+    view.set(1, 2, 9)
+
+    assert data[5] == 9, f"view should write through, error={data[5]}"
+    assert memoryview(view).shape == (2, 3), "memoryview shape should be (2, 3)"
+    assert_eq_list(crn.matrix.frombuffer(bytes(memoryview(view)), rows=3), [[1, 2], [3, 4], [5, 9]])
+
+    wide = crn.matrix.from_list([[i * 20 + j for j in range(20)] for i in range(3)])
+
+    assert memoryview(wide).strides[1] == 4, "padded rows should keep float items"
+    assert memoryview(wide).strides[0] >= 80, "padded rows should export their stride"
+    assert crn.matrix.frombuffer(bytes(memoryview(wide)), rows=3) == wide, "padded rows should copy out dense"
+    wide.reshape(6, 10)
+    assert wide[5, 9] == 59, f"reshape should pack padded rows, error={wide[5, 9]}"
+
+    grid = crn.matrix.from_list([[1, 2, 3], [4, 5, 6]])
+    grid.col(1).assign(crn.vector.from_list([7, 8]))
+
+    assert_eq_list(grid, [[1, 7, 3], [4, 8, 6]])
+    vector.assert_eq_list(grid[0] + grid[1], [5, 15, 9])
+    assert_eq_list(grid[:, 1:] * 2, [[14, 6], [16, 12]])
+    assert grid.col(0).dot(grid.col(2)) == 27, "column views should dot in place"
+    assert grid.transpose()[2, 1] == 6, "transpose should swap indices"
+    assert_eq_list(grid.transpose().copy(), [[1, 4], [7, 8], [3, 6]])
+    assert_eq_list(grid.transpose() * grid, [[17, 39, 27], [39, 113, 69], [27, 69, 45]])
+    assert_eq_list(grid * grid.transpose(), [[59, 78], [78, 116]])
+    vector.assert_eq_list(grid.transpose() * crn.vector.from_list([1, 1]), [5, 15, 9])
+
+    column1 = crn.matrix.from_list([[1], [2], [3]])
+    column2 = crn.matrix.from_list([[4], [5], [6]])
+    row = crn.matrix.from_list([[1, 2, 3]])
+
+    assert_eq_list(column1 * column2.transpose(), [[4, 5, 6], [8, 10, 12], [12, 15, 18]])
+    assert_eq_list(row.transpose() * row, [[1, 2, 3], [2, 4, 6], [3, 6, 9]])
+    assert_eq_list(column1.transpose() * column2, [[32]])
+    assert_eq_list(column1.transpose().copy(), [[1, 2, 3]])
+
+    grid[0, 0:2] = 0
+    first_row = grid.row(0)
+
+    assert_eq_list(grid, [[0, 0, 3], [4, 8, 6]])
+    try:
+        grid.push_row(crn.vector.from_list([1, 1, 1]))
+        raise AssertionError("push_row should fail while a view is alive")
+    except BufferError:
+        pass
+
+    del first_row
+    grid.push_row(crn.vector.from_list([1, 1, 1]))
+
+    assert grid.rows == 3, f"push_row should work once views are gone, error={grid.rows}"
+
+    features = crn.matrix.new(2, 0)
+    features.reserve(2, 40)
+
+    for j in range(40):
+        features.push_col(crn.vector.from_list([j, -j]))
+
+    assert features.cols == 40, f"push_col should append columns, error={features.cols}"
+    assert features[1, 39] == -39, f"pushed columns should keep their values, error={features[1, 39]}"
+
+    precise = crn.matrix.from_list([[1, 2], [3, 4]], dtype="float64")
+    precise[0, 0] = 1 + 1e-12
+
+    assert precise.dtype == "float64", f"dtype should be float64, error={precise.dtype}"
+    assert precise[0, 0] == 1 + 1e-12, f"float64 should keep double precision, error={precise[0, 0]}"
+    precise[0, 0] = 1
+    assert (precise + base).dtype == "float64", "mixed operands should promote to float64"
+    assert_eq_list(precise * precise, [[7, 10], [15, 22]])
+    assert_eq_list(precise.transpose(), [[1, 3], [2, 4]])
+    assert precise.astype("float32").dtype == "float32", "astype should convert"
+    assert memoryview(precise).format == "d", "float64 buffers should export doubles"
+    assert crn.matrix.from_buffer(array.array("d", [1, 2, 3, 4]), 2, 2) == precise, "from_buffer should take doubles"
+    vector.assert_eq_list(crn.matrix.solve(system.astype("float64"), crn.vector.from_list([8, 8])), [1, 2])
+    assert_eq_list(precise.row(1), [[3, 4]])
+    assert precise.col(0).dtype == "float64", "float64 columns should copy in float64"
+    assert_eq_list(precise[:, 1:], [[2], [4]])
+    precise[1] = crn.matrix.from_list([[5, 6]])
+    assert_eq_list(precise, [[1, 2], [5, 6]])
+    precise[1] = 0
+    assert_eq_list(precise, [[1, 2], [0, 0]])
+
+    half = crn.matrix.from_list([[1, 2], [3, 4]], dtype="float16")
+    half[0, 0] = 1 + 1e-4
+
+    assert half.dtype == "float16", f"dtype should be float16, error={half.dtype}"
+    assert half[0, 0] == 1, f"float16 should round to its 11 bit mantissa, error={half[0, 0]}"
+    assert (half * half).dtype == "float16", "float16 products should stay float16"
+    assert_eq_list(half * half, [[7, 10], [15, 22]])
+    assert_eq_list(half.transpose() + 1, [[2, 4], [3, 5]])
+    assert (half + half.astype("bfloat16")).dtype == "float32", "float16 and bfloat16 should meet in float32"
+    assert memoryview(half).format == "e", "float16 buffers should export halves"
+    assert crn.matrix.from_buffer(memoryview(half).tobytes(), 2, 2, dtype="float16") == half, "float16 bytes round trip"
+    brain = half.astype("bfloat16")
+    assert memoryview(brain).format == "H", "bfloat16 buffers should export raw bits"
+    assert crn.matrix.from_buffer(array.array("H", memoryview(brain).tobytes()), 2, 2, dtype="bfloat16") == half, \
+        "from_buffer should take bfloat16 bits"
+
+    weights = crn.matrix.from_list([[1, -2, 0.5], [4, 0, -1]])
+    quantized = crn.matrix.quantize(weights, per_row=True)
+    restored = quantized.dequantize()
+
+    assert quantized.rows == 2 and quantized.cols == 3, "quantized shape should match"
+    assert len(quantized.scales) == 2, f"per row quantization should keep a scale per row, error={quantized.scales}"
+    assert restored[1, 1] == 0, f"zero should quantize exactly, error={restored[1, 1]}"
+    for i in range(2):
+        for j in range(3):
+            assert abs(restored[i, j] - weights[i, j]) <= quantized.scales[i], \
+                f"dequantized value should be within a step, error={restored[i, j]}"
+    product = quantized * crn.vector.from_list([1, 2, 3])
+    assert abs(product[0] + 1.5) < 0.05 and abs(product[1] - 1) < 0.05, f"int8 product should be close, error={product}"
+    assert len(crn.matrix.quantize(weights).scales) == 1, "per tensor quantization should keep one scale"
+    out = crn.matrix.new(2, 2)
+    assert quantized.mul(crn.matrix.from_list([[1, 0], [0, 1], [0, 0]]), out=out) is out, "mul should write into out"
+    assert abs(out[1, 0] - 4) < 0.05, f"int8 matrix product should be close, error={out[1, 0]}"
+
+    adjacency = crn.matrix.from_list([[0, 2, 0], [0, 0, 0], [1, 0, 3]])
+    sparse = crn.matrix.sparse(adjacency)
+
+    assert sparse.nnz == 3 and sparse.format == "csr", f"sparse should keep the nonzeros, error={sparse.nnz}"
+    assert sparse.todense() == adjacency, "todense should round trip"
+    vector.assert_eq_list(sparse * crn.vector.from_list([1, 2, 3]), [4, 0, 10])
+    assert_eq_list(sparse * adjacency, [[0, 0, 0], [0, 0, 0], [3, 2, 9]])
+    assert sparse.transpose().todense() == adjacency.transpose(), "sparse transpose should match dense"
+    assert sparse.transpose().format == "csc", "transpose should flip the format"
+    assert crn.matrix.sparse(adjacency, format="csc").tocsr().todense() == adjacency, "csc should convert to csr"
+    triplets = crn.matrix.sparse_triplets(3, 3, [(0, 1, 2), (2, 2, 1), (2, 0, 1), (2, 2, 2)])
+    assert triplets.nnz == 3 and triplets.todense() == adjacency, "repeated triplets should be summed"
+    try:
+        crn.matrix.sparse_triplets(2, 2, [(2, 0, 1)])
+        raise AssertionError("out of range triplets should raise")
+    except IndexError:
+        pass
+
+    rotate = crn.matrix.from_list([[0, -1], [1, 0]])
+    scale = crn.matrix.from_list([[2, 0], [0, 3]])
+    transforms = crn.batch.stack([rotate, scale, rotate])
+
+    assert len(transforms) == 3 and transforms.rows == 2, f"batch shape is wrong, error={len(transforms)}"
+    assert_eq_list(transforms[1], [[2, 0], [0, 3]])
+    assert_eq_list((transforms * transforms)[0], [[-1, 0], [0, -1]])
+    assert_eq_list((crn.batch.stack([scale]) * transforms)[2], [[0, -2], [3, 0]])
+    moved = transforms * crn.vector.from_list([1, 2])
+    assert moved.cols == 1, f"batch mul vector should give columns, error={moved.cols}"
+    assert_eq_list(moved[1], [[2], [6]])
+    assert_eq_list(transforms.transpose()[0], [[0, 1], [-1, 0]])
+    transforms[2] = crn.matrix.from_list([[1, 2], [2, 4]])
+    inverse, singular = transforms.inverse()
+    assert singular == 1, f"one matrix should be singular, error={singular}"
+    assert_eq_list(inverse[1], [[0.5, 0], [0, 1 / 3]])
+    out = crn.batch.new(3, 2, 2)
+    assert transforms.mul(transforms, out=out) is out, "mul should write into out"
+    assert_eq_list(out[-1], [[5, 10], [10, 20]])
+
     assert_eq_scalar(base / base, 1)
 
     assert_eq_list(base + 2, [[3, 4], [5, 6]])
@@ -68,6 +271,16 @@ def main():
 
     assert_eq_list(base, [[1, 2], [3, 4], [5, 6]])
 
+    wide = crn.matrix.new(0, 4096)
+    wide_row = crn.vector.new(4096, 1)
+    crn.pool_reset_stats()
+    for _ in range(1000):
+        wide.push_row(wide_row)
+    stats = crn.pool_stats()
+
+    assert wide.rows == 1000 and wide[999, 4095] == 1, "pushed rows should keep their values"
+    assert stats["allocs"] < 40, f"push_row past the pool classes should stay amortized, error={stats}"
+
     assert base.rows == 3, f"base row size isn't 3, error={base.rows}"
     assert base.cols == 2, f"base col size isn't 2, error={base.rows}"
 
@@ -86,6 +299,42 @@ def main():
 
     assert_eq_list(base * base_inverse, [[1, 0], [0, 1]])
 
+    assert base.det() == -2, f"det of base isn't -2, error={base.det()}"
+
+    shear = crn.matrix.from_list([[1, 2, 0, 0], [0, 1, 0, 0], [0, 0, 2, 0], [0, 0, 0, 4]])
+
+    assert_eq_list(shear.inverse(), [[1, -2, 0, 0], [0, 1, 0, 0], [0, 0, 0.5, 0], [0, 0, 0, 0.25]])
+    assert shear.det() == 8, f"det of shear isn't 8, error={shear.det()}"
+
+    scores = crn.matrix.from_list([[3, -1, 4], [1, 5, -9]])
+
+    assert scores.sum() == 3 and scores.mean() == 0.5, f"sum and mean aren't 3 and 0.5, error={scores.sum()}"
+    assert scores.min() == -9 and scores.max() == 5, f"min and max aren't -9 and 5, error={scores.min()}"
+    assert scores.argmin() == 5, f"argmin isn't 5, error={scores.argmin()}"
+    vector.assert_eq_list(scores.sum(axis=0), [4, 4, -5])
+    vector.assert_eq_list(scores.argmax(axis=1), [2, 1])
+    assert scores.norm(1) == 23 and scores.norm(float("inf")) == 9, f"norms aren't 23 and 9, error={scores.norm(1)}"
+    assert crn.matrix.from_list([[3, 4]]).norm() == 5, "2-norm of [[3, 4]] isn't 5"
+
+    logits = crn.matrix.from_list([[0, 1], [-2, 4]])
+
+    assert_eq_list(logits.map("exp").map("log"), [[0, 1], [-2, 4]])
+    assert abs(logits.map("sigmoid")[0, 0] - 0.5) < 1e-6, f"sigmoid(0) isn't 0.5, error={logits.map('sigmoid')[0, 0]}"
+    assert_eq_list(logits.map("clamp", -1, 2), [[0, 1], [-1, 2]])
+    assert_eq_list(logits.map("pow", 3), [[0, 1], [-8, 64]])
+    assert logits.map("abs", out=logits) is logits, "map with out doesn't return out"
+    vector.assert_eq_list(crn.vector.from_list([4, 9]).map("sqrt"), [2, 3])
+
+    results = crn.matrix.from_list([[0.1, 0.2], [0.3, 0.4]])
+    expected = crn.matrix.from_list([[0.1, 0.2], [0.3, 0.5]])
+
+    assert results.lt(expected).count_nonzero() == 1, "only one element should be less"
+    assert results.ge(0.25)[1, 0] and not results.ge(0.25)[0, 1], "mask should mark elements >= 0.25"
+    assert_eq_list(results.gt(0.15).tomatrix(), [[0, 1], [1, 1]])
+    assert (results * 3 / 3).allclose(results), "arithmetic round trip should be close"
+    assert not results.allclose(expected) and results.allclose(expected, atol=0.2), "atol should widen allclose"
+    assert crn.vector.from_list([1, 2, 3]).ne(2).count_nonzero() == 2, "two elements should differ from 2"
+
     print("[SUCCESS]")
 
 if __name__ == "__main__":
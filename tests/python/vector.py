@@ -2,6 +2,7 @@
 
 import sys
 import math
+import array
 sys.path = ['']
 
 import crunum as crn
@@ -38,8 +39,51 @@ def main():
 
     assert math.isclose(last_value, 6.7, rel_tol=1e-6), f"should be 6.7, error={last_value}"
 
+    grown = crn.vector.new(0)
+    crn.pool_reset_stats()
+    for i in range(10000):
+        grown.push(i)
+    stats = crn.pool_stats()
+
+    assert grown.len == 10000 and grown[9999] == 9999, "pushed values should be kept"
+    assert stats["allocs"] < 30, f"push should double the capacity, error={stats}"
+
     assert vec1.len == 3, f"vec1 length isn't 3, error={vec1.len}"
 
+    data = array.array("f", [1, 2, 3])
+    view = crn.vector.from_buffer(data)
+
+    data[0] = 4
+
+    assert_eq_list(view, [4, 2, 3])
+    assert memoryview(view).tolist() == [4, 2, 3], "memoryview should see the vector values"
+
+    precise = crn.vector.from_list([1, 2, 3], dtype="float64")
+    precise[0] = 1 + 1e-12
+
+    assert precise.dtype == "float64", f"dtype should be float64, error={precise.dtype}"
+    assert precise[0] == 1 + 1e-12, f"float64 should keep double precision, error={precise[0]}"
+    assert (precise + crn.vector.new(3)).dtype == "float64", "mixed operands should promote to float64"
+    assert memoryview(precise).itemsize == 8, "float64 buffers should export doubles"
+    assert crn.vector.from_buffer(array.array("d", [1, 2])).dtype == "float64", "from_buffer should take doubles"
+
+    half = crn.vector.from_list([1, 2, 3], dtype="bfloat16")
+
+    assert half.dtype == "bfloat16", f"dtype should be bfloat16, error={half.dtype}"
+    assert_eq_list(half * 2 + half, [3, 6, 9])
+    assert (half * 2).dtype == "bfloat16", "scalar ops should keep bfloat16"
+    assert_eq_list(crn.matrix.identity(3, dtype="float16") * half, [1, 2, 3])
+    assert memoryview(half.astype("float16")).itemsize == 2, "float16 buffers should export halves"
+
+    crn.pool_reset_stats()
+    with crn.arena():
+        for _ in range(100):
+            total = crn.vector.from_list([1, 2, 3]) + 1
+    stats = crn.pool_stats()
+
+    assert_eq_list(total, [2, 3, 4])
+    assert stats["hits"] > stats["misses"], f"temporaries should be recycled, error={stats}"
+
     print("[SUCCESS]")
 
 if __name__ == "__main__":